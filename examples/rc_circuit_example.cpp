@@ -1,8 +1,11 @@
 #include "core/circuit.h"
+#include "core/result_store.h"
+#include <algorithm>
 #include <iostream>
 #include <memory>
 #include <iomanip>
 #include <cmath>
+#include <vector>
 
 using namespace ic_sim;
 
@@ -49,25 +52,27 @@ int main() {
     std::cout << "\\nRunning transient simulation..." << std::endl;
     double duration = 0.01; // 10ms
     double timestep = 1e-5; // 10μs
-    int steps = static_cast<int>(duration / timestep);
+    
+    // Record the output voltage and resistor current at every step
+    auto results = std::make_shared<ResultStore>();
+    results->addProbe("v(VOUT)");
+    results->addProbe("i(R1)");
+    circuit->setResultStore(results);
+    circuit->simulate(duration, timestep);
     
     std::cout << "Time(ms)\\tVout(V)\\tCurrent(mA)" << std::endl;
     std::cout << "--------\\t-------\\t-----------" << std::endl;
     
-    for (int i = 0; i <= steps; i += steps/20) {
-        double time = i * timestep;
-        
-        // Simulate one timestep
-        resistor->simulate(timestep);
-        capacitor->simulate(timestep);
-        
-        // Display results every 5% of simulation
-        if (i % (steps/20) == 0) {
-            std::cout << std::fixed << std::setprecision(2);
-            std::cout << time * 1000 << "\\t\\t";
-            std::cout << vout->getVoltage() << "\\t\\t";
-            std::cout << resistor->getCurrentValue() * 1000 << std::endl;
-        }
+    // Display results every 5% of simulation
+    std::vector<double> time = results->copyTime();
+    std::vector<double> vout_samples = results->copySamples(results->findProbe("v(VOUT)"));
+    std::vector<double> current = results->copySamples(results->findProbe("i(R1)"));
+    size_t every = std::max<size_t>(1, time.size() / 20);
+    for (size_t i = 0; i < time.size(); i += every) {
+        std::cout << std::fixed << std::setprecision(2);
+        std::cout << time[i] * 1000 << "\\t\\t";
+        std::cout << vout_samples[i] << "\\t\\t";
+        std::cout << current[i] * 1000 << std::endl;
     }
     
     std::cout << "\\nSimulation completed!" << std::endl;
@@ -0,0 +1,168 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <typeindex>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+namespace ic_sim {
+
+/**
+ * Memory usage of a CircuitArena
+ */
+struct ArenaStats {
+    size_t pools = 0;           // one per object type
+    size_t objects = 0;         // live objects across all pools
+    size_t bytes_reserved = 0;  // capacity of all chunks
+    size_t bytes_used = 0;      // bytes occupied by live objects
+};
+
+/**
+ * Type-erased interface so an arena can own pools of different types
+ */
+class PoolBase {
+public:
+    virtual ~PoolBase() = default;
+    virtual void addStats(ArenaStats& stats) const = 0;
+};
+
+/**
+ * Pool of T objects stored back to back in large chunks
+ * Objects are never freed individually; they are destroyed together with the
+ * pool, which releases whole chunks instead of one allocation per object.
+ */
+template <typename T>
+class TypedPool : public PoolBase {
+public:
+    static constexpr size_t kDefaultChunkBytes = 64 * 1024;
+
+    TypedPool() = default;
+    TypedPool(const TypedPool&) = delete;
+    TypedPool& operator=(const TypedPool&) = delete;
+
+    ~TypedPool() override {
+        for (auto& chunk : chunks_) {
+            T* objects = chunk.objects();
+            for (size_t i = 0; i < chunk.used; ++i) {
+                objects[i].~T();
+            }
+        }
+    }
+
+    template <typename... Args>
+    T* create(Args&&... args) {
+        if (chunks_.empty() || chunks_.back().used == chunks_.back().capacity) {
+            reserve(std::max<size_t>(1, kDefaultChunkBytes / sizeof(T)));
+        }
+        Chunk& chunk = chunks_.back();
+        T* object = new (chunk.objects() + chunk.used) T(std::forward<Args>(args)...);
+        ++chunk.used;
+        return object;
+    }
+
+    // Makes room for at least `count` more objects in a single contiguous chunk
+    void reserve(size_t count) {
+        if (!chunks_.empty() && chunks_.back().capacity - chunks_.back().used >= count) {
+            return;
+        }
+        chunks_.push_back(Chunk(count));
+    }
+
+    size_t size() const {
+        size_t total = 0;
+        for (const auto& chunk : chunks_) {
+            total += chunk.used;
+        }
+        return total;
+    }
+
+    void addStats(ArenaStats& stats) const override {
+        ++stats.pools;
+        for (const auto& chunk : chunks_) {
+            stats.objects += chunk.used;
+            stats.bytes_reserved += chunk.capacity * sizeof(T);
+            stats.bytes_used += chunk.used * sizeof(T);
+        }
+    }
+
+private:
+    struct Chunk {
+        explicit Chunk(size_t count)
+            : storage(new Storage[count]), capacity(count), used(0) {}
+
+        T* objects() { return std::launder(reinterpret_cast<T*>(storage.get())); }
+
+        struct Storage {
+            alignas(T) unsigned char bytes[sizeof(T)];
+        };
+        std::unique_ptr<Storage[]> storage;
+        size_t capacity;
+        size_t used;
+    };
+
+    std::vector<Chunk> chunks_;
+};
+
+/**
+ * Owns the typed pools backing one circuit's nodes and components
+ * A circuit only ever uses a handful of types, so pools are found with a short
+ * linear scan keyed by std::type_index; unlike a static per-type counter this
+ * stays correct when plugins compiled into other shared objects create objects.
+ */
+class CircuitArena {
+public:
+    CircuitArena() = default;
+    CircuitArena(const CircuitArena&) = delete;
+    CircuitArena& operator=(const CircuitArena&) = delete;
+
+    ~CircuitArena() {
+        // Later pools may reference objects in earlier ones; tear down newest first
+        while (!pools_.empty()) {
+            pools_.pop_back();
+        }
+    }
+
+    template <typename T, typename... Args>
+    T* create(Args&&... args) {
+        return pool<T>().create(std::forward<Args>(args)...);
+    }
+
+    template <typename T>
+    void reserve(size_t count) {
+        pool<T>().reserve(count);
+    }
+
+    ArenaStats getStats() const {
+        ArenaStats stats;
+        for (const auto& entry : pools_) {
+            entry.pool->addStats(stats);
+        }
+        return stats;
+    }
+
+private:
+    struct Entry {
+        std::type_index type;
+        std::unique_ptr<PoolBase> pool;
+    };
+
+    template <typename T>
+    TypedPool<T>& pool() {
+        const std::type_index type(typeid(T));
+        for (auto& entry : pools_) {
+            if (entry.type == type) {
+                return static_cast<TypedPool<T>&>(*entry.pool);
+            }
+        }
+        pools_.push_back({type, std::make_unique<TypedPool<T>>()});
+        return static_cast<TypedPool<T>&>(*pools_.back().pool);
+    }
+
+    std::vector<Entry> pools_;
+};
+
+} // namespace ic_sim
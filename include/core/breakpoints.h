@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <queue>
+#include <vector>
+
+namespace ic_sim {
+
+/**
+ * Priority queue of upcoming waveform corners consumed by the transient stepper
+ * Each entry remembers the source that published it, so the source is only asked
+ * for its following corner once this one has been reached. The queue therefore
+ * holds at most one pending entry per source, however long the run is.
+ */
+class BreakpointQueue {
+public:
+    struct Entry {
+        double time;
+        size_t source;
+
+        bool operator>(const Entry& other) const { return time > other.time; }
+    };
+
+    void push(double time, size_t source) { heap_.push({time, source}); }
+    void pop() { heap_.pop(); }
+    void clear() { heap_ = decltype(heap_)(); }
+
+    const Entry& top() const { return heap_.top(); }
+    // Pending entries in time order, e.g. for a checkpoint
+    std::vector<Entry> getEntries() const {
+        std::vector<Entry> entries;
+        for (auto heap = heap_; !heap.empty(); heap.pop()) {
+            entries.push_back(heap.top());
+        }
+        return entries;
+    }
+    bool empty() const { return heap_.empty(); }
+    size_t size() const { return heap_.size(); }
+
+private:
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> heap_;
+};
+
+} // namespace ic_sim
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "core/device_state.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace ic_sim {
+
+/**
+ * State of a transient run after an accepted step, enough to continue it bit
+ * for bit (Circuit::resume)
+ * The stepper keeps no step-size history of its own: the next step follows
+ * from the time, the run's nominal timestep and the pending source corners,
+ * so those are stored with the stats. The circuit side is the node voltages,
+ * the SoA device banks and the private state of every device outside them.
+ * Checkpoints are immutable once captured and shared by pointer, so a writer
+ * can serialize one on another thread while the run goes on.
+ */
+struct SimulationCheckpoint {
+    // Run position
+    double duration = 0.0;
+    double timestep = 0.0;
+    double time = 0.0;
+    uint64_t steps = 0;
+    uint64_t breakpoints = 0;
+    // Corners still ahead, with the handle of the source that published each
+    std::vector<double> pending_times;
+    std::vector<uint32_t> pending_sources;
+    // Rows the result store had recorded, the initial point included; a resumed
+    // run records the rows after these
+    uint64_t recorded_rows = 0;
+
+    // Circuit state, checked against the circuit on resume
+    uint64_t component_count = 0;
+    SimdLevel simd_level = SimdLevel::Scalar;
+    std::vector<double> node_voltages;
+    DeviceStateSnapshot devices;
+    // Devices outside the banks in DeviceState::getUnbound() order: their
+    // handles, and their Component::saveState values, device i at
+    // device_offsets[i]..device_offsets[i + 1]
+    std::vector<uint32_t> device_handles;
+    std::vector<uint64_t> device_offsets{0};
+    std::vector<double> device_values;
+};
+
+/**
+ * Receives checkpoints from Circuit::simulate and Circuit::resume
+ * due() is asked after every accepted step and has to be cheap; when it says
+ * yes the circuit captures its state and hands it to write(), which may keep
+ * the checkpoint and store it on another thread. finish() ends the run.
+ */
+class CheckpointSink {
+public:
+    virtual ~CheckpointSink() = default;
+
+    virtual bool due(size_t steps) = 0;
+    virtual void write(std::shared_ptr<const SimulationCheckpoint> checkpoint) = 0;
+    virtual void finish() {}
+};
+
+} // namespace ic_sim
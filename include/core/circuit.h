@@ -1,85 +1,422 @@
 #pragma once
 
+#include "core/arena.h"
+#include "core/checkpoint.h"
+#include "core/device_state.h"
+#include "core/symbol_table.h"
+#include "core/topology.h"
+#include <cstdint>
 #include <memory>
 #include <vector>
 #include <string>
-#include <map>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
 
 namespace ic_sim {
 
+// Integer handles assigned by the owning Circuit; they index its node and component tables
+using NodeId = uint32_t;
+using ComponentId = uint32_t;
+constexpr uint32_t kInvalidId = kInvalidSymbol;
+
 // Forward declarations
 class Component;
 class Node;
 class Circuit;
+class Source;
+class ConvergenceMonitor;
+class ResultStore;
+class BreakpointQueue;
 
 /**
  * Abstract base class for all circuit components
- * Implements the Strategy pattern for different component behaviors
+ * Implements the Strategy pattern for different component behaviors.
+ * Terminals are plain Node pointers: the nodes are owned by the circuit (or,
+ * for standalone use, kept alive by connect()), so wiring a component inside a
+ * circuit costs no reference-count traffic.
  */
-class Component : public std::enable_shared_from_this<Component> {
+class Component {
 public:
     virtual ~Component() = default;
     
     virtual void simulate(double timestep) = 0;
     virtual double getCurrentValue() const = 0;
-    virtual void connect(std::shared_ptr<Node> node) = 0;
     virtual std::string getType() const = 0;
     
+    // Copy of this component, parameters and state included, used when a cloned
+    // circuit takes a private copy. Types returning nullptr can be shared by
+    // clones but not edited or simulated in one.
+    virtual std::unique_ptr<Component> clone() const { return nullptr; }
+    
+    // Appends the device's state, parameters and terminal handles to one of the
+    // circuit's SoA banks. Returning false keeps the device on the per-object
+    // simulate() path. Leaves the device itself alone: clones bind the devices
+    // they share, and only the circuit that owns a device attaches it.
+    virtual bool bindState(DeviceState& /*state*/) const { return false; }
+    // An attached device reads its state through its bank slot until
+    // unbindState() copies it back
+    virtual void attachState(DeviceState& /*state*/, size_t /*slot*/) {}
+    virtual void unbindState() {}
+    // The circuit moved the attached state to another slot of the same bank
+    virtual void moveSlot(size_t /*slot*/) {}
+    
+    // Returns the device to its power-on state (bound state is reset by the circuit)
+    virtual void resetState() {}
+    
+    // Appends the state a checkpoint needs to continue this device bit for bit,
+    // and reads it back in the same layout. Bound state is saved with the banks.
+    // False if the device cannot be checkpointed.
+    virtual bool saveState(std::vector<double>& /*values*/) const { return false; }
+    virtual void restoreState(const double* /*values*/) {}
+    
+    // Appends the values that rebuild this device: schema slot order for plugin
+    // types, a type-specific layout for built-in ones. False if the device
+    // cannot be described that way (it is then not cacheable).
+    virtual bool getParameters(std::vector<double>& /*values*/) const { return false; }
+    // Changes value `index` of that layout in place, bound state included.
+    // False if the device has no such parameter or cannot change it.
+    virtual bool setParameter(size_t /*index*/, double /*value*/) { return false; }
+    
+    // Attaches the next terminal and keeps the node alive. Inside a circuit prefer
+    // Circuit::connect, which records the terminal without touching refcounts.
+    virtual void connect(std::shared_ptr<Node> node);
+    
     void setId(const std::string& id) { id_ = id; }
-    std::string getId() const { return id_; }
+    const std::string& getId() const { return id_; }
+    
+    // Handle in the circuit this component was last added to
+    ComponentId getHandle() const { return handle_; }
+    
+    // Terminal nodes in connection order
+    const std::vector<Node*>& getNodes() const { return nodes_; }
 
 protected:
     std::string id_;
-    std::vector<std::shared_ptr<Node>> nodes_;
+    std::vector<Node*> nodes_;
+
+private:
+    friend class Circuit;
+    ComponentId handle_ = kInvalidId;
+    // Ownership taken by connect(); empty for circuit-wired components
+    std::vector<std::shared_ptr<Node>> retained_nodes_;
 };
 
 /**
  * Node class representing circuit connection points
+ * Which components touch a node is not stored per node; it is available from
+ * the circuit's compiled Topology. Inside a circuit the voltage lives in the
+ * circuit's voltage table (Circuit::getVoltages), under the node's handle.
  */
 class Node {
 public:
     Node(const std::string& id) : id_(id), voltage_(0.0) {}
     
-    void setVoltage(double voltage) { voltage_ = voltage; }
-    double getVoltage() const { return voltage_; }
+    void setVoltage(double voltage) { (voltages_ ? (*voltages_)[handle_] : voltage_) = voltage; }
+    double getVoltage() const { return voltages_ ? (*voltages_)[handle_] : voltage_; }
     
-    void addComponent(std::shared_ptr<Component> component) {
-        connected_components_.push_back(component);
-    }
+    const std::string& getId() const { return id_; }
     
-    std::string getId() const { return id_; }
+    // Handle in the circuit this node was last added to
+    NodeId getHandle() const { return handle_; }
 
 private:
+    friend class Circuit;
     std::string id_;
     double voltage_;
-    std::vector<std::weak_ptr<Component>> connected_components_;
+    NodeId handle_ = kInvalidId;
+    // Voltage table of the circuit the node is attached to; null for standalone
+    // nodes and for nodes shared between clones
+    std::vector<double>* voltages_ = nullptr;
+};
+
+enum class SteadyState {
+    None,
+    Settled,
+    Periodic
+};
+
+/**
+ * Summary of the most recent transient run
+ */
+struct SimulationStats {
+    size_t steps = 0;        // accepted timesteps
+    size_t breakpoints = 0;  // source corners the stepper landed on
+    double end_time = 0.0;
+    
+    // Filled in when a convergence monitor stopped the run early
+    SteadyState steady_state = SteadyState::None;
+    double settle_time = 0.0;
+    double period = 0.0;
 };
 
 /**
  * Circuit class implementing the Composite pattern
- * Manages collections of components and nodes
+ * Manages collections of components and nodes. Identifiers are interned once
+ * when an element is added; after that nodes and components are addressed by
+ * NodeId/ComponentId handles with O(1) vector lookups. The string overloads
+ * are thin wrappers kept for compatibility.
+ *
+ * Elements can either be created by the caller and added, or built in place with
+ * createNode/createComponent. The latter allocate from typed pools in the circuit's
+ * arena and are released in bulk with the circuit; the shared_ptrs they return do
+ * not own the object and must not outlive the circuit.
+ *
+ * clone() is copy-on-write: the copy shares the elements, name tables and compiled
+ * topology with its source. Node voltages and bound device state are not part of
+ * the elements: every circuit keeps its own voltage table and DeviceState, so
+ * clones simulate, reset and checkpoint shared nodes and devices side by side.
+ * While its elements are shared, a circuit hands out private copies of single
+ * nodes and devices (getNode, getComponent, editComponent), and a run copies only
+ * the devices that keep state outside the banks, such as sources. Structural
+ * edits give the editing circuit private copies of all elements. Handles stay
+ * valid across all of this, element pointers fetched earlier do not.
  */
 class Circuit {
 public:
-    Circuit(const std::string& name) : name_(name) {}
+    Circuit(const std::string& name);
+    // Nodes point at the circuit's voltage table, so a circuit stays where it
+    // was built; nodes still held elsewhere keep their last voltage
+    ~Circuit();
+    Circuit(const Circuit&) = delete;
+    Circuit& operator=(const Circuit&) = delete;
+    
+    // Variant sharing everything with this circuit until one of them writes.
+    // Both circuits start from this circuit's voltages and device state; the
+    // convergence monitor is not carried over.
+    std::unique_ptr<Circuit> clone(const std::string& name);
+    
+    // Component to change parameters on, as getComponent(id); throws
+    // std::out_of_range for an unknown handle
+    std::shared_ptr<Component> editComponent(ComponentId id);
+    
+    // True while elements are shared with a clone or a source circuit
+    bool isShared() const { return elements_.use_count() > 1; }
+    // Devices this circuit copied out of elements it shares
+    size_t getEditCount() const { return edits_.size(); }
+    
+    // Unlike add*, these throw std::invalid_argument for an empty or taken id;
+    // the id is checked before anything is built in the arena
+    std::shared_ptr<Node> createNode(const std::string& id);
+    template <typename T, typename... Args>
+    std::shared_ptr<T> createComponent(const std::string& id, Args&&... args);
+    
+    // Pre-sizes the arena pool and handle tables for bulk construction
+    template <typename T>
+    void reserve(size_t count);
+    
+    // Attaches the next terminal of a component by handle. The circuit owns both
+    // sides, so this is a plain pointer append with no atomic operations.
+    void connect(ComponentId component, NodeId node);
+    
+    ArenaStats getArenaStats() const { return elements_->arena->getStats(); }
     
-    void addComponent(std::shared_ptr<Component> component);
-    void addNode(std::shared_ptr<Node> node);
+    // Adding an element whose id is already present replaces it under the same handle.
+    // Elements with an empty id are ignored and get kInvalidId.
+    ComponentId addComponent(std::shared_ptr<Component> component);
+    NodeId addNode(std::shared_ptr<Node> node);
     
     void simulate(double duration, double timestep);
+    
+    // Continues the run a checkpoint was taken from, up to its duration. Node
+    // voltages, device state, the stats and the pending source corners are
+    // restored first, so the steps match the uninterrupted run bit for bit.
+    // The result store records the rows after the checkpoint; a convergence
+    // monitor starts a fresh history. Throws std::invalid_argument if the
+    // circuit does not have the devices the checkpoint was taken from, or if the
+    // result store has sinks: they would restart their output instead of
+    // continuing it at the checkpoint's recorded_rows.
+    void resume(const SimulationCheckpoint& checkpoint);
+    
+    // Restores node voltages and all device state to the saved initial conditions,
+    // or to zero if none were saved. Bound device state is restored with one pass
+    // over the SoA banks, so this is cheap enough to call between sweep points.
+    // Devices outside the banks get their saved state back, or resetState() if
+    // they could not save it.
     void reset();
+    // Captures the current node voltages and device state as the reset target,
+    // including the state of devices outside the banks (Component::saveState).
+    // Structural edits discard it.
+    void saveInitialConditions();
+    void clearInitialConditions() { initial_conditions_.reset(); }
+    bool hasInitialConditions() const { return initial_conditions_ != nullptr; }
+    
+    // Freezes the current connectivity into a CSR Topology; throws if a terminal is
+    // outside the circuit. Adding elements drops the cached topology, but terminals
+    // attached with Component::connect are only picked up by the next compile().
+    const Topology& compile();
+    std::shared_ptr<const Topology> getTopology() const { return topology_; }
+    // Adopts a topology compiled earlier for this exact connectivity (e.g. read
+    // from the netlist cache) instead of compiling; throws std::invalid_argument
+    // if it does not match the circuit's elements and terminals
+    void setTopology(std::shared_ptr<const Topology> topology);
+    
+    // Incremental (ECO) edits of a compiled or simulated circuit. Where the
+    // functions above drop the compiled topology and the device state, these
+    // patch both: the topology rewrites only the rows of the nodes involved
+    // (see Topology::addDevice), an inserted device takes a new slot in the
+    // existing SoA banks, a removed one hands its slot to the last device of
+    // its bank, and a parameter change writes through to the slot.
+    // Initial conditions are discarded as with any structural edit. Removal
+    // keeps handles dense: the last node or component takes over the removed
+    // handle. Throw std::invalid_argument on unknown handles, ids already in
+    // use and nodes that still have terminals attached.
+    NodeId insertNode(const std::string& id);
+    ComponentId insertComponent(std::shared_ptr<Component> component, const std::vector<NodeId>& terminals);
+    void removeComponent(ComponentId id);
+    void removeNode(NodeId id);
+    // Sets value `index` of the device's getParameters() layout
+    void setParameter(ComponentId id, size_t index, double value);
     
+    // On a circuit whose elements are shared these copy the node or device out
+    // of the shared elements first, so writes through them stay in this circuit
+    const std::shared_ptr<Node>& getNode(NodeId id);
+    const std::shared_ptr<Component>& getComponent(ComponentId id);
     std::shared_ptr<Node> getNode(const std::string& id);
     std::shared_ptr<Component> getComponent(const std::string& id);
     
+    // kInvalidId if no element has that id
+    NodeId findNode(std::string_view id) const { return node_names_->find(id); }
+    ComponentId findComponent(std::string_view id) const { return component_names_->find(id); }
+    std::string_view getNodeName(NodeId id) const { return node_names_->name(id); }
+    std::string_view getComponentName(ComponentId id) const { return component_names_->name(id); }
+    
+    // Node voltages by handle; what runs read and write
+    const std::vector<double>& getVoltages() const { return voltages_; }
+    
+    // SoA store of device state, built by the first simulate() after a
+    // structural change; null before that
+    const DeviceState* getDeviceState() const { return state_.get(); }
+    // Kernel width for the device state; defaults to the widest the CPU supports
+    void setSimdLevel(SimdLevel level);
+    
+    size_t getNodeCount() const { return elements_->nodes.size(); }
+    size_t getComponentCount() const { return elements_->components.size(); }
+    
     std::string getName() const { return name_; }
+    void setName(const std::string& name) { name_ = name; }
+    const SimulationStats& getLastRunStats() const { return stats_; }
+    
+    // Optional: stop transient runs once the monitored quantities are steady
+    void setConvergenceMonitor(std::shared_ptr<ConvergenceMonitor> monitor) { monitor_ = monitor; }
+    std::shared_ptr<ConvergenceMonitor> getConvergenceMonitor() const { return monitor_; }
+    
+    // Optional: record the store's probes at t=0 and after every accepted step.
+    // Like the monitor, the store is not carried over to clones.
+    void setResultStore(std::shared_ptr<ResultStore> results) { results_ = std::move(results); }
+    std::shared_ptr<ResultStore> getResultStore() const { return results_; }
+    
+    // Optional: capture the run's state whenever the sink asks for it. Not
+    // carried over to clones either.
+    void setCheckpointSink(std::shared_ptr<CheckpointSink> sink) { checkpoints_ = std::move(sink); }
+    std::shared_ptr<CheckpointSink> getCheckpointSink() const { return checkpoints_; }
 
 private:
+    // Element tables, shared between a circuit and its clones
+    struct Elements {
+        // Declared first so arena-built elements outlive every table that points at them
+        std::unique_ptr<CircuitArena> arena = std::make_unique<CircuitArena>();
+        std::vector<std::shared_ptr<Component>> components;
+        std::vector<std::shared_ptr<Node>> nodes;
+        std::vector<std::shared_ptr<Source>> sources;
+        // Nodes read the owning circuit's voltage table and bound devices are
+        // attached to its DeviceState; cleared before the elements are shared
+        bool attached = true;
+    };
+    
+    // Reset target; immutable, so clones share it
+    struct InitialConditions {
+        std::vector<double> node_voltages;
+        DeviceStateSnapshot devices;
+        // Unbound devices in DeviceState order, laid out like a checkpoint's;
+        // saved[i] is false for a device whose saveState() declined
+        std::vector<uint64_t> device_offsets{0};
+        std::vector<double> device_values;
+        std::vector<bool> saved;
+    };
+    
+    // Element tables this circuit may write: copies shared tables and folds in edits
+    Elements& mutableElements();
+    // Hands voltages and bound state back to the elements before they are shared
+    void detach();
+    static void detachNode(Node& node);
+    // A node of this circuit: in the elements, or this circuit's copy of one
+    bool ownsNode(const Node* node) const;
+    // Moves terminals of a device copy from the source circuit's nodes to this one's
+    void wireTerminals(Component& component, const Circuit& source);
+    DeviceState& deviceState();
+    // Device state for a run; devices outside the banks are made private first
+    DeviceState& runState();
+    // The run's sources, in Elements::sources order
+    std::vector<Source*> runSources();
+    // Drops the device state and the initial conditions after a structural edit
+    void invalidateState();
+    void replaceComponent(Elements& elements, ComponentId handle, std::shared_ptr<Component> component);
+    // Interns the id of a new element and appends it under the next handle;
+    // kInvalidId if the id is already taken
+    ComponentId appendComponent(std::shared_ptr<Component> component);
+    NodeId appendNode(std::shared_ptr<Node> node);
+    // Steps from time to duration; recorded_rows counts the rows of the run
+    // recorded before this call
+    void transient(const std::vector<Source*>& sources, double duration, double timestep, double time,
+                   BreakpointQueue& breakpoints, size_t recorded_rows);
+    std::shared_ptr<SimulationCheckpoint> captureCheckpoint(const std::vector<Source*>& sources, double duration,
+                                                            double timestep, double time,
+                                                            const BreakpointQueue& breakpoints,
+                                                            size_t recorded_rows) const;
+    
     std::string name_;
-    std::map<std::string, std::shared_ptr<Component>> components_;
-    std::map<std::string, std::shared_ptr<Node>> nodes_;
+    std::shared_ptr<Elements> elements_;
+    // Private device and node copies layered over shared elements_, by handle
+    std::unordered_map<ComponentId, std::shared_ptr<Component>> edits_;
+    std::unordered_map<NodeId, std::shared_ptr<Node>> node_edits_;
+    std::vector<double> voltages_;
+    // Copied before a new name is interned while shared
+    std::shared_ptr<SymbolTable> component_names_;
+    std::shared_ptr<SymbolTable> node_names_;
+    std::shared_ptr<ConvergenceMonitor> monitor_;
+    std::shared_ptr<ResultStore> results_;
+    std::shared_ptr<CheckpointSink> checkpoints_;
+    std::shared_ptr<const Topology> topology_;
+    // Declared after elements_ so devices are unbound before they can be released
+    std::unique_ptr<DeviceState> state_;
+    SimdLevel simd_level_ = detectSimdLevel();
+    std::shared_ptr<const InitialConditions> initial_conditions_;
+    SimulationStats stats_;
 };
 
+template <typename T, typename... Args>
+std::shared_ptr<T> Circuit::createComponent(const std::string& id, Args&&... args) {
+    if (id.empty() || findComponent(id) != kInvalidId) {
+        throw std::invalid_argument("Component '" + id + "' cannot be created in circuit " + name_);
+    }
+    T* raw = mutableElements().arena->create<T>(std::forward<Args>(args)...);
+    raw->setId(id);
+    // Aliasing an empty owner gives a non-owning pointer with no control block
+    std::shared_ptr<T> component(std::shared_ptr<T>(), raw);
+    appendComponent(component);
+    return component;
+}
+
+template <typename T>
+void Circuit::reserve(size_t count) {
+    Elements& elements = mutableElements();
+    elements.arena->reserve<T>(count);
+    if (std::is_base_of<Node, T>::value) {
+        elements.nodes.reserve(elements.nodes.size() + count);
+        if (node_names_.use_count() == 1) {
+            node_names_->reserve(elements.nodes.size() + count);
+        }
+    } else {
+        elements.components.reserve(elements.components.size() + count);
+        if (component_names_.use_count() == 1) {
+            component_names_->reserve(elements.components.size() + count);
+        }
+    }
+}
+
 /**
  * Resistor component implementation
  */
@@ -88,15 +425,41 @@ public:
     Resistor(double resistance) : resistance_(resistance), current_(0.0) {}
     
     void simulate(double timestep) override;
-    double getCurrentValue() const override { return current_; }
-    void connect(std::shared_ptr<Node> node) override;
+    double getCurrentValue() const override { return bank_ ? bank_->current[slot_] : current_; }
     std::string getType() const override { return "Resistor"; }
+    std::unique_ptr<Component> clone() const override;
+    
+    bool bindState(DeviceState& state) const override;
+    void attachState(DeviceState& state, size_t slot) override;
+    void unbindState() override;
+    void moveSlot(size_t slot) override { slot_ = slot; }
+    void resetState() override;
+    bool saveState(std::vector<double>& values) const override {
+        values.push_back(current_);
+        return true;
+    }
+    void restoreState(const double* values) override { current_ = values[0]; }
+    bool getParameters(std::vector<double>& values) const override {
+        values.push_back(resistance_);
+        return true;
+    }
+    bool setParameter(size_t index, double value) override {
+        if (index != 0) {
+            return false;
+        }
+        setResistance(value);
+        return true;
+    }
     
     double getResistance() const { return resistance_; }
+    void setResistance(double resistance);
 
 private:
     double resistance_;
     double current_;
+    // Set while the state lives in the circuit's DeviceState
+    ResistorBank* bank_ = nullptr;
+    size_t slot_ = 0;
 };
 
 /**
@@ -104,19 +467,44 @@ private:
  */
 class Capacitor : public Component {
 public:
-    Capacitor(double capacitance) : capacitance_(capacitance), charge_(0.0), voltage_(0.0) {}
+    Capacitor(double capacitance) : capacitance_(capacitance), charge_(0.0), voltage_(0.0), current_(0.0) {}
     
     void simulate(double timestep) override;
-    double getCurrentValue() const override { return voltage_; }
-    void connect(std::shared_ptr<Node> node) override;
+    double getCurrentValue() const override { return bank_ ? bank_->voltage[slot_] : voltage_; }
     std::string getType() const override { return "Capacitor"; }
+    std::unique_ptr<Component> clone() const override;
+    
+    bool bindState(DeviceState& state) const override;
+    void attachState(DeviceState& state, size_t slot) override;
+    void unbindState() override;
+    void moveSlot(size_t slot) override { slot_ = slot; }
+    void resetState() override;
+    bool saveState(std::vector<double>& values) const override;
+    void restoreState(const double* values) override;
+    bool getParameters(std::vector<double>& values) const override {
+        values.push_back(capacitance_);
+        return true;
+    }
+    bool setParameter(size_t index, double value) override {
+        if (index != 0) {
+            return false;
+        }
+        setCapacitance(value);
+        return true;
+    }
     
     double getCapacitance() const { return capacitance_; }
+    void setCapacitance(double capacitance);
+    double getCharge() const { return bank_ ? bank_->charge[slot_] : charge_; }
 
 private:
     double capacitance_;
     double charge_;
     double voltage_;
+    double current_;
+    // Set while the state lives in the circuit's DeviceState
+    CapacitorBank* bank_ = nullptr;
+    size_t slot_ = 0;
 };
 
 } // namespace ic_sim
\ No newline at end of file
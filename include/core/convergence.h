@@ -0,0 +1,135 @@
+#pragma once
+
+#include "core/circuit.h"
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ic_sim {
+
+/**
+ * Per-probe settings for steady-state detection
+ * A probe is settled once its last `window` samples stay within
+ * abstol + reltol * |x|. It is periodic once `periods` consecutive cycles have
+ * matching lengths (within period_reltol) and matching peaks and troughs
+ * (within abstol + reltol * |x|). The window does not limit the period that
+ * can be detected.
+ */
+struct ProbeTolerance {
+    size_t window = 64;
+    double abstol = 1e-6;
+    double reltol = 1e-3;
+    size_t periods = 3;
+    double period_reltol = 1e-2;
+};
+
+/**
+ * Watches selected circuit quantities during a transient run and decides when
+ * the run has reached steady state (DC settled or periodic)
+ * All checks are incremental: sliding-window extrema use monotonic deques and
+ * periodicity is only re-examined when a probe crosses its mid level, so each
+ * sample costs O(1) amortised per probe.
+ *
+ * Cycles close on upward crossings of the midpoint between the last completed
+ * cycle's peak and trough. Before the first cycle, or when the signal has not
+ * come back to that level for two cycle lengths, the level is taken from the
+ * extrema since the last crossing instead, kept in blocks that double in
+ * length so an early transient ages out. A crossing only counts after the
+ * signal has been in the bottom quarter of its swing.
+ */
+class ConvergenceMonitor {
+public:
+    size_t addProbe(const std::string& name, std::function<double()> read,
+                    const ProbeTolerance& tolerance = {});
+    // Node voltage and device current probes are bound by handle when a run
+    // starts, so they follow the circuit the monitor is set on, clones included
+    size_t addNodeProbe(NodeId node, const ProbeTolerance& tolerance = {});
+    size_t addComponentProbe(ComponentId component, const ProbeTolerance& tolerance = {});
+
+    // Called by Circuit::simulate and resume: binds the handle probes to the
+    // circuit's voltage table and devices, names them V(node) and the device id,
+    // and clears the history. Throws std::invalid_argument for a handle the
+    // circuit does not have.
+    void begin(Circuit& circuit);
+    // Clears all sample history
+    void reset();
+
+    // Records every probe at the given time. Returns true once all probes are
+    // steady at the same time.
+    bool sample(double time);
+
+    bool isSteady() const { return steady_; }
+    SteadyState getState() const;
+    SteadyState getProbeState(size_t probe) const { return probes_.at(probe).state; }
+    const std::string& getProbeName(size_t probe) const { return probes_.at(probe).name; }
+    size_t getProbeCount() const { return probes_.size(); }
+
+    // Earliest time from which every probe has stayed steady
+    double getSettleTime() const { return settle_time_; }
+    // Longest detected period over the periodic probes; 0 if all settled to DC
+    double getPeriod() const { return period_; }
+
+private:
+    enum class Target {
+        Reader,
+        Node,
+        Component
+    };
+
+    struct Probe {
+        std::string name;
+        std::function<double()> read;
+        ProbeTolerance tolerance;
+        // What begin() binds read to
+        Target target = Target::Reader;
+        uint32_t handle = kInvalidId;
+
+        size_t count = 0;
+        double previous = 0.0;
+        double previous_time = 0.0;
+        std::deque<double> times;
+        std::deque<std::pair<size_t, double>> window_max;
+        std::deque<std::pair<size_t, double>> window_min;
+
+        // Upward mid-level crossings and the extrema of the cycles between them
+        std::deque<double> crossings;
+        std::deque<double> peaks;
+        std::deque<double> troughs;
+        double cycle_max = 0.0;
+        double cycle_min = 0.0;
+        bool armed = false;
+
+        // Extrema since the last crossing: the current block and the one
+        // before it, which together span at least half of that time
+        size_t block_count = 0;
+        size_t block_length = 0;
+        double block_max = 0.0;
+        double block_min = 0.0;
+        bool has_previous = false;
+        double previous_max = 0.0;
+        double previous_min = 0.0;
+
+        SteadyState state = SteadyState::None;
+        double settle_time = 0.0;
+        double period = 0.0;
+    };
+
+    size_t add(Probe probe);
+    void update(Probe& probe, double time, double value);
+    // Restarts the extrema kept since the last crossing
+    static void restartBlocks(Probe& probe);
+    static void trackBlocks(Probe& probe, double value);
+    bool isSettled(const Probe& probe) const;
+    bool isPeriodic(const Probe& probe) const;
+
+    std::vector<Probe> probes_;
+    bool steady_ = false;
+    double settle_time_ = 0.0;
+    double period_ = 0.0;
+};
+
+} // namespace ic_sim
@@ -0,0 +1,185 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace ic_sim {
+
+class Component;
+
+enum class SimdLevel {
+    Scalar,
+    AVX2,
+    AVX512
+};
+
+// Widest kernel set this CPU can run
+SimdLevel detectSimdLevel();
+const char* toString(SimdLevel level);
+
+/**
+ * Capacitor integration state, one entry per bound device. Terminals are node
+ * handles into the voltage table the bank is stepped with.
+ */
+struct CapacitorBank {
+    std::vector<uint32_t> positive;
+    std::vector<uint32_t> negative;
+    std::vector<double> capacitance;
+    std::vector<double> charge;
+    std::vector<double> voltage;
+    std::vector<double> current;
+
+    size_t add(uint32_t pos, uint32_t neg, double c, double q, double v, double i);
+    // Moves the last entry into slot and drops the last one
+    void remove(size_t slot);
+    size_t size() const { return capacitance.size(); }
+};
+
+/**
+ * Inductor integration state, one entry per bound device
+ */
+struct InductorBank {
+    std::vector<uint32_t> positive;
+    std::vector<uint32_t> negative;
+    std::vector<double> inductance;
+    std::vector<double> current;
+    std::vector<double> voltage;
+
+    size_t add(uint32_t pos, uint32_t neg, double l, double i, double v);
+    // Moves the last entry into slot and drops the last one
+    void remove(size_t slot);
+    size_t size() const { return inductance.size(); }
+};
+
+/**
+ * Resistor state, one entry per bound device; the current follows the
+ * terminal voltages of each step
+ */
+struct ResistorBank {
+    std::vector<uint32_t> positive;
+    std::vector<uint32_t> negative;
+    std::vector<double> resistance;
+    std::vector<double> current;
+
+    size_t add(uint32_t pos, uint32_t neg, double r, double i);
+    // Moves the last entry into slot and drops the last one
+    void remove(size_t slot);
+    size_t size() const { return resistance.size(); }
+};
+
+// Copy of every bank's state, used as a reset target
+struct DeviceStateSnapshot {
+    std::vector<double> capacitor_charge;
+    std::vector<double> capacitor_voltage;
+    std::vector<double> capacitor_current;
+    std::vector<double> inductor_current;
+    std::vector<double> inductor_voltage;
+    std::vector<double> resistor_current;
+};
+
+// Largest local truncation error estimate of the last step, per bank
+struct TruncationError {
+    double charge = 0.0;   // capacitors, coulombs
+    double current = 0.0;  // inductors, amperes
+};
+
+/**
+ * Structure-of-arrays state of a circuit's devices
+ * Devices that support it add their state to per-type banks (Component::bindState)
+ * and, once attached, read it back through their slot. Each step gathers the
+ * terminal voltages once from the circuit's voltage table and advances every bank
+ * with a vectorized kernel chosen at runtime. Devices are kept by circuit handle.
+ * A device can be bound without being attached: clones share device objects but
+ * each steps its own banks. Destroying the store hands the state back to the
+ * attached devices.
+ */
+class DeviceState {
+public:
+    explicit DeviceState(SimdLevel level = detectSimdLevel());
+    // Same banks and device places with nothing attached, for a clone of the
+    // circuit; the clone attaches its own device copies with replace()
+    DeviceState(const DeviceState& other);
+    ~DeviceState();
+
+    DeviceState& operator=(const DeviceState&) = delete;
+
+    // Offers every component a slot, in handle order; the ones that decline stay
+    // on the per-object path
+    void bind(const std::vector<std::shared_ptr<Component>>& components, bool attach = true);
+    // Same for one component added later; the existing slots are untouched
+    void add(Component* component, bool attach = true);
+    // Hands a component's state back to it and frees its slot. The last device
+    // of that bank moves into the slot (Component::moveSlot), so the banks stay
+    // dense and every other device keeps its place. As in the circuit, the
+    // device with the last handle takes over the removed one's.
+    void remove(Component* component);
+    // Puts a device in the place of the one with its handle, e.g. a circuit's
+    // private copy of a shared device, and attaches it to the bound state
+    void replace(Component* component);
+    // replace() for a whole component table
+    void attach(const std::vector<std::shared_ptr<Component>>& components);
+    // Hands the bound state back to the attached devices, which stay in their
+    // places; the banks keep their values
+    void detach();
+    // Terminals on node handle `from` move to `to`
+    void moveNode(uint32_t from, uint32_t to);
+
+    const std::vector<Component*>& getUnbound() const { return unbound_; }
+    size_t getBoundCount() const { return capacitors_.size() + inductors_.size() + resistors_.size(); }
+
+    CapacitorBank& capacitors() { return capacitors_; }
+    InductorBank& inductors() { return inductors_; }
+    ResistorBank& resistors() { return resistors_; }
+    const CapacitorBank& capacitors() const { return capacitors_; }
+    const InductorBank& inductors() const { return inductors_; }
+    const ResistorBank& resistors() const { return resistors_; }
+
+    // Advances every bank by one step of the given length; voltages are indexed
+    // by node handle
+    void step(const std::vector<double>& voltages, double timestep);
+    const TruncationError& getLastError() const { return error_; }
+
+    // Zeroes every bank, or restores a snapshot taken from this store; both are
+    // straight passes over the contiguous state arrays
+    void clear();
+    DeviceStateSnapshot save() const;
+    void restore(const DeviceStateSnapshot& snapshot);
+
+    // Requests are clamped to what the CPU supports
+    void setSimdLevel(SimdLevel level);
+    SimdLevel getSimdLevel() const { return level_; }
+
+private:
+    enum class Bank : uint8_t {
+        Unbound,
+        Capacitor,
+        Inductor,
+        Resistor
+    };
+    // Where a device's state lives: a bank slot, or its index in unbound_
+    struct Place {
+        Bank bank = Bank::Unbound;
+        bool attached = false;
+        size_t index = 0;
+    };
+
+    std::vector<Component*>& owners(Bank bank);
+
+    SimdLevel level_;
+    CapacitorBank capacitors_;
+    InductorBank inductors_;
+    ResistorBank resistors_;
+    // By device handle
+    std::vector<Place> places_;
+    std::vector<Component*> unbound_;
+    // Device in each bank slot
+    std::vector<Component*> capacitor_owners_;
+    std::vector<Component*> inductor_owners_;
+    std::vector<Component*> resistor_owners_;
+    std::vector<double> terminal_voltage_;
+    TruncationError error_;
+};
+
+} // namespace ic_sim
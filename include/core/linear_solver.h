@@ -0,0 +1,102 @@
+#pragma once
+
+#include "core/memory_policy.h"
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ic_sim {
+
+enum class SolverPrecision {
+    Double,  // LU factorization in float64
+    Mixed    // LU in float32, refined in float64 against the double residual
+};
+
+struct SolverOptions {
+    SolverPrecision precision = SolverPrecision::Double;
+    size_t max_refinements = 30;
+    // Backward error to reach; 0 picks sqrt(n) * double epsilon
+    double tolerance = 0.0;
+    // A refinement step that shrinks the residual by less than this factor has stalled
+    double stall_ratio = 0.5;
+    // Placement of the matrix and factor storage
+    MemoryPolicy memory;
+};
+
+/**
+ * Outcome of one LinearSolver::solve call
+ */
+struct SolveReport {
+    // Precision of the factorization that produced the solution
+    SolverPrecision precision = SolverPrecision::Double;
+    size_t refinements = 0;
+    // ||b - Ax|| / (||A|| ||x|| + ||b||) in infinity norms; only measured in Mixed mode
+    double backward_error = 0.0;
+    // Set when mixed precision gave up and this solve used a double factorization
+    bool fell_back = false;
+    std::string fallback_reason;
+};
+
+/**
+ * Dense LU solver with partial pivoting
+ * In Mixed mode the matrix is factored in float32, which halves the memory
+ * traffic of the factorization and the triangular solves. Each solution is then
+ * refined in float64 until it reaches double accuracy. If the float factorization
+ * breaks down or refinement stalls, the solver factors in float64 once, uses that
+ * for the rest of the factorization's lifetime and reports the fallback.
+ */
+class LinearSolver {
+public:
+    using FallbackHandler = std::function<void(const SolveReport&)>;
+
+    explicit LinearSolver(SolverOptions options = SolverOptions());
+
+    // Row-major n x n matrix. In Double mode a matrix that is singular throws
+    // std::runtime_error here; Mixed mode only learns that when a solve falls
+    // back to double precision.
+    void factor(const std::vector<double>& matrix, size_t n);
+    void factor(const std::vector<std::vector<double>>& matrix);
+
+    // In Mixed mode throws std::runtime_error when the double fallback finds
+    // the matrix singular. In Double mode throws std::logic_error after a
+    // factor() that failed.
+    SolveReport solve(const std::vector<double>& rhs, std::vector<double>& solution);
+
+    // Called whenever a solve falls back to double precision
+    void setFallbackHandler(FallbackHandler handler) { on_fallback_ = std::move(handler); }
+
+    size_t getSize() const { return n_; }
+    size_t getFallbackCount() const { return fallbacks_; }
+    const SolverOptions& getOptions() const { return options_; }
+    // Where the matrix and factor storage currently lives
+    PlacementReport getPlacement() const;
+
+private:
+    void factorDouble();
+    void solveDouble(const std::vector<double>& rhs, std::vector<double>& solution) const;
+    double backwardError(const std::vector<double>& rhs, const std::vector<double>& solution,
+                         std::vector<double>& residual) const;
+    SolveReport fallBack(const std::vector<double>& rhs, std::vector<double>& solution,
+                         SolveReport report, const std::string& reason);
+
+    SolverOptions options_;
+    size_t n_ = 0;
+    // Original matrix, kept for double residuals in Mixed mode
+    PagedBuffer<double> matrix_;
+    double matrix_norm_ = 0.0;
+
+    PagedBuffer<float> lu_single_;
+    std::vector<size_t> pivots_single_;
+    PagedBuffer<double> lu_double_;
+    std::vector<size_t> pivots_double_;
+    bool single_ready_ = false;
+    bool double_ready_ = false;
+    std::string single_failure_;
+
+    size_t fallbacks_ = 0;
+    FallbackHandler on_fallback_;
+};
+
+} // namespace ic_sim
@@ -0,0 +1,136 @@
+#pragma once
+
+#include "core/thread_pool.h"
+#include <cstddef>
+#include <functional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ic_sim {
+
+enum class PagePolicy {
+    Default,      // ordinary base pages
+    Transparent,  // 2 MB aligned mapping advised for transparent huge pages
+    Explicit      // MAP_HUGETLB from the reserved pool, Transparent if none is free
+};
+
+// Zeroes base pages [first, last) of a buffer being mapped
+using PageTouch = std::function<void(size_t first, size_t last)>;
+// Calls touch on page ranges covering [0, pages), each from the thread that
+// will work on that part of the buffer
+using FirstTouch = std::function<void(size_t pages, const PageTouch& touch)>;
+
+/**
+ * Placement policy for large numeric buffers (solver factors, waveform chunks)
+ */
+struct MemoryPolicy {
+    PagePolicy pages = PagePolicy::Default;
+    // Run as soon as the buffer is mapped, so that every page lands on the NUMA
+    // node of the thread that touched it. The caller slices the buffer the way
+    // its consumers do and runs each slice on the (pinned) thread that will use
+    // it; firstTouchOn() does that on a thread pool. Unset leaves pages untouched and the first thread to write a page
+    // decides where it goes. With huge pages a whole 2 MB page follows its first
+    // toucher.
+    FirstTouch first_touch;
+};
+
+// First touch in parallelForStatic slices of the pages, slice i on worker i of
+// the pool, so a consumer that splits the buffer with parallelForStatic on the
+// same pool finds each slice on its worker's node
+FirstTouch firstTouchOn(ThreadPool& pool = ThreadPool::shared());
+
+/**
+ * Where the pages of a buffer actually are
+ */
+struct PlacementReport {
+    size_t bytes = 0;
+    size_t pages = 0;           // base pages spanned
+    size_t resident_pages = 0;  // pages backed by memory so far
+    // Resident pages per NUMA node; empty when the kernel cannot be asked
+    std::vector<size_t> node_pages;
+    // Bytes of the mappings backed by transparent or explicit huge pages
+    size_t huge_page_bytes = 0;
+
+    void merge(const PlacementReport& other);
+};
+
+PlacementReport queryPlacement(const void* data, size_t bytes);
+
+/**
+ * Anonymous page mapping allocated according to a MemoryPolicy
+ * The contents start zeroed. Without a first touch nothing is resident until
+ * first written.
+ */
+class PageMapping {
+public:
+    PageMapping() = default;
+    PageMapping(size_t bytes, const MemoryPolicy& policy);
+    ~PageMapping();
+
+    PageMapping(PageMapping&& other) noexcept;
+    PageMapping& operator=(PageMapping&& other) noexcept;
+    PageMapping(const PageMapping&) = delete;
+    PageMapping& operator=(const PageMapping&) = delete;
+
+    void* data() const { return data_; }
+    size_t size() const { return bytes_; }
+    // Page policy in effect, after any fallback from Explicit
+    PagePolicy getPagePolicy() const { return policy_; }
+
+    PlacementReport placement() const { return queryPlacement(data_, bytes_); }
+    void release();
+
+private:
+    void* data_ = nullptr;
+    size_t bytes_ = 0;
+    size_t mapped_ = 0;
+    PagePolicy policy_ = PagePolicy::Default;
+};
+
+/**
+ * Fixed-size array of trivially copyable values stored in a PageMapping
+ */
+template <typename T>
+class PagedBuffer {
+    static_assert(std::is_trivially_copyable<T>::value, "PagedBuffer holds plain numeric data");
+
+public:
+    PagedBuffer() = default;
+    PagedBuffer(size_t count, const MemoryPolicy& policy)
+        : mapping_(count * sizeof(T), policy), count_(count) {}
+
+    PagedBuffer(PagedBuffer&& other) noexcept
+        : mapping_(std::move(other.mapping_)), count_(std::exchange(other.count_, 0)) {}
+    PagedBuffer& operator=(PagedBuffer&& other) noexcept {
+        mapping_ = std::move(other.mapping_);
+        count_ = std::exchange(other.count_, 0);
+        return *this;
+    }
+
+    T* data() { return static_cast<T*>(mapping_.data()); }
+    const T* data() const { return static_cast<const T*>(mapping_.data()); }
+    size_t size() const { return count_; }
+    bool empty() const { return count_ == 0; }
+
+    T& operator[](size_t i) { return data()[i]; }
+    const T& operator[](size_t i) const { return data()[i]; }
+    T* begin() { return data(); }
+    T* end() { return data() + count_; }
+    const T* begin() const { return data(); }
+    const T* end() const { return data() + count_; }
+
+    PagePolicy getPagePolicy() const { return mapping_.getPagePolicy(); }
+    PlacementReport placement() const { return mapping_.placement(); }
+
+    void release() {
+        mapping_.release();
+        count_ = 0;
+    }
+
+private:
+    PageMapping mapping_;
+    size_t count_ = 0;
+};
+
+} // namespace ic_sim
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace ic_sim {
+
+enum class ParameterKind {
+    Real,
+    Integer,
+    Boolean
+};
+
+struct ParameterSpec {
+    std::string name;
+    ParameterKind kind;
+    double default_value;
+};
+
+class ParameterBlock;
+
+/**
+ * Parameter layout of one component type
+ * Names are resolved to slot indices once (e.g. when a netlist column or a
+ * plugin type is first seen); instances are then described by a flat
+ * ParameterBlock indexed by slot, with no per-instance strings or maps.
+ */
+class ParameterSchema {
+public:
+    static constexpr size_t kMaxParameters = 16;
+    static constexpr size_t kInvalidSlot = std::numeric_limits<size_t>::max();
+
+    explicit ParameterSchema(std::string type) : type_(std::move(type)) {}
+
+    // Appends a parameter and returns the schema for chaining; throws on
+    // duplicate names or when kMaxParameters is exceeded
+    ParameterSchema& add(const std::string& name, double default_value,
+                         ParameterKind kind = ParameterKind::Real);
+
+    size_t slot(std::string_view name) const;
+    const ParameterSpec& parameter(size_t slot) const { return parameters_[slot]; }
+    size_t size() const { return parameters_.size(); }
+    const std::string& getType() const { return type_; }
+
+    // Block holding every default value
+    ParameterBlock defaults() const;
+    // Compatibility path for name/value maps; unknown names are ignored
+    ParameterBlock fromMap(const std::map<std::string, double>& values) const;
+    std::map<std::string, double> toMap(const ParameterBlock& block) const;
+
+private:
+    std::string type_;
+    std::vector<ParameterSpec> parameters_;
+};
+
+/**
+ * Parameter values of one component instance, laid out by schema slot
+ * Values are stored inline, so building and passing a block never allocates.
+ */
+class ParameterBlock {
+public:
+    explicit ParameterBlock(const ParameterSchema& schema);
+
+    const ParameterSchema& getSchema() const { return *schema_; }
+
+    void set(size_t slot, double value);
+    bool isSet(size_t slot) const { return (set_mask_ >> slot) & 1u; }
+
+    double real(size_t slot) const { return values_[slot]; }
+    long integer(size_t slot) const { return static_cast<long>(values_[slot]); }
+    bool flag(size_t slot) const { return values_[slot] != 0.0; }
+
+private:
+    const ParameterSchema* schema_;
+    std::array<double, ParameterSchema::kMaxParameters> values_;
+    uint32_t set_mask_;
+};
+
+} // namespace ic_sim
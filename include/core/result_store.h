@@ -0,0 +1,163 @@
+#pragma once
+
+#include "core/memory_policy.h"
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace ic_sim {
+
+class Circuit;
+class Component;
+class Node;
+
+enum class ProbeKind {
+    Voltage,  // v(node)
+    Current   // i(device): the device's getCurrentValue()
+};
+
+struct ResultStoreOptions {
+    // Rows per chunk; a chunk holds this many samples of every column
+    size_t chunk_samples = 4096;
+    // Placement of the chunk buffers
+    MemoryPolicy memory;
+    // False streams rows to the sinks only and maps no chunks
+    bool keep_samples = true;
+};
+
+/**
+ * Receiver of recorded rows as the store flushes them, e.g. a file writer
+ * Rows arrive row-major: the time, then one value per probe column. Calls come
+ * from the simulating thread; wrap slow sinks in an AsyncSampleWriter.
+ */
+class SampleSink {
+public:
+    virtual ~SampleSink() = default;
+
+    // Start of a run; columns[0] is "time", then the probe names
+    virtual void begin(const std::vector<std::string>& columns) = 0;
+    virtual void write(const double* rows, size_t count, size_t width) = 0;
+    // End of the run; everything written so far must be delivered
+    virtual void finish() = 0;
+};
+
+/**
+ * Contiguous read-only run of samples inside one chunk
+ */
+struct SampleSpan {
+    const double* first = nullptr;
+    const double* last = nullptr;
+
+    const double* data() const { return first; }
+    const double* begin() const { return first; }
+    const double* end() const { return last; }
+    size_t size() const { return static_cast<size_t>(last - first); }
+    bool empty() const { return first == last; }
+    double operator[](size_t i) const { return first[i]; }
+};
+
+/**
+ * Transient results for a selected set of probes
+ * Probes are patterns such as "v(out)", "i(R1)" or "v(X1.*)"; '*' and '?' match
+ * any run of characters and any single character. Patterns are matched against
+ * the circuit when a run starts, every match becomes one column, and a name
+ * matched by several patterns is recorded once.
+ *
+ * Samples are stored column-major in fixed-size chunks: chunk k holds rows
+ * [k * chunk_samples, (k + 1) * chunk_samples) of the time column followed by
+ * the same rows of every probe column, in one PagedBuffer. Chunks for the
+ * expected number of samples are mapped before the run starts, so recording
+ * never allocates, and the columns are read back in place as one SampleSpan
+ * per chunk. chunk_samples should be a multiple of 8 to keep the column
+ * writes cache-line aligned.
+ */
+class ResultStore {
+public:
+    static constexpr size_t kNoProbe = std::numeric_limits<size_t>::max();
+
+    explicit ResultStore(const ResultStoreOptions& options = {});
+
+    // Throws std::invalid_argument unless the pattern is v(...) or i(...)
+    void addProbe(const std::string& pattern);
+    const std::vector<std::string>& getPatterns() const { return patterns_; }
+
+    // Called by Circuit::simulate: binds the patterns to the circuit's voltage
+    // table and devices, drops earlier samples and maps chunks for
+    // expected_samples rows (at most 1 GB up front; later chunks are mapped when
+    // reached). Throws std::invalid_argument if a pattern without wildcards
+    // matches nothing.
+    void begin(Circuit& circuit, size_t expected_samples);
+    // Appends one row: the time and the current value of every probe
+    void record(double time);
+    // Moves rows still staged by record() into the chunks and the sinks. The
+    // spans and copies only show flushed rows.
+    void flush();
+    // Called by Circuit::simulate at the end of a run: flushes and finishes the sinks
+    void finish();
+
+    // Sinks receive every row of the following runs, in order
+    void addSink(std::shared_ptr<SampleSink> sink) { sinks_.push_back(std::move(sink)); }
+    size_t getSinkCount() const { return sinks_.size(); }
+
+    size_t getProbeCount() const { return columns_.size(); }
+    // Probe names as matched, e.g. "v(X1.mid)"
+    const std::string& getProbeName(size_t probe) const { return columns_.at(probe).name; }
+    ProbeKind getProbeKind(size_t probe) const { return columns_.at(probe).kind; }
+    size_t findProbe(std::string_view name) const;
+
+    size_t getSampleCount() const { return samples_; }
+    size_t getChunkSamples() const { return options_.chunk_samples; }
+    // Chunks holding flushed samples (none if samples are not kept); mapped but
+    // unused chunks are not counted
+    size_t getChunkCount() const {
+        return options_.keep_samples ? (flushed() + options_.chunk_samples - 1) / options_.chunk_samples : 0;
+    }
+
+    SampleSpan time(size_t chunk) const { return column(0, chunk); }
+    SampleSpan samples(size_t probe, size_t chunk) const { return column(probe + 1, chunk); }
+    // Copies of whole columns, for callers that want one flat array
+    std::vector<double> copyTime() const { return copyColumn(0); }
+    std::vector<double> copySamples(size_t probe) const { return copyColumn(probe + 1); }
+
+    // Bytes of chunk memory mapped so far
+    size_t memoryBytes() const;
+
+private:
+    struct Column {
+        std::string name;
+        ProbeKind kind;
+    };
+
+    size_t flushed() const { return samples_ - staged_; }
+    SampleSpan column(size_t column, size_t chunk) const;
+    std::vector<double> copyColumn(size_t column) const;
+    void addChunk();
+
+    ResultStoreOptions options_;
+    std::vector<std::string> patterns_;
+    std::vector<Column> columns_;
+    // Elements read by record(), with their column (1-based, 0 is time)
+    const std::vector<double>* voltages_ = nullptr;
+    std::vector<std::pair<size_t, uint32_t>> node_reads_;
+    std::vector<std::pair<size_t, const Component*>> device_reads_;
+
+    std::vector<std::shared_ptr<SampleSink>> sinks_;
+    std::vector<PagedBuffer<double>> chunks_;
+    size_t samples_ = 0;
+    // Rows are gathered row-major and transposed into the chunks kBlockRows at
+    // a time, so the columns are written a cache line per column rather than a
+    // double per column per step
+    static constexpr size_t kBlockRows = 8;
+    std::vector<double> staging_;
+    size_t staged_ = 0;
+};
+
+// Glob match with '*' (any run, possibly empty) and '?' (any one character)
+bool matchWildcard(std::string_view pattern, std::string_view text);
+
+} // namespace ic_sim
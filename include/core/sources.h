@@ -0,0 +1,145 @@
+#pragma once
+
+#include "core/circuit.h"
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace ic_sim {
+
+enum class WaveformType {
+    DC,
+    Pulse,
+    Sine,
+    PiecewiseLinear
+};
+
+/**
+ * Time-dependent stimulus shared by independent sources
+ * Follows the SPICE PULSE/SIN/PWL conventions. Besides the value at a given time,
+ * a waveform reports its corners (slope discontinuities) so the stepper can land
+ * on them exactly instead of stepping across them.
+ */
+class Waveform {
+public:
+    static Waveform dc(double value);
+    static Waveform pulse(double initial, double pulsed, double delay, double rise,
+                          double fall, double width, double period);
+    static Waveform sine(double offset, double amplitude, double frequency,
+                         double delay = 0.0, double damping = 0.0, double phase_deg = 0.0);
+    // Points are (time, value) pairs with non-decreasing times
+    static Waveform pwl(std::vector<std::pair<double, double>> points);
+
+    // Value at the given time. PWL lookups resume from the previous segment,
+    // so evaluating at increasing times is amortised O(1).
+    double valueAt(double time) const;
+
+    // First corner strictly after the given time, or infinity if there is none
+    double nextBreakpoint(double time) const;
+
+    WaveformType getType() const { return type_; }
+
+    // Exact stored parameters, e.g. for the netlist cache: DC {value}, PULSE
+    // {initial pulsed delay rise fall width period}, SIN {offset amplitude
+    // frequency delay damping phase_rad}, PWL {t0 v0 t1 v1 ...}
+    std::vector<double> getParameters() const;
+    // Inverse of getParameters(); throws std::invalid_argument on a bad count
+    static Waveform fromParameters(WaveformType type, const double* values, size_t count);
+
+private:
+    explicit Waveform(WaveformType type) : type_(type) {}
+
+    double pulseValue(double time) const;
+    double pulseBreakpoint(double time) const;
+    double pwlValue(double time) const;
+
+    WaveformType type_;
+
+    // DC value, PULSE initial value or SIN offset
+    double initial_ = 0.0;
+    // PULSE and SIN parameters (unused fields stay zero)
+    double pulsed_ = 0.0;
+    double amplitude_ = 0.0;
+    double delay_ = 0.0;
+    double rise_ = 0.0;
+    double fall_ = 0.0;
+    double width_ = 0.0;
+    double period_ = 0.0;
+    double frequency_ = 0.0;
+    double damping_ = 0.0;
+    double phase_ = 0.0;
+
+    // PWL corners
+    std::vector<double> times_;
+    std::vector<double> values_;
+    mutable size_t cursor_ = 0;
+};
+
+/**
+ * Base class for independent sources driven by a Waveform
+ * The circuit advances sources with setTime() before the other components are
+ * simulated, so every component of a step sees the same stimulus.
+ */
+class Source : public Component {
+public:
+    explicit Source(Waveform waveform);
+
+    void setTime(double time);
+    double getTime() const { return time_; }
+
+    void simulate(double timestep) override;
+    double getCurrentValue() const override { return value_; }
+    // Back to t = 0, with that value pushed onto the terminals
+    void resetState() override;
+    // {time, value}
+    bool saveState(std::vector<double>& values) const override;
+    void restoreState(const double* values) override;
+    // {waveform type, waveform parameters...}
+    bool getParameters(std::vector<double>& values) const override;
+    // Waveform parameters only; the waveform type is fixed
+    bool setParameter(size_t index, double value) override;
+
+    double nextBreakpoint(double time) const { return waveform_.nextBreakpoint(time); }
+    const Waveform& getWaveform() const { return waveform_; }
+    void setWaveform(Waveform waveform) { waveform_ = std::move(waveform); }
+
+protected:
+    // Pushes value_ onto the terminals
+    virtual void apply() = 0;
+
+    Waveform waveform_;
+    double time_;
+    double value_;
+};
+
+/**
+ * Independent voltage source: holds nodes_[0] at nodes_[1] + v(t)
+ */
+class VoltageSource : public Source {
+public:
+    explicit VoltageSource(double voltage) : Source(Waveform::dc(voltage)) {}
+    explicit VoltageSource(Waveform waveform) : Source(std::move(waveform)) {}
+
+    std::string getType() const override { return "VoltageSource"; }
+    std::unique_ptr<Component> clone() const override { return std::make_unique<VoltageSource>(*this); }
+
+protected:
+    void apply() override;
+};
+
+/**
+ * Independent current source: reports i(t) flowing from nodes_[0] to nodes_[1]
+ */
+class CurrentSource : public Source {
+public:
+    explicit CurrentSource(double current) : Source(Waveform::dc(current)) {}
+    explicit CurrentSource(Waveform waveform) : Source(std::move(waveform)) {}
+
+    std::string getType() const override { return "CurrentSource"; }
+    std::unique_ptr<Component> clone() const override { return std::make_unique<CurrentSource>(*this); }
+
+protected:
+    void apply() override {}
+};
+
+} // namespace ic_sim
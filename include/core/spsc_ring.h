@@ -0,0 +1,92 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace ic_sim {
+
+/**
+ * Bounded lock-free ring of preallocated slots for exactly one producer thread
+ * and one consumer thread
+ * Slots are filled and read in place: the producer acquires the slot at the
+ * head, fills it and publishes it; the consumer reads the slot at the tail and
+ * releases it. Each side keeps a cached copy of the other side's index and only
+ * reloads the shared atomic when the cache says the ring is full (or empty), so
+ * the indices' cache lines move between cores once per wrap rather than once
+ * per slot.
+ */
+template <typename T>
+class SpscRing {
+public:
+    // Capacity is rounded up to a power of two
+    explicit SpscRing(size_t capacity) {
+        size_t slots = 1;
+        while (slots < capacity) {
+            slots <<= 1;
+        }
+        slots_.resize(slots);
+        mask_ = slots - 1;
+    }
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    size_t capacity() const { return slots_.size(); }
+
+    // Producer: slot to fill next, or nullptr while the ring is full
+    T* tryAcquire() {
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (head - producer_tail_ == slots_.size()) {
+            producer_tail_ = tail_.load(std::memory_order_acquire);
+            if (head - producer_tail_ == slots_.size()) {
+                return nullptr;
+            }
+        }
+        return &slots_[head & mask_];
+    }
+    // Producer: hands the acquired slot to the consumer
+    void publish() { head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+    // Consumer: oldest published slot, or nullptr while the ring is empty
+    T* tryFront() {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail == consumer_head_) {
+            consumer_head_ = head_.load(std::memory_order_acquire);
+            if (tail == consumer_head_) {
+                return nullptr;
+            }
+        }
+        return &slots_[tail & mask_];
+    }
+    // Consumer: returns the front slot to the producer
+    void release() { tail_.store(tail_.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+    // Published slots not yet released; exact only when both sides are idle
+    size_t size() const {
+        // Tail first: it never passes head, so the difference cannot wrap
+        size_t tail = tail_.load(std::memory_order_acquire);
+        return head_.load(std::memory_order_acquire) - tail;
+    }
+
+    // Setup while neither side is running: direct slot access, and emptying
+    std::vector<T>& slots() { return slots_; }
+    void clear() {
+        head_.store(0, std::memory_order_relaxed);
+        tail_.store(0, std::memory_order_relaxed);
+        producer_tail_ = 0;
+        consumer_head_ = 0;
+    }
+
+private:
+    static constexpr size_t kCacheLine = 64;
+
+    std::vector<T> slots_;
+    size_t mask_ = 0;
+    alignas(kCacheLine) std::atomic<size_t> head_{0};
+    size_t producer_tail_ = 0;  // producer's view of tail_
+    alignas(kCacheLine) std::atomic<size_t> tail_{0};
+    size_t consumer_head_ = 0;  // consumer's view of head_
+};
+
+} // namespace ic_sim
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+namespace ic_sim {
+
+using Symbol = uint32_t;
+constexpr Symbol kInvalidSymbol = std::numeric_limits<Symbol>::max();
+
+/**
+ * Interns identifier strings into dense integer symbols
+ * Symbols are assigned 0, 1, 2, ... in first-seen order, so they double as
+ * vector indices. Characters live in large append-only blocks, which keeps the
+ * returned views stable and avoids one heap allocation per name. The index is
+ * an open-addressed table of 64-bit slots (hash tag and symbol), so a lookup
+ * is usually one cache miss for the slot and one for the name it compares.
+ */
+class SymbolTable {
+public:
+    SymbolTable() = default;
+    SymbolTable(const SymbolTable& other);
+    SymbolTable& operator=(const SymbolTable& other);
+    SymbolTable(SymbolTable&&) = default;
+    SymbolTable& operator=(SymbolTable&&) = default;
+
+    // Returns the existing symbol for name, or assigns the next one
+    Symbol intern(std::string_view name);
+
+    // Forgets a symbol's name and gives the last symbol its number, so symbols
+    // stay dense. The characters stay in their block until clear().
+    void swapRemove(Symbol symbol);
+
+    // Returns kInvalidSymbol if name was never interned
+    Symbol find(std::string_view name) const {
+        if (slots_.empty()) {
+            return kInvalidSymbol;
+        }
+        uint64_t slot = slots_[probe(name, tagOf(name))];
+        return (slot != 0) ? symbolOf(slot) : kInvalidSymbol;
+    }
+
+    std::string_view name(Symbol symbol) const { return names_[symbol]; }
+    size_t size() const { return names_.size(); }
+    bool empty() const { return names_.empty(); }
+
+    void reserve(size_t symbols);
+    void clear();
+
+    // Bytes held by the character blocks
+    size_t storageBytes() const { return blocks_.size() * kBlockSize + oversized_bytes_; }
+
+private:
+    static constexpr size_t kBlockSize = 64 * 1024;
+    static constexpr size_t kMinSlots = 16;
+
+    // Upper half of the name's hash; its low bits pick the home slot
+    static uint32_t tagOf(std::string_view name) {
+        return static_cast<uint32_t>(static_cast<uint64_t>(std::hash<std::string_view>()(name)) >> 32);
+    }
+    // Slots hold tag << 32 | (symbol + 1); 0 is empty
+    static Symbol symbolOf(uint64_t slot) { return static_cast<Symbol>(slot) - 1; }
+
+    // Slot holding name, or the empty slot that ends its probe sequence
+    size_t probe(std::string_view name, uint32_t tag) const {
+        size_t mask = slots_.size() - 1;
+        for (size_t i = tag & mask;; i = (i + 1) & mask) {
+            uint64_t slot = slots_[i];
+            if (slot == 0 || (static_cast<uint32_t>(slot >> 32) == tag && names_[symbolOf(slot)] == name)) {
+                return i;
+            }
+        }
+    }
+    // Rebuilds the index with the given power-of-two slot count
+    void rehash(size_t slots);
+    // Empties a slot, shifting later entries of its probe run back into place
+    void erase(size_t slot);
+    std::string_view store(std::string_view name);
+
+    std::vector<std::unique_ptr<char[]>> blocks_;
+    std::vector<std::unique_ptr<char[]>> oversized_;
+    size_t block_used_ = kBlockSize;
+    size_t oversized_bytes_ = 0;
+    std::vector<std::string_view> names_;
+    std::vector<uint64_t> slots_;  // power-of-two size, at most 70% full
+};
+
+/**
+ * Symbol table that several threads can intern into at once
+ * Names are spread over independently locked shards by hash, so threads that
+ * intern different names rarely wait for each other. Symbols come from one
+ * counter and stay dense, but their order depends on which thread got to a
+ * name first. name() takes no lock: it is valid on any thread that has
+ * synchronized with the interning one since, e.g. by waiting for its task.
+ */
+class ConcurrentSymbolTable {
+public:
+    ConcurrentSymbolTable();
+    ConcurrentSymbolTable(const ConcurrentSymbolTable&) = delete;
+    ConcurrentSymbolTable& operator=(const ConcurrentSymbolTable&) = delete;
+
+    Symbol intern(std::string_view name);
+    Symbol find(std::string_view name) const;
+
+    std::string_view name(Symbol symbol) const {
+        size_t segment = segmentOf(symbol);
+        return segments_[segment].load(std::memory_order_acquire)[symbol - segmentStart(segment)];
+    }
+    // Symbols handed out so far; every symbol a thread holds is below it
+    size_t size() const { return next_.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr size_t kShards = 64;
+    // Segment k holds kFirstSegment << k names, so views never move and a
+    // fixed directory covers every symbol
+    static constexpr size_t kFirstSegment = 1024;
+    static constexpr size_t kSegments = 23;
+
+    struct Shard {
+        mutable std::mutex mutex;
+        SymbolTable names;            // shard-local symbols, owns the characters
+        std::vector<Symbol> symbols;  // table symbol of each local one
+    };
+
+    static size_t segmentOf(Symbol symbol) {
+        size_t blocks = symbol / kFirstSegment + 1;
+        size_t segment = 0;
+        while (blocks >>= 1) {
+            ++segment;
+        }
+        return segment;
+    }
+    static size_t segmentStart(size_t segment) { return kFirstSegment * ((size_t(1) << segment) - 1); }
+
+    Shard& shardOf(std::string_view name) const;
+    std::string_view* segment(size_t index);
+
+    std::unique_ptr<Shard[]> shards_;
+    std::array<std::atomic<std::string_view*>, kSegments> segments_;
+    std::array<std::unique_ptr<std::string_view[]>, kSegments> owned_;
+    std::mutex grow_mutex_;
+    std::atomic<size_t> next_{0};
+};
+
+} // namespace ic_sim
@@ -0,0 +1,199 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace ic_sim {
+
+class TaskGroup;
+
+struct ThreadPoolOptions {
+    // Threads running tasks, counting the caller, which runs tasks while it
+    // waits: threads - 1 workers are started. 0 uses one per hardware thread.
+    size_t threads = 0;
+    // Logical CPUs to pin the workers to, worker i on cpus[i % cpus.size()];
+    // empty leaves placement to the OS. Pinning is Linux only.
+    std::vector<unsigned> cpus;
+};
+
+/**
+ * Work-stealing task scheduler shared by the engine
+ * Every worker owns a deque. A task spawned on a worker goes to the back of its
+ * deque and the worker runs its own tasks newest first, which keeps nested
+ * splits depth-first and their data in cache; an idle worker steals the oldest
+ * task from the front of another deque, which is the largest piece of work
+ * left there. Tasks spawned from other threads go to a shared queue. Idle
+ * workers sleep, so an idle pool costs nothing.
+ *
+ * Tasks belong to a TaskGroup. A thread waiting for a group runs queued tasks
+ * until the group is done instead of blocking, so parallelism nests freely (a
+ * task may spawn and wait for a group of its own) and a pool without workers
+ * still makes progress on the waiting thread.
+ *
+ * The constructor throws std::invalid_argument for a CPU number the platform
+ * cannot address.
+ */
+class ThreadPool {
+public:
+    explicit ThreadPool(const ThreadPoolOptions& options = {});
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t getWorkerCount() const { return workers_.size(); }
+    // Workers plus the waiting caller
+    size_t getThreadCount() const { return workers_.size() + 1; }
+    // Workers whose CPU affinity was set as asked
+    size_t getPinnedCount() const { return pinned_; }
+
+    // Pool used across the engine, created on first use
+    static ThreadPool& shared();
+    // Options for the shared pool; throws std::logic_error once it exists
+    static void configureShared(const ThreadPoolOptions& options);
+
+private:
+    friend class TaskGroup;
+
+    struct Task {
+        std::function<void()> run;
+        TaskGroup* group;
+    };
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+        // Tasks for this worker only, which nobody steals
+        std::deque<Task> assigned;
+        std::atomic<size_t> assigned_count{0};
+    };
+
+    void push(Task task);
+    void pushTo(size_t worker, Task task);
+    // Runs one queued task; false if none was found
+    bool runOne();
+    void execute(Task& task);
+    void wait(TaskGroup& group);
+    void workerLoop(size_t index);
+    void wakeAll();
+
+    // One queue per worker, then the shared queue
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> workers_;
+    size_t pinned_ = 0;
+
+    std::mutex sleep_mutex_;
+    std::condition_variable wake_;
+    std::atomic<size_t> queued_{0};
+    std::atomic<size_t> sleepers_{0};
+    bool stopping_ = false;
+};
+
+/**
+ * Set of tasks that are waited for together
+ * wait() runs queued tasks (of any group) until every task of this group has
+ * finished, then rethrows the first exception one of them threw. The
+ * destructor waits too, discarding exceptions.
+ */
+class TaskGroup {
+public:
+    explicit TaskGroup(ThreadPool& pool = ThreadPool::shared()) : pool_(pool) {}
+    ~TaskGroup();
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    template <typename F>
+    void run(F&& task) {
+        pending_.fetch_add(1);
+        pool_.push({std::function<void()>(std::forward<F>(task)), this});
+    }
+    // Runs the task on the given worker of the pool, never on another thread
+    template <typename F>
+    void runOn(size_t worker, F&& task) {
+        pending_.fetch_add(1);
+        pool_.pushTo(worker, {std::function<void()>(std::forward<F>(task)), this});
+    }
+    void wait();
+
+private:
+    friend class ThreadPool;
+
+    ThreadPool& pool_;
+    std::atomic<size_t> pending_{0};
+    std::mutex error_mutex_;
+    std::exception_ptr error_;
+};
+
+namespace detail {
+
+// Hands the upper halves to the group until the range fits the grain
+template <typename Body>
+void splitRange(TaskGroup& group, size_t begin, size_t end, size_t grain, const Body& body) {
+    while (end - begin > grain) {
+        size_t middle = begin + (end - begin) / 2;
+        group.run([&group, middle, end, grain, &body]() { splitRange(group, middle, end, grain, body); });
+        end = middle;
+    }
+    body(begin, end);
+}
+
+} // namespace detail
+
+/**
+ * Calls body(first, last) on disjoint ranges of at most grain indices that
+ * together cover [begin, end), in parallel on the pool
+ * The range is split in halves recursively, so idle threads steal large
+ * pieces and the calling thread keeps the rest. Without workers the ranges run
+ * in order on the calling thread. Rethrows the first exception body threw.
+ */
+template <typename Body>
+void parallelFor(size_t begin, size_t end, size_t grain, const Body& body, ThreadPool& pool = ThreadPool::shared()) {
+    grain = std::max<size_t>(grain, 1);
+    if (pool.getWorkerCount() == 0 || end - begin <= grain) {
+        for (size_t first = begin; first < end; first += grain) {
+            body(first, std::min(end, first + grain));
+        }
+        return;
+    }
+    TaskGroup group(pool);
+    detail::splitRange(group, begin, end, grain, body);
+    group.wait();
+}
+
+/**
+ * Calls body(first, last) once per worker on consecutive slices of [begin,
+ * end) of equal size, slice i on worker i
+ * The mapping is fixed, so data a worker pinned to a CPU touched in one call is
+ * the data it gets in the next; this is what NUMA first touch and its
+ * consumers rely on. Slices are not stolen, so uneven work is better left to
+ * parallelFor. Without workers the calling thread runs the whole range.
+ * Rethrows the first exception body threw.
+ */
+template <typename Body>
+void parallelForStatic(size_t begin, size_t end, const Body& body, ThreadPool& pool = ThreadPool::shared()) {
+    const size_t workers = pool.getWorkerCount();
+    if (workers == 0 || end <= begin) {
+        body(begin, end);
+        return;
+    }
+    const size_t count = end - begin;
+    TaskGroup group(pool);
+    for (size_t i = 0; i < workers; ++i) {
+        size_t first = begin + count * i / workers;
+        size_t last = begin + count * (i + 1) / workers;
+        group.runOn(i, [first, last, &body]() { body(first, last); });
+    }
+    group.wait();
+}
+
+} // namespace ic_sim
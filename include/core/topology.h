@@ -0,0 +1,149 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace ic_sim {
+
+class Component;
+class Node;
+
+/**
+ * Read-only connectivity of a compiled circuit in CSR form
+ * Built once by Circuit::compile() from the components' terminal lists. Both
+ * directions (node -> devices and device -> terminal nodes) are stored as flat
+ * 32-bit offset/index arrays, so traversals are plain array walks with no
+ * pointer chasing or reference counting.
+ */
+class Topology {
+public:
+    // Simple read-only view over a contiguous index range
+    struct Range {
+        const uint32_t* first;
+        const uint32_t* last;
+
+        const uint32_t* begin() const { return first; }
+        const uint32_t* end() const { return last; }
+        size_t size() const { return static_cast<size_t>(last - first); }
+        uint32_t operator[](size_t i) const { return first[i]; }
+    };
+
+    // Every array of a compiled topology, e.g. as stored in the netlist cache
+    struct Arrays {
+        std::vector<uint32_t> node_offsets;
+        std::vector<uint32_t> node_devices;
+        std::vector<uint32_t> device_offsets;
+        std::vector<uint32_t> device_nodes;
+        std::vector<uint32_t> pattern_offsets;
+        std::vector<uint32_t> pattern_columns;
+        std::vector<uint32_t> islands;
+        std::vector<uint32_t> ordering;
+        size_t island_count = 0;
+    };
+
+    // Throws std::runtime_error if a terminal refers to a node outside the circuit
+    static std::shared_ptr<const Topology> build(const std::vector<std::shared_ptr<Component>>& components,
+                                                 const std::vector<std::shared_ptr<Node>>& nodes);
+    // Adopts arrays compiled earlier without recomputing anything; only sizes
+    // and index ranges are checked. Throws std::runtime_error if inconsistent.
+    static std::shared_ptr<const Topology> fromArrays(Arrays arrays);
+
+    // Incremental edits behind Circuit's ECO functions. Only the CSR rows of the
+    // nodes involved are rewritten and only their pattern rows recomputed;
+    // islands are relabelled where an edit merges or splits them. The ordering
+    // is spliced, not recomputed: merged islands are eliminated ahead of the
+    // largest one and split islands keep their relative order, which stays a
+    // valid order but can drift from what build() would pick after many edits.
+    // The topology is patched in place when the argument is its only owner,
+    // otherwise a copy is. Throws std::runtime_error on nodes outside it.
+    static std::shared_ptr<const Topology> addNode(std::shared_ptr<const Topology> topology);
+    static std::shared_ptr<const Topology> addDevice(std::shared_ptr<const Topology> topology,
+                                                     const std::vector<uint32_t>& nodes);
+    // The last device (node) takes over the removed index. A removed node must
+    // have no terminals attached.
+    static std::shared_ptr<const Topology> removeDevice(std::shared_ptr<const Topology> topology,
+                                                        uint32_t device);
+    static std::shared_ptr<const Topology> removeNode(std::shared_ptr<const Topology> topology, uint32_t node);
+
+    size_t getNodeCount() const { return node_offsets_.size() - 1; }
+    size_t getDeviceCount() const { return device_offsets_.size() - 1; }
+    size_t getTerminalCount() const { return device_nodes_.size(); }
+
+    // Devices touching a node, one entry per terminal on that node
+    Range nodeDevices(uint32_t node) const {
+        return {node_devices_.data() + node_offsets_[node], node_devices_.data() + node_offsets_[node + 1]};
+    }
+    // Terminal nodes of a device, in connection order
+    Range deviceNodes(uint32_t device) const {
+        return {device_nodes_.data() + device_offsets_[device],
+                device_nodes_.data() + device_offsets_[device + 1]};
+    }
+
+    // Node-to-node structure of the nodal matrix (diagonal included, columns sorted)
+    Range patternRow(uint32_t node) const {
+        return {pattern_columns_.data() + pattern_offsets_[node],
+                pattern_columns_.data() + pattern_offsets_[node + 1]};
+    }
+    size_t getPatternNonZeros() const { return pattern_columns_.size(); }
+    const std::vector<uint32_t>& getPatternOffsets() const { return pattern_offsets_; }
+    const std::vector<uint32_t>& getPatternColumns() const { return pattern_columns_; }
+
+    // Fill-reducing elimination order of the nodal matrix: reverse Cuthill-McKee
+    // per island, started from a minimum-degree node. Keeps the factor's profile,
+    // and with it the fill, close to the matrix's own.
+    const std::vector<uint32_t>& getOrdering() const { return ordering_; }
+
+    const std::vector<uint32_t>& getNodeOffsets() const { return node_offsets_; }
+    const std::vector<uint32_t>& getNodeDevices() const { return node_devices_; }
+    const std::vector<uint32_t>& getDeviceOffsets() const { return device_offsets_; }
+    const std::vector<uint32_t>& getDeviceNodes() const { return device_nodes_; }
+
+    // Connected-component label per node; isolated nodes get their own island
+    const std::vector<uint32_t>& getIslands() const { return islands_; }
+    size_t getIslandCount() const { return island_count_; }
+
+    // Nodes with fewer than two device terminals attached
+    std::vector<uint32_t> getDanglingNodes() const;
+
+    // Splits nodes into `parts` groups of near-equal size by cutting the
+    // breadth-first order of each island, which keeps neighbours together
+    std::vector<uint32_t> partition(size_t parts) const;
+
+    // Bytes held by all index arrays
+    size_t memoryBytes() const;
+
+private:
+    Topology() = default;
+    Topology(const Topology&) = default;
+
+    // The topology an edit may patch, copied first if anyone else holds it
+    static Topology& writable(std::shared_ptr<const Topology>& topology);
+
+    void buildPattern();
+    void labelIslands();
+    void buildOrdering();
+    std::vector<uint32_t> breadthFirstOrder() const;
+    // Couples (uncouples, where no device still joins them) every pair of the
+    // given sorted nodes in the pattern; false if no row changed
+    bool addCouplings(const std::vector<uint32_t>& nodes);
+    bool dropCouplings(const std::vector<uint32_t>& nodes);
+    void mergeIslands(const std::vector<uint32_t>& nodes);
+    // Relabels the pieces of the given terminals' island if it fell apart
+    void splitIsland(const std::vector<uint32_t>& nodes);
+    // Renumbers islands densely after the given labels fell out of use
+    void releaseIslands(std::vector<uint32_t> labels);
+
+    std::vector<uint32_t> node_offsets_;
+    std::vector<uint32_t> node_devices_;
+    std::vector<uint32_t> device_offsets_;
+    std::vector<uint32_t> device_nodes_;
+    std::vector<uint32_t> pattern_offsets_;
+    std::vector<uint32_t> pattern_columns_;
+    std::vector<uint32_t> islands_;
+    std::vector<uint32_t> ordering_;
+    size_t island_count_ = 0;
+};
+
+} // namespace ic_sim
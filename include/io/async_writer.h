@@ -0,0 +1,98 @@
+#pragma once
+
+#include "core/result_store.h"
+#include "core/spsc_ring.h"
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ic_sim {
+
+enum class OverflowPolicy {
+    Block,      // back-pressure: the simulation waits for a free block
+    DropNewest  // rows that find the ring full are discarded and counted
+};
+
+struct AsyncWriterOptions {
+    // Blocks in the ring (rounded up to a power of two) and bytes per block;
+    // a block holds as many whole rows as fit, at least one
+    size_t ring_blocks = 64;
+    size_t block_bytes = size_t(256) << 10;
+    OverflowPolicy overflow = OverflowPolicy::Block;
+};
+
+struct AsyncWriterStats {
+    size_t rows_written = 0;   // delivered to the target
+    size_t blocks_written = 0;
+    size_t rows_dropped = 0;   // DropNewest only
+    size_t waits = 0;          // writes that found the ring full
+    double wait_seconds = 0.0; // time the simulating thread spent blocked on the writer
+    size_t max_queued = 0;     // deepest ring occupancy seen by the producer
+};
+
+/**
+ * SampleSink decorator that moves the target sink onto a writer thread
+ * write() copies rows into a block of a lock-free SPSC ring and returns; a
+ * dedicated thread drains the ring into the target, so file I/O never runs on
+ * the timestep loop. Blocks are allocated once per run when the row width is
+ * known. When the ring is full the producer either waits (Block) or drops the
+ * rows (DropNewest); both are counted in the stats, including how long the
+ * simulation waited.
+ *
+ * begin() starts the thread and calls the target's begin(); finish() drains the
+ * ring, joins the thread and finishes the target on the calling thread. An
+ * exception thrown by the target on the writer thread is rethrown by the next
+ * write() or by finish().
+ */
+class AsyncSampleWriter : public SampleSink {
+public:
+    explicit AsyncSampleWriter(std::shared_ptr<SampleSink> target, const AsyncWriterOptions& options = {});
+    ~AsyncSampleWriter() override;
+
+    AsyncSampleWriter(const AsyncSampleWriter&) = delete;
+    AsyncSampleWriter& operator=(const AsyncSampleWriter&) = delete;
+
+    void begin(const std::vector<std::string>& columns) override;
+    void write(const double* rows, size_t count, size_t width) override;
+    void finish() override;
+
+    // Totals of the current or last run; rows_written is final after finish()
+    AsyncWriterStats getStats() const;
+
+private:
+    struct Block {
+        std::vector<double> data;
+        size_t rows = 0;
+    };
+
+    // Acquires the block to fill; nullptr if the rows are to be dropped
+    Block* acquire();
+    void drain();
+    void stop();
+    void rethrowWriterError();
+
+    std::shared_ptr<SampleSink> target_;
+    AsyncWriterOptions options_;
+    SpscRing<Block> ring_;
+    size_t width_ = 0;
+    size_t block_rows_ = 0;
+
+    // Producer side
+    Block* filling_ = nullptr;
+    AsyncWriterStats stats_;
+
+    // Consumer side, read by getStats()
+    std::atomic<size_t> rows_written_{0};
+    std::atomic<size_t> blocks_written_{0};
+
+    std::thread thread_;
+    std::atomic<bool> done_{false};
+    std::atomic<bool> failed_{false};
+    std::exception_ptr error_;
+};
+
+} // namespace ic_sim
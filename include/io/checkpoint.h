@@ -0,0 +1,88 @@
+#pragma once
+
+#include "core/checkpoint.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace ic_sim {
+
+class CheckpointError : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+struct CheckpointOptions {
+    // Accepted steps between checkpoints; 0 leaves it to the wall clock
+    size_t every_steps = 0;
+    // Wall-clock seconds between checkpoints; 0 leaves it to the step count
+    double every_seconds = 60.0;
+};
+
+struct CheckpointStats {
+    size_t written = 0;
+    // Checkpoints replaced by a newer one before the writer got to them
+    size_t superseded = 0;
+    size_t bytes = 0;            // size of the last file
+    double write_seconds = 0.0;  // spent on the writer thread
+};
+
+/**
+ * CheckpointSink that keeps the latest checkpoint of a run in one file
+ * The simulation thread only captures the state (a copy of the node voltages
+ * and device arrays) and hands the immutable checkpoint over; a writer thread
+ * serializes it next to the file and renames it into place, so the file is
+ * always either the previous checkpoint or the new one, never a torn mix. If
+ * the run produces checkpoints faster than they can be written, the newest
+ * waits and older pending ones are dropped. finish() waits for the pending
+ * write; an I/O error on the writer thread is rethrown by the next write() or
+ * by finish().
+ */
+class CheckpointFile : public CheckpointSink {
+public:
+    explicit CheckpointFile(const std::string& path, const CheckpointOptions& options = {});
+    ~CheckpointFile() override;
+
+    CheckpointFile(const CheckpointFile&) = delete;
+    CheckpointFile& operator=(const CheckpointFile&) = delete;
+
+    bool due(size_t steps) override;
+    void write(std::shared_ptr<const SimulationCheckpoint> checkpoint) override;
+    void finish() override;
+
+    const std::string& getPath() const { return path_; }
+    CheckpointStats getStats() const;
+
+private:
+    void run();
+    void rethrowWriterError();
+
+    std::string path_;
+    CheckpointOptions options_;
+    size_t last_steps_ = 0;
+    std::chrono::steady_clock::time_point last_time_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable idle_;
+    std::shared_ptr<const SimulationCheckpoint> pending_;
+    bool writing_ = false;
+    bool stopping_ = false;
+    std::exception_ptr error_;
+    CheckpointStats stats_;
+    std::thread thread_;
+};
+
+// Throws std::runtime_error on I/O errors
+void writeCheckpoint(const std::string& path, const SimulationCheckpoint& checkpoint);
+
+// Throws CheckpointError if the file is not an intact checkpoint of this version
+std::shared_ptr<SimulationCheckpoint> readCheckpoint(const std::string& path);
+
+} // namespace ic_sim
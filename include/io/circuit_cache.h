@@ -0,0 +1,117 @@
+#pragma once
+
+#include "core/circuit.h"
+#include "io/json_netlist.h"
+#include "io/mapped_file.h"
+#include "io/simulation_settings.h"
+#include "io/spice_netlist.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ic_sim {
+
+class CircuitCacheError : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+// 64-bit content hash (MurmurHash64A) of a byte range
+uint64_t hashBytes(const void* data, size_t size, uint64_t seed = 0);
+
+// A netlist file a cache was built from, identified by its contents
+struct CacheSource {
+    std::string path;  // absolute
+    uint64_t size = 0;
+    uint64_t hash = 0;
+};
+
+// Throws std::runtime_error if the file cannot be read
+CacheSource hashSourceFile(const std::string& path);
+
+/**
+ * Writes a compiled circuit to a versioned binary cache file
+ * Stores the node table, device names and types, device parameters (see
+ * Component::getParameters), the compiled topology including its sparsity
+ * pattern and fill-reducing ordering, the simulation settings and the hashes
+ * of the sources. The circuit is compiled first if it has no topology. The file
+ * is written next to its final path and renamed into place, so readers never
+ * see a partial cache. Throws CircuitCacheError if a device cannot be
+ * described by its parameters, std::runtime_error on I/O errors.
+ */
+void writeCircuitCache(const std::string& path, Circuit& circuit, const SimulationSettings& simulation,
+                       const std::vector<CacheSource>& sources);
+
+/**
+ * Read side of a circuit cache file
+ * The file is memory-mapped and every section is used in place: opening a
+ * cache checks the header, section table and a checksum of the payload, but
+ * parses nothing. instantiate() builds the circuit straight from the mapped
+ * arrays and adopts the stored topology instead of compiling.
+ */
+class CircuitCache {
+public:
+    // Throws CircuitCacheError if the file is not a valid cache of this version
+    explicit CircuitCache(const std::string& path);
+
+    // True if every source still has the contents the cache was built from
+    bool isCurrent() const;
+
+    const std::vector<CacheSource>& getSources() const { return sources_; }
+    const SimulationSettings& getSimulation() const { return simulation_; }
+    size_t getNodeCount() const;
+    size_t getComponentCount() const;
+
+    // Plugin types must be loaded. Throws CircuitCacheError if a device type
+    // cannot be rebuilt.
+    std::unique_ptr<Circuit> instantiate() const;
+
+private:
+    struct SectionView {
+        const char* data = nullptr;
+        size_t count = 0;
+    };
+
+    template <typename T>
+    const T* array(uint32_t section) const {
+        return reinterpret_cast<const T*>(sections_[section].data);
+    }
+    size_t count(uint32_t section) const { return sections_[section].count; }
+    std::string_view string(uint32_t offsets, uint32_t chars, size_t index) const;
+    std::vector<uint32_t> copyIndices(uint32_t section) const;
+
+    MappedFile file_;
+    std::vector<SectionView> sections_;
+    std::vector<CacheSource> sources_;
+    SimulationSettings simulation_;
+};
+
+struct NetlistCacheOptions {
+    // Cache file; empty uses the netlist path with ".iccache" appended
+    std::string cache_path;
+    // Rewrite the cache after a netlist had to be parsed
+    bool update = true;
+    SpiceOptions spice;
+    JsonNetlistOptions json;
+};
+
+struct CachedNetlist {
+    std::unique_ptr<Circuit> circuit;  // compiled
+    SimulationSettings simulation;
+    bool from_cache = false;
+    std::string cache_path;
+};
+
+/**
+ * Loads a SPICE or JSON netlist (by extension), through the compiled-circuit
+ * cache when one exists for exactly these source contents. A missing, stale,
+ * corrupt or unusable cache is ignored and the netlist is parsed; the cache is
+ * then rewritten unless disabled. Failing to write the cache is not an error.
+ */
+CachedNetlist loadNetlistCached(const std::string& path, const NetlistCacheOptions& options = {});
+
+} // namespace ic_sim
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "core/result_store.h"
+#include "io/waveform_file.h"
+#include <cstddef>
+#include <limits>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace ic_sim {
+
+struct CsvExportOptions {
+    // ',' for CSV, '\t' for TSV
+    char delimiter = ',';
+    // Probe names or wildcard patterns such as "v(X1.*)", in output order;
+    // empty exports every probe. The time column always comes first.
+    std::vector<std::string> columns;
+    // Rows with start_time <= time <= end_time
+    double start_time = -std::numeric_limits<double>::infinity();
+    double end_time = std::numeric_limits<double>::infinity();
+    bool header = true;
+    // Significant digits; 0 writes the shortest text that reads back as the
+    // same double
+    int precision = 0;
+    // Chunks formatted ahead on the shared thread pool: 1 formats on the
+    // calling thread, 0 uses one per pool thread
+    size_t threads = 1;
+};
+
+struct CsvExportStats {
+    size_t rows = 0;
+    size_t columns = 0;  // including time
+    size_t bytes = 0;
+};
+
+/**
+ * Writes recorded samples as CSV/TSV
+ * Numbers are formatted with std::to_chars straight into one text buffer per
+ * chunk of rows, which goes to the stream with a single write. With threads
+ * above 1, chunks are formatted ahead as tasks on the shared ThreadPool (and,
+ * for waveform files, decoded there too) and written in order, so memory stays
+ * at about threads chunks of text. Chunks outside the time window are skipped without
+ * being read.
+ *
+ * Throws std::invalid_argument if a column without wildcards names no probe,
+ * std::runtime_error if the stream fails.
+ */
+CsvExportStats exportCsv(const ResultStore& results, std::ostream& out, const CsvExportOptions& options = {});
+CsvExportStats exportCsv(const WaveformFileReader& reader, std::ostream& out, const CsvExportOptions& options = {});
+
+} // namespace ic_sim
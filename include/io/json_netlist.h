@@ -0,0 +1,42 @@
+#pragma once
+
+#include "core/circuit.h"
+#include "io/simulation_settings.h"
+#include <cstddef>
+#include <istream>
+#include <memory>
+#include <string>
+
+namespace ic_sim {
+
+struct JsonNetlist {
+    std::unique_ptr<Circuit> circuit;
+    std::string description;
+    std::string version;
+    SimulationSettings simulation;
+    size_t connections = 0;
+    size_t bytes_read = 0;
+};
+
+struct JsonNetlistOptions {
+    size_t buffer_size = size_t(1) << 20;
+    // Resolve types other than the built-in ones through loaded plugins
+    bool use_plugins = true;
+};
+
+/**
+ * Loads a netlist in the examples/rc_filter.json format in one streaming pass
+ * Components are built as soon as their object closes and connections are
+ * merged into nets with a union-find over device terminals, so no document
+ * tree is kept and memory grows with the circuit rather than the file.
+ * Connections may reference components defined later in the file.
+ *
+ * Terminals are named positive/input/anode/plus/p/+ (first) or
+ * negative/output/cathode/minus/n/- (second). Each net becomes one node named
+ * after its earliest terminal in device order, e.g. "R1.input".
+ * Throws JsonError on malformed JSON and std::runtime_error on netlist errors.
+ */
+JsonNetlist loadJsonNetlist(std::istream& in, const JsonNetlistOptions& options = {});
+JsonNetlist loadJsonNetlistFile(const std::string& path, const JsonNetlistOptions& options = {});
+
+} // namespace ic_sim
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+#include <istream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ic_sim {
+
+/**
+ * Receives the events of a JSON document in order
+ * String views are only valid for the duration of the call.
+ */
+class JsonHandler {
+public:
+    virtual ~JsonHandler() = default;
+
+    virtual void startObject() = 0;
+    virtual void endObject() = 0;
+    virtual void startArray() = 0;
+    virtual void endArray() = 0;
+    virtual void key(std::string_view name) = 0;
+    virtual void string(std::string_view value) = 0;
+    virtual void number(double value) = 0;
+    virtual void boolean(bool value) = 0;
+    virtual void null() = 0;
+};
+
+class JsonError : public std::runtime_error {
+public:
+    JsonError(const std::string& message, size_t offset)
+        : std::runtime_error("JSON error at byte " + std::to_string(offset) + ": " + message), offset_(offset) {}
+
+    size_t getOffset() const { return offset_; }
+
+private:
+    size_t offset_;
+};
+
+/**
+ * Streaming SAX-style JSON parser
+ * Input is read through a fixed-size buffer and no document tree is built, so
+ * memory use is bounded by the buffer, the nesting depth and the longest single
+ * token, whatever the size of the input.
+ */
+class JsonReader {
+public:
+    explicit JsonReader(std::istream& in, size_t buffer_size = size_t(1) << 20,
+                        size_t max_token_size = size_t(16) << 20);
+
+    // Parses one document and throws JsonError on malformed input
+    void parse(JsonHandler& handler);
+
+    size_t getBytesRead() const { return consumed_ + pos_; }
+
+private:
+    int peek() {
+        if (pos_ == end_ && !refill()) {
+            return -1;
+        }
+        return static_cast<unsigned char>(buffer_[pos_]);
+    }
+    int skipWhitespace();
+    bool refill();
+    void expect(char c, const char* message);
+    void readString();
+    void readNumber();
+    void readLiteral(const char* literal);
+    void appendCodePoint(unsigned code_point);
+    unsigned readHex4();
+    void checkTokenSize();
+    [[noreturn]] void fail(const std::string& message) const;
+
+    std::istream& in_;
+    std::vector<char> buffer_;
+    size_t pos_ = 0;
+    size_t end_ = 0;
+    size_t consumed_ = 0;  // bytes before the current buffer
+    size_t max_token_size_;
+    std::string token_;
+};
+
+} // namespace ic_sim
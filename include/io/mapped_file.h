@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ic_sim {
+
+/**
+ * Read-only view of a whole file
+ * The file is memory-mapped where the platform allows it, so opening a
+ * multi-GB file costs no copy and pages are read on first access. Elsewhere
+ * the contents are read into a heap buffer.
+ */
+class MappedFile {
+public:
+    // Read-ahead hint for the mapping
+    enum class Access {
+        Sequential,  // parsers reading front to back
+        Random       // indexed lookups touching scattered pages
+    };
+
+    // Throws std::runtime_error if the file cannot be opened
+    explicit MappedFile(const std::string& path, Access access = Access::Sequential);
+    ~MappedFile();
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+    std::string_view view() const { return std::string_view(data_, size_); }
+    bool isMapped() const { return mapped_; }
+
+private:
+    void release();
+
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    bool mapped_ = false;
+    std::vector<char> buffer_;
+};
+
+} // namespace ic_sim
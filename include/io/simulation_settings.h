@@ -0,0 +1,14 @@
+#pragma once
+
+#include <string>
+
+namespace ic_sim {
+
+// Analysis requested by a netlist file; zero where the file does not say
+struct SimulationSettings {
+    double duration = 0.0;
+    double timestep = 0.0;
+    std::string type;
+};
+
+} // namespace ic_sim
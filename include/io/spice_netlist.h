@@ -0,0 +1,77 @@
+#pragma once
+
+#include "core/circuit.h"
+#include "io/simulation_settings.h"
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ic_sim {
+
+class SpiceError : public std::runtime_error {
+public:
+    SpiceError(const std::string& message, const std::string& file, size_t line)
+        : std::runtime_error(file + ":" + std::to_string(line) + ": " + message), file_(file), line_(line) {}
+
+    const std::string& getFile() const { return file_; }
+    size_t getLine() const { return line_; }
+
+private:
+    std::string file_;
+    size_t line_;
+};
+
+struct SpiceNetlist {
+    std::unique_ptr<Circuit> circuit;
+    std::string title;
+    SimulationSettings simulation;
+    size_t cards = 0;                 // logical lines read, includes and subcircuit bodies once
+    size_t subcircuit_instances = 0;  // X cards expanded, nested ones included
+    size_t bytes = 0;                 // deck and included files
+    std::vector<std::string> files;   // deck first, then includes in the order read
+};
+
+struct SpiceOptions {
+    // Chunks tokenized and resolved ahead on the shared thread pool; 1 does
+    // it all on the calling thread, 0 uses one per pool thread
+    size_t threads = 0;
+    // Bytes of deck text per tokenizer task; chunks always end on a card boundary
+    size_t chunk_size = size_t(8) << 20;
+};
+
+/**
+ * SPICE deck front end
+ * Supports R, C, L, V, I (DC, SIN, PULSE, PWL), D and X elements, .subckt/.ends,
+ * .include, .param, .model, .global, .tran and .end; other dot cards are
+ * ignored. Subcircuits are flattened: instance X1 of a subcircuit containing R1
+ * and internal node mid yields component "X1.R1" and node "X1.mid". Node 0
+ * (or gnd) is the shared ground node "0".
+ *
+ * Values accept scale suffixes (f p n u m k meg g t mil, trailing unit letters
+ * ignored), parameter names and {expressions} with + - * / ^, parentheses and
+ * the usual math functions. Keywords, parameter, model and subcircuit names are
+ * case-insensitive; element and node names keep their case.
+ *
+ * The deck is memory-mapped and split into chunks on card boundaries. Each
+ * chunk is a task on the shared ThreadPool that tokenizes it into its own
+ * symbol table and then resolves those names against the deck's concurrent
+ * one, so name resolution runs in parallel as well. The calling thread applies
+ * the resolved cards in file order: nodes are found by deck symbol in an array,
+ * and only building the devices and nodes in the circuit stays serial. The
+ * result is the same for any thread count. L and D elements are built through
+ * the Inductor and Diode plugin types. Throws SpiceError with the file and line
+ * on malformed decks.
+ */
+SpiceNetlist loadSpiceNetlist(const std::string& path, const SpiceOptions& options = {});
+// Deck text held by the caller; .include paths are resolved against base_dir
+SpiceNetlist parseSpiceNetlist(std::string_view deck, const SpiceOptions& options = {},
+                               const std::string& base_dir = ".");
+
+// Parses a number with an optional scale suffix ("4.7k", "10uF", "1meg"); false
+// if the text is not a number
+bool parseSpiceNumber(std::string_view text, double& value);
+
+} // namespace ic_sim
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "core/result_store.h"
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace ic_sim {
+
+struct VcdWriterOptions {
+    // Name of the outermost scope; usually the circuit name
+    std::string top_scope = "top";
+    // Time unit of the file: 1, 10 or 100 of s, ms, us, ns, ps or fs
+    double timescale = 1e-12;
+    // Probe names or wildcard patterns of the columns recorded as real
+    // variables; every other column is a one-bit wire
+    std::vector<std::string> analog;
+    // Columns to record as wires; empty records every column not in analog
+    std::vector<std::string> digital;
+    // A wire goes to 1 above threshold + hysteresis / 2, to 0 below
+    // threshold - hysteresis / 2, and keeps its value in between (x until it
+    // has had one)
+    double threshold = 0.5;
+    double hysteresis = 0.0;
+    // Text gathered before one write to the file
+    size_t buffer_bytes = size_t(1) << 20;
+};
+
+struct VcdWriterStats {
+    size_t rows = 0;
+    size_t variables = 0;
+    size_t changes = 0;  // value changes written, including the initial dump
+    size_t bytes = 0;
+};
+
+/**
+ * SampleSink writing a Value Change Dump (IEEE 1364) for waveform viewers
+ * Only changes are written: every row is compared with the last value of each
+ * variable, and a timestamp is emitted only for rows where something changed,
+ * so static nets cost one comparison per row and nothing in the file. Wires are
+ * the columns thresholded to 0/1/x; analog columns become real variables.
+ *
+ * Probe names are split on '.' into scopes: "v(X1.X2.out)" is the wire "out"
+ * in scope X2 inside X1 inside the top scope, and "i(X1.R1)" is "i(R1)" in X1.
+ * Times are rounded to the timescale.
+ *
+ * Output is gathered in a text buffer and written in large pieces from the
+ * calling thread; wrap the writer in an AsyncSampleWriter to move the
+ * comparisons and the I/O off the timestep loop.
+ *
+ * The constructor throws std::invalid_argument for an unsupported timescale;
+ * begin() throws std::invalid_argument if a pattern without wildcards names no
+ * column, and begin(), write() and finish() throw std::runtime_error on I/O
+ * errors.
+ */
+class VcdWriter : public SampleSink {
+public:
+    explicit VcdWriter(std::string path, const VcdWriterOptions& options = {});
+
+    void begin(const std::vector<std::string>& columns) override;
+    void write(const double* rows, size_t count, size_t width) override;
+    void finish() override;
+
+    const std::string& getPath() const { return path_; }
+    const VcdWriterStats& getStats() const { return stats_; }
+
+private:
+    struct Wire {
+        size_t column;
+        uint8_t value;  // 0, 1, or 2 for x
+    };
+    struct Real {
+        size_t column;
+        double value;
+    };
+
+    void writeHeader(const std::vector<std::string>& columns);
+    // Starts the row at tick unless it was started already
+    void stamp(int64_t tick);
+    void flushText();
+
+    std::string path_;
+    VcdWriterOptions options_;
+    std::string unit_;
+    std::ofstream out_;
+    std::string text_;
+    double low_ = 0.0;
+    double high_ = 0.0;
+    std::vector<Wire> wires_;
+    std::vector<Real> reals_;
+    std::vector<std::string> codes_;  // identifier codes, wires then reals
+    int64_t last_tick_ = 0;  // of the last timestamp written
+    int64_t last_row_tick_ = 0;
+    bool stamped_ = false;
+    VcdWriterStats stats_;
+};
+
+} // namespace ic_sim
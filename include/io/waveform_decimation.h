@@ -0,0 +1,101 @@
+#pragma once
+
+#include "io/waveform_file.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace ic_sim {
+
+/**
+ * Aggregate of consecutive samples: the first, last, minimum and maximum
+ * value with the times they occur (an M4 bucket). Drawing the four points of
+ * every pixel column reproduces the full-resolution plot exactly. count == 0
+ * marks an empty bucket, e.g. a pixel column no sample falls in.
+ */
+struct WaveformBucket {
+    double first_time = 0.0;
+    double last_time = 0.0;
+    double min_time = 0.0;
+    double max_time = 0.0;
+    double first = 0.0;
+    double last = 0.0;
+    double min = 0.0;
+    double max = 0.0;
+    uint64_t count = 0;
+};
+
+// One bucket per equal-width time slice of [t0, t1]; samples outside the
+// window are ignored. times must not decrease.
+std::vector<WaveformBucket> minMaxBuckets(const double* times, const double* values, size_t count, double t0,
+                                          double t1, size_t buckets);
+
+// Largest-Triangle-Three-Buckets: indices of the points (at most points, the
+// first and last always included) that best keep the shape of the line
+std::vector<size_t> lttbIndices(const double* times, const double* values, size_t count, size_t points);
+
+struct PyramidOptions {
+    // Samples per bucket of the finest level, and buckets merged per level above
+    size_t leaf_samples = 16;
+    size_t fan_out = 4;
+};
+
+/**
+ * Multi-resolution min/max pyramid over one waveform, for zoomable plots
+ * Level 0 holds one bucket per leaf_samples samples, and each level above
+ * merges fan_out buckets of the one below; with the defaults the levels take
+ * about a third of the memory of the raw samples. A query for a time window
+ * at a given width starts at the coarsest level that still has a bucket per
+ * pixel, so it touches O(pixels) buckets at any zoom; buckets cut by the
+ * window edges are refined down the levels, and only windows narrower than
+ * the finest level read raw samples.
+ *
+ * The raw samples come from arrays owned by the pyramid or from a column of
+ * a waveform file, which is streamed once to build the levels and read by
+ * time range afterwards. Queries are const and may run concurrently.
+ */
+class WaveformPyramid {
+public:
+    WaveformPyramid(std::vector<double> times, std::vector<double> values, const PyramidOptions& options = {});
+    WaveformPyramid(std::shared_ptr<const WaveformFileReader> reader, size_t column,
+                    const PyramidOptions& options = {});
+
+    size_t getSampleCount() const { return samples_; }
+    size_t getLevelCount() const { return levels_.size(); }
+    const std::vector<WaveformBucket>& getLevel(size_t level) const { return levels_.at(level); }
+    size_t memoryBytes() const;
+
+    // Min/max envelope of [t0, t1] in pixels equal-width columns. Every point
+    // reported is a sample inside its column, and the window's extremes and
+    // sample count are exact. A pyramid bucket that straddles a column edge
+    // adds its extremes to the columns they occur in and the rest of its
+    // count to the column of its first sample.
+    std::vector<WaveformBucket> envelope(double t0, double t1, size_t pixels) const;
+
+    // LTTB down to at most points points of [t0, t1], run over the M4 points of
+    // the level that has at least points buckets there (or the raw samples)
+    void lttb(double t0, double t1, size_t points, std::vector<double>& times, std::vector<double>& values) const;
+
+private:
+    // Builds the levels from source(add), which calls add(time, value) for
+    // every sample in order
+    template <typename Source>
+    void build(const PyramidOptions& options, const Source& source);
+    void readRaw(double t0, double t1, std::vector<double>& times, std::vector<double>& values) const;
+    template <typename Visit>
+    void visitWindow(double t0, double t1, size_t min_buckets, Visit& visit) const;
+    template <typename Visit>
+    void visitBuckets(size_t level, size_t begin, size_t end, double t0, double t1, Visit& visit) const;
+
+    std::vector<double> times_;
+    std::vector<double> values_;
+    std::shared_ptr<const WaveformFileReader> reader_;
+    size_t column_ = 0;
+
+    size_t samples_ = 0;
+    size_t fan_out_ = 4;
+    std::vector<std::vector<WaveformBucket>> levels_;
+};
+
+} // namespace ic_sim
@@ -0,0 +1,231 @@
+#pragma once
+
+#include "core/result_store.h"
+#include "io/mapped_file.h"
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ic_sim {
+
+class WaveformFileError : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+// How one column of one chunk is encoded
+enum class WaveformCodec : uint32_t {
+    Xor = 0,          // Gorilla: XOR with the previous value, leading/trailing zeros elided
+    DeltaOfDelta = 1  // second differences of the IEEE bit patterns, zigzag + variable width
+};
+
+/**
+ * Encodes values with the codec that is smaller on the first few hundred
+ * values, appending whole 64-bit words to out; returns the codec used
+ * mantissa_bits < 52 first rounds every finite value to that many mantissa
+ * bits (relative error at most 2^-(mantissa_bits + 1)), which makes noisy
+ * low-order bits compressible; 52 is lossless.
+ */
+WaveformCodec encodeWaveform(const double* values, size_t count, std::vector<uint64_t>& out,
+                             int mantissa_bits = 52);
+
+/**
+ * Streaming decoder of one encoded block: yields the values one at a time
+ * without materialising the block. Throws WaveformFileError if the block ends
+ * before count values were read.
+ */
+class WaveformDecoder {
+public:
+    WaveformDecoder() = default;
+    WaveformDecoder(const uint64_t* words, size_t word_count, size_t count, WaveformCodec codec);
+
+    size_t remaining() const { return remaining_; }
+    bool next(double& value);
+    // Decodes all remaining values into out
+    void decode(double* out);
+
+private:
+    uint64_t bits(unsigned count);
+    double nextXor();
+    double nextDeltaOfDelta();
+
+    const uint64_t* words_ = nullptr;
+    const uint64_t* end_ = nullptr;
+    uint64_t current_ = 0;
+    unsigned available_ = 0;  // unread low bits of current_
+    size_t remaining_ = 0;
+    size_t decoded_ = 0;
+    WaveformCodec codec_ = WaveformCodec::Xor;
+
+    uint64_t previous_ = 0;
+    uint64_t delta_ = 0;
+    unsigned lead_ = 0;
+    unsigned width_ = 0;
+    unsigned shift_ = 0;
+};
+
+struct WaveformWriterOptions {
+    // Rows per chunk, capped so the raw chunk buffer stays near chunk_bytes
+    // (at least 64 rows)
+    size_t chunk_samples = 4096;
+    size_t chunk_bytes = size_t(64) << 20;
+    // Mantissa bits kept for probe columns (see encodeWaveform); the time
+    // column is always lossless
+    int mantissa_bits = 52;
+};
+
+struct WaveformWriterStats {
+    size_t rows = 0;
+    size_t chunks = 0;
+    size_t raw_bytes = 0;   // rows * columns * sizeof(double)
+    size_t file_bytes = 0;
+    double compressionRatio() const { return file_bytes ? double(raw_bytes) / double(file_bytes) : 0.0; }
+};
+
+/**
+ * SampleSink writing a compressed waveform file (".icwave")
+ * Rows are gathered column-major into chunks; every column of a chunk is
+ * encoded separately with encodeWaveform, so a reader can decode one probe of
+ * one chunk without touching the others. Each chunk starts with a small header
+ * giving its first row, time range and block sizes, and finish() appends an
+ * index of all chunks plus a trailer, so readers get random access, and a file
+ * cut short by a crash can still be read up to its last whole chunk.
+ *
+ * Encoding runs on the calling thread; wrap the writer in an AsyncSampleWriter
+ * to move it off the timestep loop.
+ */
+class WaveformFileWriter : public SampleSink {
+public:
+    explicit WaveformFileWriter(std::string path, const WaveformWriterOptions& options = {});
+
+    // Opens (truncates) the file; throws WaveformFileError on I/O errors
+    void begin(const std::vector<std::string>& columns) override;
+    void write(const double* rows, size_t count, size_t width) override;
+    void finish() override;
+
+    const std::string& getPath() const { return path_; }
+    const WaveformWriterStats& getStats() const { return stats_; }
+
+private:
+    struct ChunkEntry {
+        uint64_t offset;
+        uint64_t first_row;
+        uint64_t rows;
+        double first_time;
+        double last_time;
+    };
+
+    void writeChunk();
+    void put(const void* data, size_t bytes);
+
+    std::string path_;
+    WaveformWriterOptions options_;
+    std::ofstream out_;
+    size_t width_ = 0;
+    size_t chunk_rows_ = 0;
+    std::vector<double> chunk_;  // column-major, chunk_rows_ per column
+    size_t filled_ = 0;
+    std::vector<std::vector<uint64_t>> blocks_;
+    std::vector<ChunkEntry> index_;
+    WaveformWriterStats stats_;
+};
+
+// One entry of a waveform file's chunk index
+struct WaveformChunk {
+    uint64_t offset = 0;  // of the chunk header
+    uint64_t first_row = 0;
+    uint64_t rows = 0;
+    double first_time = 0.0;
+    double last_time = 0.0;
+};
+
+/**
+ * Read side of a waveform file
+ * The file is memory-mapped and blocks are decoded straight from the mapping,
+ * so any number of readers, in one process or many, share one copy of the
+ * pages in the page cache. Opening reads the header and the chunk index only;
+ * without a trailer (the writer did not finish) the index is rebuilt by walking
+ * the chunk headers and stops at the first incomplete chunk.
+ *
+ * The chunk index doubles as the time index: time queries binary-search the
+ * chunks' time ranges, decode only the time and probe blocks of the chunks
+ * they overlap, and binary-search the decoded times. Times must not decrease
+ * along the file, which holds for everything Circuit::simulate records.
+ * Readers are immutable after opening and safe to share between threads.
+ */
+class WaveformFileReader {
+public:
+    static constexpr size_t kNoColumn = std::numeric_limits<size_t>::max();
+
+    // Throws WaveformFileError if the file is not a waveform file
+    explicit WaveformFileReader(const std::string& path);
+
+    // columns[0] is "time", then the probe names
+    const std::vector<std::string>& getColumns() const { return columns_; }
+    size_t findColumn(std::string_view name) const;
+    size_t getSampleCount() const { return samples_; }
+    size_t getChunkCount() const { return index_.size(); }
+    const WaveformChunk& getChunk(size_t chunk) const { return index_.at(chunk); }
+    // False if the file has no trailer and was recovered from its chunk headers
+    bool isComplete() const { return complete_; }
+    // Time of the first and last sample; 0 for an empty file
+    double getStartTime() const { return index_.empty() ? 0.0 : index_.front().first_time; }
+    double getEndTime() const { return index_.empty() ? 0.0 : index_.back().last_time; }
+
+    // Decoder over one column of one chunk, reading from the mapping
+    WaveformDecoder openBlock(size_t chunk, size_t column) const;
+    void readChunk(size_t chunk, size_t column, std::vector<double>& values) const;
+    std::vector<double> readColumn(size_t column) const;
+
+    // First chunk whose last sample is at or after time; getChunkCount() if none
+    size_t findChunk(double time) const;
+    // Samples with t0 <= time <= t1, replacing the contents of times and values
+    void readRange(size_t column, double t0, double t1, std::vector<double>& times,
+                   std::vector<double>& values) const;
+    // Linear interpolation between the samples around time, clamped to the
+    // first and last sample; exact at sample times
+    double valueAt(size_t column, double time) const;
+    // valueAt for count non-decreasing times (throws std::invalid_argument
+    // otherwise); every chunk is decoded at most once
+    void sample(size_t column, const double* times, size_t count, double* out) const;
+
+private:
+    bool readIndex();
+    void scanChunks();
+    void checkColumn(size_t column) const;
+
+    MappedFile file_;
+    std::vector<std::string> columns_;
+    uint64_t data_offset_ = 0;
+    std::vector<WaveformChunk> index_;
+    size_t samples_ = 0;
+    bool complete_ = false;
+};
+
+/**
+ * Sequential (time, value) pairs of one column across the whole file, decoded
+ * a chunk at a time with constant memory
+ */
+class WaveformStream {
+public:
+    WaveformStream(const WaveformFileReader& reader, size_t column);
+
+    bool next(double& time, double& value);
+
+private:
+    bool openChunk();
+
+    const WaveformFileReader& reader_;
+    size_t column_;
+    size_t chunk_ = 0;
+    std::vector<double> times_;
+    std::vector<double> values_;
+    size_t position_ = 0;
+};
+
+} // namespace ic_sim
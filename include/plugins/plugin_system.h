@@ -1,5 +1,6 @@
 #pragma once
 
+#include "core/parameter_schema.h"
 #include <string>
 #include <memory>
 #include <map>
@@ -31,6 +32,29 @@ public:
     virtual std::shared_ptr<Component> createComponent(const std::string& type,
                                                       const std::map<std::string, double>& parameters) = 0;
     virtual std::vector<std::string> getSupportedComponents() const = 0;
+    
+    // Compiled factory path: a plugin that publishes a schema for a type receives
+    // instances as flat ParameterBlocks built against that schema. The defaults
+    // keep plugins without schemas working through the map-based factory.
+    virtual const ParameterSchema* getParameterSchema(const std::string& type) const {
+        (void)type;
+        return nullptr;
+    }
+    virtual std::shared_ptr<Component> instantiate(const ParameterBlock& parameters) {
+        const ParameterSchema& schema = parameters.getSchema();
+        return createComponent(schema.getType(), schema.toMap(parameters));
+    }
+};
+
+/**
+ * Component type resolved to its plugin and schema once, then reused for every
+ * instance of that type
+ */
+struct ComponentFactory {
+    IPlugin* plugin = nullptr;
+    const ParameterSchema* schema = nullptr;
+    
+    explicit operator bool() const { return plugin != nullptr && schema != nullptr; }
 };
 
 /**
@@ -55,6 +79,12 @@ public:
                                               const std::map<std::string, double>& parameters);
     std::vector<std::string> getAllSupportedComponents() const;
     
+    // Resolves a type name once; the returned factory is invalid if no loaded
+    // plugin publishes a schema for it
+    ComponentFactory resolveComponent(const std::string& type) const;
+    std::shared_ptr<Component> createComponent(const ComponentFactory& factory,
+                                              const ParameterBlock& parameters);
+    
     // Plugin discovery
     std::vector<std::string> discoverPlugins(const std::string& directory);
 
@@ -1,83 +1,916 @@
 #include "core/circuit.h"
+#include "core/breakpoints.h"
+#include "core/convergence.h"
+#include "core/result_store.h"
+#include "core/sources.h"
 #include <algorithm>
+#include <cmath>
 #include <stdexcept>
 #include <iostream>
 
 namespace ic_sim {
 
-void Circuit::addComponent(std::shared_ptr<Component> component) {
-    if (component && !component->getId().empty()) {
-        components_[component->getId()] = component;
+namespace {
+
+// Name tables are shared with clones until one of them interns a new name
+SymbolTable& writableNames(std::shared_ptr<SymbolTable>& names) {
+    if (names.use_count() > 1) {
+        names = std::make_shared<SymbolTable>(*names);
+    }
+    return *names;
+}
+
+std::unique_ptr<Component> copyComponent(const Component& component) {
+    std::unique_ptr<Component> copy = component.clone();
+    if (!copy) {
+        throw std::runtime_error("Component '" + component.getId() + "' of type " + component.getType() +
+                                 " cannot be copied out of a shared circuit");
+    }
+    return copy;
+}
+
+} // namespace
+
+Circuit::Circuit(const std::string& name)
+    : name_(name),
+      elements_(std::make_shared<Elements>()),
+      component_names_(std::make_shared<SymbolTable>()),
+      node_names_(std::make_shared<SymbolTable>()) {}
+
+Circuit::~Circuit() {
+    if (elements_->attached) {
+        for (const auto& node : elements_->nodes) {
+            detachNode(*node);
+        }
+    }
+    for (const auto& [handle, node] : node_edits_) {
+        detachNode(*node);
+    }
+}
+
+std::unique_ptr<Circuit> Circuit::clone(const std::string& name) {
+    detach();
+    auto copy = std::make_unique<Circuit>(name);
+    copy->elements_ = elements_;
+    copy->component_names_ = component_names_;
+    copy->node_names_ = node_names_;
+    copy->topology_ = topology_;
+    copy->initial_conditions_ = initial_conditions_;
+    copy->stats_ = stats_;
+    copy->simd_level_ = simd_level_;
+    copy->voltages_ = voltages_;
+    // Private copies stay private to this circuit, so the clone gets its own.
+    // Node copies are made again on demand from the table just copied.
+    for (const auto& [handle, component] : edits_) {
+        std::shared_ptr<Component> device = copyComponent(*component);
+        copy->wireTerminals(*device, *this);
+        copy->edits_.emplace(handle, std::move(device));
+    }
+    if (state_) {
+        copy->state_ = std::make_unique<DeviceState>(*state_);
+        for (const auto& [handle, component] : copy->edits_) {
+            copy->state_->replace(component.get());
+        }
+    }
+    return copy;
+}
+
+void Circuit::detach() {
+    if (!elements_->attached) {
+        return;
+    }
+    for (const auto& node : elements_->nodes) {
+        detachNode(*node);
+    }
+    if (state_) {
+        state_->detach();
+    }
+    elements_->attached = false;
+}
+
+void Circuit::detachNode(Node& node) {
+    node.voltage_ = node.getVoltage();
+    node.voltages_ = nullptr;
+}
+
+bool Circuit::ownsNode(const Node* node) const {
+    NodeId handle = node->getHandle();
+    if (handle >= elements_->nodes.size()) {
+        return false;
+    }
+    if (elements_->nodes[handle].get() == node) {
+        return true;
+    }
+    auto copy = node_edits_.find(handle);
+    return copy != node_edits_.end() && copy->second.get() == node;
+}
+
+void Circuit::wireTerminals(Component& component, const Circuit& source) {
+    for (Node*& node : component.nodes_) {
+        if (source.ownsNode(node)) {
+            node = getNode(node->getHandle()).get();
+        }
+    }
+}
+
+std::shared_ptr<Component> Circuit::editComponent(ComponentId id) {
+    if (id >= getComponentCount()) {
+        throw std::out_of_range("No component " + std::to_string(id) + " in circuit " + name_);
+    }
+    return getComponent(id);
+}
+
+const std::shared_ptr<Node>& Circuit::getNode(NodeId id) {
+    if (elements_->attached) {
+        return elements_->nodes[id];
+    }
+    auto copy = node_edits_.find(id);
+    if (copy == node_edits_.end()) {
+        auto node = std::make_shared<Node>(*elements_->nodes[id]);
+        node->voltages_ = &voltages_;
+        copy = node_edits_.emplace(id, std::move(node)).first;
+    }
+    return copy->second;
+}
+
+const std::shared_ptr<Component>& Circuit::getComponent(ComponentId id) {
+    if (elements_->attached) {
+        return elements_->components[id];
+    }
+    auto edit = edits_.find(id);
+    if (edit == edits_.end()) {
+        std::shared_ptr<Component> copy = copyComponent(*elements_->components[id]);
+        wireTerminals(*copy, *this);
+        if (state_) {
+            // Takes over the shared device's slot, state included
+            state_->replace(copy.get());
+        }
+        edit = edits_.emplace(id, std::move(copy)).first;
+    }
+    return edit->second;
+}
+
+Circuit::Elements& Circuit::mutableElements() {
+    if (elements_->attached) {
+        return *elements_;
+    }
+    if (!isShared()) {
+        // The clones are gone: fold the private copies back in
+        Elements& elements = *elements_;
+        for (auto& [handle, component] : edits_) {
+            for (Node*& node : component->nodes_) {
+                if (ownsNode(node)) {
+                    node = elements.nodes[node->getHandle()].get();
+                }
+            }
+            replaceComponent(elements, handle, std::move(component));
+        }
+        for (const auto& [handle, node] : node_edits_) {
+            detachNode(*node);
+        }
+        for (const auto& node : elements.nodes) {
+            node->voltages_ = &voltages_;
+        }
+    } else {
+        // Copy every node and device, reusing this circuit's private copies, then
+        // move terminals onto the copied nodes. Handles, the compiled topology
+        // and the run state carry over unchanged.
+        const Elements& shared = *elements_;
+        auto elements = std::make_shared<Elements>();
+        elements->nodes.reserve(shared.nodes.size());
+        elements->arena->reserve<Node>(shared.nodes.size());
+        for (NodeId handle = 0; handle < shared.nodes.size(); ++handle) {
+            auto copy = node_edits_.find(handle);
+            if (copy != node_edits_.end()) {
+                elements->nodes.push_back(copy->second);
+                continue;
+            }
+            Node* node = elements->arena->create<Node>(*shared.nodes[handle]);
+            node->voltages_ = &voltages_;
+            elements->nodes.emplace_back(std::shared_ptr<Node>(), node);
+        }
+        
+        elements->components.reserve(shared.components.size());
+        for (ComponentId handle = 0; handle < shared.components.size(); ++handle) {
+            auto edit = edits_.find(handle);
+            std::shared_ptr<Component> copy = (edit != edits_.end()) ? edit->second
+                                                                      : copyComponent(*shared.components[handle]);
+            for (Node*& node : copy->nodes_) {
+                if (ownsNode(node)) {
+                    node = elements->nodes[node->getHandle()].get();
+                }
+            }
+            auto& retained = copy->retained_nodes_;
+            retained.erase(std::remove_if(retained.begin(), retained.end(),
+                                          [&](const std::shared_ptr<Node>& node) { return ownsNode(node.get()); }),
+                           retained.end());
+            
+            if (auto source = std::dynamic_pointer_cast<Source>(copy)) {
+                elements->sources.push_back(source);
+            }
+            elements->components.push_back(std::move(copy));
+        }
+        elements_ = std::move(elements);
+    }
+    
+    edits_.clear();
+    node_edits_.clear();
+    elements_->attached = true;
+    if (state_) {
+        state_->attach(elements_->components);
+    }
+    return *elements_;
+}
+
+void Circuit::replaceComponent(Elements& elements, ComponentId handle, std::shared_ptr<Component> component) {
+    // Replacing a component must also drop it from the source list
+    auto& slot = elements.components[handle];
+    elements.sources.erase(std::remove(elements.sources.begin(), elements.sources.end(), slot),
+                           elements.sources.end());
+    slot = std::move(component);
+    if (auto source = std::dynamic_pointer_cast<Source>(slot)) {
+        elements.sources.push_back(source);
+    }
+}
+
+ComponentId Circuit::addComponent(std::shared_ptr<Component> component) {
+    if (!component || component->getId().empty()) {
+        return kInvalidId;
+    }
+    
+    ComponentId handle = component_names_->find(component->getId());
+    if (handle == kInvalidId) {
+        return appendComponent(std::move(component));
+    }
+    Elements& elements = mutableElements();
+    invalidateState();
+    component->handle_ = handle;
+    topology_.reset();
+    replaceComponent(elements, handle, std::move(component));
+    return handle;
+}
+
+ComponentId Circuit::appendComponent(std::shared_ptr<Component> component) {
+    Elements& elements = mutableElements();
+    ComponentId handle = writableNames(component_names_).intern(component->getId());
+    if (handle != elements.components.size()) {
+        return kInvalidId;
+    }
+    invalidateState();
+    component->handle_ = handle;
+    topology_.reset();
+    elements.components.push_back(component);
+    if (auto source = std::dynamic_pointer_cast<Source>(component)) {
+        elements.sources.push_back(source);
+    }
+    return handle;
+}
+
+NodeId Circuit::addNode(std::shared_ptr<Node> node) {
+    if (!node || node->getId().empty()) {
+        return kInvalidId;
     }
+    
+    NodeId handle = node_names_->find(node->getId());
+    if (handle == kInvalidId) {
+        return appendNode(std::move(node));
+    }
+    Elements& elements = mutableElements();
+    invalidateState();
+    double voltage = node->getVoltage();
+    detachNode(*elements.nodes[handle]);
+    elements.nodes[handle] = node;
+    voltages_[handle] = voltage;
+    node->handle_ = handle;
+    node->voltages_ = &voltages_;
+    topology_.reset();
+    return handle;
 }
 
-void Circuit::addNode(std::shared_ptr<Node> node) {
-    if (node && !node->getId().empty()) {
-        nodes_[node->getId()] = node;
+NodeId Circuit::appendNode(std::shared_ptr<Node> node) {
+    Elements& elements = mutableElements();
+    NodeId handle = writableNames(node_names_).intern(node->getId());
+    if (handle != elements.nodes.size()) {
+        return kInvalidId;
     }
+    invalidateState();
+    voltages_.push_back(node->getVoltage());
+    elements.nodes.push_back(node);
+    node->handle_ = handle;
+    node->voltages_ = &voltages_;
+    topology_.reset();
+    return handle;
 }
 
 void Circuit::simulate(double duration, double timestep) {
     std::cout << "Simulating circuit '" << name_ << "' for " << duration 
               << "s with timestep " << timestep << "s" << std::endl;
     
-    double time = 0.0;
+    runState();
+    std::vector<Source*> sources = runSources();
+    stats_ = SimulationStats{};
+    if (monitor_) {
+        monitor_->begin(*this);
+    }
+    
+    // Seed the queue with each source's first corner
+    BreakpointQueue breakpoints;
+    for (size_t i = 0; i < sources.size(); ++i) {
+        sources[i]->setTime(0.0);
+        double next = sources[i]->nextBreakpoint(0.0);
+        if (next < duration) {
+            breakpoints.push(next, i);
+        }
+    }
+    if (results_) {
+        // One row per nominal step plus the initial point; corners add a few more
+        results_->begin(*this, static_cast<size_t>(std::ceil(duration / timestep)) + 1);
+        results_->record(0.0);
+    }
+    transient(sources, duration, timestep, 0.0, breakpoints, 0);
+}
+
+void Circuit::resume(const SimulationCheckpoint& checkpoint) {
+    if (results_ && results_->getSinkCount() > 0) {
+        throw std::invalid_argument("Result store sinks cannot continue a resumed run of circuit " + name_);
+    }
+    std::cout << "Resuming circuit '" << name_ << "' at t=" << checkpoint.time << "s of " << checkpoint.duration
+              << "s" << std::endl;
+    
+    auto mismatch = [&]() { return std::invalid_argument("Checkpoint does not match circuit " + name_); };
+    if (checkpoint.node_voltages.size() != voltages_.size() || checkpoint.component_count != getComponentCount() ||
+        checkpoint.pending_times.size() != checkpoint.pending_sources.size() ||
+        checkpoint.device_offsets.size() != checkpoint.device_handles.size() + 1) {
+        throw mismatch();
+    }
+    // Same kernels as the interrupted run, so the banks round the same way
+    setSimdLevel(checkpoint.simd_level);
+    DeviceState& state = runState();
+    const std::vector<Component*>& unbound = state.getUnbound();
+    if (checkpoint.device_handles.size() != unbound.size()) {
+        throw mismatch();
+    }
+    std::vector<double> values;
+    for (size_t i = 0; i < unbound.size(); ++i) {
+        values.clear();
+        if (unbound[i]->getHandle() != checkpoint.device_handles[i] || !unbound[i]->saveState(values) ||
+            values.size() != checkpoint.device_offsets[i + 1] - checkpoint.device_offsets[i]) {
+            throw mismatch();
+        }
+    }
+    if (checkpoint.device_offsets.back() != checkpoint.device_values.size()) {
+        throw mismatch();
+    }
+    std::vector<Source*> sources = runSources();
+    std::vector<size_t> source_index(getComponentCount(), kInvalidId);
+    for (size_t i = 0; i < sources.size(); ++i) {
+        source_index[sources[i]->getHandle()] = i;
+    }
+    BreakpointQueue breakpoints;
+    for (size_t i = 0; i < checkpoint.pending_times.size(); ++i) {
+        uint32_t handle = checkpoint.pending_sources[i];
+        if (handle >= source_index.size() || source_index[handle] == kInvalidId) {
+            throw mismatch();
+        }
+        breakpoints.push(checkpoint.pending_times[i], source_index[handle]);
+    }
+    
+    state.restore(checkpoint.devices);
+    voltages_ = checkpoint.node_voltages;
+    for (size_t i = 0; i < unbound.size(); ++i) {
+        unbound[i]->restoreState(checkpoint.device_values.data() + checkpoint.device_offsets[i]);
+    }
+    stats_ = SimulationStats{};
+    stats_.steps = checkpoint.steps;
+    stats_.breakpoints = checkpoint.breakpoints;
+    if (monitor_) {
+        monitor_->begin(*this);
+    }
+    if (results_) {
+        double remaining = std::max(0.0, checkpoint.duration - checkpoint.time);
+        results_->begin(*this, static_cast<size_t>(std::ceil(remaining / checkpoint.timestep)));
+    }
+    transient(sources, checkpoint.duration, checkpoint.timestep, checkpoint.time, breakpoints,
+              checkpoint.recorded_rows);
+}
+
+void Circuit::transient(const std::vector<Source*>& sources, double duration, double timestep, double time,
+                        BreakpointQueue& breakpoints, size_t recorded_rows) {
+    DeviceState& state = *state_;
     while (time < duration) {
-        // Simulate all components
-        for (auto& [id, component] : components_) {
-            component->simulate(timestep);
+        // Never step across a corner: shorten the step to land on it, and split
+        // the last two steps evenly so no sliver step is left in front of it
+        double limit = duration;
+        if (!breakpoints.empty() && breakpoints.top().time < limit) {
+            limit = breakpoints.top().time;
+        }
+        double next_time = time + timestep;
+        if (limit - time <= timestep) {
+            next_time = limit;
+        } else if (limit - time < 2.0 * timestep) {
+            next_time = time + 0.5 * (limit - time);
+        }
+        double step = next_time - time;
+        
+        // Sources first, so every component sees this step's stimulus
+        for (Source* source : sources) {
+            source->setTime(next_time);
+        }
+        for (Component* component : state.getUnbound()) {
+            component->simulate(step);
+        }
+        state.step(voltages_, step);
+        time = next_time;
+        ++stats_.steps;
+        
+        // Retire the corners just reached and queue each source's following one
+        while (!breakpoints.empty() && breakpoints.top().time <= time) {
+            BreakpointQueue::Entry reached = breakpoints.top();
+            breakpoints.pop();
+            ++stats_.breakpoints;
+            double next = sources[reached.source]->nextBreakpoint(reached.time);
+            if (next < duration) {
+                breakpoints.push(next, reached.source);
+            }
+        }
+        
+        if (results_) {
+            results_->record(time);
+        }
+        
+        if (monitor_ && monitor_->sample(time)) {
+            stats_.steady_state = monitor_->getState();
+            stats_.settle_time = monitor_->getSettleTime();
+            stats_.period = monitor_->getPeriod();
+            break;
+        }
+        
+        if (checkpoints_ && checkpoints_->due(stats_.steps)) {
+            size_t rows = recorded_rows + (results_ ? results_->getSampleCount() : 0);
+            checkpoints_->write(captureCheckpoint(sources, duration, timestep, time, breakpoints, rows));
         }
-        time += timestep;
+    }
+    stats_.end_time = time;
+    if (results_) {
+        results_->finish();
+    }
+    if (checkpoints_) {
+        checkpoints_->finish();
     }
     
+    if (stats_.steady_state != SteadyState::None) {
+        std::cout << "Steady state reached at t=" << stats_.settle_time
+                  << "s, stopped at t=" << time << "s" << std::endl;
+    }
     std::cout << "Simulation completed." << std::endl;
 }
 
+std::shared_ptr<SimulationCheckpoint> Circuit::captureCheckpoint(const std::vector<Source*>& sources,
+                                                                 double duration, double timestep, double time,
+                                                                 const BreakpointQueue& breakpoints,
+                                                                 size_t recorded_rows) const {
+    auto checkpoint = std::make_shared<SimulationCheckpoint>();
+    checkpoint->duration = duration;
+    checkpoint->timestep = timestep;
+    checkpoint->time = time;
+    checkpoint->steps = stats_.steps;
+    checkpoint->breakpoints = stats_.breakpoints;
+    for (const BreakpointQueue::Entry& entry : breakpoints.getEntries()) {
+        checkpoint->pending_times.push_back(entry.time);
+        checkpoint->pending_sources.push_back(sources[entry.source]->getHandle());
+    }
+    checkpoint->recorded_rows = recorded_rows;
+    
+    checkpoint->component_count = elements_->components.size();
+    checkpoint->simd_level = state_->getSimdLevel();
+    checkpoint->node_voltages = voltages_;
+    checkpoint->devices = state_->save();
+    for (const Component* component : state_->getUnbound()) {
+        if (!component->saveState(checkpoint->device_values)) {
+            throw std::runtime_error("Component '" + component->getId() + "' of type " + component->getType() +
+                                     " cannot be checkpointed");
+        }
+        checkpoint->device_handles.push_back(component->getHandle());
+        checkpoint->device_offsets.push_back(checkpoint->device_values.size());
+    }
+    return checkpoint;
+}
+
 void Circuit::reset() {
-    // Reset all nodes to zero voltage
-    for (auto& [id, node] : nodes_) {
-        node->setVoltage(0.0);
+    DeviceState& state = runState();
+    
+    if (initial_conditions_) {
+        voltages_ = initial_conditions_->node_voltages;
+        state.restore(initial_conditions_->devices);
+    } else {
+        std::fill(voltages_.begin(), voltages_.end(), 0.0);
+        state.clear();
+    }
+    // Only devices outside the banks keep state of their own
+    const std::vector<Component*>& unbound = state.getUnbound();
+    for (size_t i = 0; i < unbound.size(); ++i) {
+        if (initial_conditions_ && initial_conditions_->saved[i]) {
+            unbound[i]->restoreState(initial_conditions_->device_values.data() +
+                                     initial_conditions_->device_offsets[i]);
+        } else {
+            unbound[i]->resetState();
+        }
+    }
+    stats_ = SimulationStats{};
+}
+
+void Circuit::saveInitialConditions() {
+    auto snapshot = std::make_shared<InitialConditions>();
+    snapshot->node_voltages = voltages_;
+    DeviceState& state = deviceState();
+    snapshot->devices = state.save();
+    for (const Component* component : state.getUnbound()) {
+        size_t size = snapshot->device_values.size();
+        bool saved = component->saveState(snapshot->device_values);
+        if (!saved) {
+            snapshot->device_values.resize(size);
+        }
+        snapshot->saved.push_back(saved);
+        snapshot->device_offsets.push_back(snapshot->device_values.size());
+    }
+    initial_conditions_ = std::move(snapshot);
+}
+
+DeviceState& Circuit::deviceState() {
+    if (!state_) {
+        const Elements& elements = *elements_;
+        auto state = std::make_unique<DeviceState>(simd_level_);
+        for (ComponentId handle = 0; handle < elements.components.size(); ++handle) {
+            Component* component = elements.components[handle].get();
+            bool attach = elements.attached;
+            auto edit = edits_.find(handle);
+            if (edit != edits_.end()) {
+                component = edit->second.get();
+                attach = true;
+            }
+            // Banks address terminals by handle, so they must be this circuit's nodes
+            for (const Node* node : component->getNodes()) {
+                if (!ownsNode(node)) {
+                    throw std::runtime_error("Component '" + component->getId() + "' is connected to node '" +
+                                             node->getId() + "', which is not part of the circuit");
+                }
+            }
+            // Devices shared with clones get a slot but stay detached from it
+            state->add(component, attach);
+        }
+        state_ = std::move(state);
+    }
+    return *state_;
+}
+
+DeviceState& Circuit::runState() {
+    DeviceState& state = deviceState();
+    if (!elements_->attached) {
+        // Devices outside the banks keep their state in the object itself
+        const std::vector<Component*>& unbound = state.getUnbound();
+        for (size_t i = 0; i < unbound.size(); ++i) {
+            getComponent(unbound[i]->getHandle());
+        }
+    }
+    return state;
+}
+
+std::vector<Source*> Circuit::runSources() {
+    std::vector<Source*> sources;
+    sources.reserve(elements_->sources.size());
+    for (const auto& source : elements_->sources) {
+        sources.push_back(static_cast<Source*>(getComponent(source->getHandle()).get()));
+    }
+    return sources;
+}
+
+void Circuit::invalidateState() {
+    state_.reset();
+    initial_conditions_.reset();
+}
+
+void Circuit::setSimdLevel(SimdLevel level) {
+    simd_level_ = level;
+    if (state_) {
+        state_->setSimdLevel(level);
+    }
+}
+
+std::shared_ptr<Node> Circuit::createNode(const std::string& id) {
+    if (id.empty() || findNode(id) != kInvalidId) {
+        throw std::invalid_argument("Node '" + id + "' cannot be created in circuit " + name_);
+    }
+    Node* raw = mutableElements().arena->create<Node>(id);
+    std::shared_ptr<Node> node(std::shared_ptr<Node>(), raw);
+    appendNode(node);
+    return node;
+}
+
+void Circuit::connect(ComponentId component, NodeId node) {
+    Elements& elements = mutableElements();
+    invalidateState();
+    std::vector<Node*>& terminals = elements.components.at(component)->nodes_;
+    if (terminals.empty()) {
+        terminals.reserve(2);  // one allocation for the usual two-terminal device
+    }
+    terminals.push_back(elements.nodes.at(node).get());
+    topology_.reset();
+}
+
+const Topology& Circuit::compile() {
+    // Edited copies keep the terminals of the devices they shadow
+    topology_ = Topology::build(elements_->components, elements_->nodes);
+    return *topology_;
+}
+
+void Circuit::setTopology(std::shared_ptr<const Topology> topology) {
+    if (!topology || topology->getNodeCount() != getNodeCount() ||
+        topology->getDeviceCount() != getComponentCount()) {
+        throw std::invalid_argument("Topology does not match circuit " + name_);
+    }
+    const Elements& elements = *elements_;
+    for (ComponentId id = 0; id < getComponentCount(); ++id) {
+        const auto& nodes = elements.components[id]->getNodes();
+        auto terminals = topology->deviceNodes(id);
+        if (nodes.size() != terminals.size()) {
+            throw std::invalid_argument("Topology does not match circuit " + name_);
+        }
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            if (elements.nodes[terminals[i]].get() != nodes[i]) {
+                throw std::invalid_argument("Topology does not match circuit " + name_);
+            }
+        }
+    }
+    topology_ = std::move(topology);
+}
+
+NodeId Circuit::insertNode(const std::string& id) {
+    if (id.empty() || findNode(id) != kInvalidId) {
+        throw std::invalid_argument("Node '" + id + "' cannot be inserted into circuit " + name_);
+    }
+    Elements& elements = mutableElements();
+    Node* raw = elements.arena->create<Node>(id);
+    NodeId handle = writableNames(node_names_).intern(id);
+    raw->handle_ = handle;
+    raw->voltages_ = &voltages_;
+    elements.nodes.emplace_back(std::shared_ptr<Node>(), raw);
+    voltages_.push_back(0.0);
+    initial_conditions_.reset();
+    if (topology_) {
+        topology_ = Topology::addNode(std::move(topology_));
+    }
+    return handle;
+}
+
+ComponentId Circuit::insertComponent(std::shared_ptr<Component> component, const std::vector<NodeId>& terminals) {
+    if (!component || component->getId().empty() || findComponent(component->getId()) != kInvalidId ||
+        !component->getNodes().empty()) {
+        throw std::invalid_argument("Component '" + (component ? component->getId() : std::string()) +
+                                    "' cannot be inserted into circuit " + name_);
+    }
+    Elements& elements = mutableElements();
+    for (NodeId terminal : terminals) {
+        if (terminal >= elements.nodes.size()) {
+            throw std::invalid_argument("Node " + std::to_string(terminal) + " is not part of circuit " + name_);
+        }
+    }
+    
+    ComponentId handle = writableNames(component_names_).intern(component->getId());
+    component->handle_ = handle;
+    for (NodeId terminal : terminals) {
+        component->nodes_.push_back(elements.nodes[terminal].get());
+    }
+    elements.components.push_back(component);
+    if (auto source = std::dynamic_pointer_cast<Source>(component)) {
+        elements.sources.push_back(source);
     }
     
-    std::cout << "Circuit '" << name_ << "' reset." << std::endl;
+    initial_conditions_.reset();
+    if (state_) {
+        state_->add(component.get());
+    }
+    if (topology_) {
+        topology_ = Topology::addDevice(std::move(topology_), terminals);
+    }
+    return handle;
+}
+
+void Circuit::removeComponent(ComponentId id) {
+    if (id >= getComponentCount()) {
+        throw std::invalid_argument("No component " + std::to_string(id) + " in circuit " + name_);
+    }
+    Elements& elements = mutableElements();
+    initial_conditions_.reset();
+    std::shared_ptr<Component> removed = std::move(elements.components[id]);
+    if (state_) {
+        state_->remove(removed.get());
+    }
+    elements.sources.erase(std::remove(elements.sources.begin(), elements.sources.end(), removed),
+                           elements.sources.end());
+    ComponentId last = static_cast<ComponentId>(elements.components.size() - 1);
+    if (id != last) {
+        elements.components[id] = std::move(elements.components[last]);
+        elements.components[id]->handle_ = id;
+    }
+    elements.components.pop_back();
+    writableNames(component_names_).swapRemove(id);
+    removed->handle_ = kInvalidId;
+    
+    if (topology_) {
+        topology_ = Topology::removeDevice(std::move(topology_), id);
+    }
+}
+
+void Circuit::removeNode(NodeId id) {
+    if (id >= getNodeCount()) {
+        throw std::invalid_argument("No node " + std::to_string(id) + " in circuit " + name_);
+    }
+    Elements& elements = mutableElements();
+    const Node* node = elements.nodes[id].get();
+    bool attached = false;
+    if (topology_) {
+        attached = topology_->nodeDevices(id).size() > 0;
+    } else {
+        for (const auto& component : elements.components) {
+            const auto& nodes = component->getNodes();
+            attached = attached || std::find(nodes.begin(), nodes.end(), node) != nodes.end();
+        }
+    }
+    if (attached) {
+        throw std::invalid_argument("Node '" + node->getId() + "' still has devices attached");
+    }
+    
+    initial_conditions_.reset();
+    std::shared_ptr<Node> removed = std::move(elements.nodes[id]);
+    detachNode(*removed);
+    NodeId last = static_cast<NodeId>(elements.nodes.size() - 1);
+    if (id != last) {
+        elements.nodes[id] = std::move(elements.nodes[last]);
+        elements.nodes[id]->handle_ = id;
+        voltages_[id] = voltages_[last];
+        // Bound devices address terminals by handle
+        if (state_) {
+            state_->moveNode(last, id);
+        }
+    }
+    elements.nodes.pop_back();
+    voltages_.pop_back();
+    writableNames(node_names_).swapRemove(id);
+    removed->handle_ = kInvalidId;
+    
+    if (topology_) {
+        topology_ = Topology::removeNode(std::move(topology_), id);
+    }
+}
+
+void Circuit::setParameter(ComponentId id, size_t index, double value) {
+    if (id >= getComponentCount()) {
+        throw std::invalid_argument("No component " + std::to_string(id) + " in circuit " + name_);
+    }
+    std::shared_ptr<Component> component = editComponent(id);
+    if (!component->setParameter(index, value)) {
+        throw std::invalid_argument("Component '" + component->getId() + "' has no parameter " +
+                                    std::to_string(index) + " to set");
+    }
 }
 
 std::shared_ptr<Node> Circuit::getNode(const std::string& id) {
-    auto it = nodes_.find(id);
-    return (it != nodes_.end()) ? it->second : nullptr;
+    NodeId handle = findNode(id);
+    return (handle != kInvalidId) ? getNode(handle) : nullptr;
 }
 
 std::shared_ptr<Component> Circuit::getComponent(const std::string& id) {
-    auto it = components_.find(id);
-    return (it != components_.end()) ? it->second : nullptr;
+    ComponentId handle = findComponent(id);
+    return (handle != kInvalidId) ? getComponent(handle) : nullptr;
+}
+
+// Component implementation
+void Component::connect(std::shared_ptr<Node> node) {
+    nodes_.push_back(node.get());
+    retained_nodes_.push_back(std::move(node));
 }
 
 // Resistor implementation
 void Resistor::simulate(double timestep) {
+    (void)timestep;
     if (nodes_.size() >= 2) {
         double voltage_diff = nodes_[0]->getVoltage() - nodes_[1]->getVoltage();
-        current_ = voltage_diff / resistance_; // Ohm's law: I = V/R
+        (bank_ ? bank_->current[slot_] : current_) = voltage_diff / resistance_; // Ohm's law: I = V/R
+    }
+}
+
+std::unique_ptr<Component> Resistor::clone() const {
+    auto copy = std::make_unique<Resistor>(*this);
+    copy->unbindState();
+    return copy;
+}
+
+bool Resistor::bindState(DeviceState& state) const {
+    if (nodes_.size() < 2) {
+        return false;
+    }
+    state.resistors().add(nodes_[0]->getHandle(), nodes_[1]->getHandle(), resistance_, current_);
+    return true;
+}
+
+void Resistor::attachState(DeviceState& state, size_t slot) {
+    bank_ = &state.resistors();
+    slot_ = slot;
+}
+
+void Resistor::unbindState() {
+    if (bank_) {
+        current_ = bank_->current[slot_];
+        bank_ = nullptr;
     }
 }
 
-void Resistor::connect(std::shared_ptr<Node> node) {
-    nodes_.push_back(node);
-    node->addComponent(std::static_pointer_cast<Component>(shared_from_this()));
+void Resistor::resetState() {
+    current_ = 0.0;
+    if (bank_) {
+        bank_->current[slot_] = 0.0;
+    }
+}
+
+void Resistor::setResistance(double resistance) {
+    resistance_ = resistance;
+    if (bank_) {
+        bank_->resistance[slot_] = resistance;
+    }
 }
 
+
 // Capacitor implementation
 void Capacitor::simulate(double timestep) {
     if (nodes_.size() >= 2) {
+        double& voltage = bank_ ? bank_->voltage[slot_] : voltage_;
         double new_voltage = nodes_[0]->getVoltage() - nodes_[1]->getVoltage();
-        double current = capacitance_ * (new_voltage - voltage_) / timestep; // I = C * dV/dt
-        charge_ += current * timestep;
-        voltage_ = new_voltage;
+        double current = capacitance_ * (new_voltage - voltage) / timestep; // I = C * dV/dt
+        (bank_ ? bank_->charge[slot_] : charge_) += current * timestep;
+        (bank_ ? bank_->current[slot_] : current_) = current;
+        voltage = new_voltage;
     }
 }
 
-void Capacitor::connect(std::shared_ptr<Node> node) {
-    nodes_.push_back(node);
-    node->addComponent(std::static_pointer_cast<Component>(shared_from_this()));
+std::unique_ptr<Component> Capacitor::clone() const {
+    auto copy = std::make_unique<Capacitor>(*this);
+    copy->unbindState();
+    return copy;
+}
+
+bool Capacitor::bindState(DeviceState& state) const {
+    if (nodes_.size() < 2) {
+        return false;
+    }
+    state.capacitors().add(nodes_[0]->getHandle(), nodes_[1]->getHandle(), capacitance_, charge_, voltage_,
+                           current_);
+    return true;
 }
 
+void Capacitor::attachState(DeviceState& state, size_t slot) {
+    bank_ = &state.capacitors();
+    slot_ = slot;
+}
+
+void Capacitor::unbindState() {
+    if (bank_) {
+        charge_ = bank_->charge[slot_];
+        voltage_ = bank_->voltage[slot_];
+        current_ = bank_->current[slot_];
+        bank_ = nullptr;
+    }
+}
+
+void Capacitor::resetState() {
+    charge_ = 0.0;
+    voltage_ = 0.0;
+    current_ = 0.0;
+    if (bank_) {
+        bank_->charge[slot_] = 0.0;
+        bank_->voltage[slot_] = 0.0;
+        bank_->current[slot_] = 0.0;
+    }
+}
+
+bool Capacitor::saveState(std::vector<double>& values) const {
+    values.push_back(charge_);
+    values.push_back(voltage_);
+    values.push_back(current_);
+    return true;
+}
+
+void Capacitor::restoreState(const double* values) {
+    charge_ = values[0];
+    voltage_ = values[1];
+    current_ = values[2];
+}
+
+void Capacitor::setCapacitance(double capacitance) {
+    capacitance_ = capacitance;
+    if (bank_) {
+        bank_->capacitance[slot_] = capacitance;
+    }
+}
+
+
 } // namespace ic_sim
\ No newline at end of file
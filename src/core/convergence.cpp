@@ -0,0 +1,290 @@
+#include "core/convergence.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace ic_sim {
+
+namespace {
+
+double band(const ProbeTolerance& tolerance, double magnitude) {
+    return tolerance.abstol + tolerance.reltol * magnitude;
+}
+
+bool matches(const std::deque<double>& values, const ProbeTolerance& tolerance) {
+    double reference = values.back();
+    for (double value : values) {
+        if (std::abs(value - reference) > band(tolerance, std::abs(reference))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+size_t ConvergenceMonitor::addProbe(const std::string& name, std::function<double()> read,
+                                    const ProbeTolerance& tolerance) {
+    if (!read) {
+        throw std::invalid_argument("Convergence probe '" + name + "' has no reader");
+    }
+    Probe probe;
+    probe.name = name;
+    probe.read = std::move(read);
+    probe.tolerance = tolerance;
+    return add(std::move(probe));
+}
+
+size_t ConvergenceMonitor::addNodeProbe(NodeId node, const ProbeTolerance& tolerance) {
+    Probe probe;
+    probe.name = "node " + std::to_string(node);
+    probe.tolerance = tolerance;
+    probe.target = Target::Node;
+    probe.handle = node;
+    return add(std::move(probe));
+}
+
+size_t ConvergenceMonitor::addComponentProbe(ComponentId component, const ProbeTolerance& tolerance) {
+    Probe probe;
+    probe.name = "component " + std::to_string(component);
+    probe.tolerance = tolerance;
+    probe.target = Target::Component;
+    probe.handle = component;
+    return add(std::move(probe));
+}
+
+size_t ConvergenceMonitor::add(Probe probe) {
+    if (probe.tolerance.window < 2 || probe.tolerance.periods < 1) {
+        throw std::invalid_argument("Convergence probe '" + probe.name + "' needs window >= 2 and periods >= 1");
+    }
+    probes_.push_back(std::move(probe));
+    return probes_.size() - 1;
+}
+
+void ConvergenceMonitor::begin(Circuit& circuit) {
+    for (auto& probe : probes_) {
+        if (probe.target == Target::Node) {
+            if (probe.handle >= circuit.getNodeCount()) {
+                throw std::invalid_argument("Convergence probe on node " + std::to_string(probe.handle) +
+                                            " is outside circuit " + circuit.getName());
+            }
+            probe.name = "V(" + std::string(circuit.getNodeName(probe.handle)) + ")";
+            const std::vector<double>* voltages = &circuit.getVoltages();
+            probe.read = [voltages, node = probe.handle]() { return (*voltages)[node]; };
+        } else if (probe.target == Target::Component) {
+            if (probe.handle >= circuit.getComponentCount()) {
+                throw std::invalid_argument("Convergence probe on component " + std::to_string(probe.handle) +
+                                            " is outside circuit " + circuit.getName());
+            }
+            probe.name = std::string(circuit.getComponentName(probe.handle));
+            const Component* component = circuit.getComponent(probe.handle).get();
+            probe.read = [component]() { return component->getCurrentValue(); };
+        }
+    }
+    reset();
+}
+
+void ConvergenceMonitor::reset() {
+    for (auto& probe : probes_) {
+        Probe fresh;
+        fresh.name = std::move(probe.name);
+        fresh.read = std::move(probe.read);
+        fresh.tolerance = probe.tolerance;
+        fresh.target = probe.target;
+        fresh.handle = probe.handle;
+        probe = std::move(fresh);
+    }
+    steady_ = false;
+    settle_time_ = 0.0;
+    period_ = 0.0;
+}
+
+bool ConvergenceMonitor::sample(double time) {
+    if (probes_.empty()) {
+        return false;
+    }
+
+    bool all_steady = true;
+    double settle_time = 0.0;
+    double period = 0.0;
+    for (auto& probe : probes_) {
+        update(probe, time, probe.read());
+        if (probe.state == SteadyState::None) {
+            all_steady = false;
+        } else {
+            settle_time = std::max(settle_time, probe.settle_time);
+            period = std::max(period, probe.period);
+        }
+    }
+
+    steady_ = all_steady;
+    if (steady_) {
+        settle_time_ = settle_time;
+        period_ = period;
+    }
+    return steady_;
+}
+
+SteadyState ConvergenceMonitor::getState() const {
+    if (!steady_) {
+        return SteadyState::None;
+    }
+    bool periodic = std::any_of(probes_.begin(), probes_.end(),
+                                [](const Probe& probe) { return probe.state == SteadyState::Periodic; });
+    return periodic ? SteadyState::Periodic : SteadyState::Settled;
+}
+
+void ConvergenceMonitor::update(Probe& probe, double time, double value) {
+    const ProbeTolerance& tolerance = probe.tolerance;
+    size_t index = probe.count++;
+
+    // Sliding-window extrema over the last `window` samples
+    probe.times.push_back(time);
+    if (probe.times.size() > tolerance.window) {
+        probe.times.pop_front();
+    }
+    while (!probe.window_max.empty() && probe.window_max.back().second <= value) {
+        probe.window_max.pop_back();
+    }
+    probe.window_max.emplace_back(index, value);
+    while (!probe.window_min.empty() && probe.window_min.back().second >= value) {
+        probe.window_min.pop_back();
+    }
+    probe.window_min.emplace_back(index, value);
+    size_t oldest = (probe.count > tolerance.window) ? probe.count - tolerance.window : 0;
+    while (probe.window_max.front().first < oldest) {
+        probe.window_max.pop_front();
+    }
+    while (probe.window_min.front().first < oldest) {
+        probe.window_min.pop_front();
+    }
+
+    // Close a cycle on every upward crossing of the mid level
+    if (index == 0) {
+        probe.cycle_max = value;
+        probe.cycle_min = value;
+        restartBlocks(probe);
+    } else {
+        double high = value;
+        double low = value;
+        size_t crossings = probe.crossings.size();
+        if (!probe.peaks.empty() &&
+            time - probe.crossings.back() <= 2.0 * (probe.crossings.back() - probe.crossings[crossings - 2])) {
+            high = probe.peaks.back();
+            low = probe.troughs.back();
+        } else {
+            if (probe.block_count > 0) {
+                high = std::max(high, probe.block_max);
+                low = std::min(low, probe.block_min);
+            }
+            if (probe.has_previous) {
+                high = std::max(high, probe.previous_max);
+                low = std::min(low, probe.previous_min);
+            }
+        }
+        double level = 0.5 * (high + low);
+        if (high - low > band(tolerance, std::max(std::abs(high), std::abs(low))) &&
+            value < low + 0.25 * (high - low)) {
+            probe.armed = true;
+        }
+        if (probe.armed && probe.previous < level && value >= level) {
+            probe.armed = false;
+            double fraction = (level - probe.previous) / (value - probe.previous);
+            double crossing = probe.previous_time + fraction * (time - probe.previous_time);
+            if (!probe.crossings.empty()) {
+                probe.peaks.push_back(probe.cycle_max);
+                probe.troughs.push_back(probe.cycle_min);
+                if (probe.peaks.size() > tolerance.periods) {
+                    probe.peaks.pop_front();
+                    probe.troughs.pop_front();
+                }
+            }
+            probe.crossings.push_back(crossing);
+            if (probe.crossings.size() > tolerance.periods + 1) {
+                probe.crossings.pop_front();
+            }
+            probe.cycle_max = value;
+            probe.cycle_min = value;
+            restartBlocks(probe);
+        } else {
+            probe.cycle_max = std::max(probe.cycle_max, value);
+            probe.cycle_min = std::min(probe.cycle_min, value);
+        }
+    }
+    trackBlocks(probe, value);
+    probe.previous = value;
+    probe.previous_time = time;
+
+    // Keep the earliest settle time for as long as the probe stays steady
+    SteadyState state = SteadyState::None;
+    if (isSettled(probe)) {
+        state = SteadyState::Settled;
+    } else if (isPeriodic(probe)) {
+        state = SteadyState::Periodic;
+    }
+    if (state != probe.state) {
+        if (state == SteadyState::Settled) {
+            probe.settle_time = probe.times.front();
+            probe.period = 0.0;
+        } else if (state == SteadyState::Periodic) {
+            probe.settle_time = probe.crossings.front();
+        }
+        probe.state = state;
+    }
+    if (state == SteadyState::Periodic) {
+        probe.period = (probe.crossings.back() - probe.crossings.front()) /
+                       static_cast<double>(probe.crossings.size() - 1);
+    }
+}
+
+void ConvergenceMonitor::restartBlocks(Probe& probe) {
+    probe.block_count = 0;
+    probe.block_length = probe.tolerance.window;
+    probe.has_previous = false;
+}
+
+void ConvergenceMonitor::trackBlocks(Probe& probe, double value) {
+    if (probe.block_count == 0) {
+        probe.block_max = value;
+        probe.block_min = value;
+    } else {
+        probe.block_max = std::max(probe.block_max, value);
+        probe.block_min = std::min(probe.block_min, value);
+    }
+    if (++probe.block_count == probe.block_length) {
+        probe.previous_max = probe.block_max;
+        probe.previous_min = probe.block_min;
+        probe.has_previous = true;
+        probe.block_count = 0;
+        probe.block_length *= 2;
+    }
+}
+
+bool ConvergenceMonitor::isSettled(const Probe& probe) const {
+    if (probe.count < probe.tolerance.window) {
+        return false;
+    }
+    double high = probe.window_max.front().second;
+    double low = probe.window_min.front().second;
+    return high - low <= band(probe.tolerance, std::max(std::abs(high), std::abs(low)));
+}
+
+bool ConvergenceMonitor::isPeriodic(const Probe& probe) const {
+    const ProbeTolerance& tolerance = probe.tolerance;
+    if (probe.crossings.size() < tolerance.periods + 1 || probe.peaks.size() < tolerance.periods) {
+        return false;
+    }
+
+    double last = probe.crossings.back() - probe.crossings[probe.crossings.size() - 2];
+    for (size_t i = 1; i < probe.crossings.size(); ++i) {
+        double length = probe.crossings[i] - probe.crossings[i - 1];
+        if (std::abs(length - last) > tolerance.period_reltol * last) {
+            return false;
+        }
+    }
+
+    // Equal cycle lengths alone would also accept a decaying ringing
+    return matches(probe.peaks, tolerance) && matches(probe.troughs, tolerance);
+}
+
+} // namespace ic_sim
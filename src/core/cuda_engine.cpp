@@ -54,6 +54,7 @@ bool CudaSimulationEngine::simulateComponents(std::vector<double>& voltages,
                                              double timestep,
                                              int num_components) {
     // CPU fallback
+    (void)timestep;
     currents.resize(num_components);
     for (int i = 0; i < num_components; i++) {
         if (resistances[i] > 0.0) {
@@ -72,10 +73,12 @@ int CudaSimulationEngine::getDeviceCount() {
 }
 
 std::string CudaSimulationEngine::getDeviceInfo(int device_id) {
+    (void)device_id;
     return "No CUDA device available";
 }
 
 bool CudaSimulationEngine::allocateDeviceMemory(size_t size) {
+    (void)size;
     return false;
 }
 
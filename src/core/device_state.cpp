@@ -0,0 +1,500 @@
+#include "core/device_state.h"
+#include "core/circuit.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define IC_SIM_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+namespace ic_sim {
+
+namespace {
+
+// Kernels return the largest |i_new - i_old| (capacitors) or |v_new - v_old| / L
+// (inductors); the caller scales by dt / 2. Every variant does the same operations
+// in the same order as Capacitor::simulate and Inductor::simulate (no FMA
+// contraction), so results are bit-identical across dispatch levels.
+
+double capacitorScalar(size_t begin, size_t n, const double* v_new, const double* c, double* q, double* v,
+                       double* i, double dt) {
+    double worst = 0.0;
+    for (size_t k = begin; k < n; ++k) {
+        double current = c[k] * (v_new[k] - v[k]) / dt;
+        worst = std::max(worst, std::abs(current - i[k]));
+        q[k] += current * dt;
+        v[k] = v_new[k];
+        i[k] = current;
+    }
+    return worst;
+}
+
+double inductorScalar(size_t begin, size_t n, const double* v_new, const double* l, double* i, double* v,
+                      double dt) {
+    double worst = 0.0;
+    for (size_t k = begin; k < n; ++k) {
+        worst = std::max(worst, std::abs(v_new[k] - v[k]) / l[k]);
+        i[k] += v_new[k] * dt / l[k];
+        v[k] = v_new[k];
+    }
+    return worst;
+}
+
+#ifdef IC_SIM_X86_KERNELS
+
+__attribute__((target("avx2"))) double horizontalMax(__m256d values) {
+    __m128d half = _mm_max_pd(_mm256_castpd256_pd128(values), _mm256_extractf128_pd(values, 1));
+    return std::max(_mm_cvtsd_f64(half), _mm_cvtsd_f64(_mm_unpackhi_pd(half, half)));
+}
+
+__attribute__((target("avx2"))) double capacitorAvx2(size_t n, const double* v_new, const double* c, double* q,
+                                                     double* v, double* i, double dt) {
+    const __m256d step = _mm256_set1_pd(dt);
+    const __m256d magnitude = _mm256_castsi256_pd(_mm256_set1_epi64x(0x7fffffffffffffffLL));
+    __m256d worst = _mm256_setzero_pd();
+    size_t k = 0;
+    for (; k + 4 <= n; k += 4) {
+        __m256d updated = _mm256_loadu_pd(v_new + k);
+        __m256d previous = _mm256_loadu_pd(v + k);
+        __m256d current =
+            _mm256_div_pd(_mm256_mul_pd(_mm256_loadu_pd(c + k), _mm256_sub_pd(updated, previous)), step);
+        __m256d change = _mm256_and_pd(_mm256_sub_pd(current, _mm256_loadu_pd(i + k)), magnitude);
+        worst = _mm256_max_pd(worst, change);
+        _mm256_storeu_pd(q + k, _mm256_add_pd(_mm256_loadu_pd(q + k), _mm256_mul_pd(current, step)));
+        _mm256_storeu_pd(v + k, updated);
+        _mm256_storeu_pd(i + k, current);
+    }
+    return std::max(horizontalMax(worst), capacitorScalar(k, n, v_new, c, q, v, i, dt));
+}
+
+__attribute__((target("avx2"))) double inductorAvx2(size_t n, const double* v_new, const double* l, double* i,
+                                                    double* v, double dt) {
+    const __m256d step = _mm256_set1_pd(dt);
+    const __m256d magnitude = _mm256_castsi256_pd(_mm256_set1_epi64x(0x7fffffffffffffffLL));
+    __m256d worst = _mm256_setzero_pd();
+    size_t k = 0;
+    for (; k + 4 <= n; k += 4) {
+        __m256d updated = _mm256_loadu_pd(v_new + k);
+        __m256d inductance = _mm256_loadu_pd(l + k);
+        __m256d change = _mm256_and_pd(_mm256_sub_pd(updated, _mm256_loadu_pd(v + k)), magnitude);
+        worst = _mm256_max_pd(worst, _mm256_div_pd(change, inductance));
+        __m256d delta = _mm256_div_pd(_mm256_mul_pd(updated, step), inductance);
+        _mm256_storeu_pd(i + k, _mm256_add_pd(_mm256_loadu_pd(i + k), delta));
+        _mm256_storeu_pd(v + k, updated);
+    }
+    return std::max(horizontalMax(worst), inductorScalar(k, n, v_new, l, i, v, dt));
+}
+
+// _mm512_abs_pd, _mm512_max_pd and _mm512_reduce_max_pd start from an undefined
+// register that GCC 12 warns about; these helpers do the same without one
+__attribute__((target("avx512f"))) __m512d maximum(__m512d a, __m512d b) {
+    return _mm512_mask_max_pd(a, 0xff, a, b);
+}
+
+__attribute__((target("avx512f"))) __m512d absolute(__m512d values) {
+    return _mm512_castsi512_pd(
+        _mm512_and_si512(_mm512_castpd_si512(values), _mm512_set1_epi64(0x7fffffffffffffffLL)));
+}
+
+__attribute__((target("avx512f"))) double horizontalMax(__m512d values) {
+    alignas(64) double lanes[8];
+    _mm512_store_pd(lanes, values);
+    return *std::max_element(lanes, lanes + 8);
+}
+
+__attribute__((target("avx512f"))) double capacitorAvx512(size_t n, const double* v_new, const double* c,
+                                                          double* q, double* v, double* i, double dt) {
+    const __m512d step = _mm512_set1_pd(dt);
+    __m512d worst = _mm512_setzero_pd();
+    size_t k = 0;
+    for (; k + 8 <= n; k += 8) {
+        __m512d updated = _mm512_loadu_pd(v_new + k);
+        __m512d previous = _mm512_loadu_pd(v + k);
+        __m512d current =
+            _mm512_div_pd(_mm512_mul_pd(_mm512_loadu_pd(c + k), _mm512_sub_pd(updated, previous)), step);
+        worst = maximum(worst, absolute(_mm512_sub_pd(current, _mm512_loadu_pd(i + k))));
+        _mm512_storeu_pd(q + k, _mm512_add_pd(_mm512_loadu_pd(q + k), _mm512_mul_pd(current, step)));
+        _mm512_storeu_pd(v + k, updated);
+        _mm512_storeu_pd(i + k, current);
+    }
+    return std::max(horizontalMax(worst), capacitorScalar(k, n, v_new, c, q, v, i, dt));
+}
+
+__attribute__((target("avx512f"))) double inductorAvx512(size_t n, const double* v_new, const double* l,
+                                                         double* i, double* v, double dt) {
+    const __m512d step = _mm512_set1_pd(dt);
+    __m512d worst = _mm512_setzero_pd();
+    size_t k = 0;
+    for (; k + 8 <= n; k += 8) {
+        __m512d updated = _mm512_loadu_pd(v_new + k);
+        __m512d inductance = _mm512_loadu_pd(l + k);
+        __m512d change = absolute(_mm512_sub_pd(updated, _mm512_loadu_pd(v + k)));
+        worst = maximum(worst, _mm512_div_pd(change, inductance));
+        __m512d delta = _mm512_div_pd(_mm512_mul_pd(updated, step), inductance);
+        _mm512_storeu_pd(i + k, _mm512_add_pd(_mm512_loadu_pd(i + k), delta));
+        _mm512_storeu_pd(v + k, updated);
+    }
+    return std::max(horizontalMax(worst), inductorScalar(k, n, v_new, l, i, v, dt));
+}
+
+#endif
+
+void gatherVoltages(const std::vector<uint32_t>& positive, const std::vector<uint32_t>& negative,
+                    const std::vector<double>& nodes, std::vector<double>& voltages) {
+    voltages.resize(positive.size());
+    for (size_t k = 0; k < positive.size(); ++k) {
+        voltages[k] = nodes[positive[k]] - nodes[negative[k]];
+    }
+}
+
+} // namespace
+
+SimdLevel detectSimdLevel() {
+    static const SimdLevel level = [] {
+#ifdef IC_SIM_X86_KERNELS
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f")) {
+            return SimdLevel::AVX512;
+        }
+        if (__builtin_cpu_supports("avx2")) {
+            return SimdLevel::AVX2;
+        }
+#endif
+        return SimdLevel::Scalar;
+    }();
+    return level;
+}
+
+const char* toString(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::AVX512:
+            return "AVX-512";
+        case SimdLevel::AVX2:
+            return "AVX2";
+        case SimdLevel::Scalar:
+            break;
+    }
+    return "scalar";
+}
+
+size_t CapacitorBank::add(uint32_t pos, uint32_t neg, double c, double q, double v, double i) {
+    positive.push_back(pos);
+    negative.push_back(neg);
+    capacitance.push_back(c);
+    charge.push_back(q);
+    voltage.push_back(v);
+    current.push_back(i);
+    return size() - 1;
+}
+
+void CapacitorBank::remove(size_t slot) {
+    positive[slot] = positive.back();
+    negative[slot] = negative.back();
+    capacitance[slot] = capacitance.back();
+    charge[slot] = charge.back();
+    voltage[slot] = voltage.back();
+    current[slot] = current.back();
+    positive.pop_back();
+    negative.pop_back();
+    capacitance.pop_back();
+    charge.pop_back();
+    voltage.pop_back();
+    current.pop_back();
+}
+
+size_t InductorBank::add(uint32_t pos, uint32_t neg, double l, double i, double v) {
+    positive.push_back(pos);
+    negative.push_back(neg);
+    inductance.push_back(l);
+    current.push_back(i);
+    voltage.push_back(v);
+    return size() - 1;
+}
+
+void InductorBank::remove(size_t slot) {
+    positive[slot] = positive.back();
+    negative[slot] = negative.back();
+    inductance[slot] = inductance.back();
+    current[slot] = current.back();
+    voltage[slot] = voltage.back();
+    positive.pop_back();
+    negative.pop_back();
+    inductance.pop_back();
+    current.pop_back();
+    voltage.pop_back();
+}
+
+size_t ResistorBank::add(uint32_t pos, uint32_t neg, double r, double i) {
+    positive.push_back(pos);
+    negative.push_back(neg);
+    resistance.push_back(r);
+    current.push_back(i);
+    return size() - 1;
+}
+
+void ResistorBank::remove(size_t slot) {
+    positive[slot] = positive.back();
+    negative[slot] = negative.back();
+    resistance[slot] = resistance.back();
+    current[slot] = current.back();
+    positive.pop_back();
+    negative.pop_back();
+    resistance.pop_back();
+    current.pop_back();
+}
+
+namespace {
+
+template <typename Bank>
+void renameNode(Bank& bank, uint32_t from, uint32_t to) {
+    std::replace(bank.positive.begin(), bank.positive.end(), from, to);
+    std::replace(bank.negative.begin(), bank.negative.end(), from, to);
+}
+
+} // namespace
+
+DeviceState::DeviceState(SimdLevel level) : level_(SimdLevel::Scalar) {
+    setSimdLevel(level);
+}
+
+DeviceState::DeviceState(const DeviceState& other)
+    : level_(other.level_),
+      capacitors_(other.capacitors_),
+      inductors_(other.inductors_),
+      resistors_(other.resistors_),
+      places_(other.places_),
+      unbound_(other.unbound_),
+      capacitor_owners_(other.capacitor_owners_),
+      inductor_owners_(other.inductor_owners_),
+      resistor_owners_(other.resistor_owners_),
+      error_(other.error_) {
+    for (Place& place : places_) {
+        place.attached = false;
+    }
+}
+
+DeviceState::~DeviceState() {
+    detach();
+}
+
+std::vector<Component*>& DeviceState::owners(Bank bank) {
+    switch (bank) {
+        case Bank::Capacitor:
+            return capacitor_owners_;
+        case Bank::Inductor:
+            return inductor_owners_;
+        case Bank::Resistor:
+            return resistor_owners_;
+        case Bank::Unbound:
+            break;
+    }
+    return unbound_;
+}
+
+void DeviceState::bind(const std::vector<std::shared_ptr<Component>>& components, bool attach) {
+    places_.reserve(places_.size() + components.size());
+    for (const auto& component : components) {
+        add(component.get(), attach);
+    }
+}
+
+void DeviceState::add(Component* component, bool attach) {
+    size_t capacitors = capacitors_.size();
+    size_t inductors = inductors_.size();
+    size_t resistors = resistors_.size();
+    Place place;
+    if (component->bindState(*this)) {
+        if (capacitors_.size() > capacitors) {
+            place.bank = Bank::Capacitor;
+        } else if (inductors_.size() > inductors) {
+            place.bank = Bank::Inductor;
+        } else if (resistors_.size() > resistors) {
+            place.bank = Bank::Resistor;
+        } else {
+            throw std::logic_error("Component '" + component->getId() + "' bound no device state");
+        }
+        place.attached = attach;
+    }
+    std::vector<Component*>& slots = owners(place.bank);
+    place.index = slots.size();
+    slots.push_back(component);
+    if (place.attached) {
+        component->attachState(*this, place.index);
+    }
+    ComponentId handle = component->getHandle();
+    if (handle >= places_.size()) {
+        places_.resize(handle + 1);
+    }
+    places_[handle] = place;
+}
+
+void DeviceState::remove(Component* component) {
+    ComponentId handle = component->getHandle();
+    const Place place = places_.at(handle);
+    std::vector<Component*>& slots = owners(place.bank);
+    if (place.bank == Bank::Unbound) {
+        // Checkpoints list unbound devices in order, so keep it
+        slots.erase(slots.begin() + static_cast<std::ptrdiff_t>(place.index));
+        for (size_t i = place.index; i < slots.size(); ++i) {
+            places_[slots[i]->getHandle()].index = i;
+        }
+    } else {
+        if (place.attached) {
+            component->unbindState();
+        }
+        switch (place.bank) {
+            case Bank::Capacitor:
+                capacitors_.remove(place.index);
+                break;
+            case Bank::Inductor:
+                inductors_.remove(place.index);
+                break;
+            default:
+                resistors_.remove(place.index);
+                break;
+        }
+        if (place.index + 1 < slots.size()) {
+            slots[place.index] = slots.back();
+            Place& moved = places_[slots[place.index]->getHandle()];
+            moved.index = place.index;
+            if (moved.attached) {
+                slots[place.index]->moveSlot(place.index);
+            }
+        }
+        slots.pop_back();
+    }
+    places_[handle] = places_.back();
+    places_.pop_back();
+}
+
+void DeviceState::replace(Component* component) {
+    Place& place = places_.at(component->getHandle());
+    owners(place.bank)[place.index] = component;
+    if (place.bank != Bank::Unbound) {
+        place.attached = true;
+        component->attachState(*this, place.index);
+    }
+}
+
+void DeviceState::attach(const std::vector<std::shared_ptr<Component>>& components) {
+    for (const auto& component : components) {
+        replace(component.get());
+    }
+}
+
+void DeviceState::detach() {
+    for (Bank bank : {Bank::Capacitor, Bank::Inductor, Bank::Resistor}) {
+        for (Component* component : owners(bank)) {
+            Place& place = places_[component->getHandle()];
+            if (place.attached) {
+                component->unbindState();
+                place.attached = false;
+            }
+        }
+    }
+}
+
+void DeviceState::moveNode(uint32_t from, uint32_t to) {
+    renameNode(capacitors_, from, to);
+    renameNode(inductors_, from, to);
+    renameNode(resistors_, from, to);
+}
+
+void DeviceState::step(const std::vector<double>& voltages, double timestep) {
+    error_ = TruncationError{};
+    const double half_step = 0.5 * timestep;
+
+    if (capacitors_.size() > 0) {
+        gatherVoltages(capacitors_.positive, capacitors_.negative, voltages, terminal_voltage_);
+        CapacitorBank& bank = capacitors_;
+        const size_t n = bank.size();
+        double worst;
+        switch (level_) {
+#ifdef IC_SIM_X86_KERNELS
+            case SimdLevel::AVX512:
+                worst = capacitorAvx512(n, terminal_voltage_.data(), bank.capacitance.data(), bank.charge.data(),
+                                        bank.voltage.data(), bank.current.data(), timestep);
+                break;
+            case SimdLevel::AVX2:
+                worst = capacitorAvx2(n, terminal_voltage_.data(), bank.capacitance.data(), bank.charge.data(),
+                                      bank.voltage.data(), bank.current.data(), timestep);
+                break;
+#endif
+            default:
+                worst = capacitorScalar(0, n, terminal_voltage_.data(), bank.capacitance.data(), bank.charge.data(),
+                                        bank.voltage.data(), bank.current.data(), timestep);
+                break;
+        }
+        error_.charge = half_step * worst;
+    }
+
+    if (inductors_.size() > 0) {
+        gatherVoltages(inductors_.positive, inductors_.negative, voltages, terminal_voltage_);
+        InductorBank& bank = inductors_;
+        const size_t n = bank.size();
+        double worst;
+        switch (level_) {
+#ifdef IC_SIM_X86_KERNELS
+            case SimdLevel::AVX512:
+                worst = inductorAvx512(n, terminal_voltage_.data(), bank.inductance.data(), bank.current.data(),
+                                       bank.voltage.data(), timestep);
+                break;
+            case SimdLevel::AVX2:
+                worst = inductorAvx2(n, terminal_voltage_.data(), bank.inductance.data(), bank.current.data(),
+                                     bank.voltage.data(), timestep);
+                break;
+#endif
+            default:
+                worst = inductorScalar(0, n, terminal_voltage_.data(), bank.inductance.data(), bank.current.data(),
+                                       bank.voltage.data(), timestep);
+                break;
+        }
+        error_.current = half_step * worst;
+    }
+
+    // One division per device, the same as Resistor::simulate; no error estimate
+    ResistorBank& resistors = resistors_;
+    for (size_t k = 0; k < resistors.size(); ++k) {
+        double voltage_diff = voltages[resistors.positive[k]] - voltages[resistors.negative[k]];
+        resistors.current[k] = voltage_diff / resistors.resistance[k];
+    }
+}
+
+void DeviceState::clear() {
+    std::fill(capacitors_.charge.begin(), capacitors_.charge.end(), 0.0);
+    std::fill(capacitors_.voltage.begin(), capacitors_.voltage.end(), 0.0);
+    std::fill(capacitors_.current.begin(), capacitors_.current.end(), 0.0);
+    std::fill(inductors_.current.begin(), inductors_.current.end(), 0.0);
+    std::fill(inductors_.voltage.begin(), inductors_.voltage.end(), 0.0);
+    std::fill(resistors_.current.begin(), resistors_.current.end(), 0.0);
+    error_ = TruncationError{};
+}
+
+DeviceStateSnapshot DeviceState::save() const {
+    return {capacitors_.charge, capacitors_.voltage, capacitors_.current, inductors_.current, inductors_.voltage,
+            resistors_.current};
+}
+
+void DeviceState::restore(const DeviceStateSnapshot& snapshot) {
+    if (snapshot.capacitor_charge.size() != capacitors_.size() ||
+        snapshot.inductor_current.size() != inductors_.size() ||
+        snapshot.resistor_current.size() != resistors_.size()) {
+        throw std::invalid_argument("Device state snapshot does not match the bound devices");
+    }
+    // Same-size assignment reuses the existing buffers
+    capacitors_.charge = snapshot.capacitor_charge;
+    capacitors_.voltage = snapshot.capacitor_voltage;
+    capacitors_.current = snapshot.capacitor_current;
+    inductors_.current = snapshot.inductor_current;
+    inductors_.voltage = snapshot.inductor_voltage;
+    resistors_.current = snapshot.resistor_current;
+    error_ = TruncationError{};
+}
+
+void DeviceState::setSimdLevel(SimdLevel level) {
+    level_ = std::min(level, detectSimdLevel());
+}
+
+} // namespace ic_sim
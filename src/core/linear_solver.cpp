@@ -0,0 +1,264 @@
+#include "core/linear_solver.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+namespace ic_sim {
+
+namespace {
+
+// In-place row-major LU with partial pivoting; false on a zero or non-finite pivot
+template <typename T>
+bool luFactor(T* a, size_t n, std::vector<size_t>& pivots) {
+    pivots.resize(n);
+    for (size_t k = 0; k < n; ++k) {
+        size_t pivot = k;
+        T largest = std::abs(a[k * n + k]);
+        for (size_t i = k + 1; i < n; ++i) {
+            T candidate = std::abs(a[i * n + k]);
+            if (candidate > largest) {
+                largest = candidate;
+                pivot = i;
+            }
+        }
+        if (largest == T(0) || !std::isfinite(largest)) {
+            return false;
+        }
+        pivots[k] = pivot;
+        if (pivot != k) {
+            std::swap_ranges(a + k * n, a + (k + 1) * n, a + pivot * n);
+        }
+
+        T* pivot_row = &a[k * n];
+        T inverse = T(1) / pivot_row[k];
+        for (size_t i = k + 1; i < n; ++i) {
+            T* row = &a[i * n];
+            T factor = row[k] * inverse;
+            row[k] = factor;
+            if (factor != T(0)) {
+                for (size_t j = k + 1; j < n; ++j) {
+                    row[j] -= factor * pivot_row[j];
+                }
+            }
+        }
+    }
+    return true;
+}
+
+// Solves LUx = Pb in place on x, which holds b on entry
+template <typename T>
+void luSolve(const T* lu, size_t n, const std::vector<size_t>& pivots, T* x) {
+    for (size_t k = 0; k < n; ++k) {
+        std::swap(x[k], x[pivots[k]]);
+    }
+    for (size_t i = 1; i < n; ++i) {
+        const T* row = &lu[i * n];
+        T sum = x[i];
+        for (size_t j = 0; j < i; ++j) {
+            sum -= row[j] * x[j];
+        }
+        x[i] = sum;
+    }
+    for (size_t i = n; i-- > 0;) {
+        const T* row = &lu[i * n];
+        T sum = x[i];
+        for (size_t j = i + 1; j < n; ++j) {
+            sum -= row[j] * x[j];
+        }
+        x[i] = sum / row[i];
+    }
+}
+
+double infinityNorm(const std::vector<double>& values) {
+    double norm = 0.0;
+    for (double value : values) {
+        norm = std::max(norm, std::abs(value));
+    }
+    return norm;
+}
+
+} // namespace
+
+LinearSolver::LinearSolver(SolverOptions options) : options_(options) {}
+
+void LinearSolver::factor(const std::vector<double>& matrix, size_t n) {
+    if (matrix.size() != n * n) {
+        throw std::invalid_argument("LinearSolver::factor expects an n x n row-major matrix");
+    }
+    n_ = n;
+    single_ready_ = false;
+    double_ready_ = false;
+    single_failure_.clear();
+
+    if (options_.precision == SolverPrecision::Double) {
+        matrix_.release();
+        lu_single_.release();
+        lu_double_ = PagedBuffer<double>(n * n, options_.memory);
+        std::copy(matrix.begin(), matrix.end(), lu_double_.begin());
+        factorDouble();
+        return;
+    }
+
+    matrix_ = PagedBuffer<double>(n * n, options_.memory);
+    std::copy(matrix.begin(), matrix.end(), matrix_.begin());
+    matrix_norm_ = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        double row_sum = 0.0;
+        for (size_t j = 0; j < n; ++j) {
+            row_sum += std::abs(matrix[i * n + j]);
+        }
+        matrix_norm_ = std::max(matrix_norm_, row_sum);
+    }
+
+    lu_double_.release();
+    lu_single_ = PagedBuffer<float>(n * n, options_.memory);
+    bool representable = true;
+    for (size_t i = 0; i < n * n; ++i) {
+        lu_single_[i] = static_cast<float>(matrix[i]);
+        representable = representable && std::isfinite(lu_single_[i]);
+    }
+    if (!representable) {
+        single_failure_ = "matrix entries overflow single precision";
+    } else if (!luFactor(lu_single_.data(), n, pivots_single_)) {
+        single_failure_ = "single-precision factorization hit a zero pivot";
+    } else {
+        single_ready_ = true;
+    }
+}
+
+void LinearSolver::factor(const std::vector<std::vector<double>>& matrix) {
+    size_t n = matrix.size();
+    std::vector<double> flat;
+    flat.reserve(n * n);
+    for (const auto& row : matrix) {
+        if (row.size() != n) {
+            throw std::invalid_argument("LinearSolver::factor expects a square matrix");
+        }
+        flat.insert(flat.end(), row.begin(), row.end());
+    }
+    factor(flat, n);
+}
+
+SolveReport LinearSolver::solve(const std::vector<double>& rhs, std::vector<double>& solution) {
+    if (rhs.size() != n_) {
+        throw std::invalid_argument("LinearSolver::solve: right-hand side does not match the factored size");
+    }
+    if (options_.precision == SolverPrecision::Double && !double_ready_ && n_ > 0) {
+        throw std::logic_error("LinearSolver::solve: the last factorization failed");
+    }
+    SolveReport report;
+    if (options_.precision == SolverPrecision::Double || double_ready_) {
+        solveDouble(rhs, solution);
+        if (!matrix_.empty()) {
+            std::vector<double> residual;
+            report.backward_error = backwardError(rhs, solution, residual);
+        }
+        return report;
+    }
+    if (!single_ready_) {
+        return fallBack(rhs, solution, report, single_failure_);
+    }
+
+    report.precision = SolverPrecision::Mixed;
+    double tolerance = options_.tolerance > 0.0
+                           ? options_.tolerance
+                           : std::sqrt(static_cast<double>(n_)) * std::numeric_limits<double>::epsilon();
+
+    // Initial solution from the float factors
+    std::vector<float> work(rhs.begin(), rhs.end());
+    luSolve(lu_single_.data(), n_, pivots_single_, work.data());
+    solution.assign(work.begin(), work.end());
+
+    std::vector<double> residual;
+    double previous_residual = std::numeric_limits<double>::infinity();
+    for (;;) {
+        report.backward_error = backwardError(rhs, solution, residual);
+        if (report.backward_error <= tolerance) {
+            return report;
+        }
+        double residual_norm = infinityNorm(residual);
+        if (!std::isfinite(residual_norm)) {
+            return fallBack(rhs, solution, report, "refinement diverged");
+        }
+        if (report.refinements == options_.max_refinements) {
+            return fallBack(rhs, solution, report, "refinement did not converge");
+        }
+        if (residual_norm > options_.stall_ratio * previous_residual) {
+            return fallBack(rhs, solution, report, "refinement stalled");
+        }
+        previous_residual = residual_norm;
+
+        // Correction solve in float on the scaled residual, so small residuals don't underflow
+        for (size_t i = 0; i < n_; ++i) {
+            work[i] = static_cast<float>(residual[i] / residual_norm);
+        }
+        luSolve(lu_single_.data(), n_, pivots_single_, work.data());
+        for (size_t i = 0; i < n_; ++i) {
+            solution[i] += residual_norm * static_cast<double>(work[i]);
+        }
+        ++report.refinements;
+    }
+}
+
+void LinearSolver::factorDouble() {
+    if (!luFactor(lu_double_.data(), n_, pivots_double_)) {
+        lu_double_.release();
+        throw std::runtime_error("LinearSolver: matrix is singular");
+    }
+    double_ready_ = true;
+}
+
+void LinearSolver::solveDouble(const std::vector<double>& rhs, std::vector<double>& solution) const {
+    solution = rhs;
+    luSolve(lu_double_.data(), n_, pivots_double_, solution.data());
+}
+
+double LinearSolver::backwardError(const std::vector<double>& rhs, const std::vector<double>& solution,
+                                   std::vector<double>& residual) const {
+    residual.resize(n_);
+    for (size_t i = 0; i < n_; ++i) {
+        const double* row = &matrix_[i * n_];
+        double sum = rhs[i];
+        for (size_t j = 0; j < n_; ++j) {
+            sum -= row[j] * solution[j];
+        }
+        residual[i] = sum;
+    }
+    double scale = matrix_norm_ * infinityNorm(solution) + infinityNorm(rhs);
+    return scale > 0.0 ? infinityNorm(residual) / scale : 0.0;
+}
+
+PlacementReport LinearSolver::getPlacement() const {
+    PlacementReport report = matrix_.placement();
+    report.merge(lu_single_.placement());
+    report.merge(lu_double_.placement());
+    return report;
+}
+
+SolveReport LinearSolver::fallBack(const std::vector<double>& rhs, std::vector<double>& solution,
+                                   SolveReport report, const std::string& reason) {
+    // The float factors are of no further use for this matrix
+    lu_single_.release();
+    single_ready_ = false;
+    single_failure_ = reason;
+
+    lu_double_ = PagedBuffer<double>(n_ * n_, options_.memory);
+    std::copy(matrix_.begin(), matrix_.end(), lu_double_.begin());
+    factorDouble();
+    solveDouble(rhs, solution);
+
+    std::vector<double> residual;
+    report.precision = SolverPrecision::Double;
+    report.backward_error = backwardError(rhs, solution, residual);
+    report.fell_back = true;
+    report.fallback_reason = reason;
+    ++fallbacks_;
+    if (on_fallback_) {
+        on_fallback_(report);
+    }
+    return report;
+}
+
+} // namespace ic_sim
@@ -0,0 +1,267 @@
+#include "core/memory_policy.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <new>
+#include <stdexcept>
+#include <sstream>
+#include <string>
+
+#ifdef _WIN32
+#include <malloc.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+
+namespace ic_sim {
+
+namespace {
+
+constexpr size_t kHugePageSize = size_t(2) << 20;
+
+size_t basePageSize() {
+#ifdef _WIN32
+    return 4096;
+#else
+    static const size_t size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    return size;
+#endif
+}
+
+size_t roundUp(size_t value, size_t multiple) {
+    return (value + multiple - 1) / multiple * multiple;
+}
+
+// Hands the buffer to the policy's toucher, which zeroes it page range by page
+// range from the threads it picks
+void firstTouch(void* data, size_t bytes, const FirstTouch& touch) {
+    const size_t page = basePageSize();
+    const size_t pages = roundUp(bytes, page) / page;
+    touch(pages, [=](size_t first, size_t last) {
+        if (first > last || last > pages) {
+            throw std::out_of_range("First touch range past the end of the buffer");
+        }
+        size_t begin = std::min(bytes, first * page);
+        std::memset(static_cast<char*>(data) + begin, 0, std::min(bytes, last * page) - begin);
+    });
+}
+
+#ifdef __linux__
+// Huge-page backed bytes of the mappings overlapping [begin, end), from /proc/self/smaps
+size_t hugePageBytes(uintptr_t begin, uintptr_t end) {
+    std::ifstream smaps("/proc/self/smaps");
+    std::string line;
+    bool overlapping = false;
+    size_t total = 0;
+    while (std::getline(smaps, line)) {
+        uintptr_t start = 0;
+        uintptr_t stop = 0;
+        char dash = 0;
+        std::istringstream header(line);
+        if (header >> std::hex >> start >> dash >> stop && dash == '-') {
+            overlapping = start < end && stop > begin;
+            continue;
+        }
+        if (!overlapping) {
+            continue;
+        }
+        for (const char* field : {"AnonHugePages:", "Private_Hugetlb:", "Shared_Hugetlb:"}) {
+            if (line.compare(0, std::strlen(field), field) == 0) {
+                total += std::stoull(line.substr(std::strlen(field))) * 1024;
+            }
+        }
+    }
+    return total;
+}
+#endif
+
+} // namespace
+
+FirstTouch firstTouchOn(ThreadPool& pool) {
+    return [&pool](size_t pages, const PageTouch& touch) { parallelForStatic(0, pages, touch, pool); };
+}
+
+void PlacementReport::merge(const PlacementReport& other) {
+    bytes += other.bytes;
+    pages += other.pages;
+    resident_pages += other.resident_pages;
+    huge_page_bytes += other.huge_page_bytes;
+    if (node_pages.size() < other.node_pages.size()) {
+        node_pages.resize(other.node_pages.size(), 0);
+    }
+    for (size_t node = 0; node < other.node_pages.size(); ++node) {
+        node_pages[node] += other.node_pages[node];
+    }
+}
+
+PlacementReport queryPlacement(const void* data, size_t bytes) {
+    PlacementReport report;
+    report.bytes = bytes;
+    if (!data || bytes == 0) {
+        return report;
+    }
+    const size_t page = basePageSize();
+    uintptr_t begin = reinterpret_cast<uintptr_t>(data) / page * page;
+    uintptr_t end = roundUp(reinterpret_cast<uintptr_t>(data) + bytes, page);
+    report.pages = (end - begin) / page;
+
+#ifdef __linux__
+    // move_pages with no target nodes only reports where each page lives
+    constexpr size_t kBatch = 1024;
+    std::vector<void*> addresses(kBatch);
+    std::vector<int> status(kBatch);
+    bool supported = true;
+    for (size_t first = 0; first < report.pages && supported; first += kBatch) {
+        size_t count = std::min(kBatch, report.pages - first);
+        for (size_t i = 0; i < count; ++i) {
+            addresses[i] = reinterpret_cast<void*>(begin + (first + i) * page);
+        }
+        if (syscall(SYS_move_pages, 0, count, addresses.data(), nullptr, status.data(), 0) != 0) {
+            supported = false;
+            break;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            if (status[i] >= 0) {
+                size_t node = static_cast<size_t>(status[i]);
+                if (report.node_pages.size() <= node) {
+                    report.node_pages.resize(node + 1, 0);
+                }
+                ++report.node_pages[node];
+                ++report.resident_pages;
+            }
+        }
+    }
+    if (!supported) {
+        // No NUMA syscall (kernel without NUMA or filtered): residency only
+        report.node_pages.clear();
+        report.resident_pages = 0;
+        std::vector<unsigned char> resident(report.pages);
+        if (mincore(reinterpret_cast<void*>(begin), end - begin, resident.data()) == 0) {
+            report.resident_pages = static_cast<size_t>(
+                std::count_if(resident.begin(), resident.end(), [](unsigned char flag) { return flag & 1; }));
+        }
+    }
+    report.huge_page_bytes = std::min(hugePageBytes(begin, end), roundUp(bytes, kHugePageSize));
+#endif
+    return report;
+}
+
+PageMapping::PageMapping(size_t bytes, const MemoryPolicy& policy) : bytes_(bytes), policy_(policy.pages) {
+    if (bytes == 0) {
+        policy_ = PagePolicy::Default;
+        return;
+    }
+
+#ifdef _WIN32
+    policy_ = PagePolicy::Default;
+    mapped_ = roundUp(bytes, basePageSize());
+    data_ = _aligned_malloc(mapped_, basePageSize());
+    if (!data_) {
+        throw std::bad_alloc();
+    }
+    std::memset(data_, 0, mapped_);
+#else
+#ifdef MAP_HUGETLB
+    if (policy_ == PagePolicy::Explicit) {
+        mapped_ = roundUp(bytes, kHugePageSize);
+        void* address = mmap(nullptr, mapped_, PROT_READ | PROT_WRITE,
+                             MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (address != MAP_FAILED) {
+            data_ = address;
+        } else {
+            // Reserved pool empty or not configured
+            policy_ = PagePolicy::Transparent;
+        }
+    }
+#else
+    if (policy_ == PagePolicy::Explicit) {
+        policy_ = PagePolicy::Transparent;
+    }
+#endif
+
+    if (!data_ && policy_ == PagePolicy::Transparent) {
+#ifdef MADV_HUGEPAGE
+        // Over-map and trim so the region starts on a huge-page boundary
+        mapped_ = roundUp(bytes, kHugePageSize);
+        size_t span = mapped_ + kHugePageSize;
+        void* address = mmap(nullptr, span, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (address == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        uintptr_t raw = reinterpret_cast<uintptr_t>(address);
+        uintptr_t aligned = roundUp(raw, kHugePageSize);
+        if (aligned > raw) {
+            munmap(address, aligned - raw);
+        }
+        if (raw + span > aligned + mapped_) {
+            munmap(reinterpret_cast<void*>(aligned + mapped_), raw + span - aligned - mapped_);
+        }
+        data_ = reinterpret_cast<void*>(aligned);
+        madvise(data_, mapped_, MADV_HUGEPAGE);
+#else
+        policy_ = PagePolicy::Default;
+#endif
+    }
+
+    if (!data_) {
+        mapped_ = roundUp(bytes, basePageSize());
+        void* address = mmap(nullptr, mapped_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (address == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        data_ = address;
+    }
+
+    if (policy.first_touch) {
+        try {
+            firstTouch(data_, bytes_, policy.first_touch);
+        } catch (...) {
+            release();
+            throw;
+        }
+    }
+#endif
+}
+
+PageMapping::~PageMapping() {
+    release();
+}
+
+PageMapping::PageMapping(PageMapping&& other) noexcept
+    : data_(other.data_), bytes_(other.bytes_), mapped_(other.mapped_), policy_(other.policy_) {
+    other.data_ = nullptr;
+    other.bytes_ = 0;
+    other.mapped_ = 0;
+}
+
+PageMapping& PageMapping::operator=(PageMapping&& other) noexcept {
+    if (this != &other) {
+        release();
+        std::swap(data_, other.data_);
+        std::swap(bytes_, other.bytes_);
+        std::swap(mapped_, other.mapped_);
+        std::swap(policy_, other.policy_);
+    }
+    return *this;
+}
+
+void PageMapping::release() {
+    if (data_) {
+#ifdef _WIN32
+        _aligned_free(data_);
+#else
+        munmap(data_, mapped_);
+#endif
+    }
+    data_ = nullptr;
+    bytes_ = 0;
+    mapped_ = 0;
+}
+
+} // namespace ic_sim
@@ -0,0 +1,76 @@
+#include "core/parameter_schema.h"
+#include <cmath>
+#include <stdexcept>
+
+namespace ic_sim {
+
+ParameterSchema& ParameterSchema::add(const std::string& name, double default_value, ParameterKind kind) {
+    if (slot(name) != kInvalidSlot) {
+        throw std::invalid_argument("Duplicate parameter '" + name + "' in schema for " + type_);
+    }
+    if (parameters_.size() == kMaxParameters) {
+        throw std::length_error("Too many parameters in schema for " + type_);
+    }
+    parameters_.push_back({name, kind, default_value});
+    return *this;
+}
+
+size_t ParameterSchema::slot(std::string_view name) const {
+    // Schemas are short, and this only runs when a name is first resolved
+    for (size_t i = 0; i < parameters_.size(); ++i) {
+        if (parameters_[i].name == name) {
+            return i;
+        }
+    }
+    return kInvalidSlot;
+}
+
+ParameterBlock ParameterSchema::defaults() const {
+    return ParameterBlock(*this);
+}
+
+ParameterBlock ParameterSchema::fromMap(const std::map<std::string, double>& values) const {
+    ParameterBlock block(*this);
+    for (const auto& [name, value] : values) {
+        size_t index = slot(name);
+        if (index != kInvalidSlot) {
+            block.set(index, value);
+        }
+    }
+    return block;
+}
+
+std::map<std::string, double> ParameterSchema::toMap(const ParameterBlock& block) const {
+    std::map<std::string, double> values;
+    for (size_t i = 0; i < parameters_.size(); ++i) {
+        values[parameters_[i].name] = block.real(i);
+    }
+    return values;
+}
+
+ParameterBlock::ParameterBlock(const ParameterSchema& schema)
+    : schema_(&schema), set_mask_(0) {
+    for (size_t i = 0; i < schema.size(); ++i) {
+        values_[i] = schema.parameter(i).default_value;
+    }
+}
+
+void ParameterBlock::set(size_t slot, double value) {
+    if (slot >= schema_->size()) {
+        throw std::out_of_range("Parameter slot out of range for " + schema_->getType());
+    }
+    switch (schema_->parameter(slot).kind) {
+        case ParameterKind::Real:
+            break;
+        case ParameterKind::Integer:
+            value = std::round(value);
+            break;
+        case ParameterKind::Boolean:
+            value = (value != 0.0) ? 1.0 : 0.0;
+            break;
+    }
+    values_[slot] = value;
+    set_mask_ |= 1u << slot;
+}
+
+} // namespace ic_sim
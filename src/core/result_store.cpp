@@ -0,0 +1,239 @@
+#include "core/result_store.h"
+#include "core/circuit.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace ic_sim {
+
+namespace {
+
+// Longer runs map further chunks as they fill
+constexpr size_t kMaxPremappedBytes = size_t(1) << 30;
+
+bool hasWildcard(std::string_view text) {
+    return text.find_first_of("*?") != std::string_view::npos;
+}
+
+std::string probeName(ProbeKind kind, std::string_view element) {
+    return (kind == ProbeKind::Voltage ? "v(" : "i(") + std::string(element) + ")";
+}
+
+} // namespace
+
+bool matchWildcard(std::string_view pattern, std::string_view text) {
+    // Greedy scan that backtracks to the most recent '*' on a mismatch
+    size_t p = 0;
+    size_t t = 0;
+    size_t star = std::string_view::npos;
+    size_t resume = 0;
+    while (t < text.size()) {
+        if (p < pattern.size() && (pattern[p] == '?' || pattern[p] == text[t])) {
+            ++p;
+            ++t;
+        } else if (p < pattern.size() && pattern[p] == '*') {
+            star = p++;
+            resume = t;
+        } else if (star != std::string_view::npos) {
+            p = star + 1;
+            t = ++resume;
+        } else {
+            return false;
+        }
+    }
+    while (p < pattern.size() && pattern[p] == '*') {
+        ++p;
+    }
+    return p == pattern.size();
+}
+
+ResultStore::ResultStore(const ResultStoreOptions& options) : options_(options) {
+    if (options_.chunk_samples == 0) {
+        throw std::invalid_argument("Result chunks need at least one sample");
+    }
+}
+
+void ResultStore::addProbe(const std::string& pattern) {
+    bool valid = pattern.size() > 3 && (pattern[0] == 'v' || pattern[0] == 'V' || pattern[0] == 'i' ||
+                                        pattern[0] == 'I') &&
+                 pattern[1] == '(' && pattern.back() == ')';
+    if (!valid) {
+        throw std::invalid_argument("Probe must be v(node) or i(device): " + pattern);
+    }
+    patterns_.push_back(pattern);
+}
+
+void ResultStore::begin(Circuit& circuit, size_t expected_samples) {
+    columns_.clear();
+    voltages_ = &circuit.getVoltages();
+    node_reads_.clear();
+    device_reads_.clear();
+    std::vector<bool> node_seen(circuit.getNodeCount(), false);
+    std::vector<bool> device_seen(circuit.getComponentCount(), false);
+
+    for (const std::string& pattern : patterns_) {
+        ProbeKind kind = (pattern[0] == 'v' || pattern[0] == 'V') ? ProbeKind::Voltage : ProbeKind::Current;
+        std::string_view element = std::string_view(pattern).substr(2, pattern.size() - 3);
+        std::vector<bool>& seen = (kind == ProbeKind::Voltage) ? node_seen : device_seen;
+        auto bind = [&](uint32_t handle) {
+            if (seen[handle]) {
+                return;
+            }
+            seen[handle] = true;
+            size_t column = columns_.size() + 1;
+            if (kind == ProbeKind::Voltage) {
+                columns_.push_back({probeName(kind, circuit.getNodeName(handle)), kind});
+                node_reads_.emplace_back(column, handle);
+            } else {
+                const Component* device = circuit.getComponent(handle).get();
+                columns_.push_back({probeName(kind, circuit.getComponentName(handle)), kind});
+                device_reads_.emplace_back(column, device);
+            }
+        };
+
+        if (!hasWildcard(element)) {
+            uint32_t handle = (kind == ProbeKind::Voltage) ? circuit.findNode(element) : circuit.findComponent(element);
+            if (handle == kInvalidId) {
+                throw std::invalid_argument("Probe " + pattern + " matches nothing in circuit " +
+                                            circuit.getName());
+            }
+            bind(handle);
+            continue;
+        }
+        size_t count = (kind == ProbeKind::Voltage) ? circuit.getNodeCount() : circuit.getComponentCount();
+        for (uint32_t handle = 0; handle < count; ++handle) {
+            std::string_view id = (kind == ProbeKind::Voltage) ? circuit.getNodeName(handle)
+                                                               : circuit.getComponentName(handle);
+            if (matchWildcard(element, id)) {
+                bind(handle);
+            }
+        }
+    }
+
+    // Chunks of an earlier run are reused when the row layout is unchanged
+    size_t width = options_.chunk_samples * (columns_.size() + 1);
+    if (!options_.keep_samples || (!chunks_.empty() && chunks_.front().size() != width)) {
+        chunks_.clear();
+    }
+    if (options_.keep_samples) {
+        size_t needed = (expected_samples + options_.chunk_samples - 1) / options_.chunk_samples;
+        needed = std::max<size_t>(1, std::min(needed, kMaxPremappedBytes / (width * sizeof(double))));
+        while (chunks_.size() < needed) {
+            addChunk();
+        }
+    }
+    if (!sinks_.empty()) {
+        std::vector<std::string> names{"time"};
+        for (const Column& column : columns_) {
+            names.push_back(column.name);
+        }
+        for (auto& sink : sinks_) {
+            sink->begin(names);
+        }
+    }
+    staging_.assign(kBlockRows * (columns_.size() + 1), 0.0);
+    staged_ = 0;
+    samples_ = 0;
+}
+
+void ResultStore::addChunk() {
+    chunks_.emplace_back(options_.chunk_samples * (columns_.size() + 1), options_.memory);
+}
+
+void ResultStore::record(double time) {
+    const size_t width = columns_.size() + 1;
+    double* row = staging_.data() + staged_ * width;
+    row[0] = time;
+    const std::vector<double>& voltages = *voltages_;
+    for (const auto& [column, node] : node_reads_) {
+        row[column] = voltages[node];
+    }
+    for (const auto& [column, device] : device_reads_) {
+        row[column] = device->getCurrentValue();
+    }
+    ++samples_;
+    if (++staged_ == kBlockRows) {
+        flush();
+    }
+}
+
+void ResultStore::flush() {
+    if (staged_ == 0) {
+        return;
+    }
+    const size_t width = columns_.size() + 1;
+    for (auto& sink : sinks_) {
+        sink->write(staging_.data(), staged_, width);
+    }
+    if (!options_.keep_samples) {
+        staged_ = 0;
+        return;
+    }
+    const size_t stride = options_.chunk_samples;
+    size_t first = samples_ - staged_;
+    while (first < samples_) {
+        // Rows of the block that fall into one chunk
+        size_t chunk = first / stride;
+        size_t row = first % stride;
+        size_t rows = std::min(samples_ - first, stride - row);
+        if (chunk == chunks_.size()) {
+            addChunk();
+        }
+        const double* source = staging_.data() + (first - (samples_ - staged_)) * width;
+        double* target = chunks_[chunk].data() + row;
+        // Column by column, so each column receives one contiguous run
+        for (size_t column = 0; column < width; ++column) {
+            double* out = target + column * stride;
+            for (size_t r = 0; r < rows; ++r) {
+                out[r] = source[r * width + column];
+            }
+        }
+        first += rows;
+    }
+    staged_ = 0;
+}
+
+void ResultStore::finish() {
+    flush();
+    for (auto& sink : sinks_) {
+        sink->finish();
+    }
+}
+
+size_t ResultStore::findProbe(std::string_view name) const {
+    for (size_t i = 0; i < columns_.size(); ++i) {
+        if (columns_[i].name == name) {
+            return i;
+        }
+    }
+    return kNoProbe;
+}
+
+SampleSpan ResultStore::column(size_t column, size_t chunk) const {
+    if (column > columns_.size() || chunk >= getChunkCount()) {
+        throw std::out_of_range("No such result column or chunk");
+    }
+    const size_t stride = options_.chunk_samples;
+    size_t rows = std::min(stride, flushed() - chunk * stride);
+    const double* first = chunks_[chunk].data() + column * stride;
+    return {first, first + rows};
+}
+
+std::vector<double> ResultStore::copyColumn(size_t column) const {
+    std::vector<double> values;
+    values.reserve(flushed());
+    for (size_t chunk = 0; chunk < getChunkCount(); ++chunk) {
+        SampleSpan span = this->column(column, chunk);
+        values.insert(values.end(), span.begin(), span.end());
+    }
+    return values;
+}
+
+size_t ResultStore::memoryBytes() const {
+    size_t bytes = 0;
+    for (const auto& chunk : chunks_) {
+        bytes += chunk.size() * sizeof(double);
+    }
+    return bytes;
+}
+
+} // namespace ic_sim
@@ -0,0 +1,286 @@
+#include "core/sources.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace ic_sim {
+
+namespace {
+
+constexpr double kNoBreakpoint = std::numeric_limits<double>::infinity();
+constexpr double kPi = 3.14159265358979323846;
+
+} // namespace
+
+Waveform Waveform::dc(double value) {
+    Waveform waveform(WaveformType::DC);
+    waveform.initial_ = value;
+    return waveform;
+}
+
+Waveform Waveform::pulse(double initial, double pulsed, double delay, double rise,
+                         double fall, double width, double period) {
+    if (rise < 0.0 || fall < 0.0 || width < 0.0 || period < 0.0) {
+        throw std::invalid_argument("PULSE timing parameters must be non-negative");
+    }
+    Waveform waveform(WaveformType::Pulse);
+    waveform.initial_ = initial;
+    waveform.pulsed_ = pulsed;
+    waveform.delay_ = delay;
+    waveform.rise_ = rise;
+    waveform.fall_ = fall;
+    waveform.width_ = width;
+    // A period shorter than one pulse would overlap consecutive pulses
+    waveform.period_ = (period > 0.0) ? std::max(period, rise + width + fall) : 0.0;
+    return waveform;
+}
+
+Waveform Waveform::sine(double offset, double amplitude, double frequency,
+                        double delay, double damping, double phase_deg) {
+    Waveform waveform(WaveformType::Sine);
+    waveform.initial_ = offset;
+    waveform.amplitude_ = amplitude;
+    waveform.frequency_ = frequency;
+    waveform.delay_ = delay;
+    waveform.damping_ = damping;
+    waveform.phase_ = phase_deg * kPi / 180.0;
+    return waveform;
+}
+
+Waveform Waveform::pwl(std::vector<std::pair<double, double>> points) {
+    if (points.empty()) {
+        throw std::invalid_argument("PWL waveform needs at least one point");
+    }
+    Waveform waveform(WaveformType::PiecewiseLinear);
+    waveform.times_.reserve(points.size());
+    waveform.values_.reserve(points.size());
+    for (const auto& [time, value] : points) {
+        if (!waveform.times_.empty() && time < waveform.times_.back()) {
+            throw std::invalid_argument("PWL times must be non-decreasing");
+        }
+        waveform.times_.push_back(time);
+        waveform.values_.push_back(value);
+    }
+    return waveform;
+}
+
+std::vector<double> Waveform::getParameters() const {
+    switch (type_) {
+        case WaveformType::DC:
+            return {initial_};
+        case WaveformType::Pulse:
+            return {initial_, pulsed_, delay_, rise_, fall_, width_, period_};
+        case WaveformType::Sine:
+            return {initial_, amplitude_, frequency_, delay_, damping_, phase_};
+        case WaveformType::PiecewiseLinear: {
+            std::vector<double> values;
+            values.reserve(2 * times_.size());
+            for (size_t i = 0; i < times_.size(); ++i) {
+                values.push_back(times_[i]);
+                values.push_back(values_[i]);
+            }
+            return values;
+        }
+    }
+    return {};
+}
+
+Waveform Waveform::fromParameters(WaveformType type, const double* values, size_t count) {
+    switch (type) {
+        case WaveformType::DC:
+            if (count == 1) {
+                return dc(values[0]);
+            }
+            break;
+        case WaveformType::Pulse:
+            if (count == 7) {
+                // The stored period already covers one pulse, so pulse() keeps it as is
+                return pulse(values[0], values[1], values[2], values[3], values[4], values[5], values[6]);
+            }
+            break;
+        case WaveformType::Sine:
+            if (count == 6) {
+                // Phase is restored in radians; converting back to degrees could round
+                Waveform waveform = sine(values[0], values[1], values[2], values[3], values[4]);
+                waveform.phase_ = values[5];
+                return waveform;
+            }
+            break;
+        case WaveformType::PiecewiseLinear:
+            if (count >= 2 && count % 2 == 0) {
+                std::vector<std::pair<double, double>> points;
+                points.reserve(count / 2);
+                for (size_t i = 0; i < count; i += 2) {
+                    points.emplace_back(values[i], values[i + 1]);
+                }
+                return pwl(std::move(points));
+            }
+            break;
+    }
+    throw std::invalid_argument("Wrong number of waveform parameters");
+}
+
+double Waveform::valueAt(double time) const {
+    switch (type_) {
+        case WaveformType::DC:
+            return initial_;
+        case WaveformType::Pulse:
+            return pulseValue(time);
+        case WaveformType::Sine: {
+            if (time < delay_) {
+                return initial_ + amplitude_ * std::sin(phase_);
+            }
+            double t = time - delay_;
+            return initial_ + amplitude_ * std::exp(-damping_ * t) *
+                              std::sin(2.0 * kPi * frequency_ * t + phase_);
+        }
+        case WaveformType::PiecewiseLinear:
+            return pwlValue(time);
+    }
+    return 0.0;
+}
+
+double Waveform::nextBreakpoint(double time) const {
+    switch (type_) {
+        case WaveformType::DC:
+            return kNoBreakpoint;
+        case WaveformType::Pulse:
+            return pulseBreakpoint(time);
+        case WaveformType::Sine:
+            // Smooth after the delay; only the start of the oscillation is a corner
+            return (delay_ > time) ? delay_ : kNoBreakpoint;
+        case WaveformType::PiecewiseLinear: {
+            auto it = std::upper_bound(times_.begin(), times_.end(), time);
+            return (it != times_.end()) ? *it : kNoBreakpoint;
+        }
+    }
+    return kNoBreakpoint;
+}
+
+double Waveform::pulseValue(double time) const {
+    if (time < delay_) {
+        return initial_;
+    }
+    double t = time - delay_;
+    if (period_ > 0.0) {
+        t -= std::floor(t / period_) * period_;
+    }
+    if (t < rise_) {
+        return initial_ + (pulsed_ - initial_) * t / rise_;
+    }
+    t -= rise_;
+    if (t <= width_) {
+        return pulsed_;
+    }
+    t -= width_;
+    if (t < fall_) {
+        return pulsed_ + (initial_ - pulsed_) * t / fall_;
+    }
+    return initial_;
+}
+
+double Waveform::pulseBreakpoint(double time) const {
+    const double offsets[] = {0.0, rise_, rise_ + width_, rise_ + width_ + fall_};
+
+    // Corners are always recomputed as delay + k * period + offset, so a corner
+    // handed back in as `time` compares equal to itself and is skipped. Checking
+    // the neighbouring periods guards against floor() landing one period off.
+    long first_period = 0;
+    if (period_ > 0.0 && time > delay_) {
+        first_period = std::max(0L, static_cast<long>(std::floor((time - delay_) / period_)) - 1);
+    }
+    long last_period = (period_ > 0.0) ? first_period + 2 : 0;
+
+    for (long k = first_period; k <= last_period; ++k) {
+        double base = delay_ + static_cast<double>(k) * period_;
+        for (double offset : offsets) {
+            double corner = base + offset;
+            if (corner > time) {
+                return corner;
+            }
+        }
+    }
+    return kNoBreakpoint;
+}
+
+double Waveform::pwlValue(double time) const {
+    if (time <= times_.front()) {
+        cursor_ = 0;
+        return values_.front();
+    }
+    if (time < times_[cursor_]) {
+        // Time went backwards (e.g. a restarted run); resume from the start
+        cursor_ = 0;
+    }
+    while (cursor_ + 1 < times_.size() && times_[cursor_ + 1] <= time) {
+        ++cursor_;
+    }
+    if (cursor_ + 1 == times_.size()) {
+        return values_.back();
+    }
+    double t0 = times_[cursor_];
+    double t1 = times_[cursor_ + 1];
+    double fraction = (time - t0) / (t1 - t0);
+    return values_[cursor_] + (values_[cursor_ + 1] - values_[cursor_]) * fraction;
+}
+
+// Source implementation
+Source::Source(Waveform waveform)
+    : waveform_(std::move(waveform)), time_(0.0), value_(0.0) {
+    value_ = waveform_.valueAt(0.0);
+}
+
+void Source::setTime(double time) {
+    time_ = time;
+    value_ = waveform_.valueAt(time);
+    apply();
+}
+
+void Source::resetState() {
+    time_ = 0.0;
+    value_ = waveform_.valueAt(0.0);
+    apply();
+}
+
+bool Source::saveState(std::vector<double>& values) const {
+    values.push_back(time_);
+    values.push_back(value_);
+    return true;
+}
+
+void Source::restoreState(const double* values) {
+    time_ = values[0];
+    value_ = values[1];
+}
+
+bool Source::getParameters(std::vector<double>& values) const {
+    values.push_back(static_cast<double>(waveform_.getType()));
+    std::vector<double> parameters = waveform_.getParameters();
+    values.insert(values.end(), parameters.begin(), parameters.end());
+    return true;
+}
+
+bool Source::setParameter(size_t index, double value) {
+    std::vector<double> parameters = waveform_.getParameters();
+    if (index == 0 || index > parameters.size()) {
+        return false;
+    }
+    parameters[index - 1] = value;
+    waveform_ = Waveform::fromParameters(waveform_.getType(), parameters.data(), parameters.size());
+    return true;
+}
+
+void Source::simulate(double timestep) {
+    (void)timestep;
+    apply();
+}
+
+// VoltageSource implementation
+void VoltageSource::apply() {
+    if (nodes_.size() >= 2) {
+        nodes_[0]->setVoltage(nodes_[1]->getVoltage() + value_);
+    }
+}
+
+} // namespace ic_sim
@@ -0,0 +1,173 @@
+#include "core/symbol_table.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace ic_sim {
+
+SymbolTable::SymbolTable(const SymbolTable& other) {
+    *this = other;
+}
+
+SymbolTable& SymbolTable::operator=(const SymbolTable& other) {
+    if (this != &other) {
+        // Views must point into our own blocks, so re-intern instead of copying
+        clear();
+        reserve(other.size());
+        for (std::string_view name : other.names_) {
+            intern(name);
+        }
+    }
+    return *this;
+}
+
+Symbol SymbolTable::intern(std::string_view name) {
+    if ((names_.size() + 1) * 10 > slots_.size() * 7) {
+        rehash(std::max(kMinSlots, slots_.size() * 2));
+    }
+    uint32_t tag = tagOf(name);
+    size_t index = probe(name, tag);
+    if (slots_[index] != 0) {
+        return symbolOf(slots_[index]);
+    }
+    if (names_.size() >= kInvalidSymbol) {
+        throw std::length_error("Symbol table is full");
+    }
+    Symbol symbol = static_cast<Symbol>(names_.size());
+    names_.push_back(store(name));
+    slots_[index] = (static_cast<uint64_t>(tag) << 32) | (uint64_t(symbol) + 1);
+    return symbol;
+}
+
+void SymbolTable::swapRemove(Symbol symbol) {
+    erase(probe(names_[symbol], tagOf(names_[symbol])));
+    Symbol last = static_cast<Symbol>(names_.size() - 1);
+    if (symbol != last) {
+        uint64_t& slot = slots_[probe(names_[last], tagOf(names_[last]))];
+        slot = (slot & ~uint64_t(0xffffffff)) | (uint64_t(symbol) + 1);
+        names_[symbol] = names_[last];
+    }
+    names_.pop_back();
+}
+
+void SymbolTable::reserve(size_t symbols) {
+    names_.reserve(symbols);
+    size_t slots = std::max(kMinSlots, slots_.size());
+    while (symbols * 10 > slots * 7) {
+        slots *= 2;
+    }
+    if (slots != slots_.size()) {
+        rehash(slots);
+    }
+}
+
+void SymbolTable::clear() {
+    blocks_.clear();
+    oversized_.clear();
+    block_used_ = kBlockSize;
+    oversized_bytes_ = 0;
+    names_.clear();
+    std::fill(slots_.begin(), slots_.end(), 0);
+}
+
+void SymbolTable::rehash(size_t slots) {
+    std::vector<uint64_t> old(slots, 0);
+    old.swap(slots_);
+    size_t mask = slots - 1;
+    for (uint64_t slot : old) {
+        if (slot != 0) {
+            size_t i = static_cast<uint32_t>(slot >> 32) & mask;
+            while (slots_[i] != 0) {
+                i = (i + 1) & mask;
+            }
+            slots_[i] = slot;
+        }
+    }
+}
+
+void SymbolTable::erase(size_t slot) {
+    size_t mask = slots_.size() - 1;
+    size_t hole = slot;
+    for (size_t i = (slot + 1) & mask; slots_[i] != 0; i = (i + 1) & mask) {
+        // An entry may fill the hole if the hole lies between its home slot and i
+        size_t home = static_cast<uint32_t>(slots_[i] >> 32) & mask;
+        if (((i - home) & mask) >= ((i - hole) & mask)) {
+            slots_[hole] = slots_[i];
+            hole = i;
+        }
+    }
+    slots_[hole] = 0;
+}
+
+std::string_view SymbolTable::store(std::string_view name) {
+    if (name.empty()) {
+        return std::string_view();
+    }
+    if (name.size() > kBlockSize / 4) {
+        // Rare very long names get their own allocation instead of wasting a block
+        oversized_.push_back(std::make_unique<char[]>(name.size()));
+        char* data = oversized_.back().get();
+        std::memcpy(data, name.data(), name.size());
+        oversized_bytes_ += name.size();
+        return std::string_view(data, name.size());
+    }
+    if (block_used_ + name.size() > kBlockSize) {
+        blocks_.push_back(std::make_unique<char[]>(kBlockSize));
+        block_used_ = 0;
+    }
+    char* data = blocks_.back().get() + block_used_;
+    std::memcpy(data, name.data(), name.size());
+    block_used_ += name.size();
+    return std::string_view(data, name.size());
+}
+
+ConcurrentSymbolTable::ConcurrentSymbolTable() : shards_(std::make_unique<Shard[]>(kShards)) {
+    for (auto& segment : segments_) {
+        segment.store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+Symbol ConcurrentSymbolTable::intern(std::string_view name) {
+    Shard& shard = shardOf(name);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    Symbol local = shard.names.intern(name);
+    if (local < shard.symbols.size()) {
+        return shard.symbols[local];
+    }
+    size_t symbol = next_.fetch_add(1, std::memory_order_relaxed);
+    if (symbol >= kInvalidSymbol) {
+        shard.names.swapRemove(local);
+        throw std::length_error("Symbol table is full");
+    }
+    size_t index = segmentOf(static_cast<Symbol>(symbol));
+    segment(index)[symbol - segmentStart(index)] = shard.names.name(local);
+    shard.symbols.push_back(static_cast<Symbol>(symbol));
+    return static_cast<Symbol>(symbol);
+}
+
+Symbol ConcurrentSymbolTable::find(std::string_view name) const {
+    Shard& shard = shardOf(name);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    Symbol local = shard.names.find(name);
+    return (local != kInvalidSymbol) ? shard.symbols[local] : kInvalidSymbol;
+}
+
+ConcurrentSymbolTable::Shard& ConcurrentSymbolTable::shardOf(std::string_view name) const {
+    return shards_[std::hash<std::string_view>()(name) % kShards];
+}
+
+std::string_view* ConcurrentSymbolTable::segment(size_t index) {
+    std::string_view* data = segments_[index].load(std::memory_order_acquire);
+    if (data == nullptr) {
+        std::lock_guard<std::mutex> lock(grow_mutex_);
+        data = segments_[index].load(std::memory_order_relaxed);
+        if (data == nullptr) {
+            owned_[index] = std::make_unique<std::string_view[]>(kFirstSegment << index);
+            data = owned_[index].get();
+            segments_[index].store(data, std::memory_order_release);
+        }
+    }
+    return data;
+}
+
+} // namespace ic_sim
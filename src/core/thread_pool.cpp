@@ -0,0 +1,239 @@
+#include "core/thread_pool.h"
+#include <stdexcept>
+#include <string>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace ic_sim {
+
+namespace {
+
+// The pool the current thread works for, and its queue there
+thread_local const ThreadPool* t_pool = nullptr;
+thread_local size_t t_queue = 0;
+
+std::mutex g_shared_mutex;
+std::unique_ptr<ThreadPool> g_shared;
+ThreadPoolOptions g_shared_options;
+
+bool pinThread(std::thread& thread, unsigned cpu) {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set) == 0;
+#else
+    (void)thread;
+    (void)cpu;
+    return false;
+#endif
+}
+
+} // namespace
+
+ThreadPool::ThreadPool(const ThreadPoolOptions& options) {
+    for (unsigned cpu : options.cpus) {
+#ifdef __linux__
+        if (cpu >= CPU_SETSIZE) {
+            throw std::invalid_argument("CPU " + std::to_string(cpu) + " cannot be addressed");
+        }
+#endif
+        (void)cpu;
+    }
+    size_t threads = options.threads;
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    size_t workers = threads - 1;
+    for (size_t i = 0; i <= workers; ++i) {
+        queues_.push_back(std::make_unique<Queue>());
+    }
+    workers_.reserve(workers);
+    for (size_t i = 0; i < workers; ++i) {
+        workers_.emplace_back([this, i]() { workerLoop(i); });
+        if (!options.cpus.empty() && pinThread(workers_.back(), options.cpus[i % options.cpus.size()])) {
+            ++pinned_;
+        }
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (std::thread& worker : workers_) {
+        worker.join();
+    }
+}
+
+ThreadPool& ThreadPool::shared() {
+    std::lock_guard<std::mutex> lock(g_shared_mutex);
+    if (!g_shared) {
+        g_shared = std::make_unique<ThreadPool>(g_shared_options);
+    }
+    return *g_shared;
+}
+
+void ThreadPool::configureShared(const ThreadPoolOptions& options) {
+    std::lock_guard<std::mutex> lock(g_shared_mutex);
+    if (g_shared) {
+        throw std::logic_error("The shared thread pool is already running");
+    }
+    g_shared_options = options;
+}
+
+void ThreadPool::push(Task task) {
+    // Workers keep what they spawn; everyone else feeds the shared queue
+    Queue& queue = (t_pool == this) ? *queues_[t_queue] : *queues_.back();
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+    }
+    queued_.fetch_add(1);
+    if (sleepers_.load() > 0) {
+        // Taking the lock orders this with a sleeper's check of queued_
+        { std::lock_guard<std::mutex> lock(sleep_mutex_); }
+        wake_.notify_one();
+    }
+}
+
+void ThreadPool::pushTo(size_t worker, Task task) {
+    if (worker >= workers_.size()) {
+        throw std::out_of_range("Worker " + std::to_string(worker) + " is not in the pool");
+    }
+    Queue& queue = *queues_[worker];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.assigned.push_back(std::move(task));
+    }
+    queue.assigned_count.fetch_add(1);
+    // Only one worker can take it, so wake them all
+    if (sleepers_.load() > 0) {
+        wakeAll();
+    }
+}
+
+bool ThreadPool::runOne() {
+    Task task;
+    auto take = [&](Queue& queue, bool newest) {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty()) {
+            return false;
+        }
+        if (newest) {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+        } else {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+        }
+        return true;
+    };
+
+    // Tasks assigned to this worker first, in order
+    const size_t count = queues_.size();
+    const bool worker = (t_pool == this);
+    const size_t own = worker ? t_queue : count - 1;
+    if (worker && queues_[own]->assigned_count.load() > 0) {
+        Queue& queue = *queues_[own];
+        {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            task = std::move(queue.assigned.front());
+            queue.assigned.pop_front();
+        }
+        queue.assigned_count.fetch_sub(1);
+        execute(task);
+        return true;
+    }
+
+    // Own deque newest first, then the shared queue, then steal the oldest
+    // task of the other workers, starting with the next one
+    bool found = (worker && take(*queues_[own], true)) || take(*queues_.back(), false);
+    for (size_t k = 1; !found && k < count - 1 + !worker; ++k) {
+        size_t victim = (own + k) % (count - 1);
+        found = (victim != own) && take(*queues_[victim], false);
+    }
+    if (!found) {
+        return false;
+    }
+    queued_.fetch_sub(1);
+    execute(task);
+    return true;
+}
+
+void ThreadPool::execute(Task& task) {
+    TaskGroup& group = *task.group;
+    try {
+        task.run();
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(group.error_mutex_);
+        if (!group.error_) {
+            group.error_ = std::current_exception();
+        }
+    }
+    // The group may be gone as soon as its count drops to zero
+    if (group.pending_.fetch_sub(1) == 1 && sleepers_.load() > 0) {
+        wakeAll();
+    }
+}
+
+void ThreadPool::wakeAll() {
+    { std::lock_guard<std::mutex> lock(sleep_mutex_); }
+    wake_.notify_all();
+}
+
+void ThreadPool::wait(TaskGroup& group) {
+    // A worker waiting inside a task still takes what is assigned to it
+    const std::atomic<size_t>* assigned = (t_pool == this) ? &queues_[t_queue]->assigned_count : nullptr;
+    while (group.pending_.load() > 0) {
+        if (runOne()) {
+            continue;
+        }
+        // Nothing to help with: sleep until a task is queued or the group is done
+        std::unique_lock<std::mutex> lock(sleep_mutex_);
+        sleepers_.fetch_add(1);
+        wake_.wait(lock, [&]() {
+            return group.pending_.load() == 0 || queued_.load() > 0 || (assigned && assigned->load() > 0);
+        });
+        sleepers_.fetch_sub(1);
+    }
+}
+
+void ThreadPool::workerLoop(size_t index) {
+    t_pool = this;
+    t_queue = index;
+    const std::atomic<size_t>& assigned = queues_[index]->assigned_count;
+    while (true) {
+        if (runOne()) {
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleep_mutex_);
+        sleepers_.fetch_add(1);
+        wake_.wait(lock, [&]() { return stopping_ || queued_.load() > 0 || assigned.load() > 0; });
+        sleepers_.fetch_sub(1);
+        if (stopping_ && queued_.load() == 0 && assigned.load() == 0) {
+            return;
+        }
+    }
+}
+
+TaskGroup::~TaskGroup() {
+    pool_.wait(*this);
+}
+
+void TaskGroup::wait() {
+    pool_.wait(*this);
+    std::lock_guard<std::mutex> lock(error_mutex_);
+    if (error_) {
+        std::exception_ptr error = error_;
+        error_ = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+} // namespace ic_sim
@@ -0,0 +1,775 @@
+#include "core/topology.h"
+#include "core/circuit.h"
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace ic_sim {
+
+namespace {
+
+constexpr uint32_t kUnvisited = std::numeric_limits<uint32_t>::max();
+
+} // namespace
+
+std::shared_ptr<const Topology> Topology::build(const std::vector<std::shared_ptr<Component>>& components,
+                                                const std::vector<std::shared_ptr<Node>>& nodes) {
+    std::shared_ptr<Topology> topology(new Topology());
+    const size_t node_count = nodes.size();
+
+    // Device -> node rows straight from the terminal lists
+    topology->device_offsets_.reserve(components.size() + 1);
+    topology->device_offsets_.push_back(0);
+    for (const auto& component : components) {
+        for (const Node* node : component->getNodes()) {
+            NodeId handle = node->getHandle();
+            if (handle >= node_count || nodes[handle].get() != node) {
+                throw std::runtime_error("Component '" + component->getId() + "' is connected to node '" +
+                                         node->getId() + "', which is not part of the circuit");
+            }
+            topology->device_nodes_.push_back(handle);
+        }
+        topology->device_offsets_.push_back(static_cast<uint32_t>(topology->device_nodes_.size()));
+    }
+    if (topology->device_nodes_.size() >= std::numeric_limits<uint32_t>::max()) {
+        throw std::length_error("Circuit has too many terminals for 32-bit topology indices");
+    }
+
+    // Node -> device rows by counting sort over the transpose
+    auto& offsets = topology->node_offsets_;
+    offsets.assign(node_count + 1, 0);
+    for (uint32_t node : topology->device_nodes_) {
+        ++offsets[node + 1];
+    }
+    for (size_t i = 0; i < node_count; ++i) {
+        offsets[i + 1] += offsets[i];
+    }
+    topology->node_devices_.resize(topology->device_nodes_.size());
+    std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+    for (uint32_t device = 0; device + 1 < topology->device_offsets_.size(); ++device) {
+        for (uint32_t node : topology->deviceNodes(device)) {
+            topology->node_devices_[fill[node]++] = device;
+        }
+    }
+
+    topology->buildPattern();
+    topology->labelIslands();
+    topology->buildOrdering();
+    return topology;
+}
+
+namespace {
+
+// Offsets must start at zero, never decrease and end at the indexed array's size
+bool validOffsets(const std::vector<uint32_t>& offsets, size_t rows, size_t entries) {
+    if (offsets.size() != rows + 1 || offsets.front() != 0 || offsets.back() != entries) {
+        return false;
+    }
+    return std::is_sorted(offsets.begin(), offsets.end());
+}
+
+bool allBelow(const std::vector<uint32_t>& values, size_t limit) {
+    return std::all_of(values.begin(), values.end(), [limit](uint32_t value) { return value < limit; });
+}
+
+} // namespace
+
+std::shared_ptr<const Topology> Topology::fromArrays(Arrays arrays) {
+    if (arrays.node_offsets.empty() || arrays.device_offsets.empty()) {
+        throw std::runtime_error("Topology arrays are empty");
+    }
+    const size_t nodes = arrays.node_offsets.size() - 1;
+    const size_t devices = arrays.device_offsets.size() - 1;
+    bool valid = validOffsets(arrays.node_offsets, nodes, arrays.node_devices.size()) &&
+                 validOffsets(arrays.device_offsets, devices, arrays.device_nodes.size()) &&
+                 validOffsets(arrays.pattern_offsets, nodes, arrays.pattern_columns.size()) &&
+                 arrays.node_devices.size() == arrays.device_nodes.size() &&
+                 allBelow(arrays.node_devices, devices) && allBelow(arrays.device_nodes, nodes) &&
+                 allBelow(arrays.pattern_columns, nodes) && arrays.islands.size() == nodes &&
+                 allBelow(arrays.islands, arrays.island_count) && arrays.island_count <= nodes &&
+                 arrays.ordering.size() == nodes && allBelow(arrays.ordering, nodes);
+    if (!valid) {
+        throw std::runtime_error("Topology arrays are inconsistent");
+    }
+
+    std::shared_ptr<Topology> topology(new Topology());
+    topology->node_offsets_ = std::move(arrays.node_offsets);
+    topology->node_devices_ = std::move(arrays.node_devices);
+    topology->device_offsets_ = std::move(arrays.device_offsets);
+    topology->device_nodes_ = std::move(arrays.device_nodes);
+    topology->pattern_offsets_ = std::move(arrays.pattern_offsets);
+    topology->pattern_columns_ = std::move(arrays.pattern_columns);
+    topology->islands_ = std::move(arrays.islands);
+    topology->ordering_ = std::move(arrays.ordering);
+    topology->island_count_ = arrays.island_count;
+    return topology;
+}
+
+namespace {
+
+using RowEdit = std::pair<uint32_t, std::vector<uint32_t>>;
+
+// Replaces the listed rows of a CSR array and sets its row count; rows at or
+// past the old end must all be listed. Rows are patched in place when every
+// edit moves the rest of the array the same way (all grow or all shrink), so
+// the untouched runs shift once without a copy of the array.
+void rewriteRows(std::vector<uint32_t>& offsets, std::vector<uint32_t>& values, size_t row_count,
+                 std::vector<RowEdit> rows) {
+    std::sort(rows.begin(), rows.end(), [](const RowEdit& a, const RowEdit& b) { return a.first < b.first; });
+    // Rows dropped from the end go first; rows added at the end start out empty
+    if (row_count < offsets.size() - 1) {
+        values.resize(offsets[row_count]);
+        offsets.resize(row_count + 1);
+    }
+    offsets.resize(row_count + 1, offsets.back());
+    while (!rows.empty() && rows.back().first >= row_count) {
+        rows.pop_back();
+    }
+    if (rows.empty()) {
+        return;
+    }
+
+    // Shift of everything after each edited row
+    std::vector<int64_t> shift(rows.size());
+    int64_t total = 0;
+    bool grows = true;
+    bool shrinks = true;
+    for (size_t k = 0; k < rows.size(); ++k) {
+        uint32_t row = rows[k].first;
+        int64_t delta = static_cast<int64_t>(rows[k].second.size()) - (offsets[row + 1] - offsets[row]);
+        total += delta;
+        shift[k] = total;
+        grows = grows && delta >= 0;
+        shrinks = shrinks && delta <= 0;
+    }
+    const size_t old_size = values.size();
+    if (old_size + total >= std::numeric_limits<uint32_t>::max()) {
+        throw std::length_error("Circuit has too many terminals for 32-bit topology indices");
+    }
+    auto run_end = [&](size_t k) { return (k + 1 < rows.size()) ? offsets[rows[k + 1].first] : old_size; };
+    auto before = [&](size_t k) { return (k == 0) ? int64_t(0) : shift[k - 1]; };
+    auto at = [&](int64_t position) { return values.begin() + position; };
+
+    if (grows || shrinks) {
+        // Runs move right back to front, or left front to back, so none is
+        // overwritten before it has moved
+        if (grows) {
+            values.resize(old_size + total);
+        }
+        for (size_t i = 0; i < rows.size(); ++i) {
+            size_t k = grows ? rows.size() - 1 - i : i;
+            int64_t start = offsets[rows[k].first + 1];
+            int64_t end = run_end(k);
+            if (grows) {
+                std::copy_backward(at(start), at(end), at(end + shift[k]));
+            } else {
+                std::copy(at(start), at(end), at(start + shift[k]));
+            }
+            std::copy(rows[k].second.begin(), rows[k].second.end(), at(offsets[rows[k].first] + before(k)));
+        }
+        if (shrinks) {
+            values.resize(old_size + total);
+        }
+    } else {
+        // Mixed edits: rebuild everything after the first edited row once
+        const size_t first = rows.front().first;
+        std::vector<uint32_t> tail;
+        tail.reserve(old_size + total - offsets[first]);
+        for (size_t k = 0; k < rows.size(); ++k) {
+            tail.insert(tail.end(), rows[k].second.begin(), rows[k].second.end());
+            tail.insert(tail.end(), at(offsets[rows[k].first + 1]), at(run_end(k)));
+        }
+        values.resize(offsets[first]);
+        values.insert(values.end(), tail.begin(), tail.end());
+    }
+
+    for (size_t k = 0; k < rows.size(); ++k) {
+        size_t last = (k + 1 < rows.size()) ? rows[k + 1].first : row_count;
+        for (size_t row = rows[k].first + 1; row <= last; ++row) {
+            offsets[row] = static_cast<uint32_t>(offsets[row] + shift[k]);
+        }
+    }
+}
+
+std::vector<uint32_t> sortedUnique(std::vector<uint32_t> values) {
+    std::sort(values.begin(), values.end());
+    values.erase(std::unique(values.begin(), values.end()), values.end());
+    return values;
+}
+
+// Nodes reached by searching the pattern from several seeds side by side
+struct Flood {
+    std::vector<uint32_t> group;               // per seed: the first seed of the group it joined
+    std::vector<std::vector<uint32_t>> nodes;  // per seed: the nodes its search reached
+    std::vector<bool> live;                    // per group: could still grow when the search stopped
+};
+
+// Expands one node per search and round, joining searches that reach each
+// other; with same_island a search stays on its seed's island. Stops once at
+// most one group can still grow, so the work is bounded by the groups that
+// ran dry, which are whole pieces, not by the island they hang off.
+Flood floodSideBySide(const Topology& topology, const std::vector<uint32_t>& seeds, bool same_island) {
+    const uint32_t count = static_cast<uint32_t>(seeds.size());
+    const std::vector<uint32_t>& islands = topology.getIslands();
+    Flood flood;
+    flood.group.resize(count);
+    std::iota(flood.group.begin(), flood.group.end(), 0);
+    flood.nodes.resize(count);
+    std::vector<uint32_t> owner(topology.getNodeCount(), kUnvisited);
+    std::vector<size_t> head(count, 0);
+    auto root = [&](uint32_t search) {
+        while (flood.group[search] != search) {
+            search = flood.group[search];
+        }
+        return search;
+    };
+    for (uint32_t i = 0; i < count; ++i) {
+        owner[seeds[i]] = i;
+        flood.nodes[i].push_back(seeds[i]);
+    }
+
+    while (true) {
+        flood.live.assign(count, false);
+        size_t groups = 0;
+        size_t live = 0;
+        for (uint32_t i = 0; i < count; ++i) {
+            uint32_t group = root(i);
+            groups += (group == i);
+            if (head[i] < flood.nodes[i].size() && !flood.live[group]) {
+                flood.live[group] = true;
+                ++live;
+            }
+        }
+        if (groups < 2 || live < 2) {
+            break;
+        }
+        for (uint32_t i = 0; i < count; ++i) {
+            if (head[i] == flood.nodes[i].size()) {
+                continue;
+            }
+            uint32_t node = flood.nodes[i][head[i]++];
+            for (uint32_t neighbour : topology.patternRow(node)) {
+                if (same_island && islands[neighbour] != islands[seeds[i]]) {
+                    continue;
+                }
+                uint32_t other = owner[neighbour];
+                if (other == kUnvisited) {
+                    owner[neighbour] = i;
+                    flood.nodes[i].push_back(neighbour);
+                } else if (root(i) != root(other)) {
+                    uint32_t a = root(i);
+                    uint32_t b = root(other);
+                    flood.group[std::max(a, b)] = std::min(a, b);
+                }
+            }
+        }
+    }
+    for (uint32_t i = 0; i < count; ++i) {
+        flood.group[i] = root(i);
+    }
+    return flood;
+}
+
+} // namespace
+
+Topology& Topology::writable(std::shared_ptr<const Topology>& topology) {
+    if (!topology) {
+        throw std::invalid_argument("No topology to edit");
+    }
+    if (topology.use_count() > 1) {
+        topology = std::shared_ptr<const Topology>(new Topology(*topology));
+    }
+    // Topologies are only ever created non-const, by build() and fromArrays()
+    return const_cast<Topology&>(*topology);
+}
+
+std::shared_ptr<const Topology> Topology::addNode(std::shared_ptr<const Topology> topology) {
+    Topology& edited = writable(topology);
+    uint32_t node = static_cast<uint32_t>(edited.getNodeCount());
+    edited.node_offsets_.push_back(edited.node_offsets_.back());
+    edited.pattern_columns_.push_back(node);
+    edited.pattern_offsets_.push_back(static_cast<uint32_t>(edited.pattern_columns_.size()));
+    // An unconnected node is an island of its own
+    edited.islands_.push_back(static_cast<uint32_t>(edited.island_count_++));
+    edited.ordering_.push_back(node);
+    return topology;
+}
+
+std::shared_ptr<const Topology> Topology::addDevice(std::shared_ptr<const Topology> topology,
+                                                    const std::vector<uint32_t>& nodes) {
+    Topology& edited = writable(topology);
+    const size_t node_count = edited.getNodeCount();
+    for (uint32_t node : nodes) {
+        if (node >= node_count) {
+            throw std::runtime_error("Terminal node " + std::to_string(node) + " is outside the topology");
+        }
+    }
+    if (edited.device_nodes_.size() + nodes.size() >= std::numeric_limits<uint32_t>::max()) {
+        throw std::length_error("Circuit has too many terminals for 32-bit topology indices");
+    }
+
+    uint32_t device = static_cast<uint32_t>(edited.getDeviceCount());
+    edited.device_nodes_.insert(edited.device_nodes_.end(), nodes.begin(), nodes.end());
+    edited.device_offsets_.push_back(static_cast<uint32_t>(edited.device_nodes_.size()));
+
+    // The new device has the highest index, so it goes last in each of its rows
+    std::vector<uint32_t> rows = sortedUnique(nodes);
+    std::vector<RowEdit> edits;
+    for (uint32_t node : rows) {
+        Range old = edited.nodeDevices(node);
+        std::vector<uint32_t> row(old.begin(), old.end());
+        row.insert(row.end(), std::count(nodes.begin(), nodes.end(), node), device);
+        edits.emplace_back(node, std::move(row));
+    }
+    rewriteRows(edited.node_offsets_, edited.node_devices_, node_count, std::move(edits));
+
+    edited.addCouplings(rows);
+    edited.mergeIslands(rows);
+    return topology;
+}
+
+std::shared_ptr<const Topology> Topology::removeDevice(std::shared_ptr<const Topology> topology,
+                                                       uint32_t device) {
+    Topology& edited = writable(topology);
+    if (device >= edited.getDeviceCount()) {
+        throw std::runtime_error("Device " + std::to_string(device) + " is outside the topology");
+    }
+    const uint32_t last = static_cast<uint32_t>(edited.getDeviceCount() - 1);
+    Range removed = edited.deviceNodes(device);
+    Range renamed = edited.deviceNodes(last);
+    std::vector<uint32_t> terminals(removed.begin(), removed.end());
+    std::vector<uint32_t> moved(renamed.begin(), renamed.end());
+
+    // Node rows lose the device and see the last device under its index
+    std::vector<uint32_t> rows = terminals;
+    rows.insert(rows.end(), moved.begin(), moved.end());
+    std::vector<RowEdit> edits;
+    for (uint32_t node : sortedUnique(std::move(rows))) {
+        Range old = edited.nodeDevices(node);
+        std::vector<uint32_t> row;
+        for (uint32_t entry : old) {
+            if (entry != device) {
+                row.push_back((entry == last) ? device : entry);
+            }
+        }
+        std::sort(row.begin(), row.end());
+        edits.emplace_back(node, std::move(row));
+    }
+    rewriteRows(edited.node_offsets_, edited.node_devices_, edited.getNodeCount(), std::move(edits));
+
+    std::vector<RowEdit> device_rows;
+    if (device != last) {
+        device_rows.emplace_back(device, std::move(moved));
+    }
+    rewriteRows(edited.device_offsets_, edited.device_nodes_, last, std::move(device_rows));
+
+    // Dropping a coupling can cut the device's island in two
+    terminals = sortedUnique(std::move(terminals));
+    if (!terminals.empty() && edited.dropCouplings(terminals)) {
+        edited.splitIsland(terminals);
+    }
+    return topology;
+}
+
+std::shared_ptr<const Topology> Topology::removeNode(std::shared_ptr<const Topology> topology, uint32_t node) {
+    Topology& edited = writable(topology);
+    if (node >= edited.getNodeCount()) {
+        throw std::runtime_error("Node " + std::to_string(node) + " is outside the topology");
+    }
+    if (edited.nodeDevices(node).size() > 0) {
+        throw std::runtime_error("Node " + std::to_string(node) + " still has terminals attached");
+    }
+    const uint32_t last = static_cast<uint32_t>(edited.getNodeCount() - 1);
+    const uint32_t island = edited.islands_[node];
+
+    std::vector<RowEdit> device_rows;
+    std::vector<RowEdit> pattern_rows;
+    if (node != last) {
+        // Devices and pattern neighbours of the last node now refer to it by the removed index
+        for (uint32_t device : edited.nodeDevices(last)) {
+            for (uint32_t i = edited.device_offsets_[device]; i < edited.device_offsets_[device + 1]; ++i) {
+                if (edited.device_nodes_[i] == last) {
+                    edited.device_nodes_[i] = node;
+                }
+            }
+        }
+        Range neighbours = edited.patternRow(last);
+        std::vector<uint32_t> columns(neighbours.begin(), neighbours.end());
+        for (uint32_t& column : columns) {
+            if (column == last) {
+                column = node;
+                continue;
+            }
+            auto first = edited.pattern_columns_.begin() + edited.pattern_offsets_[column];
+            auto end = edited.pattern_columns_.begin() + edited.pattern_offsets_[column + 1];
+            std::replace(first, end, last, node);
+            std::sort(first, end);
+        }
+        std::sort(columns.begin(), columns.end());
+        Range devices = edited.nodeDevices(last);
+        device_rows.emplace_back(node, std::vector<uint32_t>(devices.begin(), devices.end()));
+        pattern_rows.emplace_back(node, std::move(columns));
+    }
+    rewriteRows(edited.node_offsets_, edited.node_devices_, last, std::move(device_rows));
+    rewriteRows(edited.pattern_offsets_, edited.pattern_columns_, last, std::move(pattern_rows));
+
+    edited.islands_[node] = edited.islands_[last];
+    edited.islands_.pop_back();
+    edited.ordering_.erase(std::find(edited.ordering_.begin(), edited.ordering_.end(), node));
+    std::replace(edited.ordering_.begin(), edited.ordering_.end(), last, node);
+    edited.releaseIslands({island});
+    return topology;
+}
+
+bool Topology::addCouplings(const std::vector<uint32_t>& nodes) {
+    std::vector<RowEdit> edits;
+    for (uint32_t row : nodes) {
+        Range old = patternRow(row);
+        std::vector<uint32_t> columns;
+        columns.reserve(old.size() + nodes.size());
+        std::set_union(old.begin(), old.end(), nodes.begin(), nodes.end(), std::back_inserter(columns));
+        if (columns.size() != old.size()) {
+            edits.emplace_back(row, std::move(columns));
+        }
+    }
+    if (edits.empty()) {
+        return false;
+    }
+    rewriteRows(pattern_offsets_, pattern_columns_, getNodeCount(), std::move(edits));
+    return true;
+}
+
+bool Topology::dropCouplings(const std::vector<uint32_t>& nodes) {
+    // A pair stays coupled while another device joins it. Only the shorter of
+    // the two device rows is searched, so a ground node is never walked.
+    std::vector<std::pair<uint32_t, uint32_t>> cut;
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        for (size_t j = i + 1; j < nodes.size(); ++j) {
+            uint32_t a = nodes[i];
+            uint32_t b = nodes[j];
+            if (nodeDevices(a).size() > nodeDevices(b).size()) {
+                std::swap(a, b);
+            }
+            bool joined = false;
+            for (uint32_t device : nodeDevices(a)) {
+                Range terminals = deviceNodes(device);
+                joined = joined || std::find(terminals.begin(), terminals.end(), b) != terminals.end();
+            }
+            if (!joined) {
+                cut.emplace_back(a, b);
+            }
+        }
+    }
+    if (cut.empty()) {
+        return false;
+    }
+
+    std::vector<RowEdit> edits;
+    for (uint32_t row : nodes) {
+        std::vector<uint32_t> dropped;
+        for (const auto& [a, b] : cut) {
+            if (a == row || b == row) {
+                dropped.push_back((a == row) ? b : a);
+            }
+        }
+        if (dropped.empty()) {
+            continue;
+        }
+        Range old = patternRow(row);
+        std::vector<uint32_t> columns;
+        columns.reserve(old.size());
+        std::copy_if(old.begin(), old.end(), std::back_inserter(columns), [&](uint32_t column) {
+            return std::find(dropped.begin(), dropped.end(), column) == dropped.end();
+        });
+        edits.emplace_back(row, std::move(columns));
+    }
+    rewriteRows(pattern_offsets_, pattern_columns_, getNodeCount(), std::move(edits));
+    return true;
+}
+
+void Topology::mergeIslands(const std::vector<uint32_t>& nodes) {
+    // One seed per island the device touches
+    std::vector<uint32_t> seeds;
+    std::vector<uint32_t> labels;
+    for (uint32_t node : nodes) {
+        if (std::find(labels.begin(), labels.end(), islands_[node]) == labels.end()) {
+            labels.push_back(islands_[node]);
+            seeds.push_back(node);
+        }
+    }
+    if (seeds.size() < 2) {
+        return;
+    }
+
+    // The island still growing when the others ran dry is the largest; it keeps
+    // its label and its place in the ordering
+    Flood flood = floodSideBySide(*this, seeds, true);
+    size_t target = 0;
+    for (size_t i = 1; i < seeds.size(); ++i) {
+        if (flood.live[i] || (!flood.live[target] && flood.nodes[i].size() > flood.nodes[target].size())) {
+            target = i;
+        }
+    }
+    const uint32_t target_label = labels[target];
+    std::vector<bool> merged(island_count_, false);
+    for (size_t i = 0; i < seeds.size(); ++i) {
+        merged[labels[i]] = (i != target);
+    }
+
+    // The others are eliminated just ahead of it, each in its own order
+    std::vector<uint32_t> moved;
+    for (uint32_t node : ordering_) {
+        if (merged[islands_[node]]) {
+            moved.push_back(node);
+        }
+    }
+    ordering_.erase(std::remove_if(ordering_.begin(), ordering_.end(),
+                                   [&](uint32_t node) { return merged[islands_[node]]; }),
+                    ordering_.end());
+    auto segment = std::find_if(ordering_.begin(), ordering_.end(),
+                                [&](uint32_t node) { return islands_[node] == target_label; });
+    ordering_.insert(segment, moved.begin(), moved.end());
+
+    for (size_t i = 0; i < seeds.size(); ++i) {
+        if (i != target) {
+            for (uint32_t node : flood.nodes[i]) {
+                islands_[node] = target_label;
+            }
+        }
+    }
+    labels.erase(labels.begin() + static_cast<std::ptrdiff_t>(target));
+    releaseIslands(std::move(labels));
+}
+
+void Topology::splitIsland(const std::vector<uint32_t>& nodes) {
+    // Every node of the island still reaches one of the terminals, so groups
+    // that ran dry are whole pieces. The group still growing, or else the
+    // first one, keeps the label.
+    const uint32_t island = islands_[nodes.front()];
+    Flood flood = floodSideBySide(*this, nodes, false);
+    const uint32_t count = static_cast<uint32_t>(nodes.size());
+    uint32_t keeper = flood.group[0];
+    for (uint32_t i = 0; i < count; ++i) {
+        if (flood.group[i] == i && flood.live[i]) {
+            keeper = i;
+        }
+    }
+    const uint32_t first_new = static_cast<uint32_t>(island_count_);
+    for (uint32_t group = 0; group < count; ++group) {
+        if (flood.group[group] != group || group == keeper) {
+            continue;
+        }
+        uint32_t label = static_cast<uint32_t>(island_count_++);
+        for (uint32_t i = 0; i < count; ++i) {
+            if (flood.group[i] == group) {
+                for (uint32_t node : flood.nodes[i]) {
+                    islands_[node] = label;
+                }
+            }
+        }
+    }
+    if (island_count_ == first_new) {
+        return;
+    }
+
+    // The pieces go just ahead of what is left of the island, each keeping its
+    // nodes' relative order
+    std::vector<uint32_t> moved;
+    for (uint32_t node : ordering_) {
+        if (islands_[node] >= first_new) {
+            moved.push_back(node);
+        }
+    }
+    std::stable_sort(moved.begin(), moved.end(), [&](uint32_t a, uint32_t b) { return islands_[a] < islands_[b]; });
+    ordering_.erase(std::remove_if(ordering_.begin(), ordering_.end(),
+                                   [&](uint32_t node) { return islands_[node] >= first_new; }),
+                    ordering_.end());
+    auto segment = std::find_if(ordering_.begin(), ordering_.end(),
+                                [&](uint32_t node) { return islands_[node] == island; });
+    ordering_.insert(segment, moved.begin(), moved.end());
+}
+
+void Topology::releaseIslands(std::vector<uint32_t> labels) {
+    if (labels.empty()) {
+        return;
+    }
+    std::sort(labels.begin(), labels.end());
+    std::vector<bool> released(island_count_, false);
+    for (uint32_t label : labels) {
+        released[label] = true;
+    }
+
+    // The highest labels still in use move into the gaps
+    std::vector<uint32_t> remap(island_count_);
+    std::iota(remap.begin(), remap.end(), 0);
+    size_t count = island_count_;
+    for (uint32_t label : labels) {
+        while (count > 0 && released[count - 1]) {
+            --count;
+        }
+        if (label >= count) {
+            break;
+        }
+        remap[count - 1] = label;
+        released[label] = false;
+        --count;
+    }
+    island_count_ -= labels.size();
+    // Usually only the newest labels were released and nobody moves
+    if (std::any_of(remap.begin() + island_count_, remap.end(),
+                    [this](uint32_t label) { return label < island_count_; })) {
+        for (uint32_t& island : islands_) {
+            island = remap[island];
+        }
+    }
+}
+
+void Topology::buildPattern() {
+    const size_t node_count = getNodeCount();
+    pattern_offsets_.assign(1, 0);
+    pattern_offsets_.reserve(node_count + 1);
+    pattern_columns_.clear();
+
+    // Every pair of terminals on one device couples their rows
+    std::vector<uint32_t> last_row(node_count, kUnvisited);
+    for (uint32_t row = 0; row < node_count; ++row) {
+        size_t row_start = pattern_columns_.size();
+        last_row[row] = row;
+        pattern_columns_.push_back(row);
+        for (uint32_t device : nodeDevices(row)) {
+            for (uint32_t column : deviceNodes(device)) {
+                if (last_row[column] != row) {
+                    last_row[column] = row;
+                    pattern_columns_.push_back(column);
+                }
+            }
+        }
+        std::sort(pattern_columns_.begin() + row_start, pattern_columns_.end());
+        pattern_offsets_.push_back(static_cast<uint32_t>(pattern_columns_.size()));
+    }
+}
+
+void Topology::labelIslands() {
+    const size_t node_count = getNodeCount();
+    islands_.assign(node_count, kUnvisited);
+    island_count_ = 0;
+
+    std::vector<uint32_t> stack;
+    for (uint32_t seed = 0; seed < node_count; ++seed) {
+        if (islands_[seed] != kUnvisited) {
+            continue;
+        }
+        uint32_t island = static_cast<uint32_t>(island_count_++);
+        islands_[seed] = island;
+        stack.push_back(seed);
+        while (!stack.empty()) {
+            uint32_t node = stack.back();
+            stack.pop_back();
+            for (uint32_t neighbour : patternRow(node)) {
+                if (islands_[neighbour] == kUnvisited) {
+                    islands_[neighbour] = island;
+                    stack.push_back(neighbour);
+                }
+            }
+        }
+    }
+}
+
+void Topology::buildOrdering() {
+    const size_t node_count = getNodeCount();
+    auto degree = [this](uint32_t node) { return pattern_offsets_[node + 1] - pattern_offsets_[node]; };
+
+    // Seeds in increasing degree, so each island starts from a peripheral node
+    std::vector<uint32_t> seeds(node_count);
+    for (uint32_t node = 0; node < node_count; ++node) {
+        seeds[node] = node;
+    }
+    std::stable_sort(seeds.begin(), seeds.end(),
+                     [&](uint32_t a, uint32_t b) { return degree(a) < degree(b); });
+
+    ordering_.clear();
+    ordering_.reserve(node_count);
+    std::vector<bool> visited(node_count, false);
+    for (uint32_t seed : seeds) {
+        if (visited[seed]) {
+            continue;
+        }
+        visited[seed] = true;
+        size_t head = ordering_.size();
+        ordering_.push_back(seed);
+        while (head < ordering_.size()) {
+            uint32_t node = ordering_[head++];
+            size_t first = ordering_.size();
+            for (uint32_t neighbour : patternRow(node)) {
+                if (!visited[neighbour]) {
+                    visited[neighbour] = true;
+                    ordering_.push_back(neighbour);
+                }
+            }
+            std::stable_sort(ordering_.begin() + first, ordering_.end(),
+                             [&](uint32_t a, uint32_t b) { return degree(a) < degree(b); });
+        }
+    }
+    std::reverse(ordering_.begin(), ordering_.end());
+}
+
+std::vector<uint32_t> Topology::getDanglingNodes() const {
+    std::vector<uint32_t> dangling;
+    for (uint32_t node = 0; node < getNodeCount(); ++node) {
+        if (nodeDevices(node).size() < 2) {
+            dangling.push_back(node);
+        }
+    }
+    return dangling;
+}
+
+std::vector<uint32_t> Topology::breadthFirstOrder() const {
+    const size_t node_count = getNodeCount();
+    std::vector<uint32_t> order;
+    order.reserve(node_count);
+    std::vector<bool> visited(node_count, false);
+
+    for (uint32_t seed = 0; seed < node_count; ++seed) {
+        if (visited[seed]) {
+            continue;
+        }
+        visited[seed] = true;
+        size_t head = order.size();
+        order.push_back(seed);
+        while (head < order.size()) {
+            uint32_t node = order[head++];
+            for (uint32_t neighbour : patternRow(node)) {
+                if (!visited[neighbour]) {
+                    visited[neighbour] = true;
+                    order.push_back(neighbour);
+                }
+            }
+        }
+    }
+    return order;
+}
+
+std::vector<uint32_t> Topology::partition(size_t parts) const {
+    if (parts == 0) {
+        throw std::invalid_argument("Topology::partition needs at least one part");
+    }
+    const size_t node_count = getNodeCount();
+    std::vector<uint32_t> assignment(node_count, 0);
+    std::vector<uint32_t> order = breadthFirstOrder();
+    for (size_t i = 0; i < order.size(); ++i) {
+        assignment[order[i]] = static_cast<uint32_t>(i * parts / node_count);
+    }
+    return assignment;
+}
+
+size_t Topology::memoryBytes() const {
+    return sizeof(uint32_t) * (node_offsets_.size() + node_devices_.size() + device_offsets_.size() +
+                               device_nodes_.size() + pattern_offsets_.size() + pattern_columns_.size() +
+                               islands_.size() + ordering_.size());
+}
+
+} // namespace ic_sim
@@ -0,0 +1,178 @@
+#include "io/async_writer.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+
+namespace ic_sim {
+
+namespace {
+
+// Spins briefly, then yields, then sleeps for growing intervals of up to 1 ms,
+// so an idle side costs little CPU but a busy one reacts within microseconds
+class Backoff {
+public:
+    void pause() {
+        if (rounds_ < 64) {
+            // spin
+        } else if (rounds_ < 128) {
+            std::this_thread::yield();
+        } else {
+            size_t shift = std::min<size_t>(rounds_ - 128, 7);
+            std::this_thread::sleep_for(std::chrono::microseconds(std::min<size_t>(size_t(10) << shift, 1000)));
+        }
+        ++rounds_;
+    }
+    void reset() { rounds_ = 0; }
+
+private:
+    size_t rounds_ = 0;
+};
+
+} // namespace
+
+AsyncSampleWriter::AsyncSampleWriter(std::shared_ptr<SampleSink> target, const AsyncWriterOptions& options)
+    : target_(std::move(target)), options_(options), ring_(std::max<size_t>(2, options.ring_blocks)) {
+    if (!target_) {
+        throw std::invalid_argument("AsyncSampleWriter needs a target sink");
+    }
+}
+
+AsyncSampleWriter::~AsyncSampleWriter() {
+    stop();
+}
+
+void AsyncSampleWriter::begin(const std::vector<std::string>& columns) {
+    if (thread_.joinable()) {
+        finish();
+    }
+    width_ = columns.size();
+    block_rows_ = std::max<size_t>(1, options_.block_bytes / (std::max<size_t>(1, width_) * sizeof(double)));
+    ring_.clear();
+    for (Block& block : ring_.slots()) {
+        block.data.resize(width_ * block_rows_);
+        block.rows = 0;
+    }
+    stats_ = AsyncWriterStats{};
+    rows_written_.store(0, std::memory_order_relaxed);
+    blocks_written_.store(0, std::memory_order_relaxed);
+    filling_ = nullptr;
+
+    target_->begin(columns);
+    done_.store(false, std::memory_order_relaxed);
+    failed_.store(false, std::memory_order_relaxed);
+    error_ = nullptr;
+    thread_ = std::thread(&AsyncSampleWriter::drain, this);
+}
+
+void AsyncSampleWriter::write(const double* rows, size_t count, size_t width) {
+    if (width != width_) {
+        throw std::invalid_argument("Row width differs from the columns given to begin()");
+    }
+    rethrowWriterError();
+    while (count > 0) {
+        if (!filling_) {
+            filling_ = acquire();
+            if (!filling_) {
+                stats_.rows_dropped += count;
+                return;
+            }
+        }
+        size_t n = std::min(count, block_rows_ - filling_->rows);
+        std::memcpy(filling_->data.data() + filling_->rows * width_, rows, n * width_ * sizeof(double));
+        filling_->rows += n;
+        rows += n * width_;
+        count -= n;
+        if (filling_->rows == block_rows_) {
+            ring_.publish();
+            filling_ = nullptr;
+        }
+    }
+}
+
+AsyncSampleWriter::Block* AsyncSampleWriter::acquire() {
+    Block* block = ring_.tryAcquire();
+    if (!block) {
+        ++stats_.waits;
+        if (options_.overflow == OverflowPolicy::DropNewest) {
+            return nullptr;
+        }
+        auto start = std::chrono::steady_clock::now();
+        Backoff backoff;
+        while (!(block = ring_.tryAcquire())) {
+            rethrowWriterError();
+            backoff.pause();
+        }
+        stats_.wait_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    stats_.max_queued = std::max(stats_.max_queued, ring_.size());
+    block->rows = 0;
+    return block;
+}
+
+void AsyncSampleWriter::finish() {
+    if (!thread_.joinable()) {
+        return;
+    }
+    if (filling_ && filling_->rows > 0) {
+        ring_.publish();
+    }
+    filling_ = nullptr;
+    stop();
+    rethrowWriterError();
+    target_->finish();
+}
+
+void AsyncSampleWriter::drain() {
+    Backoff backoff;
+    while (true) {
+        if (Block* block = ring_.tryFront()) {
+            try {
+                target_->write(block->data.data(), block->rows, width_);
+            } catch (...) {
+                error_ = std::current_exception();
+                failed_.store(true, std::memory_order_release);
+                return;
+            }
+            rows_written_.fetch_add(block->rows, std::memory_order_relaxed);
+            blocks_written_.fetch_add(1, std::memory_order_relaxed);
+            ring_.release();
+            backoff.reset();
+        } else if (done_.load(std::memory_order_acquire)) {
+            // Everything published before done_ was set is visible now
+            if (!ring_.tryFront()) {
+                return;
+            }
+        } else {
+            backoff.pause();
+        }
+    }
+}
+
+void AsyncSampleWriter::stop() {
+    if (thread_.joinable()) {
+        done_.store(true, std::memory_order_release);
+        thread_.join();
+    }
+}
+
+void AsyncSampleWriter::rethrowWriterError() {
+    if (!failed_.load(std::memory_order_acquire)) {
+        return;
+    }
+    stop();
+    std::exception_ptr error = error_;
+    error_ = nullptr;
+    failed_.store(false, std::memory_order_relaxed);
+    filling_ = nullptr;
+    std::rethrow_exception(error);
+}
+
+AsyncWriterStats AsyncSampleWriter::getStats() const {
+    AsyncWriterStats stats = stats_;
+    stats.rows_written = rows_written_.load(std::memory_order_relaxed);
+    stats.blocks_written = blocks_written_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+} // namespace ic_sim
@@ -0,0 +1,284 @@
+#include "io/checkpoint.h"
+#include "io/circuit_cache.h"
+#include "io/mapped_file.h"
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+#include <vector>
+
+namespace ic_sim {
+
+namespace {
+
+constexpr char kMagic[8] = {'I', 'C', 'S', 'I', 'M', 'C', 'K', '\0'};
+constexpr uint32_t kVersion = 2;
+constexpr uint32_t kByteOrderMark = 0x01020304;
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint64_t payload_bytes;
+    uint64_t payload_hash;
+};
+
+// Payload: the scalars in declaration order, then every array as a u64 count
+// followed by its elements
+class Encoder {
+public:
+    template <typename T>
+    void value(T v) {
+        append(&v, sizeof(v));
+    }
+    template <typename T>
+    void array(const std::vector<T>& values) {
+        value<uint64_t>(values.size());
+        append(values.data(), values.size() * sizeof(T));
+    }
+    const std::vector<char>& bytes() const { return bytes_; }
+
+private:
+    void append(const void* data, size_t size) {
+        const char* begin = static_cast<const char*>(data);
+        bytes_.insert(bytes_.end(), begin, begin + size);
+    }
+
+    std::vector<char> bytes_;
+};
+
+class Decoder {
+public:
+    Decoder(const char* data, size_t size, const std::string& path) : data_(data), size_(size), path_(path) {}
+
+    template <typename T>
+    T value() {
+        T v;
+        take(&v, sizeof(v));
+        return v;
+    }
+    template <typename T>
+    void array(std::vector<T>& values) {
+        uint64_t count = value<uint64_t>();
+        if (count > (size_ - used_) / sizeof(T)) {
+            throw CheckpointError("Truncated checkpoint: " + path_);
+        }
+        values.resize(count);
+        take(values.data(), count * sizeof(T));
+    }
+    bool done() const { return used_ == size_; }
+
+private:
+    void take(void* out, size_t size) {
+        if (size > size_ - used_) {
+            throw CheckpointError("Truncated checkpoint: " + path_);
+        }
+        std::memcpy(out, data_ + used_, size);
+        used_ += size;
+    }
+
+    const char* data_;
+    size_t size_;
+    size_t used_ = 0;
+    const std::string& path_;
+};
+
+std::vector<char> encode(const SimulationCheckpoint& checkpoint) {
+    Encoder payload;
+    payload.value(checkpoint.duration);
+    payload.value(checkpoint.timestep);
+    payload.value(checkpoint.time);
+    payload.value(checkpoint.steps);
+    payload.value(checkpoint.breakpoints);
+    payload.value(checkpoint.recorded_rows);
+    payload.value(checkpoint.component_count);
+    payload.value(static_cast<uint32_t>(checkpoint.simd_level));
+    payload.array(checkpoint.pending_times);
+    payload.array(checkpoint.pending_sources);
+    payload.array(checkpoint.node_voltages);
+    payload.array(checkpoint.devices.capacitor_charge);
+    payload.array(checkpoint.devices.capacitor_voltage);
+    payload.array(checkpoint.devices.capacitor_current);
+    payload.array(checkpoint.devices.inductor_current);
+    payload.array(checkpoint.devices.inductor_voltage);
+    payload.array(checkpoint.devices.resistor_current);
+    payload.array(checkpoint.device_handles);
+    payload.array(checkpoint.device_offsets);
+    payload.array(checkpoint.device_values);
+
+    const std::vector<char>& body = payload.bytes();
+    FileHeader header;
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.byte_order = kByteOrderMark;
+    header.payload_bytes = body.size();
+    header.payload_hash = hashBytes(body.data(), body.size());
+    std::vector<char> image(sizeof(header) + body.size());
+    std::memcpy(image.data(), &header, sizeof(header));
+    std::memcpy(image.data() + sizeof(header), body.data(), body.size());
+    return image;
+}
+
+} // namespace
+
+void writeCheckpoint(const std::string& path, const SimulationCheckpoint& checkpoint) {
+    std::vector<char> image = encode(checkpoint);
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        if (!out || !out.write(image.data(), static_cast<std::streamsize>(image.size())) || !out.flush()) {
+            std::remove(temporary.c_str());
+            throw std::runtime_error("Cannot write checkpoint: " + temporary);
+        }
+    }
+    std::error_code error;
+    std::filesystem::rename(temporary, path, error);
+    if (error) {
+        std::remove(temporary.c_str());
+        throw std::runtime_error("Cannot write checkpoint: " + path + ": " + error.message());
+    }
+}
+
+std::shared_ptr<SimulationCheckpoint> readCheckpoint(const std::string& path) {
+    MappedFile file(path);
+    FileHeader header;
+    if (file.size() < sizeof(header)) {
+        throw CheckpointError("Not a checkpoint: " + path);
+    }
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.byte_order != kByteOrderMark) {
+        throw CheckpointError("Not a checkpoint: " + path);
+    }
+    if (header.version != kVersion) {
+        throw CheckpointError("Unsupported checkpoint version " + std::to_string(header.version) + ": " + path);
+    }
+    const char* body = file.data() + sizeof(header);
+    if (header.payload_bytes != file.size() - sizeof(header) ||
+        hashBytes(body, header.payload_bytes) != header.payload_hash) {
+        throw CheckpointError("Corrupt checkpoint: " + path);
+    }
+
+    auto checkpoint = std::make_shared<SimulationCheckpoint>();
+    Decoder payload(body, header.payload_bytes, path);
+    checkpoint->duration = payload.value<double>();
+    checkpoint->timestep = payload.value<double>();
+    checkpoint->time = payload.value<double>();
+    checkpoint->steps = payload.value<uint64_t>();
+    checkpoint->breakpoints = payload.value<uint64_t>();
+    checkpoint->recorded_rows = payload.value<uint64_t>();
+    checkpoint->component_count = payload.value<uint64_t>();
+    checkpoint->simd_level = static_cast<SimdLevel>(payload.value<uint32_t>());
+    payload.array(checkpoint->pending_times);
+    payload.array(checkpoint->pending_sources);
+    payload.array(checkpoint->node_voltages);
+    payload.array(checkpoint->devices.capacitor_charge);
+    payload.array(checkpoint->devices.capacitor_voltage);
+    payload.array(checkpoint->devices.capacitor_current);
+    payload.array(checkpoint->devices.inductor_current);
+    payload.array(checkpoint->devices.inductor_voltage);
+    payload.array(checkpoint->devices.resistor_current);
+    payload.array(checkpoint->device_handles);
+    payload.array(checkpoint->device_offsets);
+    payload.array(checkpoint->device_values);
+    if (!payload.done()) {
+        throw CheckpointError("Corrupt checkpoint: " + path);
+    }
+    return checkpoint;
+}
+
+CheckpointFile::CheckpointFile(const std::string& path, const CheckpointOptions& options)
+    : path_(path), options_(options), last_time_(std::chrono::steady_clock::now()) {
+    thread_ = std::thread([this]() { run(); });
+}
+
+CheckpointFile::~CheckpointFile() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_one();
+    thread_.join();
+}
+
+bool CheckpointFile::due(size_t steps) {
+    // Multiples of the step interval, so a resumed run keeps the same cadence
+    if (options_.every_steps > 0 && steps % options_.every_steps == 0) {
+        return true;
+    }
+    // The clock is read every 64 steps only
+    if (options_.every_seconds > 0.0 && steps % 64 == 0) {
+        auto now = std::chrono::steady_clock::now();
+        return std::chrono::duration<double>(now - last_time_).count() >= options_.every_seconds;
+    }
+    return false;
+}
+
+void CheckpointFile::write(std::shared_ptr<const SimulationCheckpoint> checkpoint) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (error_) {
+            std::exception_ptr error = error_;
+            error_ = nullptr;
+            std::rethrow_exception(error);
+        }
+        if (pending_) {
+            ++stats_.superseded;
+        }
+        pending_ = std::move(checkpoint);
+    }
+    last_time_ = std::chrono::steady_clock::now();
+    wake_.notify_one();
+}
+
+void CheckpointFile::finish() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_.wait(lock, [this]() { return !pending_ && !writing_; });
+    if (error_) {
+        std::exception_ptr error = error_;
+        error_ = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+CheckpointStats CheckpointFile::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void CheckpointFile::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        wake_.wait(lock, [this]() { return pending_ || stopping_; });
+        if (!pending_) {
+            return;
+        }
+        std::shared_ptr<const SimulationCheckpoint> checkpoint = std::move(pending_);
+        pending_.reset();
+        writing_ = true;
+        lock.unlock();
+
+        auto start = std::chrono::steady_clock::now();
+        std::exception_ptr error;
+        try {
+            writeCheckpoint(path_, *checkpoint);
+        } catch (...) {
+            error = std::current_exception();
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        lock.lock();
+        writing_ = false;
+        if (error) {
+            error_ = error;
+        } else {
+            ++stats_.written;
+            stats_.write_seconds += seconds;
+            std::error_code ignored;
+            stats_.bytes = static_cast<size_t>(std::filesystem::file_size(path_, ignored));
+        }
+        idle_.notify_all();
+    }
+}
+
+} // namespace ic_sim
@@ -0,0 +1,575 @@
+#include "io/circuit_cache.h"
+#include "core/sources.h"
+#include "plugins/plugin_system.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <unordered_map>
+
+namespace ic_sim {
+
+namespace {
+
+constexpr char kMagic[8] = {'I', 'C', 'S', 'I', 'M', 'C', 'C', '\0'};
+constexpr uint32_t kVersion = 1;
+constexpr uint32_t kByteOrder = 0x01020304;
+constexpr size_t kAlignment = 8;
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint64_t file_size;
+    uint64_t payload_hash;  // everything after the header
+    uint32_t section_count;
+    uint32_t reserved;
+};
+
+struct SectionEntry {
+    uint32_t id;
+    uint32_t element_size;
+    uint64_t offset;  // from the start of the file, kAlignment-aligned
+    uint64_t count;
+};
+
+// Every section is required; the ids index CircuitCache::sections_
+enum Section : uint32_t {
+    kCounts,          // uint64 {nodes, devices, islands}
+    kSettings,        // double {duration, timestep}
+    kMetaOffsets,     // strings {circuit name, simulation type}
+    kMetaChars,
+    kSourceOffsets,   // source paths
+    kSourceChars,
+    kSourceRecords,   // uint64 {size, hash} per source
+    kNodeNameOffsets,
+    kNodeNameChars,
+    kDeviceNameOffsets,
+    kDeviceNameChars,
+    kTypeNameOffsets,
+    kTypeNameChars,
+    kDeviceTypes,     // uint32 index into the type names per device
+    kParamOffsets,    // uint64, devices + 1
+    kParams,          // double
+    kNodeOffsets,     // Topology arrays, uint32
+    kNodeDevices,
+    kDeviceOffsets,
+    kDeviceNodes,
+    kPatternOffsets,
+    kPatternColumns,
+    kIslands,
+    kOrdering,
+    kSectionCount
+};
+
+constexpr size_t align(size_t offset) {
+    return (offset + kAlignment - 1) & ~(kAlignment - 1);
+}
+
+// Flat string table: offsets[i]..offsets[i + 1] delimit string i in chars
+struct StringTable {
+    std::vector<uint64_t> offsets{0};
+    std::string chars;
+
+    void add(std::string_view text) {
+        chars.append(text);
+        offsets.push_back(chars.size());
+    }
+};
+
+class CacheWriter {
+public:
+    template <typename T>
+    void add(Section id, const T* data, size_t count) {
+        sections_.push_back({id, static_cast<uint32_t>(sizeof(T)), 0, count});
+        const char* bytes = reinterpret_cast<const char*>(data);
+        payloads_.emplace_back(bytes, bytes + count * sizeof(T));
+    }
+    template <typename T>
+    void add(Section id, const std::vector<T>& values) {
+        add(id, values.data(), values.size());
+    }
+    void add(Section offsets, Section chars, const StringTable& table) {
+        add(offsets, table.offsets);
+        add(chars, table.chars.data(), table.chars.size());
+    }
+
+    // Header, section table, then the sections in the order they were added
+    std::vector<char> finish() {
+        size_t offset = align(sizeof(FileHeader) + sections_.size() * sizeof(SectionEntry));
+        for (size_t i = 0; i < sections_.size(); ++i) {
+            sections_[i].offset = offset;
+            offset = align(offset + payloads_[i].size());
+        }
+        std::vector<char> image(offset, 0);
+        std::memcpy(image.data() + sizeof(FileHeader), sections_.data(), sections_.size() * sizeof(SectionEntry));
+        for (size_t i = 0; i < sections_.size(); ++i) {
+            std::copy(payloads_[i].begin(), payloads_[i].end(), image.begin() + sections_[i].offset);
+        }
+
+        FileHeader header{};
+        std::memcpy(header.magic, kMagic, sizeof(kMagic));
+        header.version = kVersion;
+        header.byte_order = kByteOrder;
+        header.file_size = image.size();
+        header.payload_hash = hashBytes(image.data() + sizeof(FileHeader), image.size() - sizeof(FileHeader));
+        header.section_count = static_cast<uint32_t>(sections_.size());
+        std::memcpy(image.data(), &header, sizeof(header));
+        return image;
+    }
+
+private:
+    std::vector<SectionEntry> sections_;
+    std::vector<std::vector<char>> payloads_;
+};
+
+// Element size each section must be stored with
+uint32_t elementSize(uint32_t id) {
+    switch (id) {
+        case kCounts:
+        case kMetaOffsets:
+        case kSourceOffsets:
+        case kSourceRecords:
+        case kNodeNameOffsets:
+        case kDeviceNameOffsets:
+        case kTypeNameOffsets:
+        case kParamOffsets:
+            return sizeof(uint64_t);
+        case kSettings:
+        case kParams:
+            return sizeof(double);
+        case kMetaChars:
+        case kSourceChars:
+        case kNodeNameChars:
+        case kDeviceNameChars:
+        case kTypeNameChars:
+            return sizeof(char);
+        default:
+            return sizeof(uint32_t);
+    }
+}
+
+std::string absolutePath(const std::string& path) {
+    return std::filesystem::absolute(path).lexically_normal().string();
+}
+
+bool hasSuffix(const std::string& text, std::string_view suffix) {
+    return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+} // namespace
+
+uint64_t hashBytes(const void* data, size_t size, uint64_t seed) {
+    constexpr uint64_t m = 0xc6a4a7935bd1e995ULL;
+    constexpr int r = 47;
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    uint64_t h = seed ^ (size * m);
+
+    size_t blocks = size / 8;
+    for (size_t i = 0; i < blocks; ++i) {
+        uint64_t k;
+        std::memcpy(&k, bytes + i * 8, sizeof(k));
+        k *= m;
+        k ^= k >> r;
+        k *= m;
+        h ^= k;
+        h *= m;
+    }
+
+    const unsigned char* tail = bytes + blocks * 8;
+    switch (size & 7) {
+        case 7: h ^= uint64_t(tail[6]) << 48; [[fallthrough]];
+        case 6: h ^= uint64_t(tail[5]) << 40; [[fallthrough]];
+        case 5: h ^= uint64_t(tail[4]) << 32; [[fallthrough]];
+        case 4: h ^= uint64_t(tail[3]) << 24; [[fallthrough]];
+        case 3: h ^= uint64_t(tail[2]) << 16; [[fallthrough]];
+        case 2: h ^= uint64_t(tail[1]) << 8; [[fallthrough]];
+        case 1:
+            h ^= uint64_t(tail[0]);
+            h *= m;
+    }
+
+    h ^= h >> r;
+    h *= m;
+    h ^= h >> r;
+    return h;
+}
+
+CacheSource hashSourceFile(const std::string& path) {
+    MappedFile file(path);
+    return {absolutePath(path), file.size(), hashBytes(file.data(), file.size())};
+}
+
+void writeCircuitCache(const std::string& path, Circuit& circuit, const SimulationSettings& simulation,
+                       const std::vector<CacheSource>& sources) {
+    std::shared_ptr<const Topology> topology = circuit.getTopology();
+    if (!topology) {
+        circuit.compile();
+        topology = circuit.getTopology();
+    }
+    const size_t node_count = circuit.getNodeCount();
+    const size_t device_count = circuit.getComponentCount();
+
+    CacheWriter writer;
+    const uint64_t counts[] = {node_count, device_count, topology->getIslandCount()};
+    writer.add(kCounts, counts, 3);
+    const double settings[] = {simulation.duration, simulation.timestep};
+    writer.add(kSettings, settings, 2);
+
+    StringTable meta;
+    meta.add(circuit.getName());
+    meta.add(simulation.type);
+    writer.add(kMetaOffsets, kMetaChars, meta);
+
+    StringTable source_paths;
+    std::vector<uint64_t> source_records;
+    for (const CacheSource& source : sources) {
+        source_paths.add(source.path);
+        source_records.push_back(source.size);
+        source_records.push_back(source.hash);
+    }
+    writer.add(kSourceOffsets, kSourceChars, source_paths);
+    writer.add(kSourceRecords, source_records);
+
+    StringTable node_names;
+    for (NodeId id = 0; id < node_count; ++id) {
+        node_names.add(circuit.getNode(id)->getId());
+    }
+    writer.add(kNodeNameOffsets, kNodeNameChars, node_names);
+
+    StringTable device_names;
+    StringTable type_names;
+    std::unordered_map<std::string, uint32_t> type_index;
+    std::vector<uint32_t> device_types(device_count);
+    std::vector<uint64_t> param_offsets{0};
+    std::vector<double> params;
+    param_offsets.reserve(device_count + 1);
+    for (ComponentId id = 0; id < device_count; ++id) {
+        const Component& component = *circuit.getComponent(id);
+        device_names.add(component.getId());
+        auto [type, added] = type_index.emplace(component.getType(), static_cast<uint32_t>(type_index.size()));
+        if (added) {
+            type_names.add(type->first);
+        }
+        device_types[id] = type->second;
+        if (!component.getParameters(params)) {
+            throw CircuitCacheError("Device " + component.getId() + " of type " + type->first +
+                                    " cannot be cached");
+        }
+        param_offsets.push_back(params.size());
+    }
+    writer.add(kDeviceNameOffsets, kDeviceNameChars, device_names);
+    writer.add(kTypeNameOffsets, kTypeNameChars, type_names);
+    writer.add(kDeviceTypes, device_types);
+    writer.add(kParamOffsets, param_offsets);
+    writer.add(kParams, params);
+
+    writer.add(kNodeOffsets, topology->getNodeOffsets());
+    writer.add(kNodeDevices, topology->getNodeDevices());
+    writer.add(kDeviceOffsets, topology->getDeviceOffsets());
+    writer.add(kDeviceNodes, topology->getDeviceNodes());
+    writer.add(kPatternOffsets, topology->getPatternOffsets());
+    writer.add(kPatternColumns, topology->getPatternColumns());
+    writer.add(kIslands, topology->getIslands());
+    writer.add(kOrdering, topology->getOrdering());
+
+    std::vector<char> image = writer.finish();
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        if (!out || !out.write(image.data(), static_cast<std::streamsize>(image.size())) || !out.flush()) {
+            std::remove(temporary.c_str());
+            throw std::runtime_error("Cannot write circuit cache: " + temporary);
+        }
+    }
+    std::error_code error;
+    std::filesystem::rename(temporary, path, error);
+    if (error) {
+        std::remove(temporary.c_str());
+        throw std::runtime_error("Cannot write circuit cache: " + path + ": " + error.message());
+    }
+}
+
+CircuitCache::CircuitCache(const std::string& path) : file_(path), sections_(kSectionCount) {
+    const char* base = file_.data();
+    const size_t size = file_.size();
+    FileHeader header;
+    if (size < sizeof(header)) {
+        throw CircuitCacheError("Not a circuit cache: " + path);
+    }
+    std::memcpy(&header, base, sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) {
+        throw CircuitCacheError("Not a circuit cache: " + path);
+    }
+    if (header.version != kVersion || header.byte_order != kByteOrder) {
+        throw CircuitCacheError("Circuit cache " + path + " was written by an incompatible build");
+    }
+    if (header.file_size != size || reinterpret_cast<uintptr_t>(base) % kAlignment != 0 ||
+        header.section_count > (size - sizeof(header)) / sizeof(SectionEntry) ||
+        hashBytes(base + sizeof(header), size - sizeof(header)) != header.payload_hash) {
+        throw CircuitCacheError("Circuit cache " + path + " is corrupt");
+    }
+
+    std::vector<bool> seen(kSectionCount, false);
+    for (uint32_t i = 0; i < header.section_count; ++i) {
+        SectionEntry entry;
+        std::memcpy(&entry, base + sizeof(header) + i * sizeof(SectionEntry), sizeof(entry));
+        if (entry.id >= kSectionCount) {
+            continue;  // unknown sections are skipped
+        }
+        bool valid = !seen[entry.id] && entry.element_size == elementSize(entry.id) &&
+                     entry.offset % kAlignment == 0 && entry.offset <= size &&
+                     entry.count <= (size - entry.offset) / entry.element_size;
+        if (!valid) {
+            throw CircuitCacheError("Circuit cache " + path + " has a bad section table");
+        }
+        seen[entry.id] = true;
+        sections_[entry.id] = {base + entry.offset, static_cast<size_t>(entry.count)};
+    }
+    if (std::find(seen.begin(), seen.end(), false) != seen.end()) {
+        throw CircuitCacheError("Circuit cache " + path + " is missing sections");
+    }
+
+    // Cross-section consistency; the topology arrays are checked when adopted
+    auto table_ok = [this](uint32_t offsets, uint32_t chars, size_t strings) {
+        const uint64_t* o = array<uint64_t>(offsets);
+        return count(offsets) == strings + 1 && o[0] == 0 && o[strings] == count(chars) &&
+               std::is_sorted(o, o + strings + 1);
+    };
+    const uint64_t* counts = array<uint64_t>(kCounts);
+    const size_t sources = count(kSourceOffsets) > 0 ? count(kSourceOffsets) - 1 : 0;
+    bool consistent = count(kCounts) == 3 && count(kSettings) == 2 && table_ok(kMetaOffsets, kMetaChars, 2) &&
+                      sources > 0 && table_ok(kSourceOffsets, kSourceChars, sources) &&
+                      count(kSourceRecords) == 2 * sources;
+    if (consistent) {
+        const size_t nodes = counts[0];
+        const size_t devices = counts[1];
+        const size_t types = count(kTypeNameOffsets) > 0 ? count(kTypeNameOffsets) - 1 : 0;
+        const uint32_t* device_types = array<uint32_t>(kDeviceTypes);
+        consistent = table_ok(kNodeNameOffsets, kNodeNameChars, nodes) &&
+                     table_ok(kDeviceNameOffsets, kDeviceNameChars, devices) &&
+                     table_ok(kTypeNameOffsets, kTypeNameChars, types) && count(kDeviceTypes) == devices &&
+                     std::all_of(device_types, device_types + devices, [types](uint32_t t) { return t < types; }) &&
+                     table_ok(kParamOffsets, kParams, devices) && count(kNodeOffsets) == nodes + 1 &&
+                     count(kDeviceOffsets) == devices + 1 && array<uint32_t>(kDeviceOffsets)[0] == 0 &&
+                     array<uint32_t>(kDeviceOffsets)[devices] == count(kDeviceNodes) &&
+                     std::is_sorted(array<uint32_t>(kDeviceOffsets), array<uint32_t>(kDeviceOffsets) + devices + 1);
+    }
+    if (!consistent) {
+        throw CircuitCacheError("Circuit cache " + path + " is inconsistent");
+    }
+
+    const uint64_t* records = array<uint64_t>(kSourceRecords);
+    for (size_t i = 0; i < sources; ++i) {
+        sources_.push_back({std::string(string(kSourceOffsets, kSourceChars, i)), records[2 * i], records[2 * i + 1]});
+    }
+    simulation_.duration = array<double>(kSettings)[0];
+    simulation_.timestep = array<double>(kSettings)[1];
+    simulation_.type = std::string(string(kMetaOffsets, kMetaChars, 1));
+}
+
+std::string_view CircuitCache::string(uint32_t offsets, uint32_t chars, size_t index) const {
+    const uint64_t* o = array<uint64_t>(offsets);
+    return std::string_view(array<char>(chars) + o[index], static_cast<size_t>(o[index + 1] - o[index]));
+}
+
+std::vector<uint32_t> CircuitCache::copyIndices(uint32_t section) const {
+    const uint32_t* first = array<uint32_t>(section);
+    return std::vector<uint32_t>(first, first + count(section));
+}
+
+size_t CircuitCache::getNodeCount() const {
+    return array<uint64_t>(kCounts)[0];
+}
+
+size_t CircuitCache::getComponentCount() const {
+    return array<uint64_t>(kCounts)[1];
+}
+
+bool CircuitCache::isCurrent() const {
+    for (const CacheSource& source : sources_) {
+        std::error_code error;
+        // Size first: a changed length fails without reading the file
+        if (std::filesystem::file_size(source.path, error) != source.size || error) {
+            return false;
+        }
+        try {
+            if (hashSourceFile(source.path).hash != source.hash) {
+                return false;
+            }
+        } catch (const std::runtime_error&) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::unique_ptr<Circuit> CircuitCache::instantiate() const {
+    const size_t node_count = getNodeCount();
+    const size_t device_count = getComponentCount();
+    auto circuit = std::make_unique<Circuit>(std::string(string(kMetaOffsets, kMetaChars, 0)));
+
+    circuit->reserve<Node>(node_count);
+    for (size_t i = 0; i < node_count; ++i) {
+        circuit->createNode(std::string(string(kNodeNameOffsets, kNodeNameChars, i)));
+    }
+
+    // Each type is resolved once; anything that is not built in goes to the plugins
+    enum class Builder { Resistor, Capacitor, VoltageSource, CurrentSource, Plugin };
+    struct TypeEntry {
+        Builder builder;
+        ComponentFactory factory;
+    };
+    std::vector<TypeEntry> types;
+    for (size_t i = 0; i + 1 < count(kTypeNameOffsets); ++i) {
+        std::string name(string(kTypeNameOffsets, kTypeNameChars, i));
+        if (name == "Resistor") {
+            types.push_back({Builder::Resistor, {}});
+        } else if (name == "Capacitor") {
+            types.push_back({Builder::Capacitor, {}});
+        } else if (name == "VoltageSource") {
+            types.push_back({Builder::VoltageSource, {}});
+        } else if (name == "CurrentSource") {
+            types.push_back({Builder::CurrentSource, {}});
+        } else {
+            ComponentFactory factory = PluginManager::getInstance().resolveComponent(name);
+            if (!factory) {
+                throw CircuitCacheError("No loaded plugin provides component type " + name);
+            }
+            types.push_back({Builder::Plugin, factory});
+        }
+    }
+
+    const uint32_t* device_types = array<uint32_t>(kDeviceTypes);
+    const uint64_t* param_offsets = array<uint64_t>(kParamOffsets);
+    const double* params = array<double>(kParams);
+    const uint32_t* device_offsets = array<uint32_t>(kDeviceOffsets);
+    const uint32_t* device_nodes = array<uint32_t>(kDeviceNodes);
+    std::vector<size_t> per_type(types.size(), 0);
+    for (size_t i = 0; i < device_count; ++i) {
+        ++per_type[device_types[i]];
+    }
+    for (size_t t = 0; t < types.size(); ++t) {
+        if (types[t].builder == Builder::Resistor) {
+            circuit->reserve<Resistor>(per_type[t]);
+        } else if (types[t].builder == Builder::Capacitor) {
+            circuit->reserve<Capacitor>(per_type[t]);
+        }
+    }
+    for (size_t i = 0; i < device_count; ++i) {
+        std::string id(string(kDeviceNameOffsets, kDeviceNameChars, i));
+        const double* p = params + param_offsets[i];
+        const size_t n = static_cast<size_t>(param_offsets[i + 1] - param_offsets[i]);
+        const TypeEntry& type = types[device_types[i]];
+        auto expect = [&](bool ok) {
+            if (!ok) {
+                throw CircuitCacheError("Bad cached parameters for device " + id);
+            }
+        };
+
+        ComponentId handle = kInvalidId;
+        switch (type.builder) {
+            case Builder::Resistor:
+                expect(n == 1);
+                handle = circuit->createComponent<Resistor>(id, p[0])->getHandle();
+                break;
+            case Builder::Capacitor:
+                expect(n == 1);
+                handle = circuit->createComponent<Capacitor>(id, p[0])->getHandle();
+                break;
+            case Builder::VoltageSource:
+            case Builder::CurrentSource: {
+                expect(n >= 1 && p[0] >= 0.0 && p[0] <= static_cast<double>(WaveformType::PiecewiseLinear));
+                Waveform waveform = Waveform::fromParameters(static_cast<WaveformType>(p[0]), p + 1, n - 1);
+                handle = (type.builder == Builder::VoltageSource)
+                             ? circuit->createComponent<VoltageSource>(id, std::move(waveform))->getHandle()
+                             : circuit->createComponent<CurrentSource>(id, std::move(waveform))->getHandle();
+                break;
+            }
+            case Builder::Plugin: {
+                expect(n == type.factory.schema->size());
+                ParameterBlock block(*type.factory.schema);
+                for (size_t slot = 0; slot < n; ++slot) {
+                    block.set(slot, p[slot]);
+                }
+                auto component = PluginManager::getInstance().createComponent(type.factory, block);
+                expect(component != nullptr);
+                component->setId(id);
+                handle = circuit->addComponent(component);
+                break;
+            }
+        }
+        expect(handle == i);
+        for (uint32_t t = device_offsets[i]; t < device_offsets[i + 1]; ++t) {
+            circuit->connect(handle, device_nodes[t]);
+        }
+    }
+
+    Topology::Arrays arrays;
+    arrays.node_offsets = copyIndices(kNodeOffsets);
+    arrays.node_devices = copyIndices(kNodeDevices);
+    arrays.device_offsets = copyIndices(kDeviceOffsets);
+    arrays.device_nodes = copyIndices(kDeviceNodes);
+    arrays.pattern_offsets = copyIndices(kPatternOffsets);
+    arrays.pattern_columns = copyIndices(kPatternColumns);
+    arrays.islands = copyIndices(kIslands);
+    arrays.ordering = copyIndices(kOrdering);
+    arrays.island_count = array<uint64_t>(kCounts)[2];
+    try {
+        circuit->setTopology(Topology::fromArrays(std::move(arrays)));
+    } catch (const std::exception& e) {
+        throw CircuitCacheError(std::string("Cached topology rejected: ") + e.what());
+    }
+    return circuit;
+}
+
+CachedNetlist loadNetlistCached(const std::string& path, const NetlistCacheOptions& options) {
+    CachedNetlist result;
+    result.cache_path = options.cache_path.empty() ? path + ".iccache" : options.cache_path;
+
+    std::error_code error;
+    if (std::filesystem::exists(result.cache_path, error)) {
+        try {
+            CircuitCache cache(result.cache_path);
+            // The cache must also describe this netlist, not just current files
+            if (cache.getSources().front().path == absolutePath(path) && cache.isCurrent()) {
+                result.circuit = cache.instantiate();
+                result.simulation = cache.getSimulation();
+                result.from_cache = true;
+                return result;
+            }
+        } catch (const std::exception&) {
+            // Unusable cache: parse the netlist instead
+        }
+    }
+
+    std::vector<std::string> files;
+    if (hasSuffix(path, ".json")) {
+        JsonNetlist netlist = loadJsonNetlistFile(path, options.json);
+        result.circuit = std::move(netlist.circuit);
+        result.simulation = netlist.simulation;
+        files.push_back(path);
+    } else {
+        SpiceNetlist netlist = loadSpiceNetlist(path, options.spice);
+        result.circuit = std::move(netlist.circuit);
+        result.simulation = netlist.simulation;
+        files = std::move(netlist.files);
+    }
+    result.circuit->compile();
+
+    if (options.update) {
+        try {
+            std::vector<CacheSource> sources;
+            for (const std::string& file : files) {
+                sources.push_back(hashSourceFile(file));
+            }
+            writeCircuitCache(result.cache_path, *result.circuit, result.simulation, sources);
+        } catch (const std::exception&) {
+            // Uncacheable device types or a read-only directory: run uncached
+        }
+    }
+    return result;
+}
+
+} // namespace ic_sim
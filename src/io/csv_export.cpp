@@ -0,0 +1,265 @@
+#include "io/csv_export.h"
+#include "core/thread_pool.h"
+#include <algorithm>
+#include <charconv>
+#include <deque>
+#include <memory>
+#include <stdexcept>
+
+namespace ic_sim {
+
+namespace {
+
+// Room for one number and the delimiter or newline after it; the longest
+// double std::to_chars writes is 24 characters
+constexpr size_t kFieldChars = 32;
+constexpr int kMaxPrecision = 17;
+
+// Rows of one chunk inside the time window, a pointer per exported column
+// (time first)
+struct Block {
+    std::vector<const double*> columns;
+    size_t rows = 0;
+    std::vector<std::vector<double>> decoded;  // owns the columns read from a file
+};
+
+struct Text {
+    std::string chars;
+    size_t rows = 0;
+};
+
+// Indices into names of the probes the patterns select, in pattern order
+std::vector<size_t> selectColumns(const std::vector<std::string>& names, const std::vector<std::string>& patterns) {
+    std::vector<size_t> selected;
+    if (patterns.empty()) {
+        for (size_t i = 0; i < names.size(); ++i) {
+            selected.push_back(i);
+        }
+        return selected;
+    }
+    std::vector<bool> taken(names.size(), false);
+    for (const std::string& pattern : patterns) {
+        bool matched = false;
+        for (size_t i = 0; i < names.size(); ++i) {
+            if (matchWildcard(pattern, names[i])) {
+                matched = true;
+                if (!taken[i]) {
+                    taken[i] = true;
+                    selected.push_back(i);
+                }
+            }
+        }
+        if (!matched && pattern.find_first_of("*?") == std::string::npos) {
+            throw std::invalid_argument("No probe named " + pattern);
+        }
+    }
+    return selected;
+}
+
+// RFC 4180 quoting for names holding the delimiter, quotes or line breaks
+void appendField(std::string& line, const std::string& field, char delimiter) {
+    if (field.find_first_of(std::string{delimiter, '"', '\n', '\r'}) == std::string::npos) {
+        line += field;
+        return;
+    }
+    line += '"';
+    for (char c : field) {
+        if (c == '"') {
+            line += '"';
+        }
+        line += c;
+    }
+    line += '"';
+}
+
+// Narrows block to the rows with t0 <= time <= t1
+void trimToWindow(Block& block, double t0, double t1) {
+    const double* times = block.columns[0];
+    size_t first = std::lower_bound(times, times + block.rows, t0) - times;
+    size_t last = std::upper_bound(times + first, times + block.rows, t1) - times;
+    for (const double*& column : block.columns) {
+        column += first;
+    }
+    block.rows = last - first;
+}
+
+void formatBlock(const Block& block, const CsvExportOptions& options, std::string& text) {
+    const size_t width = block.columns.size();
+    const int precision = std::min(options.precision, kMaxPrecision);
+    text.resize(block.rows * width * kFieldChars);
+    char* out = text.data();
+    char* const end = out + text.size();
+    for (size_t row = 0; row < block.rows; ++row) {
+        for (size_t column = 0; column < width; ++column) {
+            double value = block.columns[column][row];
+            out = (precision > 0 ? std::to_chars(out, end, value, std::chars_format::general, precision)
+                                 : std::to_chars(out, end, value))
+                      .ptr;
+            *out++ = options.delimiter;
+        }
+        out[-1] = '\n';
+    }
+    text.resize(out - text.data());
+}
+
+void writeText(std::ostream& out, const std::string& text, CsvExportStats& stats) {
+    out.write(text.data(), static_cast<std::streamsize>(text.size()));
+    if (!out) {
+        throw std::runtime_error("Failed writing CSV output");
+    }
+    stats.bytes += text.size();
+}
+
+// Writes the header and chunks [first, last); load(chunk, block) points block
+// at the chunk's rows of the exported columns
+template <typename Load>
+CsvExportStats writeCsv(std::ostream& out, const CsvExportOptions& options, const std::vector<std::string>& header,
+                        size_t first, size_t last, const Load& load) {
+    CsvExportStats stats;
+    stats.columns = header.size();
+    if (options.header) {
+        std::string line;
+        for (const std::string& name : header) {
+            appendField(line, name, options.delimiter);
+            line += options.delimiter;
+        }
+        line.back() = '\n';
+        writeText(out, line, stats);
+    }
+
+    auto format = [&options, &load](size_t chunk, Block& block, Text& text) {
+        load(chunk, block);
+        trimToWindow(block, options.start_time, options.end_time);
+        formatBlock(block, options, text.chars);
+        text.rows = block.rows;
+    };
+
+    ThreadPool& pool = ThreadPool::shared();
+    size_t threads = options.threads;
+    if (threads == 0) {
+        threads = pool.getThreadCount();
+    }
+    if (threads == 1) {
+        // One block and one buffer for the whole export
+        Block block;
+        Text text;
+        for (size_t chunk = first; chunk < last; ++chunk) {
+            format(chunk, block, text);
+            writeText(out, text.chars, stats);
+            stats.rows += text.rows;
+        }
+        return stats;
+    }
+
+    // Formats chunks ahead on the shared thread pool and writes them in order
+    struct Pending {
+        explicit Pending(ThreadPool& pool) : group(pool) {}
+        TaskGroup group;
+        Block block;
+        Text text;
+    };
+    std::deque<std::unique_ptr<Pending>> pending;
+    size_t next = first;
+    auto launch = [&]() {
+        size_t chunk = next++;
+        pending.push_back(std::make_unique<Pending>(pool));
+        Pending* slot = pending.back().get();
+        slot->group.run([chunk, slot, &format]() { format(chunk, slot->block, slot->text); });
+    };
+    while (next < last && pending.size() < threads) {
+        launch();
+    }
+    while (!pending.empty()) {
+        std::unique_ptr<Pending> front = std::move(pending.front());
+        pending.pop_front();
+        front->group.wait();
+        if (next < last) {
+            launch();
+        }
+        writeText(out, front->text.chars, stats);
+        stats.rows += front->text.rows;
+    }
+    return stats;
+}
+
+// First chunk in [0, count) for which before(chunk) is false
+template <typename Before>
+size_t partitionChunks(size_t count, const Before& before) {
+    size_t low = 0;
+    size_t high = count;
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        if (before(middle)) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+} // namespace
+
+CsvExportStats exportCsv(const ResultStore& results, std::ostream& out, const CsvExportOptions& options) {
+    std::vector<std::string> names;
+    for (size_t probe = 0; probe < results.getProbeCount(); ++probe) {
+        names.push_back(results.getProbeName(probe));
+    }
+    std::vector<size_t> selected = selectColumns(names, options.columns);
+    std::vector<std::string> header{"time"};
+    for (size_t probe : selected) {
+        header.push_back(names[probe]);
+    }
+
+    // Chunks overlapping the window; the spans point into the store, nothing
+    // is copied
+    const size_t chunks = results.getChunkCount();
+    size_t first = partitionChunks(chunks, [&](size_t chunk) {
+        SampleSpan times = results.time(chunk);
+        return times.empty() || times[times.size() - 1] < options.start_time;
+    });
+    size_t last = partitionChunks(chunks, [&](size_t chunk) {
+        SampleSpan times = results.time(chunk);
+        return times.empty() || times[0] <= options.end_time;
+    });
+    return writeCsv(out, options, header, first, std::max(first, last), [&](size_t chunk, Block& block) {
+        SampleSpan times = results.time(chunk);
+        block.rows = times.size();
+        block.columns.assign(1, times.data());
+        for (size_t probe : selected) {
+            block.columns.push_back(results.samples(probe, chunk).data());
+        }
+    });
+}
+
+CsvExportStats exportCsv(const WaveformFileReader& reader, std::ostream& out, const CsvExportOptions& options) {
+    const std::vector<std::string>& columns = reader.getColumns();
+    std::vector<std::string> names(columns.begin() + 1, columns.end());
+    std::vector<size_t> selected = selectColumns(names, options.columns);
+    std::vector<std::string> header{"time"};
+    for (size_t probe : selected) {
+        header.push_back(names[probe]);
+    }
+
+    // The chunk index holds every chunk's time range, so chunks outside the
+    // window are never decoded
+    const size_t chunks = reader.getChunkCount();
+    size_t first = reader.findChunk(options.start_time);
+    size_t last = partitionChunks(chunks, [&](size_t chunk) {
+        return reader.getChunk(chunk).first_time <= options.end_time;
+    });
+    return writeCsv(out, options, header, first, std::max(first, last), [&](size_t chunk, Block& block) {
+        block.decoded.resize(selected.size() + 1);
+        reader.readChunk(chunk, 0, block.decoded[0]);
+        for (size_t i = 0; i < selected.size(); ++i) {
+            reader.readChunk(chunk, selected[i] + 1, block.decoded[i + 1]);
+        }
+        block.rows = block.decoded[0].size();
+        block.columns.clear();
+        for (const std::vector<double>& column : block.decoded) {
+            block.columns.push_back(column.data());
+        }
+    });
+}
+
+} // namespace ic_sim
@@ -0,0 +1,474 @@
+#include "io/json_netlist.h"
+#include "core/parameter_schema.h"
+#include "core/sources.h"
+#include "core/symbol_table.h"
+#include "io/json_reader.h"
+#include "plugins/plugin_system.h"
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace ic_sim {
+
+namespace {
+
+enum class Context : uint8_t {
+    Root,
+    Components,
+    Component,
+    Parameters,
+    Connections,
+    Connection,
+    Simulation
+};
+
+enum class Builtin : uint8_t {
+    None,
+    Resistor,
+    Capacitor,
+    VoltageSource,
+    CurrentSource
+};
+
+// Built-in types share the schema path with plugins; defaults match the web editor
+const ParameterSchema& resistorSchema() {
+    static const ParameterSchema schema = ParameterSchema("Resistor").add("resistance", 1e3);
+    return schema;
+}
+
+const ParameterSchema& capacitorSchema() {
+    static const ParameterSchema schema = ParameterSchema("Capacitor").add("capacitance", 1e-6);
+    return schema;
+}
+
+// A non-zero frequency turns the source into a sine of that amplitude
+const ParameterSchema& voltageSourceSchema() {
+    static const ParameterSchema schema =
+        ParameterSchema("VoltageSource").add("voltage", 0.0).add("frequency", 0.0);
+    return schema;
+}
+
+const ParameterSchema& currentSourceSchema() {
+    static const ParameterSchema schema =
+        ParameterSchema("CurrentSource").add("current", 0.0).add("frequency", 0.0);
+    return schema;
+}
+
+Waveform sourceWaveform(const ParameterBlock& parameters) {
+    double amplitude = parameters.real(0);
+    double frequency = parameters.real(1);
+    return (frequency > 0.0) ? Waveform::sine(0.0, amplitude, frequency) : Waveform::dc(amplitude);
+}
+
+// 0 for the first terminal, 1 for the second, -1 if the name is not recognised
+int terminalIndex(std::string_view name) {
+    if (name == "positive" || name == "input" || name == "anode" || name == "plus" ||
+        name == "p" || name == "+") {
+        return 0;
+    }
+    if (name == "negative" || name == "output" || name == "cathode" || name == "minus" ||
+        name == "n" || name == "-") {
+        return 1;
+    }
+    return -1;
+}
+
+constexpr std::string_view kDefaultTerminalNames[2] = {"positive", "negative"};
+
+class NetlistBuilder : public JsonHandler {
+public:
+    explicit NetlistBuilder(const JsonNetlistOptions& options)
+        : options_(options), circuit_(std::make_unique<Circuit>("")) {}
+
+    void startObject() override { open(true); }
+    void startArray() override { open(false); }
+    void endObject() override { close(); }
+    void endArray() override { close(); }
+
+    void key(std::string_view name) override {
+        if (skip_ == 0) {
+            key_.assign(name.data(), name.size());
+        }
+    }
+
+    void string(std::string_view value) override {
+        if (skip_ > 0) {
+            return;
+        }
+        switch (context()) {
+            case Context::Root:
+                if (key_ == "name") {
+                    name_.assign(value.data(), value.size());
+                } else if (key_ == "description") {
+                    result_.description.assign(value.data(), value.size());
+                } else if (key_ == "version") {
+                    result_.version.assign(value.data(), value.size());
+                }
+                break;
+            case Context::Component:
+                if (key_ == "id") {
+                    id_.assign(value.data(), value.size());
+                } else if (key_ == "type") {
+                    type_.assign(value.data(), value.size());
+                }
+                break;
+            case Context::Connection:
+                if (key_ == "id") {
+                    connection_id_.assign(value.data(), value.size());
+                } else if (key_ == "from") {
+                    from_.assign(value.data(), value.size());
+                } else if (key_ == "to") {
+                    to_.assign(value.data(), value.size());
+                } else if (key_ == "from_node") {
+                    from_node_.assign(value.data(), value.size());
+                } else if (key_ == "to_node") {
+                    to_node_.assign(value.data(), value.size());
+                }
+                break;
+            case Context::Simulation:
+                if (key_ == "type") {
+                    result_.simulation.type.assign(value.data(), value.size());
+                }
+                break;
+            default:
+                break;
+        }
+    }
+
+    void number(double value) override {
+        if (skip_ > 0) {
+            return;
+        }
+        switch (context()) {
+            case Context::Parameters:
+                addParameter(value);
+                break;
+            case Context::Simulation:
+                if (key_ == "duration") {
+                    result_.simulation.duration = value;
+                } else if (key_ == "timestep") {
+                    result_.simulation.timestep = value;
+                }
+                break;
+            default:
+                break;
+        }
+    }
+
+    void boolean(bool value) override {
+        if (skip_ == 0 && context() == Context::Parameters) {
+            addParameter(value ? 1.0 : 0.0);
+        }
+    }
+
+    void null() override { context(); }
+
+    JsonNetlist finish() {
+        for (Symbol device = 0; device < handles_.size(); ++device) {
+            if (handles_[device] == kInvalidId) {
+                throw std::runtime_error("Connection references undefined component '" +
+                                         std::string(devices_.name(device)) + "'");
+            }
+        }
+
+        // One node per net, terminals attached in device order
+        std::vector<NodeId> net_nodes(parent_.size(), kInvalidId);
+        for (uint32_t terminal = 0; terminal < parent_.size(); ++terminal) {
+            uint32_t net = find(terminal);
+            if (net_nodes[net] == kInvalidId) {
+                std::string node_name(devices_.name(terminal / 2));
+                node_name += '.';
+                Symbol label = labels_[terminal];
+                node_name += (label != kInvalidSymbol) ? terminal_names_.name(label)
+                                                       : kDefaultTerminalNames[terminal % 2];
+                net_nodes[net] = circuit_->createNode(node_name)->getHandle();
+            }
+            circuit_->connect(handles_[terminal / 2], net_nodes[net]);
+        }
+
+        circuit_->setName(name_);
+        result_.circuit = std::move(circuit_);
+        return std::move(result_);
+    }
+
+private:
+    Context context() const {
+        if (stack_.empty()) {
+            throw std::runtime_error("Netlist must be a JSON object");
+        }
+        return stack_.back();
+    }
+
+    void open(bool object) {
+        if (skip_ > 0) {
+            ++skip_;
+            return;
+        }
+        if (stack_.empty()) {
+            if (!object) {
+                throw std::runtime_error("Netlist must be a JSON object");
+            }
+            stack_.push_back(Context::Root);
+            return;
+        }
+        switch (stack_.back()) {
+            case Context::Root:
+                if (!object && key_ == "components") {
+                    stack_.push_back(Context::Components);
+                } else if (!object && key_ == "connections") {
+                    stack_.push_back(Context::Connections);
+                } else if (object && key_ == "simulation") {
+                    stack_.push_back(Context::Simulation);
+                } else {
+                    skip_ = 1;
+                }
+                break;
+            case Context::Components:
+                if (object) {
+                    stack_.push_back(Context::Component);
+                    id_.clear();
+                    type_.clear();
+                    parameter_count_ = 0;
+                } else {
+                    skip_ = 1;
+                }
+                break;
+            case Context::Component:
+                if (object && key_ == "parameters") {
+                    stack_.push_back(Context::Parameters);
+                } else {
+                    skip_ = 1;  // position and any other metadata
+                }
+                break;
+            case Context::Connections:
+                if (object) {
+                    stack_.push_back(Context::Connection);
+                    connection_id_.clear();
+                    from_.clear();
+                    to_.clear();
+                    from_node_.clear();
+                    to_node_.clear();
+                } else {
+                    skip_ = 1;
+                }
+                break;
+            default:
+                skip_ = 1;
+                break;
+        }
+    }
+
+    void close() {
+        if (skip_ > 0) {
+            --skip_;
+            return;
+        }
+        Context closed = stack_.back();
+        stack_.pop_back();
+        if (closed == Context::Component) {
+            finishComponent();
+        } else if (closed == Context::Connection) {
+            finishConnection();
+        }
+    }
+
+    // Names are kept in reused strings: the type may follow the parameters
+    void addParameter(double value) {
+        if (parameter_count_ == parameter_names_.size()) {
+            parameter_names_.emplace_back();
+            parameter_values_.emplace_back();
+        }
+        parameter_names_[parameter_count_] = key_;
+        parameter_values_[parameter_count_] = value;
+        ++parameter_count_;
+    }
+
+    struct TypeEntry {
+        Builtin builtin = Builtin::None;
+        const ParameterSchema* schema = nullptr;
+        ComponentFactory factory;
+    };
+
+    const TypeEntry& resolve(const std::string& type) {
+        auto it = types_.find(type);
+        if (it != types_.end()) {
+            return it->second;
+        }
+        TypeEntry entry;
+        if (type == "Resistor") {
+            entry.builtin = Builtin::Resistor;
+            entry.schema = &resistorSchema();
+        } else if (type == "Capacitor") {
+            entry.builtin = Builtin::Capacitor;
+            entry.schema = &capacitorSchema();
+        } else if (type == "VoltageSource") {
+            entry.builtin = Builtin::VoltageSource;
+            entry.schema = &voltageSourceSchema();
+        } else if (type == "CurrentSource") {
+            entry.builtin = Builtin::CurrentSource;
+            entry.schema = &currentSourceSchema();
+        } else if (options_.use_plugins) {
+            entry.factory = PluginManager::getInstance().resolveComponent(type);
+            entry.schema = entry.factory.schema;
+        }
+        if (entry.schema == nullptr) {
+            throw std::runtime_error("Unknown component type '" + type + "' for '" + id_ + "'");
+        }
+        return types_.emplace(type, entry).first->second;
+    }
+
+    void finishComponent() {
+        if (id_.empty()) {
+            throw std::runtime_error("Component without an id");
+        }
+        if (type_.empty()) {
+            throw std::runtime_error("Component '" + id_ + "' has no type");
+        }
+        Symbol device = deviceFor(id_);
+        if (handles_[device] != kInvalidId) {
+            throw std::runtime_error("Duplicate component id '" + id_ + "'");
+        }
+
+        const TypeEntry& entry = resolve(type_);
+        ParameterBlock parameters(*entry.schema);
+        for (size_t i = 0; i < parameter_count_; ++i) {
+            size_t slot = entry.schema->slot(parameter_names_[i]);
+            if (slot != ParameterSchema::kInvalidSlot) {
+                parameters.set(slot, parameter_values_[i]);
+            }
+        }
+
+        ComponentId handle = kInvalidId;
+        switch (entry.builtin) {
+            case Builtin::Resistor:
+                handle = circuit_->createComponent<Resistor>(id_, parameters.real(0))->getHandle();
+                break;
+            case Builtin::Capacitor:
+                handle = circuit_->createComponent<Capacitor>(id_, parameters.real(0))->getHandle();
+                break;
+            case Builtin::VoltageSource:
+                handle = circuit_->createComponent<VoltageSource>(id_, sourceWaveform(parameters))->getHandle();
+                break;
+            case Builtin::CurrentSource:
+                handle = circuit_->createComponent<CurrentSource>(id_, sourceWaveform(parameters))->getHandle();
+                break;
+            case Builtin::None: {
+                auto component = PluginManager::getInstance().createComponent(entry.factory, parameters);
+                if (!component) {
+                    throw std::runtime_error("Plugin failed to create '" + id_ + "' of type " + type_);
+                }
+                component->setId(id_);
+                handle = circuit_->addComponent(component);
+                break;
+            }
+        }
+        handles_[device] = handle;
+    }
+
+    void finishConnection() {
+        if (from_.empty() || to_.empty()) {
+            throw std::runtime_error("Connection '" + connection_id_ + "' needs both 'from' and 'to'");
+        }
+        uint32_t a = terminalFor(from_, from_node_);
+        uint32_t b = terminalFor(to_, to_node_);
+        uint32_t root_a = find(a);
+        uint32_t root_b = find(b);
+        if (root_a != root_b) {
+            // Keep the lower terminal as root so nets are named after their earliest member
+            if (root_a < root_b) {
+                parent_[root_b] = root_a;
+            } else {
+                parent_[root_a] = root_b;
+            }
+        }
+        ++result_.connections;
+    }
+
+    Symbol deviceFor(std::string_view id) {
+        Symbol device = devices_.intern(id);
+        if (device == handles_.size()) {
+            handles_.push_back(kInvalidId);
+            for (uint32_t terminal = 2 * device; terminal < 2 * device + 2; ++terminal) {
+                parent_.push_back(terminal);
+                labels_.push_back(kInvalidSymbol);
+            }
+        }
+        return device;
+    }
+
+    uint32_t terminalFor(const std::string& device_id, const std::string& terminal_name) {
+        int index = terminalIndex(terminal_name);
+        if (index < 0) {
+            throw std::runtime_error("Connection '" + connection_id_ + "' uses unknown terminal '" +
+                                     terminal_name + "' of '" + device_id + "'");
+        }
+        uint32_t terminal = 2 * deviceFor(device_id) + static_cast<uint32_t>(index);
+        if (labels_[terminal] == kInvalidSymbol) {
+            labels_[terminal] = terminal_names_.intern(terminal_name);
+        }
+        return terminal;
+    }
+
+    uint32_t find(uint32_t terminal) {
+        while (parent_[terminal] != terminal) {
+            parent_[terminal] = parent_[parent_[terminal]];  // path halving
+            terminal = parent_[terminal];
+        }
+        return terminal;
+    }
+
+    const JsonNetlistOptions& options_;
+    std::unique_ptr<Circuit> circuit_;
+    JsonNetlist result_;
+    std::string name_;
+
+    std::vector<Context> stack_;
+    size_t skip_ = 0;  // depth inside a subtree that is ignored
+    std::string key_;
+
+    // Component being read
+    std::string id_;
+    std::string type_;
+    std::vector<std::string> parameter_names_;
+    std::vector<double> parameter_values_;
+    size_t parameter_count_ = 0;
+    std::unordered_map<std::string, TypeEntry> types_;
+
+    // Connection being read
+    std::string connection_id_;
+    std::string from_;
+    std::string to_;
+    std::string from_node_;
+    std::string to_node_;
+
+    // Devices by first mention, with two terminals each (terminal = 2 * device + index)
+    SymbolTable devices_;
+    std::vector<ComponentId> handles_;
+    std::vector<uint32_t> parent_;
+    std::vector<Symbol> labels_;
+    SymbolTable terminal_names_;
+};
+
+} // namespace
+
+JsonNetlist loadJsonNetlist(std::istream& in, const JsonNetlistOptions& options) {
+    NetlistBuilder builder(options);
+    JsonReader reader(in, options.buffer_size);
+    reader.parse(builder);
+    JsonNetlist netlist = builder.finish();
+    netlist.bytes_read = reader.getBytesRead();
+    return netlist;
+}
+
+JsonNetlist loadJsonNetlistFile(const std::string& path, const JsonNetlistOptions& options) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("Cannot open netlist file: " + path);
+    }
+    return loadJsonNetlist(in, options);
+}
+
+} // namespace ic_sim
@@ -0,0 +1,305 @@
+#include "io/json_reader.h"
+#include <charconv>
+#include <cstring>
+
+namespace ic_sim {
+
+namespace {
+
+enum class State {
+    Value,        // a value is required
+    ObjectFirst,  // after '{': a key or '}'
+    ArrayFirst,   // after '[': a value or ']'
+    Key,          // after ',' in an object
+    After         // after a value: ',', a closing bracket or the end of input
+};
+
+bool isNumberChar(int c) {
+    return (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+}
+
+} // namespace
+
+JsonReader::JsonReader(std::istream& in, size_t buffer_size, size_t max_token_size)
+    : in_(in), buffer_(buffer_size > 0 ? buffer_size : 1), max_token_size_(max_token_size) {}
+
+bool JsonReader::refill() {
+    consumed_ += end_;
+    pos_ = 0;
+    end_ = 0;
+    in_.read(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+    end_ = static_cast<size_t>(in_.gcount());
+    return end_ > 0;
+}
+
+int JsonReader::skipWhitespace() {
+    for (;;) {
+        while (pos_ < end_) {
+            char c = buffer_[pos_];
+            if (c != ' ' && c != '\n' && c != '\r' && c != '\t') {
+                return static_cast<unsigned char>(c);
+            }
+            ++pos_;
+        }
+        if (!refill()) {
+            return -1;
+        }
+    }
+}
+
+void JsonReader::expect(char c, const char* message) {
+    if (skipWhitespace() != static_cast<unsigned char>(c)) {
+        fail(message);
+    }
+    ++pos_;
+}
+
+void JsonReader::parse(JsonHandler& handler) {
+    std::vector<char> stack;  // '{' or '['
+    State state = State::Value;
+    for (;;) {
+        int c = skipWhitespace();
+        switch (state) {
+            case State::Value:
+                if (c == '{') {
+                    ++pos_;
+                    stack.push_back('{');
+                    handler.startObject();
+                    state = State::ObjectFirst;
+                    continue;
+                }
+                if (c == '[') {
+                    ++pos_;
+                    stack.push_back('[');
+                    handler.startArray();
+                    state = State::ArrayFirst;
+                    continue;
+                }
+                if (c == '"') {
+                    readString();
+                    handler.string(token_);
+                } else if (c == '-' || (c >= '0' && c <= '9')) {
+                    readNumber();
+                    double value = 0.0;
+                    const char* last = token_.data() + token_.size();
+                    auto [ptr, error] = std::from_chars(token_.data(), last, value);
+                    if (error != std::errc() || ptr != last) {
+                        fail("Invalid number '" + token_ + "'");
+                    }
+                    handler.number(value);
+                } else if (c == 't') {
+                    readLiteral("true");
+                    handler.boolean(true);
+                } else if (c == 'f') {
+                    readLiteral("false");
+                    handler.boolean(false);
+                } else if (c == 'n') {
+                    readLiteral("null");
+                    handler.null();
+                } else {
+                    fail(c < 0 ? "Unexpected end of input" : "Expected a value");
+                }
+                state = State::After;
+                break;
+
+            case State::ObjectFirst:
+                if (c == '}') {
+                    ++pos_;
+                    stack.pop_back();
+                    handler.endObject();
+                    state = State::After;
+                    break;
+                }
+                state = State::Key;
+                break;
+
+            case State::ArrayFirst:
+                if (c == ']') {
+                    ++pos_;
+                    stack.pop_back();
+                    handler.endArray();
+                    state = State::After;
+                    break;
+                }
+                state = State::Value;
+                break;
+
+            case State::Key:
+                if (c != '"') {
+                    fail("Expected an object key");
+                }
+                readString();
+                handler.key(token_);
+                expect(':', "Expected ':' after an object key");
+                state = State::Value;
+                break;
+
+            case State::After:
+                if (stack.empty()) {
+                    if (c >= 0) {
+                        fail("Unexpected data after the document");
+                    }
+                    return;
+                }
+                if (c == ',') {
+                    ++pos_;
+                    state = (stack.back() == '{') ? State::Key : State::Value;
+                } else if (c == '}' && stack.back() == '{') {
+                    ++pos_;
+                    stack.pop_back();
+                    handler.endObject();
+                } else if (c == ']' && stack.back() == '[') {
+                    ++pos_;
+                    stack.pop_back();
+                    handler.endArray();
+                } else {
+                    fail(c < 0 ? "Unexpected end of input" : "Expected ',' or a closing bracket");
+                }
+                break;
+        }
+    }
+}
+
+void JsonReader::readString() {
+    ++pos_;  // opening quote
+    token_.clear();
+    for (;;) {
+        // Copy the run up to the next quote, escape or buffer end in one go
+        size_t start = pos_;
+        while (pos_ < end_) {
+            char c = buffer_[pos_];
+            if (c == '"' || c == '\\' || static_cast<unsigned char>(c) < 0x20) {
+                break;
+            }
+            ++pos_;
+        }
+        token_.append(buffer_.data() + start, pos_ - start);
+        checkTokenSize();
+        if (pos_ == end_) {
+            if (!refill()) {
+                fail("Unterminated string");
+            }
+            continue;
+        }
+
+        char c = buffer_[pos_++];
+        if (c == '"') {
+            return;
+        }
+        if (c != '\\') {
+            fail("Control character in string");
+        }
+        int escape = peek();
+        if (escape < 0) {
+            fail("Unterminated string");
+        }
+        ++pos_;
+        switch (escape) {
+            case '"': token_.push_back('"'); break;
+            case '\\': token_.push_back('\\'); break;
+            case '/': token_.push_back('/'); break;
+            case 'b': token_.push_back('\b'); break;
+            case 'f': token_.push_back('\f'); break;
+            case 'n': token_.push_back('\n'); break;
+            case 'r': token_.push_back('\r'); break;
+            case 't': token_.push_back('\t'); break;
+            case 'u': {
+                unsigned code_point = readHex4();
+                if (code_point >= 0xD800 && code_point < 0xDC00) {
+                    // High surrogate: a low one must follow
+                    if (peek() != '\\') {
+                        fail("Unpaired surrogate in string");
+                    }
+                    ++pos_;
+                    if (peek() != 'u') {
+                        fail("Unpaired surrogate in string");
+                    }
+                    ++pos_;
+                    unsigned low = readHex4();
+                    if (low < 0xDC00 || low >= 0xE000) {
+                        fail("Unpaired surrogate in string");
+                    }
+                    code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low - 0xDC00);
+                }
+                appendCodePoint(code_point);
+                break;
+            }
+            default:
+                fail("Invalid escape in string");
+        }
+    }
+}
+
+unsigned JsonReader::readHex4() {
+    unsigned value = 0;
+    for (int i = 0; i < 4; ++i) {
+        int c = peek();
+        unsigned digit;
+        if (c >= '0' && c <= '9') {
+            digit = static_cast<unsigned>(c - '0');
+        } else if (c >= 'a' && c <= 'f') {
+            digit = static_cast<unsigned>(c - 'a' + 10);
+        } else if (c >= 'A' && c <= 'F') {
+            digit = static_cast<unsigned>(c - 'A' + 10);
+        } else {
+            fail("Invalid \\u escape");
+        }
+        ++pos_;
+        value = value * 16 + digit;
+    }
+    return value;
+}
+
+void JsonReader::appendCodePoint(unsigned code_point) {
+    if (code_point < 0x80) {
+        token_.push_back(static_cast<char>(code_point));
+    } else if (code_point < 0x800) {
+        token_.push_back(static_cast<char>(0xC0 | (code_point >> 6)));
+        token_.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+    } else if (code_point < 0x10000) {
+        token_.push_back(static_cast<char>(0xE0 | (code_point >> 12)));
+        token_.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+        token_.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+    } else {
+        token_.push_back(static_cast<char>(0xF0 | (code_point >> 18)));
+        token_.push_back(static_cast<char>(0x80 | ((code_point >> 12) & 0x3F)));
+        token_.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+        token_.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+    }
+}
+
+void JsonReader::readNumber() {
+    token_.clear();
+    for (;;) {
+        size_t start = pos_;
+        while (pos_ < end_ && isNumberChar(static_cast<unsigned char>(buffer_[pos_]))) {
+            ++pos_;
+        }
+        token_.append(buffer_.data() + start, pos_ - start);
+        checkTokenSize();
+        if (pos_ < end_ || !refill()) {
+            return;
+        }
+    }
+}
+
+void JsonReader::readLiteral(const char* literal) {
+    for (const char* expected = literal; *expected; ++expected) {
+        if (peek() != static_cast<unsigned char>(*expected)) {
+            fail(std::string("Invalid literal, expected '") + literal + "'");
+        }
+        ++pos_;
+    }
+}
+
+void JsonReader::checkTokenSize() {
+    if (token_.size() > max_token_size_) {
+        fail("Token longer than " + std::to_string(max_token_size_) + " bytes");
+    }
+}
+
+void JsonReader::fail(const std::string& message) const {
+    throw JsonError(message, getBytesRead());
+}
+
+} // namespace ic_sim
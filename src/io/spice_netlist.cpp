@@ -0,0 +1,1078 @@
+#include "io/spice_netlist.h"
+#include "core/parameter_schema.h"
+#include "core/sources.h"
+#include "core/symbol_table.h"
+#include "core/thread_pool.h"
+#include "io/mapped_file.h"
+#include "plugins/plugin_system.h"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace ic_sim {
+
+namespace {
+
+constexpr size_t kMaxIncludeDepth = 16;
+constexpr size_t kMaxSubcircuitDepth = 64;
+constexpr double kPi = 3.14159265358979323846;
+
+char lower(char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+bool isAlpha(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+bool iequals(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (lower(a[i]) != lower(b[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string lowercase(std::string_view text) {
+    std::string result(text);
+    for (char& c : result) {
+        c = lower(c);
+    }
+    return result;
+}
+
+// Scale of the letters after a number; anything that is not a scale is a unit
+double suffixScale(std::string_view letters) {
+    if (letters.empty()) {
+        return 1.0;
+    }
+    if (letters.size() >= 3 && iequals(letters.substr(0, 3), "meg")) {
+        return 1e6;
+    }
+    if (letters.size() >= 3 && iequals(letters.substr(0, 3), "mil")) {
+        return 25.4e-6;
+    }
+    switch (lower(letters[0])) {
+        case 't': return 1e12;
+        case 'g': return 1e9;
+        case 'k': return 1e3;
+        case 'm': return 1e-3;
+        case 'u': return 1e-6;
+        case 'n': return 1e-9;
+        case 'p': return 1e-12;
+        case 'f': return 1e-15;
+        case 'a': return 1e-18;
+        default: return 1.0;
+    }
+}
+
+// Parses a number and its suffix letters from the start of text; returns the
+// characters used, 0 if text does not start with a number
+size_t scanNumber(std::string_view text, double& value) {
+    size_t start = (!text.empty() && text[0] == '+') ? 1 : 0;  // from_chars rejects '+'
+    size_t digit = (start < text.size() && text[start] == '-') ? start + 1 : start;
+    if (digit >= text.size() || !(isDigit(text[digit]) || text[digit] == '.')) {
+        return 0;
+    }
+    auto [ptr, error] = std::from_chars(text.data() + start, text.data() + text.size(), value);
+    if (error != std::errc()) {
+        return 0;
+    }
+    size_t used = static_cast<size_t>(ptr - text.data());
+    size_t end = used;
+    while (end < text.size() && isAlpha(text[end])) {
+        ++end;
+    }
+    value *= suffixScale(text.substr(used, end - used));
+    return end;
+}
+
+/**
+ * Recursive-descent evaluator for parameter expressions
+ * Throws std::invalid_argument; the caller adds the deck location.
+ */
+class ExpressionParser {
+public:
+    using Lookup = std::function<bool(std::string_view, double&)>;
+
+    ExpressionParser(std::string_view text, const Lookup& lookup) : text_(text), lookup_(lookup) {}
+
+    double evaluate() {
+        double value = additive();
+        skip();
+        if (pos_ != text_.size()) {
+            fail("Unexpected '" + std::string(1, text_[pos_]) + "'");
+        }
+        return value;
+    }
+
+private:
+    void skip() {
+        while (pos_ < text_.size() && (isSpace(text_[pos_]) || text_[pos_] == '\n')) {
+            ++pos_;
+        }
+    }
+
+    bool match(char c) {
+        skip();
+        if (pos_ < text_.size() && text_[pos_] == c) {
+            ++pos_;
+            return true;
+        }
+        return false;
+    }
+
+    bool matchPower() {
+        skip();
+        if (text_.compare(pos_, 2, "**") == 0) {
+            pos_ += 2;
+            return true;
+        }
+        return match('^');
+    }
+
+    double additive() {
+        double value = term();
+        for (;;) {
+            if (match('+')) {
+                value += term();
+            } else if (match('-')) {
+                value -= term();
+            } else {
+                return value;
+            }
+        }
+    }
+
+    double term() {
+        double value = unary();
+        for (;;) {
+            if (match('*')) {
+                value *= unary();
+            } else if (match('/')) {
+                value /= unary();
+            } else {
+                return value;
+            }
+        }
+    }
+
+    // Unary minus binds looser than ^, so -2^2 is -4
+    double unary() {
+        if (match('-')) {
+            return -unary();
+        }
+        if (match('+')) {
+            return unary();
+        }
+        double base = primary();
+        return matchPower() ? std::pow(base, unary()) : base;
+    }
+
+    double primary() {
+        skip();
+        if (match('(')) {
+            double value = additive();
+            if (!match(')')) {
+                fail("Missing ')'");
+            }
+            return value;
+        }
+        double number = 0.0;
+        size_t used = scanNumber(text_.substr(pos_), number);
+        if (used > 0) {
+            pos_ += used;
+            return number;
+        }
+        if (pos_ < text_.size() && (isAlpha(text_[pos_]) || text_[pos_] == '_')) {
+            size_t begin = pos_;
+            while (pos_ < text_.size() && (isAlpha(text_[pos_]) || isDigit(text_[pos_]) || text_[pos_] == '_')) {
+                ++pos_;
+            }
+            std::string_view name = text_.substr(begin, pos_ - begin);
+            if (match('(')) {
+                std::vector<double> args;
+                if (!match(')')) {
+                    do {
+                        args.push_back(additive());
+                    } while (match(','));
+                    if (!match(')')) {
+                        fail("Missing ')' after arguments of " + std::string(name));
+                    }
+                }
+                return call(lowercase(name), args);
+            }
+            double value = 0.0;
+            if (lookup_(name, value)) {
+                return value;
+            }
+            if (iequals(name, "pi")) {
+                return kPi;
+            }
+            fail("Undefined parameter '" + std::string(name) + "'");
+        }
+        fail(pos_ < text_.size() ? "Expected a value" : "Unexpected end of expression");
+    }
+
+    double call(const std::string& name, const std::vector<double>& args) {
+        if (args.size() == 1) {
+            double x = args[0];
+            if (name == "sqrt") return std::sqrt(x);
+            if (name == "exp") return std::exp(x);
+            if (name == "log" || name == "ln") return std::log(x);
+            if (name == "log10") return std::log10(x);
+            if (name == "abs") return std::abs(x);
+            if (name == "sin") return std::sin(x);
+            if (name == "cos") return std::cos(x);
+            if (name == "tan") return std::tan(x);
+            if (name == "atan") return std::atan(x);
+            if (name == "sinh") return std::sinh(x);
+            if (name == "cosh") return std::cosh(x);
+            if (name == "tanh") return std::tanh(x);
+            if (name == "floor") return std::floor(x);
+            if (name == "ceil") return std::ceil(x);
+        } else if (args.size() == 2) {
+            if (name == "min") return std::min(args[0], args[1]);
+            if (name == "max") return std::max(args[0], args[1]);
+            if (name == "pow" || name == "pwr") return std::pow(args[0], args[1]);
+            if (name == "atan2") return std::atan2(args[0], args[1]);
+        }
+        fail("Unknown function " + name + " with " + std::to_string(args.size()) + " argument(s)");
+    }
+
+    [[noreturn]] void fail(const std::string& message) const {
+        throw std::invalid_argument(message + " in '" + std::string(text_) + "'");
+    }
+
+    std::string_view text_;
+    const Lookup& lookup_;
+    size_t pos_ = 0;
+};
+
+enum class FieldKind : uint8_t {
+    Number,
+    Text,
+    Equals
+};
+
+struct Field {
+    double number = 0.0;
+    // Text fields, and the spelling of numbers since those may be node names
+    // ("5V", "3V3", "1k")
+    Symbol text = kInvalidSymbol;
+    FieldKind kind = FieldKind::Text;
+};
+
+struct Card {
+    uint32_t first;  // index of the first field
+    uint32_t count;
+    uint32_t line;   // within the chunk, 1-based
+};
+
+// Tokenized slice of a deck. Fields are tokenized against the chunk's own
+// table, then resolve() moves them to the deck's.
+struct Chunk {
+    SymbolTable names;
+    std::vector<Field> fields;
+    std::vector<Card> cards;
+    uint32_t lines = 0;
+};
+
+// Splits one physical line into fields. Parentheses and commas separate
+// fields like blanks do; {expr}, 'expr' and "text" are kept whole.
+void tokenizeLine(std::string_view line, Chunk& chunk) {
+    size_t i = 0;
+    while (i < line.size()) {
+        char c = line[i];
+        if (isSpace(c) || c == ',' || c == '(' || c == ')') {
+            ++i;
+            continue;
+        }
+        if (c == ';' || (c == '$' && (i == 0 || isSpace(line[i - 1])))) {
+            break;  // inline comment
+        }
+        Field field;
+        if (c == '=') {
+            field.kind = FieldKind::Equals;
+            chunk.fields.push_back(field);
+            ++i;
+            continue;
+        }
+
+        size_t begin = i;
+        size_t end = i;
+        size_t next = i;
+        if (c == '{') {
+            int depth = 0;
+            for (end = i; end < line.size(); ++end) {
+                depth += (line[end] == '{') - (line[end] == '}');
+                if (depth == 0) {
+                    break;
+                }
+            }
+            begin = i + 1;
+            next = end + 1;
+        } else if (c == '\'' || c == '"') {
+            end = std::min(line.find(c, i + 1), line.size());
+            begin = i + 1;
+            next = end + 1;
+        } else {
+            while (end < line.size() && !isSpace(line[end]) && line[end] != ',' && line[end] != '(' &&
+                   line[end] != ')' && line[end] != '=' && line[end] != ';') {
+                ++end;
+            }
+            next = end;
+            std::string_view token = line.substr(begin, end - begin);
+            double value = 0.0;
+            if (scanNumber(token, value) == token.size()) {
+                field.kind = FieldKind::Number;
+                field.number = value;
+            }
+        }
+        field.text = chunk.names.intern(line.substr(begin, end - begin));
+        chunk.fields.push_back(field);
+        i = std::min(next, line.size());
+    }
+}
+
+// Joins continuation lines ('+' in the first column) into cards and drops comments
+void tokenize(std::string_view text, Chunk& chunk) {
+    size_t pos = 0;
+    uint32_t line = 0;
+    while (pos < text.size()) {
+        size_t eol = std::min(text.find('\n', pos), text.size());
+        std::string_view physical = text.substr(pos, eol - pos);
+        pos = eol + 1;
+        ++line;
+
+        size_t start = 0;
+        while (start < physical.size() && isSpace(physical[start])) {
+            ++start;
+        }
+        if (start == physical.size() || physical[start] == '*') {
+            continue;
+        }
+        bool continuation = physical[start] == '+';
+        if (continuation) {
+            ++start;
+        }
+        if (!continuation || chunk.cards.empty()) {
+            chunk.cards.push_back({static_cast<uint32_t>(chunk.fields.size()), 0, line});
+        }
+        tokenizeLine(physical.substr(start), chunk);
+        Card& card = chunk.cards.back();
+        card.count = static_cast<uint32_t>(chunk.fields.size()) - card.first;
+    }
+    chunk.lines = line;
+}
+
+// Interns the chunk's names into the deck's table and rewrites its fields to
+// deck symbols; runs in the chunk's task, so no names are merged on the thread
+// that applies the cards
+void resolve(Chunk& chunk, ConcurrentSymbolTable& deck) {
+    std::vector<Symbol> remap(chunk.names.size());
+    for (Symbol symbol = 0; symbol < remap.size(); ++symbol) {
+        remap[symbol] = deck.intern(chunk.names.name(symbol));
+    }
+    for (Field& field : chunk.fields) {
+        if (field.text != kInvalidSymbol) {
+            field.text = remap[field.text];
+        }
+    }
+    chunk.names.clear();
+}
+
+// End of the chunk starting at begin: the first line start at or after
+// begin + chunk_size that does not continue the previous card
+size_t chunkEnd(std::string_view text, size_t begin, size_t chunk_size) {
+    size_t candidate = begin + chunk_size;
+    while (candidate < text.size()) {
+        size_t newline = text.find('\n', candidate);
+        if (newline == std::string_view::npos) {
+            break;
+        }
+        size_t next = newline + 1;
+        size_t first = next;
+        while (first < text.size() && isSpace(text[first])) {
+            ++first;
+        }
+        // Comment lines may sit between a card and its continuation
+        if (first < text.size() && (text[first] == '+' || text[first] == '*')) {
+            candidate = next;
+            continue;
+        }
+        return next;
+    }
+    return text.size();
+}
+
+class SpiceLoader {
+public:
+    explicit SpiceLoader(const SpiceOptions& options)
+        : options_(options), circuit_(std::make_unique<Circuit>("")) {
+        zero_ = names_.intern("0");
+    }
+
+    SpiceNetlist load(std::string_view deck, const std::string& file, const std::string& dir) {
+        // The first line of a deck is its title
+        size_t title_end = std::min(deck.find('\n'), deck.size());
+        std::string_view title = deck.substr(0, title_end);
+        while (!title.empty() && isSpace(title.back())) {
+            title.remove_suffix(1);
+        }
+        result_.title = std::string(title);
+        result_.bytes += deck.size();
+
+        files_.push_back(file);
+        std::string_view body = (title_end < deck.size()) ? deck.substr(title_end + 1) : std::string_view();
+        readDeck(body, &files_.back(), dir, 0, 1);
+
+        if (!defining_.empty()) {
+            const Subcircuit& open = *defining_.back();
+            throw SpiceError("Missing .ends for subcircuit", *open.file, open.line);
+        }
+        circuit_->setName(result_.title);
+        result_.circuit = std::move(circuit_);
+        result_.files.assign(files_.begin(), files_.end());
+        return std::move(result_);
+    }
+
+private:
+    struct Location {
+        const std::string* file;
+        uint32_t line;
+    };
+
+    struct Statement {
+        std::vector<Field> fields;
+        Location at;
+    };
+
+    struct Subcircuit {
+        std::vector<Symbol> pins;
+        std::vector<std::pair<Symbol, Field>> params;  // folded name, default
+        std::vector<Statement> body;
+        const std::string* file;
+        uint32_t line;
+    };
+
+    struct Model {
+        Symbol type;
+        std::vector<std::pair<Symbol, double>> params;  // folded names
+    };
+
+    struct Scope {
+        const Scope* parent = nullptr;
+        std::string prefix;                          // instance path, "X1.X2."
+        std::unordered_map<Symbol, double> params;   // folded names
+        std::unordered_map<Symbol, NodeId> pins;     // subcircuit pins to the caller's nodes
+    };
+
+    // Tokenizes chunks ahead on the shared thread pool and applies them in file
+    // order
+    void readDeck(std::string_view text, const std::string* file, const std::string& dir, size_t depth,
+                  uint32_t line_base) {
+        ThreadPool& pool = ThreadPool::shared();
+        size_t threads = options_.threads;
+        if (threads == 0) {
+            threads = pool.getThreadCount();
+        }
+        size_t chunk_size = std::max<size_t>(options_.chunk_size, 1);
+
+        struct Pending {
+            explicit Pending(ThreadPool& pool) : group(pool) {}
+            TaskGroup group;
+            Chunk chunk;
+        };
+        std::deque<std::unique_ptr<Pending>> pending;
+        size_t next = 0;
+        auto launch = [&]() {
+            size_t end = chunkEnd(text, next, chunk_size);
+            std::string_view piece = text.substr(next, end - next);
+            next = end;
+            pending.push_back(std::make_unique<Pending>(pool));
+            Chunk* chunk = &pending.back()->chunk;
+            auto task = [this, piece, chunk]() {
+                tokenize(piece, *chunk);
+                resolve(*chunk, names_);
+            };
+            if (threads > 1) {
+                pending.back()->group.run(task);
+            } else {
+                task();
+            }
+        };
+
+        while (next < text.size() && pending.size() < threads) {
+            launch();
+        }
+        while (!pending.empty() && !ended_) {
+            std::unique_ptr<Pending> front = std::move(pending.front());
+            pending.pop_front();
+            front->group.wait();
+            if (next < text.size()) {
+                launch();
+            }
+            apply(front->chunk, file, dir, depth, line_base);
+            line_base += front->chunk.lines;
+        }
+    }
+
+    // Runs the cards of a resolved chunk
+    void apply(const Chunk& chunk, const std::string* file, const std::string& dir, size_t depth,
+               uint32_t line_base) {
+        for (const Card& card : chunk.cards) {
+            if (ended_) {
+                return;
+            }
+            if (card.count == 0) {
+                continue;
+            }
+            ++result_.cards;
+            statement(chunk.fields.data() + card.first, card.count, Location{file, line_base + card.line}, dir,
+                      depth);
+        }
+    }
+
+    // Definition pass: includes and subcircuit bodies are handled here, in file order
+    void statement(const Field* f, size_t n, Location at, const std::string& dir, size_t depth) {
+        std::string_view head = text(f[0]);
+        if (in_control_) {
+            in_control_ = !iequals(head, ".endc");
+            return;
+        }
+        if (!head.empty() && head[0] == '.') {
+            if (iequals(head, ".include") || iequals(head, ".inc")) {
+                include(f, n, at, dir, depth);
+                return;
+            }
+            if (iequals(head, ".subckt")) {
+                defineSubcircuit(f, n, at);
+                return;
+            }
+            if (iequals(head, ".ends")) {
+                if (defining_.empty()) {
+                    fail(at, ".ends without .subckt");
+                }
+                defining_.pop_back();
+                return;
+            }
+            if (iequals(head, ".end")) {
+                ended_ = true;
+                return;
+            }
+            if (iequals(head, ".control")) {
+                in_control_ = true;  // interactive script, not netlist
+                return;
+            }
+        }
+        if (!defining_.empty()) {
+            defining_.back()->body.push_back(Statement{std::vector<Field>(f, f + n), at});
+            return;
+        }
+        execute(f, n, at, root_);
+    }
+
+    void include(const Field* f, size_t n, Location at, const std::string& dir, size_t depth) {
+        if (n < 2 || f[1].text == kInvalidSymbol) {
+            fail(at, "Expected a file name after .include");
+        }
+        if (depth + 1 > kMaxIncludeDepth) {
+            fail(at, "Includes nested too deeply");
+        }
+        std::filesystem::path path(std::string(text(f[1])));
+        if (path.is_relative()) {
+            path = std::filesystem::path(dir) / path;
+        }
+        std::optional<MappedFile> file;
+        try {
+            file.emplace(path.string());
+        } catch (const std::runtime_error&) {
+            fail(at, "Cannot open include file " + path.string());
+        }
+        result_.bytes += file->size();
+        files_.push_back(path.string());
+        readDeck(file->view(), &files_.back(), path.parent_path().string(), depth + 1, 0);
+    }
+
+    void defineSubcircuit(const Field* f, size_t n, Location at) {
+        if (n < 2 || f[1].kind != FieldKind::Text) {
+            fail(at, "Expected a subcircuit name after .subckt");
+        }
+        Subcircuit definition;
+        definition.file = at.file;
+        definition.line = at.line;
+        size_t j = 2;
+        while (j < n && !isParamsKeyword(f[j]) && !(j + 1 < n && f[j + 1].kind == FieldKind::Equals)) {
+            if (f[j].text == kInvalidSymbol) {
+                fail(at, "Invalid subcircuit pin");
+            }
+            definition.pins.push_back(f[j].text);
+            ++j;
+        }
+        if (j < n && isParamsKeyword(f[j])) {
+            ++j;
+        }
+        for (; j < n; j += 3) {
+            checkAssignment(f, n, j, at);
+            definition.params.emplace_back(fold(f[j].text), f[j + 2]);
+        }
+        auto [it, inserted] = subcircuits_.emplace(fold(f[1].text), std::move(definition));
+        if (!inserted) {
+            fail(at, "Duplicate subcircuit " + std::string(text(f[1])));
+        }
+        defining_.push_back(&it->second);
+    }
+
+    void execute(const Field* f, size_t n, Location at, Scope& scope) {
+        std::string_view head = text(f[0]);
+        if (head.empty()) {
+            fail(at, "Expected an element name or a dot card");
+        }
+        if (head[0] == '.') {
+            directive(head, f, n, at, scope);
+            return;
+        }
+        switch (lower(head[0])) {
+            case 'r':
+            case 'c':
+            case 'l':
+                passive(lower(head[0]), f, n, at, scope);
+                break;
+            case 'v':
+            case 'i':
+                source(lower(head[0]) == 'v', f, n, at, scope);
+                break;
+            case 'd':
+                diode(f, n, at, scope);
+                break;
+            case 'x':
+                instantiate(f, n, at, scope);
+                break;
+            default:
+                fail(at, "Unsupported element " + std::string(head));
+        }
+    }
+
+    void directive(std::string_view head, const Field* f, size_t n, Location at, Scope& scope) {
+        if (iequals(head, ".param")) {
+            for (size_t j = 1; j < n; j += 3) {
+                checkAssignment(f, n, j, at);
+                scope.params[fold(f[j].text)] = value(f[j + 2], scope, at);
+            }
+        } else if (iequals(head, ".model")) {
+            if (n < 3 || f[1].text == kInvalidSymbol || f[2].text == kInvalidSymbol) {
+                fail(at, "Expected .model <name> <type>");
+            }
+            Model model;
+            model.type = fold(f[2].text);
+            for (size_t j = 3; j < n; j += 3) {
+                checkAssignment(f, n, j, at);
+                model.params.emplace_back(fold(f[j].text), value(f[j + 2], scope, at));
+            }
+            models_[fold(f[1].text)] = std::move(model);
+        } else if (iequals(head, ".global")) {
+            for (size_t j = 1; j < n; ++j) {
+                if (f[j].text != kInvalidSymbol) {
+                    globals_.insert(f[j].text);
+                }
+            }
+        } else if (iequals(head, ".tran")) {
+            if (n < 3) {
+                fail(at, "Expected .tran <step> <stop>");
+            }
+            result_.simulation.timestep = value(f[1], scope, at);
+            result_.simulation.duration = value(f[2], scope, at);
+            result_.simulation.type = "transient";
+        }
+        // Analysis, output and option cards have no effect on the circuit
+    }
+
+    void passive(char kind, const Field* f, size_t n, Location at, Scope& scope) {
+        if (n < 4) {
+            fail(at, "Expected <name> <node> <node> <value>");
+        }
+        NodeId a = node(f[1], scope, at);
+        NodeId b = node(f[2], scope, at);
+        size_t index = (n > 5 && f[4].kind == FieldKind::Equals) ? 5 : 3;  // R1 a b r=1k
+        double parameter = value(f[index], scope, at);
+        std::string name = scope.prefix + std::string(text(f[0]));
+
+        ComponentId id = kInvalidId;
+        if (kind == 'r') {
+            id = create<Resistor>(name, at, parameter);
+        } else if (kind == 'c') {
+            id = create<Capacitor>(name, at, parameter);
+        } else {
+            const ComponentFactory& factory = plugin("Inductor", inductor_, at);
+            ParameterBlock block(*factory.schema);
+            setParameter(block, "inductance", parameter);
+            id = addPluginComponent(factory, block, name, at);
+        }
+        circuit_->connect(id, a);
+        circuit_->connect(id, b);
+    }
+
+    bool isSourceKeyword(const Field& field) const {
+        if (field.kind != FieldKind::Text) {
+            return false;
+        }
+        std::string_view word = text(field);
+        return iequals(word, "dc") || iequals(word, "ac") || iequals(word, "sin") || iequals(word, "pulse") ||
+               iequals(word, "pwl");
+    }
+
+    void source(bool voltage, const Field* f, size_t n, Location at, Scope& scope) {
+        if (n < 3) {
+            fail(at, "Expected <name> <node> <node> [value]");
+        }
+        NodeId a = node(f[1], scope, at);
+        NodeId b = node(f[2], scope, at);
+
+        double dc = 0.0;
+        std::optional<Waveform> waveform;
+        size_t i = 3;
+        while (i < n) {
+            std::string_view word = (f[i].kind == FieldKind::Text) ? text(f[i]) : std::string_view();
+            if (iequals(word, "dc")) {
+                if (i + 1 >= n) {
+                    fail(at, "Expected a value after DC");
+                }
+                dc = value(f[i + 1], scope, at);
+                i += 2;
+            } else if (iequals(word, "ac")) {
+                // Magnitude and phase only matter to AC analysis
+                for (++i; i < n && !isSourceKeyword(f[i]); ++i) {
+                }
+            } else if (iequals(word, "sin") || iequals(word, "pulse") || iequals(word, "pwl")) {
+                std::vector<double> args;
+                size_t j = i + 1;
+                for (; j < n && !isSourceKeyword(f[j]); ++j) {
+                    args.push_back(value(f[j], scope, at));
+                }
+                waveform = makeWaveform(word, args, at);
+                i = j;
+            } else {
+                dc = value(f[i], scope, at);
+                ++i;
+            }
+        }
+
+        std::string name = scope.prefix + std::string(text(f[0]));
+        ComponentId id;
+        if (voltage) {
+            id = waveform ? create<VoltageSource>(name, at, *waveform) : create<VoltageSource>(name, at, dc);
+        } else {
+            id = waveform ? create<CurrentSource>(name, at, *waveform) : create<CurrentSource>(name, at, dc);
+        }
+        circuit_->connect(id, a);
+        circuit_->connect(id, b);
+    }
+
+    Waveform makeWaveform(std::string_view kind, const std::vector<double>& a, Location at) {
+        auto arg = [&](size_t k, double fallback) { return (k < a.size()) ? a[k] : fallback; };
+        if (iequals(kind, "sin")) {
+            if (a.size() < 3) {
+                fail(at, "SIN needs at least offset, amplitude and frequency");
+            }
+            return Waveform::sine(a[0], a[1], a[2], arg(3, 0.0), arg(4, 0.0), arg(5, 0.0));
+        }
+        if (iequals(kind, "pulse")) {
+            if (a.size() < 2) {
+                fail(at, "PULSE needs at least the initial and pulsed values");
+            }
+            return Waveform::pulse(a[0], a[1], arg(2, 0.0), arg(3, 0.0), arg(4, 0.0),
+                                   arg(5, std::numeric_limits<double>::infinity()), arg(6, 0.0));
+        }
+        if (a.size() < 2 || a.size() % 2 != 0) {
+            fail(at, "PWL needs time/value pairs");
+        }
+        std::vector<std::pair<double, double>> points;
+        for (size_t k = 0; k < a.size(); k += 2) {
+            points.emplace_back(a[k], a[k + 1]);
+        }
+        try {
+            return Waveform::pwl(std::move(points));
+        } catch (const std::invalid_argument& e) {
+            fail(at, e.what());
+        }
+    }
+
+    // D<name> <anode> <cathode> <model>; model parameters are matched to the
+    // Diode plugin schema by name
+    void diode(const Field* f, size_t n, Location at, Scope& scope) {
+        if (n < 4 || f[3].text == kInvalidSymbol) {
+            fail(at, "Expected <name> <anode> <cathode> <model>");
+        }
+        NodeId a = node(f[1], scope, at);
+        NodeId b = node(f[2], scope, at);
+        auto model = models_.find(fold(f[3].text));
+        if (model == models_.end()) {
+            fail(at, "Unknown model " + std::string(text(f[3])));
+        }
+        if (text(model->second.type) != "d") {
+            fail(at, "Model " + std::string(text(f[3])) + " is not a diode model");
+        }
+        const ComponentFactory& factory = plugin("Diode", diode_, at);
+        ParameterBlock block(*factory.schema);
+        for (const auto& [parameter, number] : model->second.params) {
+            setParameter(block, text(parameter), number);
+        }
+        ComponentId id = addPluginComponent(factory, block, scope.prefix + std::string(text(f[0])), at);
+        circuit_->connect(id, a);
+        circuit_->connect(id, b);
+    }
+
+    // X<name> <pins...> <subcircuit> [params:] [name=value ...]
+    void instantiate(const Field* f, size_t n, Location at, Scope& scope) {
+        if (depth_ >= kMaxSubcircuitDepth) {
+            fail(at, "Subcircuits nested too deeply (recursive definition?)");
+        }
+        size_t end = n;
+        for (size_t j = 1; j < n; ++j) {
+            if (f[j].kind == FieldKind::Equals) {
+                end = j - 1;
+                break;
+            }
+            if (isParamsKeyword(f[j])) {
+                end = j;
+                break;
+            }
+        }
+        if (end < 2 || f[end - 1].text == kInvalidSymbol) {
+            fail(at, "Expected <name> <nodes...> <subcircuit>");
+        }
+        auto it = subcircuits_.find(fold(f[end - 1].text));
+        if (it == subcircuits_.end()) {
+            fail(at, "Unknown subcircuit " + std::string(text(f[end - 1])));
+        }
+        const Subcircuit& definition = it->second;
+        size_t pins = end - 2;
+        if (pins != definition.pins.size()) {
+            fail(at, "Subcircuit " + std::string(text(f[end - 1])) + " has " +
+                         std::to_string(definition.pins.size()) + " pins, got " + std::to_string(pins));
+        }
+
+        Scope child;
+        child.parent = &scope;
+        child.prefix = scope.prefix + std::string(text(f[0])) + ".";
+        for (size_t k = 0; k < pins; ++k) {
+            child.pins[definition.pins[k]] = node(f[1 + k], scope, at);
+        }
+        // Instance values are evaluated where the instance is written, defaults
+        // inside the new scope so they can refer to earlier parameters
+        size_t j = (end < n && isParamsKeyword(f[end])) ? end + 1 : end;
+        for (; j < n; j += 3) {
+            checkAssignment(f, n, j, at);
+            child.params[fold(f[j].text)] = value(f[j + 2], scope, at);
+        }
+        for (const auto& [parameter, fallback] : definition.params) {
+            if (child.params.count(parameter) == 0) {
+                child.params[parameter] = value(fallback, child, Location{definition.file, definition.line});
+            }
+        }
+
+        ++result_.subcircuit_instances;
+        ++depth_;
+        for (const Statement& statement : definition.body) {
+            execute(statement.fields.data(), statement.fields.size(), statement.at, child);
+        }
+        --depth_;
+    }
+
+    NodeId node(const Field& field, const Scope& scope, Location at) {
+        Symbol symbol = field.text;
+        if (symbol == kInvalidSymbol) {
+            fail(at, "Invalid node name");
+        }
+        if (symbol == zero_ || iequals(text(symbol), "gnd")) {
+            symbol = zero_;
+        } else if (scope.parent != nullptr && globals_.count(symbol) == 0) {
+            auto pin = scope.pins.find(symbol);
+            if (pin != scope.pins.end()) {
+                return pin->second;
+            }
+            symbol = names_.intern(scope.prefix + std::string(text(symbol)));
+        }
+        // Every node the loader creates is found through the deck symbol of its
+        // full name, so top-level nodes cost no string lookup once resolved
+        if (symbol >= nodes_.size()) {
+            nodes_.resize(names_.size(), kInvalidId);
+        }
+        if (nodes_[symbol] == kInvalidId) {
+            nodes_[symbol] = circuit_->createNode(std::string(text(symbol)))->getHandle();
+        }
+        return nodes_[symbol];
+    }
+
+    // Builds a device in the circuit's arena; the circuit rejects a taken name
+    template <typename T, typename... Args>
+    ComponentId create(const std::string& name, Location at, Args&&... args) {
+        try {
+            return circuit_->createComponent<T>(name, std::forward<Args>(args)...)->getHandle();
+        } catch (const std::invalid_argument&) {
+            fail(at, "Duplicate element " + name);
+        }
+    }
+
+    double value(const Field& field, const Scope& scope, Location at) {
+        if (field.kind == FieldKind::Number) {
+            return field.number;
+        }
+        if (field.kind == FieldKind::Equals) {
+            fail(at, "Unexpected '='");
+        }
+        std::string_view expression = text(field);
+        double number = 0.0;
+        if (parseSpiceNumber(expression, number)) {
+            return number;
+        }
+        ExpressionParser::Lookup lookup = [&](std::string_view name, double& out) {
+            Symbol key = names_.find(lowercase(name));
+            if (key == kInvalidSymbol) {
+                return false;
+            }
+            for (const Scope* s = &scope; s != nullptr; s = s->parent) {
+                auto it = s->params.find(key);
+                if (it != s->params.end()) {
+                    out = it->second;
+                    return true;
+                }
+            }
+            return false;
+        };
+        try {
+            return ExpressionParser(expression, lookup).evaluate();
+        } catch (const std::invalid_argument& e) {
+            fail(at, e.what());
+        }
+    }
+
+    const ComponentFactory& plugin(const std::string& type, ComponentFactory& cache, Location at) {
+        if (!cache) {
+            cache = PluginManager::getInstance().resolveComponent(type);
+            if (!cache) {
+                fail(at, type + " elements need a loaded plugin that provides " + type);
+            }
+        }
+        return cache;
+    }
+
+    ComponentId addPluginComponent(const ComponentFactory& factory, const ParameterBlock& block,
+                                   const std::string& name, Location at) {
+        if (circuit_->findComponent(name) != kInvalidId) {
+            fail(at, "Duplicate element " + name);
+        }
+        auto component = PluginManager::getInstance().createComponent(factory, block);
+        if (!component) {
+            fail(at, "Plugin failed to create " + name);
+        }
+        component->setId(name);
+        return circuit_->addComponent(component);
+    }
+
+    static void setParameter(ParameterBlock& block, std::string_view name, double number) {
+        size_t slot = block.getSchema().slot(name);
+        if (slot != ParameterSchema::kInvalidSlot) {
+            block.set(slot, number);
+        }
+    }
+
+    bool isParamsKeyword(const Field& field) const {
+        return field.kind == FieldKind::Text && iequals(text(field), "params:");
+    }
+
+    void checkAssignment(const Field* f, size_t n, size_t j, Location at) const {
+        if (j + 2 >= n || f[j].kind != FieldKind::Text || f[j + 1].kind != FieldKind::Equals) {
+            fail(at, "Expected name=value");
+        }
+    }
+
+    // Lower-case spelling of a symbol, interned once per symbol
+    Symbol fold(Symbol symbol) {
+        if (symbol >= folded_.size()) {
+            folded_.resize(names_.size(), kInvalidSymbol);
+        }
+        if (folded_[symbol] == kInvalidSymbol) {
+            Symbol folded = names_.intern(lowercase(names_.name(symbol)));
+            folded_[symbol] = folded;
+        }
+        return folded_[symbol];
+    }
+
+    std::string_view text(Symbol symbol) const { return names_.name(symbol); }
+    std::string_view text(const Field& field) const {
+        return (field.text != kInvalidSymbol) ? names_.name(field.text) : std::string_view();
+    }
+
+    [[noreturn]] static void fail(Location at, const std::string& message) {
+        throw SpiceError(message, *at.file, at.line);
+    }
+
+    const SpiceOptions& options_;
+    std::unique_ptr<Circuit> circuit_;
+    SpiceNetlist result_;
+
+    ConcurrentSymbolTable names_;
+    std::vector<Symbol> folded_;
+    Symbol zero_;
+
+    Scope root_;
+    std::unordered_map<Symbol, Subcircuit> subcircuits_;
+    std::vector<Subcircuit*> defining_;
+    std::unordered_map<Symbol, Model> models_;
+    std::unordered_set<Symbol> globals_;
+    size_t depth_ = 0;
+    bool ended_ = false;
+    bool in_control_ = false;
+
+    std::vector<NodeId> nodes_;  // by deck symbol of the node name
+    ComponentFactory inductor_;
+    ComponentFactory diode_;
+    std::deque<std::string> files_;  // stable names for locations
+};
+
+} // namespace
+
+bool parseSpiceNumber(std::string_view text, double& value) {
+    double number = 0.0;
+    size_t used = scanNumber(text, number);
+    if (used == 0 || used != text.size()) {
+        return false;
+    }
+    value = number;
+    return true;
+}
+
+SpiceNetlist loadSpiceNetlist(const std::string& path, const SpiceOptions& options) {
+    MappedFile file(path);
+    SpiceLoader loader(options);
+    return loader.load(file.view(), path, std::filesystem::path(path).parent_path().string());
+}
+
+SpiceNetlist parseSpiceNetlist(std::string_view deck, const SpiceOptions& options, const std::string& base_dir) {
+    SpiceLoader loader(options);
+    return loader.load(deck, "<deck>", base_dir);
+}
+
+} // namespace ic_sim
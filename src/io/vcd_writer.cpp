@@ -0,0 +1,276 @@
+#include "io/vcd_writer.h"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+namespace ic_sim {
+
+namespace {
+
+// "1 ps" and friends; empty if the timescale is not one VCD can state
+std::string timescaleUnit(double timescale) {
+    static const std::pair<const char*, double> kUnits[] = {{"s", 1.0},   {"ms", 1e-3},  {"us", 1e-6},
+                                                            {"ns", 1e-9}, {"ps", 1e-12}, {"fs", 1e-15}};
+    for (const auto& unit : kUnits) {
+        for (int multiple : {1, 10, 100}) {
+            if (std::abs(timescale - multiple * unit.second) <= 1e-9 * timescale) {
+                return std::to_string(multiple) + " " + unit.first;
+            }
+        }
+    }
+    return {};
+}
+
+bool matchesAny(const std::vector<std::string>& patterns, const std::string& name) {
+    return std::any_of(patterns.begin(), patterns.end(),
+                       [&](const std::string& pattern) { return matchWildcard(pattern, name); });
+}
+
+void checkPatterns(const std::vector<std::string>& patterns, const std::vector<std::string>& columns) {
+    for (const std::string& pattern : patterns) {
+        if (pattern.find_first_of("*?") == std::string::npos &&
+            std::find(columns.begin() + 1, columns.end(), pattern) == columns.end()) {
+            throw std::invalid_argument("No probe named " + pattern);
+        }
+    }
+}
+
+// Short printable identifier for variable index, base 94 from '!'
+std::string identifierCode(size_t index) {
+    std::string code;
+    do {
+        code += static_cast<char>('!' + index % 94);
+        index /= 94;
+    } while (index > 0);
+    return code;
+}
+
+// VCD names are whitespace-separated tokens
+std::string token(std::string name) {
+    std::replace_if(name.begin(), name.end(), [](char c) { return c == ' ' || c == '\t' || c == '\n'; }, '_');
+    return name.empty() ? "_" : name;
+}
+
+struct Variable {
+    std::vector<std::string> scopes;
+    std::string reference;
+    size_t index;  // into the identifier codes
+    bool real;
+};
+
+// "v(X1.X2.out)" -> scopes {X1, X2}, reference "out"; currents keep their i()
+Variable splitName(const std::string& name) {
+    Variable variable;
+    std::string path = name;
+    char kind = 0;
+    if (name.size() >= 3 && name[1] == '(' && name.back() == ')') {
+        kind = name[0];
+        path = name.substr(2, name.size() - 3);
+    }
+    size_t start = 0;
+    for (size_t dot = path.find('.'); dot != std::string::npos; dot = path.find('.', start)) {
+        variable.scopes.push_back(token(path.substr(start, dot - start)));
+        start = dot + 1;
+    }
+    std::string leaf = path.substr(start);
+    variable.reference = token((kind == 0 || kind == 'v') ? leaf : std::string{kind, '('} + leaf + ")");
+    return variable;
+}
+
+void appendNumber(std::string& text, int64_t value) {
+    char digits[24];
+    text.append(digits, std::to_chars(digits, digits + sizeof(digits), value).ptr);
+}
+
+void appendNumber(std::string& text, double value) {
+    char digits[32];
+    text.append(digits, std::to_chars(digits, digits + sizeof(digits), value).ptr);
+}
+
+void appendReal(std::string& text, double value, const std::string& code) {
+    text += 'r';
+    appendNumber(text, value);
+    text += ' ';
+    text += code;
+    text += '\n';
+}
+
+void appendWire(std::string& text, uint8_t value, const std::string& code) {
+    text += "01x"[value];
+    text += code;
+    text += '\n';
+}
+
+bool sameBits(double a, double b) {
+    return std::memcmp(&a, &b, sizeof(double)) == 0;
+}
+
+} // namespace
+
+VcdWriter::VcdWriter(std::string path, const VcdWriterOptions& options)
+    : path_(std::move(path)), options_(options), unit_(timescaleUnit(options.timescale)) {
+    if (unit_.empty()) {
+        throw std::invalid_argument("Unsupported VCD timescale " + std::to_string(options.timescale) + " s");
+    }
+    low_ = options_.threshold - options_.hysteresis / 2.0;
+    high_ = options_.threshold + options_.hysteresis / 2.0;
+}
+
+void VcdWriter::begin(const std::vector<std::string>& columns) {
+    checkPatterns(options_.analog, columns);
+    checkPatterns(options_.digital, columns);
+    wires_.clear();
+    reals_.clear();
+    for (size_t column = 1; column < columns.size(); ++column) {
+        if (matchesAny(options_.analog, columns[column])) {
+            reals_.push_back({column, 0.0});
+        } else if (options_.digital.empty() || matchesAny(options_.digital, columns[column])) {
+            wires_.push_back({column, 2});
+        }
+    }
+    codes_.clear();
+    for (size_t i = 0; i < wires_.size() + reals_.size(); ++i) {
+        codes_.push_back(identifierCode(i));
+    }
+    stats_ = VcdWriterStats();
+    stats_.variables = codes_.size();
+    last_tick_ = 0;
+    last_row_tick_ = 0;
+    stamped_ = false;
+
+    out_.close();
+    out_.clear();
+    out_.open(path_, std::ios::binary | std::ios::trunc);
+    if (!out_) {
+        throw std::runtime_error("Cannot write VCD file: " + path_);
+    }
+    text_.clear();
+    text_.reserve(options_.buffer_bytes + 4096);
+    writeHeader(columns);
+    flushText();
+}
+
+void VcdWriter::writeHeader(const std::vector<std::string>& columns) {
+    std::vector<Variable> variables;
+    for (size_t i = 0; i < wires_.size(); ++i) {
+        variables.push_back(splitName(columns[wires_[i].column]));
+        variables.back().index = i;
+        variables.back().real = false;
+    }
+    for (size_t i = 0; i < reals_.size(); ++i) {
+        variables.push_back(splitName(columns[reals_[i].column]));
+        variables.back().index = wires_.size() + i;
+        variables.back().real = true;
+    }
+    // Sorting by scope path puts every scope's variables together and its
+    // subscopes right after them
+    std::stable_sort(variables.begin(), variables.end(),
+                     [](const Variable& a, const Variable& b) { return a.scopes < b.scopes; });
+
+    text_ += "$version ic_sim $end\n$timescale " + unit_ + " $end\n";
+    text_ += "$scope module " + token(options_.top_scope) + " $end\n";
+    std::vector<std::string> open;
+    for (const Variable& variable : variables) {
+        size_t common = 0;
+        while (common < open.size() && common < variable.scopes.size() && open[common] == variable.scopes[common]) {
+            ++common;
+        }
+        for (; open.size() > common; open.pop_back()) {
+            text_ += "$upscope $end\n";
+        }
+        for (; open.size() < variable.scopes.size(); open.push_back(variable.scopes[open.size()])) {
+            text_ += "$scope module " + variable.scopes[open.size()] + " $end\n";
+        }
+        text_ += variable.real ? "$var real 64 " : "$var wire 1 ";
+        text_ += codes_[variable.index] + " " + variable.reference + " $end\n";
+    }
+    for (; !open.empty(); open.pop_back()) {
+        text_ += "$upscope $end\n";
+    }
+    text_ += "$upscope $end\n$enddefinitions $end\n";
+}
+
+void VcdWriter::stamp(int64_t tick) {
+    if (!stamped_ || tick != last_tick_) {
+        text_ += '#';
+        appendNumber(text_, tick);
+        text_ += '\n';
+        last_tick_ = tick;
+        stamped_ = true;
+    }
+}
+
+void VcdWriter::write(const double* rows, size_t count, size_t width) {
+    for (size_t r = 0; r < count; ++r) {
+        const double* row = rows + r * width;
+        // Rounding may not move time backwards
+        int64_t tick = std::max(static_cast<int64_t>(std::llround(row[0] / options_.timescale)), last_row_tick_);
+        last_row_tick_ = tick;
+
+        if (stats_.rows++ == 0) {
+            stamp(tick);
+            text_ += "$dumpvars\n";
+            for (size_t i = 0; i < wires_.size(); ++i) {
+                double value = row[wires_[i].column];
+                wires_[i].value = (value > high_) ? 1 : (value < low_) ? 0 : 2;
+                appendWire(text_, wires_[i].value, codes_[i]);
+            }
+            for (size_t i = 0; i < reals_.size(); ++i) {
+                reals_[i].value = row[reals_[i].column];
+                appendReal(text_, reals_[i].value, codes_[wires_.size() + i]);
+            }
+            text_ += "$end\n";
+            stats_.changes += codes_.size();
+            continue;
+        }
+
+        for (size_t i = 0; i < wires_.size(); ++i) {
+            double value = row[wires_[i].column];
+            uint8_t level = (value > high_) ? 1 : (value < low_) ? 0 : wires_[i].value;
+            if (level != wires_[i].value) {
+                wires_[i].value = level;
+                stamp(tick);
+                appendWire(text_, level, codes_[i]);
+                ++stats_.changes;
+            }
+        }
+        for (size_t i = 0; i < reals_.size(); ++i) {
+            double value = row[reals_[i].column];
+            if (!sameBits(value, reals_[i].value)) {
+                reals_[i].value = value;
+                stamp(tick);
+                appendReal(text_, value, codes_[wires_.size() + i]);
+                ++stats_.changes;
+            }
+        }
+        if (text_.size() >= options_.buffer_bytes) {
+            flushText();
+        }
+    }
+}
+
+void VcdWriter::finish() {
+    // The last row's time closes the dump even if nothing changed there
+    if (stats_.rows > 1 && last_row_tick_ > last_tick_) {
+        stamp(last_row_tick_);
+    }
+    flushText();
+    out_.close();
+    if (out_.fail()) {
+        throw std::runtime_error("Failed writing VCD file: " + path_);
+    }
+}
+
+void VcdWriter::flushText() {
+    out_.write(text_.data(), static_cast<std::streamsize>(text_.size()));
+    if (!out_) {
+        throw std::runtime_error("Failed writing VCD file: " + path_);
+    }
+    stats_.bytes += text_.size();
+    text_.clear();
+}
+
+} // namespace ic_sim
@@ -0,0 +1,348 @@
+#include "io/waveform_decimation.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace ic_sim {
+
+namespace {
+
+// Appends a point at or after every point already in the bucket
+inline void addPoint(WaveformBucket& bucket, double time, double value, uint64_t count) {
+    if (bucket.count == 0) {
+        bucket.first_time = bucket.last_time = bucket.min_time = bucket.max_time = time;
+        bucket.first = bucket.last = bucket.min = bucket.max = value;
+        bucket.count = count;
+        return;
+    }
+    bucket.last_time = time;
+    bucket.last = value;
+    if (value < bucket.min) {
+        bucket.min = value;
+        bucket.min_time = time;
+    }
+    if (value > bucket.max) {
+        bucket.max = value;
+        bucket.max_time = time;
+    }
+    bucket.count += count;
+}
+
+// Appends next, which starts at or after the end of bucket
+inline void merge(WaveformBucket& bucket, const WaveformBucket& next) {
+    if (bucket.count == 0) {
+        bucket = next;
+        return;
+    }
+    bucket.last_time = next.last_time;
+    bucket.last = next.last;
+    if (next.min < bucket.min) {
+        bucket.min = next.min;
+        bucket.min_time = next.min_time;
+    }
+    if (next.max > bucket.max) {
+        bucket.max = next.max;
+        bucket.max_time = next.max_time;
+    }
+    bucket.count += next.count;
+}
+
+// Equal-width pixel columns over [t0, t1]
+class PixelColumns {
+public:
+    PixelColumns(double t0, double t1, size_t pixels)
+        : t0_(t0), t1_(t1), scale_(t1 > t0 ? double(pixels) / (t1 - t0) : 0.0), columns_(pixels) {}
+
+    void point(double time, double value, uint64_t count) {
+        if (time >= t0_ && time <= t1_) {
+            addPoint(columns_[column(time)], time, value, count);
+        }
+    }
+    void bucket(const WaveformBucket& b) {
+        // The four points in time order. An extreme in another column than the
+        // first point is a sample of that column and counts once there; the
+        // first point's column gets the rest of the bucket's count.
+        bool min_first = b.min_time <= b.max_time;
+        double times[4] = {b.first_time, min_first ? b.min_time : b.max_time, min_first ? b.max_time : b.min_time,
+                           b.last_time};
+        double values[4] = {b.first, min_first ? b.min : b.max, min_first ? b.max : b.min, b.last};
+        uint64_t counts[4] = {b.count, 0, 0, 0};
+        size_t first = column(times[0]);
+        for (size_t k = 1; k < 4; ++k) {
+            if (times[k] != times[k - 1] && column(times[k]) != first) {
+                counts[k] = 1;
+                --counts[0];
+            }
+        }
+        for (size_t k = 0; k < 4; ++k) {
+            point(times[k], values[k], counts[k]);
+        }
+    }
+
+    std::vector<WaveformBucket> take() { return std::move(columns_); }
+
+private:
+    size_t column(double time) const {
+        return std::min(static_cast<size_t>((time - t0_) * scale_), columns_.size() - 1);
+    }
+
+    double t0_;
+    double t1_;
+    double scale_;
+    std::vector<WaveformBucket> columns_;
+};
+
+// Collects points in time order, dropping exact repeats of the previous one
+class PointList {
+public:
+    PointList(std::vector<double>& times, std::vector<double>& values) : times_(times), values_(values) {}
+
+    void point(double time, double value, uint64_t) {
+        if (!times_.empty() && times_.back() == time && values_.back() == value) {
+            return;
+        }
+        times_.push_back(time);
+        values_.push_back(value);
+    }
+    void bucket(const WaveformBucket& b) {
+        point(b.first_time, b.first, 0);
+        bool min_first = b.min_time <= b.max_time;
+        point(min_first ? b.min_time : b.max_time, min_first ? b.min : b.max, 0);
+        point(min_first ? b.max_time : b.min_time, min_first ? b.max : b.min, 0);
+        point(b.last_time, b.last, 0);
+    }
+
+private:
+    std::vector<double>& times_;
+    std::vector<double>& values_;
+};
+
+} // namespace
+
+std::vector<WaveformBucket> minMaxBuckets(const double* times, const double* values, size_t count, double t0,
+                                          double t1, size_t buckets) {
+    if (buckets == 0) {
+        return {};
+    }
+    PixelColumns columns(t0, t1, buckets);
+    const double* first = std::lower_bound(times, times + count, t0);
+    const double* last = std::upper_bound(first, times + count, t1);
+    for (const double* t = first; t != last; ++t) {
+        columns.point(*t, values[t - times], 1);
+    }
+    return columns.take();
+}
+
+std::vector<size_t> lttbIndices(const double* times, const double* values, size_t count, size_t points) {
+    std::vector<size_t> selected;
+    if (points >= count || count <= 2) {
+        for (size_t i = 0; i < count; ++i) {
+            selected.push_back(i);
+        }
+        return selected;
+    }
+    if (points < 3) {
+        selected.push_back(0);
+        if (points == 2) {
+            selected.push_back(count - 1);
+        }
+        return points == 0 ? std::vector<size_t>{} : selected;
+    }
+
+    // The first and last points are kept; the rest is split into points - 2
+    // buckets, and each bucket keeps the point spanning the largest triangle
+    // with the point kept before it and the average of the next bucket
+    selected.reserve(points);
+    selected.push_back(0);
+    const double every = double(count - 2) / double(points - 2);
+    size_t a = 0;
+    for (size_t i = 0; i < points - 2; ++i) {
+        size_t start = static_cast<size_t>(std::floor(i * every)) + 1;
+        size_t end = std::min(static_cast<size_t>(std::floor((i + 1) * every)) + 1, count - 1);
+        size_t next_end = std::min(static_cast<size_t>(std::floor((i + 2) * every)) + 1, count);
+        double average_time = 0.0;
+        double average_value = 0.0;
+        for (size_t j = end; j < next_end; ++j) {
+            average_time += times[j];
+            average_value += values[j];
+        }
+        size_t n = next_end - end;
+        average_time /= double(n);
+        average_value /= double(n);
+
+        double best_area = -1.0;
+        size_t best = start;
+        for (size_t j = start; j < end; ++j) {
+            double area = std::abs((times[a] - average_time) * (values[j] - values[a]) -
+                                   (times[a] - times[j]) * (average_value - values[a]));
+            if (area > best_area) {
+                best_area = area;
+                best = j;
+            }
+        }
+        selected.push_back(best);
+        a = best;
+    }
+    selected.push_back(count - 1);
+    return selected;
+}
+
+WaveformPyramid::WaveformPyramid(std::vector<double> times, std::vector<double> values, const PyramidOptions& options)
+    : times_(std::move(times)), values_(std::move(values)), samples_(times_.size()) {
+    if (values_.size() != times_.size()) {
+        throw std::invalid_argument("Times and values differ in length");
+    }
+    build(options, [&](const auto& add) {
+        for (size_t i = 0; i < samples_; ++i) {
+            add(times_[i], values_[i]);
+        }
+    });
+}
+
+WaveformPyramid::WaveformPyramid(std::shared_ptr<const WaveformFileReader> reader, size_t column,
+                                 const PyramidOptions& options)
+    : reader_(std::move(reader)), column_(column) {
+    if (!reader_) {
+        throw std::invalid_argument("WaveformPyramid needs a reader");
+    }
+    samples_ = reader_->getSampleCount();
+    build(options, [&](const auto& add) {
+        WaveformStream stream(*reader_, column_);
+        double time;
+        double value;
+        while (stream.next(time, value)) {
+            add(time, value);
+        }
+    });
+}
+
+template <typename Source>
+void WaveformPyramid::build(const PyramidOptions& options, const Source& source) {
+    if (options.leaf_samples == 0 || options.fan_out < 2) {
+        throw std::invalid_argument("Pyramid levels need at least one sample and a fan-out of two");
+    }
+    fan_out_ = options.fan_out;
+
+    std::vector<WaveformBucket> leaves;
+    leaves.reserve(samples_ / options.leaf_samples + 1);
+    WaveformBucket current;
+    size_t leaf_samples = options.leaf_samples;
+    source([&](double time, double value) {
+        addPoint(current, time, value, 1);
+        if (current.count == leaf_samples) {
+            leaves.push_back(current);
+            current = WaveformBucket{};
+        }
+    });
+    if (current.count > 0) {
+        leaves.push_back(current);
+    }
+    levels_.push_back(std::move(leaves));
+
+    while (levels_.back().size() > 1) {
+        const std::vector<WaveformBucket>& below = levels_.back();
+        std::vector<WaveformBucket> level((below.size() + fan_out_ - 1) / fan_out_);
+        for (size_t i = 0; i < below.size(); ++i) {
+            merge(level[i / fan_out_], below[i]);
+        }
+        levels_.push_back(std::move(level));
+    }
+}
+
+size_t WaveformPyramid::memoryBytes() const {
+    size_t bytes = (times_.capacity() + values_.capacity()) * sizeof(double);
+    for (const std::vector<WaveformBucket>& level : levels_) {
+        bytes += level.capacity() * sizeof(WaveformBucket);
+    }
+    return bytes;
+}
+
+void WaveformPyramid::readRaw(double t0, double t1, std::vector<double>& times, std::vector<double>& values) const {
+    if (reader_) {
+        reader_->readRange(column_, t0, t1, times, values);
+        return;
+    }
+    auto first = std::lower_bound(times_.begin(), times_.end(), t0);
+    auto last = std::upper_bound(first, times_.end(), t1);
+    times.assign(first, last);
+    values.assign(values_.begin() + (first - times_.begin()), values_.begin() + (last - times_.begin()));
+}
+
+template <typename Visit>
+void WaveformPyramid::visitBuckets(size_t level, size_t begin, size_t end, double t0, double t1, Visit& visit) const {
+    const std::vector<WaveformBucket>& buckets = levels_[level];
+    for (size_t i = begin; i < end; ++i) {
+        const WaveformBucket& b = buckets[i];
+        if (b.last_time < t0 || b.first_time > t1) {
+            continue;
+        }
+        if (b.first_time >= t0 && b.last_time <= t1) {
+            visit.bucket(b);
+        } else if (level > 0) {
+            // Cut by the window edge: refine through the level below
+            visitBuckets(level - 1, i * fan_out_, std::min((i + 1) * fan_out_, levels_[level - 1].size()), t0, t1,
+                         visit);
+        } else {
+            std::vector<double> times;
+            std::vector<double> values;
+            readRaw(std::max(t0, b.first_time), std::min(t1, b.last_time), times, values);
+            for (size_t k = 0; k < times.size(); ++k) {
+                visit.point(times[k], values[k], 1);
+            }
+        }
+    }
+}
+
+template <typename Visit>
+void WaveformPyramid::visitWindow(double t0, double t1, size_t min_buckets, Visit& visit) const {
+    if (samples_ == 0 || !(t0 <= t1)) {
+        return;
+    }
+    for (size_t level = levels_.size(); level-- > 0;) {
+        const std::vector<WaveformBucket>& buckets = levels_[level];
+        size_t begin = std::lower_bound(buckets.begin(), buckets.end(), t0,
+                                        [](const WaveformBucket& b, double t) { return b.last_time < t; }) -
+                       buckets.begin();
+        size_t end = std::upper_bound(buckets.begin() + begin, buckets.end(), t1,
+                                      [](double t, const WaveformBucket& b) { return t < b.first_time; }) -
+                     buckets.begin();
+        if (end - begin >= min_buckets) {
+            visitBuckets(level, begin, end, t0, t1, visit);
+            return;
+        }
+    }
+    // Fewer samples than buckets asked for: the raw samples themselves
+    std::vector<double> times;
+    std::vector<double> values;
+    readRaw(t0, t1, times, values);
+    for (size_t k = 0; k < times.size(); ++k) {
+        visit.point(times[k], values[k], 1);
+    }
+}
+
+std::vector<WaveformBucket> WaveformPyramid::envelope(double t0, double t1, size_t pixels) const {
+    if (pixels == 0) {
+        return {};
+    }
+    PixelColumns columns(t0, t1, pixels);
+    visitWindow(t0, t1, pixels, columns);
+    return columns.take();
+}
+
+void WaveformPyramid::lttb(double t0, double t1, size_t points, std::vector<double>& times,
+                           std::vector<double>& values) const {
+    std::vector<double> candidate_times;
+    std::vector<double> candidate_values;
+    PointList list(candidate_times, candidate_values);
+    visitWindow(t0, t1, points, list);
+    std::vector<size_t> selected = lttbIndices(candidate_times.data(), candidate_values.data(),
+                                               candidate_times.size(), points);
+    times.clear();
+    values.clear();
+    for (size_t i : selected) {
+        times.push_back(candidate_times[i]);
+        values.push_back(candidate_values[i]);
+    }
+}
+
+} // namespace ic_sim
@@ -0,0 +1,731 @@
+#include "io/waveform_file.h"
+#include "io/circuit_cache.h"
+#include <algorithm>
+#include <cstring>
+
+namespace ic_sim {
+
+namespace {
+
+constexpr char kMagic[8] = {'I', 'C', 'S', 'I', 'M', 'W', 'V', '\0'};
+constexpr char kTrailerMagic[8] = {'I', 'C', 'W', 'V', 'E', 'N', 'D', '\0'};
+constexpr uint64_t kChunkTag = 0x4b4e484356574349ULL;  // "ICWVCHNK"
+constexpr uint32_t kVersion = 1;
+constexpr uint32_t kByteOrder = 0x01020304;
+constexpr size_t kMinChunkRows = 64;
+constexpr size_t kCodecSample = 512;
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t column_count;
+    uint32_t chunk_rows;
+    uint64_t names_bytes;  // name table after the header, padded to 8 bytes
+};
+
+// Followed by one BlockEntry per column, then the blocks in column order
+struct ChunkHeader {
+    uint64_t tag;
+    uint64_t first_row;
+    uint64_t rows;
+    double first_time;
+    double last_time;
+};
+
+struct BlockEntry {
+    uint32_t codec;
+    uint32_t words;
+};
+
+// After the chunk index (one WaveformChunk per chunk) at the end of the file
+struct Trailer {
+    uint64_t index_offset;
+    uint64_t chunk_count;
+    uint64_t samples;
+    uint64_t index_hash;
+    char magic[8];
+};
+
+static_assert(sizeof(WaveformChunk) == 40, "index entries are stored as is");
+
+constexpr size_t pad8(size_t bytes) {
+    return (bytes + 7) & ~size_t(7);
+}
+
+inline uint64_t mask(unsigned count) {
+    return count >= 64 ? ~uint64_t(0) : (uint64_t(1) << count) - 1;
+}
+
+inline unsigned leadingZeros(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<unsigned>(__builtin_clzll(x));
+#else
+    unsigned n = 0;
+    for (uint64_t bit = uint64_t(1) << 63; !(x & bit); bit >>= 1) {
+        ++n;
+    }
+    return n;
+#endif
+}
+
+inline unsigned trailingZeros(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<unsigned>(__builtin_ctzll(x));
+#else
+    unsigned n = 0;
+    for (; !(x & 1); x >>= 1) {
+        ++n;
+    }
+    return n;
+#endif
+}
+
+inline uint64_t zigzag(uint64_t x) {
+    return (x << 1) ^ static_cast<uint64_t>(static_cast<int64_t>(x) >> 63);
+}
+
+inline uint64_t unzigzag(uint64_t z) {
+    return (z >> 1) ^ (~(z & 1) + 1);
+}
+
+// MSB-first bit packing into 64-bit words; the caller provides room for every
+// word written
+class BitWriter {
+public:
+    explicit BitWriter(uint64_t* out) : begin_(out), out_(out) {}
+
+    // value must fit in count bits, 1 <= count <= 64
+    void put(uint64_t value, unsigned count) {
+        unsigned free = 64 - used_;
+        if (count < free) {
+            acc_ = (acc_ << count) | value;
+            used_ += count;
+            return;
+        }
+        unsigned rest = count - free;
+        *out_++ = (free == 64 ? 0 : acc_ << free) | (value >> rest);
+        acc_ = value;  // only the low rest bits count; the rest is shifted out
+        used_ = rest;
+    }
+    // Words written
+    size_t finish() {
+        if (used_ > 0) {
+            *out_++ = acc_ << (64 - used_);
+            used_ = 0;
+        }
+        return static_cast<size_t>(out_ - begin_);
+    }
+
+private:
+    uint64_t* begin_;
+    uint64_t* out_;
+    uint64_t acc_ = 0;
+    unsigned used_ = 0;
+};
+
+// Same interface as BitWriter, only adds up the size
+struct BitCounter {
+    size_t bits = 0;
+    void put(uint64_t, unsigned count) { bits += count; }
+};
+
+// Gorilla value encoding: a zero XOR is one bit; otherwise the meaningful bits
+// are written inside the previous leading/trailing-zero window if they fit,
+// or with a new 6-bit lead and 6-bit width
+template <typename Out>
+void encodeXor(const uint64_t* values, size_t count, Out& out) {
+    uint64_t previous = values[0];
+    out.put(previous, 64);
+    unsigned lead = 0;
+    unsigned width = 0;
+    for (size_t i = 1; i < count; ++i) {
+        uint64_t x = values[i] ^ previous;
+        previous = values[i];
+        if (x == 0) {
+            out.put(0, 1);
+            continue;
+        }
+        unsigned l = leadingZeros(x);
+        unsigned t = trailingZeros(x);
+        if (width != 0 && l >= lead && t >= 64 - lead - width) {
+            out.put(0b10, 2);
+            out.put(x >> (64 - lead - width), width);
+        } else {
+            lead = l;
+            width = 64 - l - t;
+            out.put(0b11, 2);
+            out.put(lead, 6);
+            out.put(width - 1, 6);
+            out.put(x >> t, width);
+        }
+    }
+}
+
+// Second differences of the bit patterns, zigzagged: zero is one bit; others
+// reuse the previous width when that costs at most 6 wasted bits, or carry a
+// new 6-bit width. Sampled time and smooth values have nearly constant bit
+// pattern increments within a binade. Low bits that are zero in every value
+// (rounded mantissas, quantised levels) are shifted out first.
+template <typename Out>
+void encodeDeltaOfDelta(const uint64_t* values, size_t count, unsigned shift, Out& out) {
+    out.put(shift, 6);
+    uint64_t previous = values[0] >> shift;
+    out.put(previous, 64);
+    uint64_t delta = 0;
+    unsigned width = 0;
+    for (size_t i = 1; i < count; ++i) {
+        uint64_t value = values[i] >> shift;
+        uint64_t d = value - previous;
+        uint64_t z = zigzag(d - delta);
+        previous = value;
+        delta = d;
+        if (z == 0) {
+            out.put(0, 1);
+            continue;
+        }
+        unsigned n = 64 - leadingZeros(z);
+        if (width >= n && width <= n + 6) {
+            out.put(0b10, 2);
+            out.put(z, width);
+        } else {
+            width = n;
+            out.put(0b11, 2);
+            out.put(width - 1, 6);
+            out.put(z, width);
+        }
+    }
+}
+
+} // namespace
+
+WaveformCodec encodeWaveform(const double* values, size_t count, std::vector<uint64_t>& out, int mantissa_bits) {
+    if (count == 0) {
+        return WaveformCodec::Xor;
+    }
+    // Bit patterns, rounded if asked, and the low bits that are zero in all
+    thread_local std::vector<uint64_t> bits;
+    bits.resize(count);
+    const unsigned drop = 52 - static_cast<unsigned>(std::min(std::max(mantissa_bits, 0), 52));
+    const uint64_t half = drop ? uint64_t(1) << (drop - 1) : 0;
+    const uint64_t keep = ~mask(drop);
+    uint64_t any = 0;
+    for (size_t i = 0; i < count; ++i) {
+        uint64_t b;
+        std::memcpy(&b, values + i, sizeof(b));
+        if (drop && (b & 0x7ff0000000000000ULL) != 0x7ff0000000000000ULL) {
+            b = (b + half) & keep;  // a carry into the exponent rounds up correctly
+        }
+        bits[i] = b;
+        any |= b;
+    }
+    unsigned shift = any == 0 ? 0 : std::min(trailingZeros(any), 63u);
+
+    // The codec is chosen on a prefix; a chunk's character rarely changes
+    // midway, and sizing both codecs over the whole block would double the cost
+    size_t sample = std::min(count, kCodecSample);
+    BitCounter xor_size;
+    BitCounter dod_size;
+    encodeXor(bits.data(), sample, xor_size);
+    encodeDeltaOfDelta(bits.data(), sample, shift, dod_size);
+    WaveformCodec codec = dod_size.bits < xor_size.bits ? WaveformCodec::DeltaOfDelta : WaveformCodec::Xor;
+
+    // Worst case: 2 + 6 + 6 + 64 bits a value, plus the headers
+    size_t start = out.size();
+    out.resize(start + (count * 78 + 70) / 64 + 2);
+    BitWriter writer(out.data() + start);
+    if (codec == WaveformCodec::DeltaOfDelta) {
+        encodeDeltaOfDelta(bits.data(), count, shift, writer);
+    } else {
+        encodeXor(bits.data(), count, writer);
+    }
+    out.resize(start + writer.finish());
+    return codec;
+}
+
+WaveformDecoder::WaveformDecoder(const uint64_t* words, size_t word_count, size_t count, WaveformCodec codec)
+    : words_(words), end_(words + word_count), remaining_(count), codec_(codec) {
+    if (codec != WaveformCodec::Xor && codec != WaveformCodec::DeltaOfDelta) {
+        throw WaveformFileError("Unknown waveform codec");
+    }
+}
+
+uint64_t WaveformDecoder::bits(unsigned count) {
+    if (count <= available_) {
+        available_ -= count;
+        return (current_ >> available_) & mask(count);
+    }
+    uint64_t high = current_ & mask(available_);
+    unsigned low = count - available_;
+    if (words_ == end_) {
+        throw WaveformFileError("Waveform block is truncated");
+    }
+    current_ = *words_++;
+    available_ = 64 - low;
+    return (low == 64 ? 0 : high << low) | ((current_ >> available_) & mask(low));
+}
+
+double WaveformDecoder::nextXor() {
+    if (decoded_ == 0) {
+        previous_ = bits(64);
+    } else if (bits(1) != 0) {
+        if (bits(1) != 0) {
+            lead_ = static_cast<unsigned>(bits(6));
+            width_ = static_cast<unsigned>(bits(6)) + 1;
+            if (lead_ + width_ > 64) {
+                throw WaveformFileError("Corrupt waveform block");
+            }
+        } else if (width_ == 0) {
+            throw WaveformFileError("Corrupt waveform block");
+        }
+        previous_ ^= bits(width_) << (64 - lead_ - width_);
+    }
+    double value;
+    std::memcpy(&value, &previous_, sizeof(value));
+    return value;
+}
+
+double WaveformDecoder::nextDeltaOfDelta() {
+    if (decoded_ == 0) {
+        shift_ = static_cast<unsigned>(bits(6));
+        previous_ = bits(64);
+        delta_ = 0;
+    } else {
+        uint64_t z = 0;
+        if (bits(1) != 0) {
+            if (bits(1) != 0) {
+                width_ = static_cast<unsigned>(bits(6)) + 1;
+            } else if (width_ == 0) {
+                throw WaveformFileError("Corrupt waveform block");
+            }
+            z = bits(width_);
+        }
+        delta_ += unzigzag(z);
+        previous_ += delta_;
+    }
+    uint64_t pattern = previous_ << shift_;
+    double value;
+    std::memcpy(&value, &pattern, sizeof(value));
+    return value;
+}
+
+bool WaveformDecoder::next(double& value) {
+    if (remaining_ == 0) {
+        return false;
+    }
+    value = codec_ == WaveformCodec::Xor ? nextXor() : nextDeltaOfDelta();
+    ++decoded_;
+    --remaining_;
+    return true;
+}
+
+void WaveformDecoder::decode(double* out) {
+    if (codec_ == WaveformCodec::Xor) {
+        for (; remaining_ > 0; --remaining_, ++decoded_) {
+            *out++ = nextXor();
+        }
+    } else {
+        for (; remaining_ > 0; --remaining_, ++decoded_) {
+            *out++ = nextDeltaOfDelta();
+        }
+    }
+}
+
+WaveformFileWriter::WaveformFileWriter(std::string path, const WaveformWriterOptions& options)
+    : path_(std::move(path)), options_(options) {
+    if (options_.chunk_samples == 0) {
+        throw std::invalid_argument("Waveform chunks need at least one row");
+    }
+    if (options_.mantissa_bits < 0 || options_.mantissa_bits > 52) {
+        throw std::invalid_argument("Mantissa bits must be between 0 and 52");
+    }
+}
+
+void WaveformFileWriter::put(const void* data, size_t bytes) {
+    if (!out_.write(static_cast<const char*>(data), static_cast<std::streamsize>(bytes))) {
+        throw WaveformFileError("Cannot write waveform file: " + path_);
+    }
+    stats_.file_bytes += bytes;
+}
+
+void WaveformFileWriter::begin(const std::vector<std::string>& columns) {
+    if (columns.empty() || columns.size() > UINT32_MAX) {
+        throw std::invalid_argument("A waveform file needs the time column");
+    }
+    out_.close();
+    out_.clear();
+    out_.open(path_, std::ios::binary | std::ios::trunc);
+    if (!out_) {
+        throw WaveformFileError("Cannot create waveform file: " + path_);
+    }
+    width_ = columns.size();
+    size_t by_bytes = options_.chunk_bytes / (width_ * sizeof(double));
+    chunk_rows_ = std::min(options_.chunk_samples, std::max(by_bytes, kMinChunkRows));
+    chunk_.assign(width_ * chunk_rows_, 0.0);
+    filled_ = 0;
+    blocks_.resize(width_);
+    index_.clear();
+    stats_ = WaveformWriterStats{};
+
+    std::vector<uint64_t> offsets{0};
+    std::string chars;
+    for (const std::string& name : columns) {
+        chars += name;
+        offsets.push_back(chars.size());
+    }
+    size_t names_bytes = pad8(offsets.size() * sizeof(uint64_t) + chars.size());
+
+    FileHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.byte_order = kByteOrder;
+    header.column_count = static_cast<uint32_t>(width_);
+    header.chunk_rows = static_cast<uint32_t>(chunk_rows_);
+    header.names_bytes = names_bytes;
+    put(&header, sizeof(header));
+    put(offsets.data(), offsets.size() * sizeof(uint64_t));
+    put(chars.data(), chars.size());
+    static const char zeros[8] = {};
+    put(zeros, names_bytes - offsets.size() * sizeof(uint64_t) - chars.size());
+}
+
+void WaveformFileWriter::write(const double* rows, size_t count, size_t width) {
+    if (width != width_) {
+        throw std::invalid_argument("Row width differs from the columns given to begin()");
+    }
+    while (count > 0) {
+        size_t n = std::min(count, chunk_rows_ - filled_);
+        // Column by column, so each column's rows land in one run
+        for (size_t c = 0; c < width_; ++c) {
+            double* target = chunk_.data() + c * chunk_rows_ + filled_;
+            for (size_t r = 0; r < n; ++r) {
+                target[r] = rows[r * width_ + c];
+            }
+        }
+        filled_ += n;
+        rows += n * width_;
+        count -= n;
+        if (filled_ == chunk_rows_) {
+            writeChunk();
+        }
+    }
+}
+
+void WaveformFileWriter::writeChunk() {
+    std::vector<BlockEntry> entries(width_);
+    for (size_t c = 0; c < width_; ++c) {
+        blocks_[c].clear();
+        WaveformCodec codec = encodeWaveform(chunk_.data() + c * chunk_rows_, filled_, blocks_[c],
+                                             c == 0 ? 52 : options_.mantissa_bits);
+        entries[c] = {static_cast<uint32_t>(codec), static_cast<uint32_t>(blocks_[c].size())};
+    }
+
+    ChunkEntry entry{stats_.file_bytes, stats_.rows, filled_, chunk_[0], chunk_[filled_ - 1]};
+    ChunkHeader header{kChunkTag, entry.first_row, entry.rows, entry.first_time, entry.last_time};
+    put(&header, sizeof(header));
+    put(entries.data(), entries.size() * sizeof(BlockEntry));
+    for (const std::vector<uint64_t>& block : blocks_) {
+        put(block.data(), block.size() * sizeof(uint64_t));
+    }
+    index_.push_back(entry);
+    stats_.rows += filled_;
+    stats_.raw_bytes += filled_ * width_ * sizeof(double);
+    ++stats_.chunks;
+    filled_ = 0;
+}
+
+void WaveformFileWriter::finish() {
+    if (!out_.is_open()) {
+        return;
+    }
+    if (filled_ > 0) {
+        writeChunk();
+    }
+    static_assert(sizeof(ChunkEntry) == sizeof(WaveformChunk), "index layout");
+    Trailer trailer{};
+    trailer.index_offset = stats_.file_bytes;
+    trailer.chunk_count = index_.size();
+    trailer.samples = stats_.rows;
+    trailer.index_hash = hashBytes(index_.data(), index_.size() * sizeof(ChunkEntry));
+    std::memcpy(trailer.magic, kTrailerMagic, sizeof(kTrailerMagic));
+    put(index_.data(), index_.size() * sizeof(ChunkEntry));
+    put(&trailer, sizeof(trailer));
+    out_.close();
+    if (out_.fail()) {
+        throw WaveformFileError("Cannot write waveform file: " + path_);
+    }
+}
+
+WaveformFileReader::WaveformFileReader(const std::string& path) : file_(path, MappedFile::Access::Random) {
+    const char* base = file_.data();
+    const size_t size = file_.size();
+    FileHeader header;
+    if (size < sizeof(header)) {
+        throw WaveformFileError("Not a waveform file: " + path);
+    }
+    std::memcpy(&header, base, sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.byte_order != kByteOrder) {
+        throw WaveformFileError("Not a waveform file: " + path);
+    }
+    if (header.version != kVersion) {
+        throw WaveformFileError("Unsupported waveform file version " + std::to_string(header.version) + ": " + path);
+    }
+    size_t count = header.column_count;
+    if (count == 0 || header.names_bytes < (count + 1) * sizeof(uint64_t) ||
+        header.names_bytes > size - sizeof(header)) {
+        throw WaveformFileError("Corrupt waveform file: " + path);
+    }
+    std::vector<uint64_t> offsets(count + 1);
+    std::memcpy(offsets.data(), base + sizeof(header), offsets.size() * sizeof(uint64_t));
+    const char* chars = base + sizeof(header) + offsets.size() * sizeof(uint64_t);
+    size_t char_count = header.names_bytes - offsets.size() * sizeof(uint64_t);
+    for (size_t i = 0; i < count; ++i) {
+        if (offsets[i] > offsets[i + 1] || offsets[i + 1] > char_count) {
+            throw WaveformFileError("Corrupt waveform file: " + path);
+        }
+        columns_.emplace_back(chars + offsets[i], offsets[i + 1] - offsets[i]);
+    }
+    data_offset_ = sizeof(header) + header.names_bytes;
+
+    complete_ = readIndex();
+    if (!complete_) {
+        scanChunks();
+    }
+}
+
+bool WaveformFileReader::readIndex() {
+    const uint64_t file_size = file_.size();
+    Trailer trailer;
+    if (file_size < data_offset_ + sizeof(trailer)) {
+        return false;
+    }
+    std::memcpy(&trailer, file_.data() + file_size - sizeof(trailer), sizeof(trailer));
+    if (std::memcmp(trailer.magic, kTrailerMagic, sizeof(kTrailerMagic)) != 0 ||
+        trailer.index_offset < data_offset_ ||
+        trailer.chunk_count > (file_size - sizeof(trailer) - trailer.index_offset) / sizeof(WaveformChunk) ||
+        trailer.index_offset + trailer.chunk_count * sizeof(WaveformChunk) + sizeof(trailer) != file_size) {
+        return false;
+    }
+    const char* entries = file_.data() + trailer.index_offset;
+    if (hashBytes(entries, trailer.chunk_count * sizeof(WaveformChunk)) != trailer.index_hash) {
+        return false;
+    }
+    std::vector<WaveformChunk> index(trailer.chunk_count);
+    std::memcpy(index.data(), entries, index.size() * sizeof(WaveformChunk));
+    const uint64_t header_bytes = sizeof(ChunkHeader) + columns_.size() * sizeof(BlockEntry);
+    uint64_t row = 0;
+    for (const WaveformChunk& chunk : index) {
+        if (chunk.first_row != row || chunk.rows == 0 || chunk.offset < data_offset_ ||
+            chunk.offset % 8 != 0 || chunk.offset + header_bytes > trailer.index_offset) {
+            return false;
+        }
+        row += chunk.rows;
+    }
+    if (row != trailer.samples) {
+        return false;
+    }
+    index_ = std::move(index);
+    samples_ = row;
+    return true;
+}
+
+void WaveformFileReader::scanChunks() {
+    const uint64_t file_size = file_.size();
+    const uint64_t entry_bytes = columns_.size() * sizeof(BlockEntry);
+    index_.clear();
+    samples_ = 0;
+    uint64_t offset = data_offset_;
+    while (offset + sizeof(ChunkHeader) + entry_bytes <= file_size) {
+        ChunkHeader header;
+        std::memcpy(&header, file_.data() + offset, sizeof(header));
+        if (header.tag != kChunkTag || header.first_row != samples_ || header.rows == 0) {
+            break;
+        }
+        const BlockEntry* entries = reinterpret_cast<const BlockEntry*>(file_.data() + offset + sizeof(header));
+        uint64_t words = 0;
+        for (size_t c = 0; c < columns_.size(); ++c) {
+            words += entries[c].words;
+        }
+        uint64_t end = offset + sizeof(header) + entry_bytes + words * sizeof(uint64_t);
+        if (end > file_size) {
+            break;
+        }
+        index_.push_back({offset, header.first_row, header.rows, header.first_time, header.last_time});
+        samples_ += header.rows;
+        offset = end;
+    }
+}
+
+void WaveformFileReader::checkColumn(size_t column) const {
+    if (column >= columns_.size()) {
+        throw std::out_of_range("Waveform column out of range");
+    }
+}
+
+size_t WaveformFileReader::findColumn(std::string_view name) const {
+    for (size_t i = 0; i < columns_.size(); ++i) {
+        if (columns_[i] == name) {
+            return i;
+        }
+    }
+    return kNoColumn;
+}
+
+WaveformDecoder WaveformFileReader::openBlock(size_t chunk, size_t column) const {
+    const WaveformChunk& info = index_.at(chunk);
+    checkColumn(column);
+    const BlockEntry* entries = reinterpret_cast<const BlockEntry*>(file_.data() + info.offset + sizeof(ChunkHeader));
+    uint64_t offset = info.offset + sizeof(ChunkHeader) + columns_.size() * sizeof(BlockEntry);
+    for (size_t c = 0; c < column; ++c) {
+        offset += uint64_t(entries[c].words) * sizeof(uint64_t);
+    }
+    uint64_t words = entries[column].words;
+    if (offset + words * sizeof(uint64_t) > file_.size()) {
+        throw WaveformFileError("Corrupt waveform file: block past the end");
+    }
+    // Blocks start 8-byte aligned and the mapping is page aligned
+    return WaveformDecoder(reinterpret_cast<const uint64_t*>(file_.data() + offset), words, info.rows,
+                           static_cast<WaveformCodec>(entries[column].codec));
+}
+
+void WaveformFileReader::readChunk(size_t chunk, size_t column, std::vector<double>& values) const {
+    WaveformDecoder decoder = openBlock(chunk, column);
+    values.resize(decoder.remaining());
+    decoder.decode(values.data());
+}
+
+std::vector<double> WaveformFileReader::readColumn(size_t column) const {
+    std::vector<double> values(samples_);
+    for (size_t chunk = 0; chunk < index_.size(); ++chunk) {
+        openBlock(chunk, column).decode(values.data() + index_[chunk].first_row);
+    }
+    return values;
+}
+
+size_t WaveformFileReader::findChunk(double time) const {
+    auto it = std::lower_bound(index_.begin(), index_.end(), time,
+                               [](const WaveformChunk& chunk, double t) { return chunk.last_time < t; });
+    return static_cast<size_t>(it - index_.begin());
+}
+
+void WaveformFileReader::readRange(size_t column, double t0, double t1, std::vector<double>& times,
+                                   std::vector<double>& values) const {
+    checkColumn(column);
+    times.clear();
+    values.clear();
+    std::vector<double> chunk_times;
+    std::vector<double> chunk_values;
+    for (size_t chunk = findChunk(t0); chunk < index_.size() && index_[chunk].first_time <= t1; ++chunk) {
+        readChunk(chunk, 0, chunk_times);
+        readChunk(chunk, column, chunk_values);
+        size_t first = std::lower_bound(chunk_times.begin(), chunk_times.end(), t0) - chunk_times.begin();
+        size_t last = std::upper_bound(chunk_times.begin(), chunk_times.end(), t1) - chunk_times.begin();
+        if (first < last) {
+            times.insert(times.end(), chunk_times.begin() + first, chunk_times.begin() + last);
+            values.insert(values.end(), chunk_values.begin() + first, chunk_values.begin() + last);
+        }
+    }
+}
+
+double WaveformFileReader::valueAt(size_t column, double time) const {
+    double value;
+    sample(column, &time, 1, &value);
+    return value;
+}
+
+void WaveformFileReader::sample(size_t column, const double* times, size_t count, double* out) const {
+    checkColumn(column);
+    if (count == 0) {
+        return;
+    }
+    if (index_.empty()) {
+        throw WaveformFileError("Waveform file has no samples");
+    }
+
+    // The chunk decoded last, and the samples either side of the last gap
+    // between two chunks
+    std::vector<double> t;
+    std::vector<double> v;
+    size_t loaded = index_.size();
+    auto load = [&](size_t chunk) {
+        if (chunk != loaded) {
+            readChunk(chunk, 0, t);
+            readChunk(chunk, column, v);
+            loaded = chunk;
+        }
+    };
+    size_t gap = index_.size();
+    double gap_time[2] = {0.0, 0.0};
+    double gap_value[2] = {0.0, 0.0};
+
+    size_t chunk = 0;
+    for (size_t i = 0; i < count; ++i) {
+        double time = times[i];
+        if (i > 0 && time < times[i - 1]) {
+            throw std::invalid_argument("Sample times must not decrease");
+        }
+        if (time <= getStartTime()) {
+            load(0);
+            out[i] = v.front();
+            continue;
+        }
+        if (time >= getEndTime()) {
+            load(index_.size() - 1);
+            out[i] = v.back();
+            continue;
+        }
+        chunk = static_cast<size_t>(std::lower_bound(index_.begin() + chunk, index_.end(), time,
+                                                     [](const WaveformChunk& c, double t) { return c.last_time < t; }) -
+                                    index_.begin());
+        if (time < index_[chunk].first_time) {
+            // Between the last sample of the previous chunk and the first of this one
+            if (gap != chunk) {
+                load(chunk - 1);
+                gap_time[0] = t.back();
+                gap_value[0] = v.back();
+                load(chunk);
+                gap_time[1] = t.front();
+                gap_value[1] = v.front();
+                gap = chunk;
+            }
+            out[i] = gap_value[0] + (gap_value[1] - gap_value[0]) * (time - gap_time[0]) / (gap_time[1] - gap_time[0]);
+            continue;
+        }
+        load(chunk);
+        size_t j = std::upper_bound(t.begin(), t.end(), time) - t.begin();  // t[j - 1] <= time < t[j]
+        if (j == t.size() || t[j - 1] == time) {
+            out[i] = v[j - 1];
+        } else {
+            out[i] = v[j - 1] + (v[j] - v[j - 1]) * (time - t[j - 1]) / (t[j] - t[j - 1]);
+        }
+    }
+}
+
+WaveformStream::WaveformStream(const WaveformFileReader& reader, size_t column) : reader_(reader), column_(column) {
+    if (column >= reader.getColumns().size()) {
+        throw std::out_of_range("Waveform column out of range");
+    }
+}
+
+bool WaveformStream::openChunk() {
+    if (chunk_ >= reader_.getChunkCount()) {
+        return false;
+    }
+    reader_.readChunk(chunk_, 0, times_);
+    reader_.readChunk(chunk_, column_, values_);
+    ++chunk_;
+    position_ = 0;
+    return true;
+}
+
+bool WaveformStream::next(double& time, double& value) {
+    if (position_ == times_.size() && !openChunk()) {
+        return false;
+    }
+    time = times_[position_];
+    value = values_[position_];
+    ++position_;
+    return true;
+}
+
+} // namespace ic_sim
@@ -1,12 +1,136 @@
 #include "core/circuit.h"
 #include "core/cuda_engine.h"
+#include "core/result_store.h"
+#include "core/thread_pool.h"
+#include "io/checkpoint.h"
+#include "io/circuit_cache.h"
+#include "io/async_writer.h"
+#include "io/csv_export.h"
+#include "io/vcd_writer.h"
 #include "plugins/plugin_system.h"
+#include <fstream>
 #include <iostream>
 #include <memory>
+#include <stdexcept>
+#include <string>
 
 using namespace ic_sim;
 
-int main() {
+// Loads a JSON netlist or a SPICE deck (any other extension) and runs it with
+// the simulation settings from the file. The compiled circuit is cached next to
+// the netlist and reused while the sources are unchanged. With csv_path set,
+// every node voltage is recorded and written there (tab-separated for .tsv);
+// with vcd_path set, node voltages are thresholded and streamed there as a VCD.
+// With checkpoint_path set, the run state is saved there once a minute, and
+// resume continues from that file if it exists. The CSV and VCD writers cannot
+// pick up their output where a checkpoint left it, so main() refuses --resume
+// together with --csv or --vcd.
+static int runNetlist(const std::string& path, const std::string& csv_path, const std::string& vcd_path,
+                      const std::string& checkpoint_path, bool resume) {
+    try {
+        std::cout << "\\nLoading circuit " << path << "..." << std::endl;
+        CachedNetlist netlist = loadNetlistCached(path);
+        std::unique_ptr<Circuit> loaded = std::move(netlist.circuit);
+        const SimulationSettings& settings = netlist.simulation;
+        Circuit& circuit = *loaded;
+        std::cout << "Circuit '" << circuit.getName() << "' loaded with " << circuit.getComponentCount()
+                  << " components and " << circuit.getNodeCount() << " nodes"
+                  << (netlist.from_cache ? " (from cache)" : "") << std::endl;
+        
+        double duration = (settings.duration > 0.0) ? settings.duration : 0.01;
+        double timestep = (settings.timestep > 0.0) ? settings.timestep : 1e-6;
+        std::shared_ptr<ResultStore> results;
+        std::shared_ptr<VcdWriter> vcd;
+        if (!csv_path.empty() || !vcd_path.empty()) {
+            ResultStoreOptions store;
+            store.keep_samples = !csv_path.empty();
+            results = std::make_shared<ResultStore>(store);
+            results->addProbe("v(*)");
+            if (!vcd_path.empty()) {
+                VcdWriterOptions options;
+                options.top_scope = circuit.getName();
+                vcd = std::make_shared<VcdWriter>(vcd_path, options);
+                results->addSink(std::make_shared<AsyncSampleWriter>(vcd));
+            }
+            circuit.setResultStore(results);
+        }
+        std::shared_ptr<SimulationCheckpoint> checkpoint;
+        if (!checkpoint_path.empty()) {
+            if (resume && std::ifstream(checkpoint_path).good()) {
+                checkpoint = readCheckpoint(checkpoint_path);
+            }
+            circuit.setCheckpointSink(std::make_shared<CheckpointFile>(checkpoint_path));
+        }
+        if (checkpoint) {
+            circuit.resume(*checkpoint);
+        } else {
+            circuit.simulate(duration, timestep);
+        }
+
+        if (vcd) {
+            std::cout << "Wrote " << vcd->getStats().changes << " value changes of " << vcd->getStats().variables
+                      << " nets to " << vcd_path << std::endl;
+        }
+        if (!csv_path.empty()) {
+            CsvExportOptions options;
+            if (csv_path.size() >= 4 && csv_path.compare(csv_path.size() - 4, 4, ".tsv") == 0) {
+                options.delimiter = '\t';
+            }
+            std::ofstream out(csv_path, std::ios::binary);
+            if (!out) {
+                throw std::runtime_error("Cannot write " + csv_path);
+            }
+            CsvExportStats stats = exportCsv(*results, out, options);
+            std::cout << "Wrote " << stats.rows << " rows of " << stats.columns << " columns to " << csv_path
+                      << std::endl;
+        }
+        
+        std::cout << "\\nSimulation Results:" << std::endl;
+        for (ComponentId id = 0; id < circuit.getComponentCount(); ++id) {
+            const auto& component = circuit.getComponent(id);
+            std::cout << component->getId() << " (" << component->getType() << "): "
+                      << component->getCurrentValue() << std::endl;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Failed to run " << path << ": " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    std::string circuit_path;
+    std::string csv_path;
+    std::string vcd_path;
+    std::string checkpoint_path;
+    bool resume = false;
+    for (int i = 1; i < argc; ++i) {
+        if (std::string(argv[i]) == "--resume") {
+            resume = true;
+        }
+    }
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (std::string(argv[i]) == "--circuit") {
+            circuit_path = argv[i + 1];
+        } else if (std::string(argv[i]) == "--csv") {
+            csv_path = argv[i + 1];
+        } else if (std::string(argv[i]) == "--vcd") {
+            vcd_path = argv[i + 1];
+        } else if (std::string(argv[i]) == "--checkpoint") {
+            checkpoint_path = argv[i + 1];
+        } else if (std::string(argv[i]) == "--threads") {
+            ThreadPoolOptions options;
+            options.threads = std::stoul(argv[i + 1]);
+            ThreadPool::configureShared(options);
+        }
+    }
+    
+    if (resume && (!csv_path.empty() || !vcd_path.empty())) {
+        std::cerr << "--resume cannot be combined with --csv or --vcd: the output would restart at the checkpoint"
+                  << std::endl;
+        return 1;
+    }
+    
     std::cout << "=== Integrated Circuit Simulation Platform ===" << std::endl;
     std::cout << "Initializing simulation environment..." << std::endl;
     
@@ -34,6 +158,10 @@ int main() {
         }
     }
     
+    if (!circuit_path.empty()) {
+        return runNetlist(circuit_path, csv_path, vcd_path, checkpoint_path, resume);
+    }
+    
     // Create a demo circuit
     std::cout << "\\nCreating demo circuit..." << std::endl;
     auto circuit = std::make_shared<Circuit>("Demo RC Circuit");
@@ -18,17 +18,77 @@ public:
             double voltage_diff = nodes_[0]->getVoltage() - nodes_[1]->getVoltage();
             // L * di/dt = V, so di = V * dt / L
             double current_change = voltage_diff * timestep / inductance_;
-            current_ += current_change;
-            voltage_ = voltage_diff;
+            (bank_ ? bank_->current[slot_] : current_) += current_change;
+            (bank_ ? bank_->voltage[slot_] : voltage_) = voltage_diff;
         }
     }
     
-    double getCurrentValue() const override { return current_; }
-    void connect(std::shared_ptr<Node> node) override {
-        nodes_.push_back(node);
-        node->addComponent(std::static_pointer_cast<Component>(shared_from_this()));
-    }
+    double getCurrentValue() const override { return bank_ ? bank_->current[slot_] : current_; }
     std::string getType() const override { return "Inductor"; }
+    std::unique_ptr<Component> clone() const override {
+        auto copy = std::make_unique<Inductor>(*this);
+        copy->unbindState();
+        return copy;
+    }
+    
+    bool bindState(DeviceState& state) const override {
+        if (nodes_.size() < 2) {
+            return false;
+        }
+        state.inductors().add(nodes_[0]->getHandle(), nodes_[1]->getHandle(), inductance_, current_, voltage_);
+        return true;
+    }
+    
+    void attachState(DeviceState& state, size_t slot) override {
+        bank_ = &state.inductors();
+        slot_ = slot;
+    }
+    
+    void unbindState() override {
+        if (bank_) {
+            current_ = bank_->current[slot_];
+            voltage_ = bank_->voltage[slot_];
+            bank_ = nullptr;
+        }
+    }
+    
+    void moveSlot(size_t slot) override { slot_ = slot; }
+    
+    void resetState() override {
+        current_ = 0.0;
+        voltage_ = 0.0;
+        if (bank_) {
+            bank_->current[slot_] = 0.0;
+            bank_->voltage[slot_] = 0.0;
+        }
+    }
+    
+    bool saveState(std::vector<double>& values) const override {
+        values.push_back(current_);
+        values.push_back(voltage_);
+        return true;
+    }
+    
+    void restoreState(const double* values) override {
+        current_ = values[0];
+        voltage_ = values[1];
+    }
+    
+    bool getParameters(std::vector<double>& values) const override {
+        values.push_back(inductance_);
+        return true;
+    }
+    
+    bool setParameter(size_t index, double value) override {
+        if (index != 0) {
+            return false;
+        }
+        inductance_ = value;
+        if (bank_) {
+            bank_->inductance[slot_] = value;
+        }
+        return true;
+    }
     
     double getInductance() const { return inductance_; }
 
@@ -36,6 +96,9 @@ private:
     double inductance_;
     double current_;
     double voltage_;
+    // Set while the state lives in the circuit's DeviceState
+    InductorBank* bank_ = nullptr;
+    size_t slot_ = 0;
 };
 
 /**
@@ -46,6 +109,7 @@ public:
     Diode(double forward_voltage = 0.7) : forward_voltage_(forward_voltage), current_(0.0) {}
     
     void simulate(double timestep) override {
+        (void)timestep;
         if (nodes_.size() >= 2) {
             double voltage_diff = nodes_[0]->getVoltage() - nodes_[1]->getVoltage();
             
@@ -60,11 +124,25 @@ public:
     }
     
     double getCurrentValue() const override { return current_; }
-    void connect(std::shared_ptr<Node> node) override {
-        nodes_.push_back(node);
-        node->addComponent(std::static_pointer_cast<Component>(shared_from_this()));
-    }
     std::string getType() const override { return "Diode"; }
+    void resetState() override { current_ = 0.0; }
+    bool saveState(std::vector<double>& values) const override {
+        values.push_back(current_);
+        return true;
+    }
+    void restoreState(const double* values) override { current_ = values[0]; }
+    std::unique_ptr<Component> clone() const override { return std::make_unique<Diode>(*this); }
+    bool getParameters(std::vector<double>& values) const override {
+        values.push_back(forward_voltage_);
+        return true;
+    }
+    bool setParameter(size_t index, double value) override {
+        if (index != 0) {
+            return false;
+        }
+        forward_voltage_ = value;
+        return true;
+    }
 
 private:
     double forward_voltage_;
@@ -76,33 +154,42 @@ private:
  */
 class ExamplePlugin : public BasePlugin {
 public:
-    ExamplePlugin() : BasePlugin("ExamplePlugin", "1.0.0", "Example plugin with inductor and diode components") {}
+    ExamplePlugin()
+        : BasePlugin("ExamplePlugin", "1.0.0", "Example plugin with inductor and diode components"),
+          inductor_schema_("Inductor"), diode_schema_("Diode") {
+        inductor_schema_.add("inductance", 1e-3);    // Default 1mH
+        diode_schema_.add("forward_voltage", 0.7);   // Default 0.7V
+    }
     
     std::shared_ptr<Component> createComponent(const std::string& type,
                                               const std::map<std::string, double>& parameters) override {
+        const ParameterSchema* schema = getParameterSchema(type);
+        return schema ? instantiate(schema->fromMap(parameters)) : nullptr;
+    }
+    
+    std::vector<std::string> getSupportedComponents() const override {
+        return {"Inductor", "Diode"};
+    }
+    
+    const ParameterSchema* getParameterSchema(const std::string& type) const override {
         if (type == "Inductor") {
-            double inductance = 1e-3; // Default 1mH
-            auto it = parameters.find("inductance");
-            if (it != parameters.end()) {
-                inductance = it->second;
-            }
-            return std::make_shared<Inductor>(inductance);
+            return &inductor_schema_;
         }
-        
         if (type == "Diode") {
-            double forward_voltage = 0.7; // Default 0.7V
-            auto it = parameters.find("forward_voltage");
-            if (it != parameters.end()) {
-                forward_voltage = it->second;
-            }
-            return std::make_shared<Diode>(forward_voltage);
+            return &diode_schema_;
         }
-        
         return nullptr;
     }
     
-    std::vector<std::string> getSupportedComponents() const override {
-        return {"Inductor", "Diode"};
+    std::shared_ptr<Component> instantiate(const ParameterBlock& parameters) override {
+        const ParameterSchema* schema = &parameters.getSchema();
+        if (schema == &inductor_schema_) {
+            return std::make_shared<Inductor>(parameters.real(kInductance));
+        }
+        if (schema == &diode_schema_) {
+            return std::make_shared<Diode>(parameters.real(kForwardVoltage));
+        }
+        return nullptr;
     }
 
 protected:
@@ -114,6 +201,14 @@ protected:
     void doCleanup() override {
         std::cout << "ExamplePlugin cleaned up" << std::endl;
     }
+
+private:
+    // Slots in the order the schemas were built
+    static constexpr size_t kInductance = 0;
+    static constexpr size_t kForwardVoltage = 0;
+    
+    ParameterSchema inductor_schema_;
+    ParameterSchema diode_schema_;
 };
 
 } // namespace ic_sim
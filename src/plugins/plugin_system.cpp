@@ -137,6 +137,27 @@ std::shared_ptr<Component> PluginManager::createComponent(const std::string& typ
     return nullptr;
 }
 
+ComponentFactory PluginManager::resolveComponent(const std::string& type) const {
+    ComponentFactory factory;
+    for (const auto& [name, plugin] : plugins_) {
+        if (const ParameterSchema* schema = plugin->getParameterSchema(type)) {
+            factory.plugin = plugin.get();
+            factory.schema = schema;
+            break;
+        }
+    }
+    return factory;
+}
+
+std::shared_ptr<Component> PluginManager::createComponent(const ComponentFactory& factory,
+                                                         const ParameterBlock& parameters) {
+    // Hot path for bulk instantiation: no lookups, maps or logging per instance
+    if (!factory || &parameters.getSchema() != factory.schema) {
+        return nullptr;
+    }
+    return factory.plugin->instantiate(parameters);
+}
+
 std::vector<std::string> PluginManager::getAllSupportedComponents() const {
     std::vector<std::string> all_components;
     
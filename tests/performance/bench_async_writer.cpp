@@ -0,0 +1,87 @@
+#include "core/circuit.h"
+#include "core/result_store.h"
+#include "io/async_writer.h"
+#include "ladder_fixture.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+
+using namespace ic_sim;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// Raw little-endian rows, flushed to the OS every block like a real writer
+class FileSink : public SampleSink {
+public:
+    explicit FileSink(std::string path) : path_(std::move(path)) {}
+
+    void begin(const std::vector<std::string>&) override { out_.open(path_, std::ios::binary | std::ios::trunc); }
+    void write(const double* rows, size_t count, size_t width) override {
+        out_.write(reinterpret_cast<const char*>(rows), static_cast<std::streamsize>(count * width * sizeof(double)));
+        out_.flush();
+    }
+    void finish() override { out_.close(); }
+
+private:
+    std::string path_;
+    std::ofstream out_;
+};
+
+double run(Circuit& circuit, std::shared_ptr<SampleSink> sink, size_t steps) {
+    ResultStoreOptions options;
+    options.keep_samples = false;
+    auto results = std::make_shared<ResultStore>(options);
+    results->addProbe("v(*)");
+    if (sink) {
+        results->addSink(sink);
+    }
+    circuit.setResultStore(results);
+    circuit.reset();
+    auto start = Clock::now();
+    circuit.simulate(static_cast<double>(steps) * 1e-9, 1e-9);
+    return secondsSince(start);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t stages = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 20000;
+    size_t steps = (argc > 2) ? std::strtoull(argv[2], nullptr, 10) : 2000;
+    std::string path = (std::filesystem::temp_directory_path() / "ic_sim_bench_waveform.bin").string();
+    auto circuit = bench::makeLadder(stages, bench::LadderKind::Capacitive);
+    std::cout << "Async writer benchmark: " << stages + 2 << " probes, " << steps << " steps" << std::endl;
+
+    double bare = run(*circuit, nullptr, steps);
+    double sync = run(*circuit, std::make_shared<FileSink>(path), steps);
+    size_t bytes = std::filesystem::file_size(path);
+
+    auto writer = std::make_shared<AsyncSampleWriter>(std::make_shared<FileSink>(path));
+    double async = run(*circuit, writer, steps);
+    AsyncWriterStats stats = writer->getStats();
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "  no output        " << std::setw(8) << bare << " s" << std::endl;
+    std::cout << "  synchronous file " << std::setw(8) << sync << " s  " << bytes / 1e6 << " MB" << std::endl;
+    std::cout << "  async file       " << std::setw(8) << async << " s  solver waited " << stats.wait_seconds
+              << " s in " << stats.waits << " waits, max queue " << stats.max_queued << std::endl;
+
+    std::remove(path.c_str());
+    size_t expected = circuit->getLastRunStats().steps + 1;
+    if (stats.rows_written != expected || stats.rows_dropped != 0) {
+        std::cerr << "Writer delivered " << stats.rows_written << " of " << expected << " rows" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,70 @@
+#include "core/circuit.h"
+#include "io/checkpoint.h"
+#include "ladder_fixture.h"
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+
+using namespace ic_sim;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t stages = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 20000;
+    size_t steps = (argc > 2) ? std::strtoull(argv[2], nullptr, 10) : 5000;
+    size_t every = (argc > 3) ? std::strtoull(argv[3], nullptr, 10) : 500;
+    std::string path = (std::filesystem::temp_directory_path() / "ic_sim_bench.ickpt").string();
+    std::cout << "Checkpoint benchmark: " << 2 * stages + 1 << " devices, " << steps << " steps, checkpoint every "
+              << every << " steps" << std::endl;
+
+    auto circuit = bench::makeLadder(stages);
+    auto start = Clock::now();
+    circuit->simulate(static_cast<double>(steps) * 1e-9, 1e-9);
+    double bare = secondsSince(start);
+
+    CheckpointOptions options;
+    options.every_steps = every;
+    options.every_seconds = 0.0;
+    auto file = std::make_shared<CheckpointFile>(path, options);
+    circuit->reset();
+    circuit->setCheckpointSink(file);
+    start = Clock::now();
+    circuit->simulate(static_cast<double>(steps) * 1e-9, 1e-9);
+    double checkpointed = secondsSince(start);
+    CheckpointStats stats = file->getStats();
+    double final_voltage = circuit->getNode(circuit->getNodeCount() - 1)->getVoltage();
+
+    start = Clock::now();
+    std::shared_ptr<SimulationCheckpoint> checkpoint = readCheckpoint(path);
+    double load = secondsSince(start);
+    auto resumed = bench::makeLadder(stages);
+    resumed->resume(*checkpoint);
+
+    size_t taken = steps / every;
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "  no checkpoints     " << std::setw(8) << bare << " s" << std::endl;
+    std::cout << "  checkpointed       " << std::setw(8) << checkpointed << " s  (" << stats.written << " written, "
+              << stats.superseded << " superseded, " << std::setprecision(1) << stats.bytes / 1e6 << " MB each)"
+              << std::setprecision(3) << std::endl;
+    std::cout << "  overhead           " << std::setw(8) << (checkpointed - bare) * 1e3 / double(taken)
+              << " ms per checkpoint on the simulation thread, writer "
+              << stats.write_seconds * 1e3 / double(stats.written) << " ms" << std::endl;
+    std::cout << "  read checkpoint    " << std::setw(8) << load * 1e3 << " ms" << std::endl;
+
+    bool ok = stats.written >= 1 && stats.written + stats.superseded == taken &&
+              resumed->getNode(resumed->getNodeCount() - 1)->getVoltage() == final_voltage;
+    std::filesystem::remove(path);
+    return ok ? 0 : 1;
+}
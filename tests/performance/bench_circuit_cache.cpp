@@ -0,0 +1,81 @@
+#include "io/circuit_cache.h"
+#include "io/spice_netlist.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+using namespace ic_sim;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// RC ladder with a parasitic cap on every fourth node
+void writeDeck(const std::string& path, size_t devices) {
+    std::ofstream out(path, std::ios::binary);
+    out << "Cache benchmark ladder\nV1 n0 0 PULSE(0 1 1n 1n 1n 5n 20n)\n";
+    for (size_t i = 0; i < devices; ++i) {
+        if (i % 4 == 3) {
+            out << "Cp" << i << " n" << i << " 0 " << (i % 97) + 1 << ".25f\n";
+        } else {
+            out << "Rp" << i << " n" << i << " n" << i + 1 << " " << (i % 89) + 1 << ".5\n";
+        }
+    }
+    out << ".tran 1p 1n\n.end\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t devices = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    std::string path = (std::filesystem::temp_directory_path() / "ic_sim_bench_cache.sp").string();
+    writeDeck(path, devices);
+
+    NetlistCacheOptions options;
+    std::filesystem::remove(path + ".iccache");
+
+    auto start = Clock::now();
+    CachedNetlist parsed = loadNetlistCached(path, options);
+    double cold = secondsSince(start);
+
+    start = Clock::now();
+    CachedNetlist cached = loadNetlistCached(path, options);
+    double warm = secondsSince(start);
+
+    // Parse and compile alone, without hashing or writing the cache
+    start = Clock::now();
+    SpiceNetlist netlist = loadSpiceNetlist(path);
+    netlist.circuit->compile();
+    double parse = secondsSince(start);
+
+    size_t deck_bytes = std::filesystem::file_size(path);
+    size_t cache_bytes = std::filesystem::file_size(parsed.cache_path);
+    bool ok = !parsed.from_cache && cached.from_cache &&
+              cached.circuit->getComponentCount() == parsed.circuit->getComponentCount() &&
+              cached.circuit->getTopology()->getOrdering() == parsed.circuit->getTopology()->getOrdering();
+
+    std::cout << "Circuit cache benchmark: " << devices << " devices, deck " << deck_bytes / 1e6 << " MB, cache "
+              << cache_bytes / 1e6 << " MB" << std::endl;
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "  parse + compile      " << std::setw(8) << parse << " s" << std::endl;
+    std::cout << "  cold (parse + write) " << std::setw(8) << cold << " s" << std::endl;
+    std::cout << "  warm (cache load)    " << std::setw(8) << warm << " s" << std::setprecision(1) << std::setw(8)
+              << parse / warm << "x" << std::endl;
+
+    std::remove(path.c_str());
+    std::remove(parsed.cache_path.c_str());
+    if (!ok) {
+        std::cerr << "Cached circuit does not match the parsed one" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,101 @@
+#include "core/circuit.h"
+#include "core/result_store.h"
+#include "core/thread_pool.h"
+#include "io/csv_export.h"
+#include "ladder_fixture.h"
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace ic_sim;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// The usual iostream loop, for comparison
+size_t exportWithStream(const ResultStore& results, std::ostream& out) {
+    out << std::setprecision(17);
+    out << "time";
+    for (size_t probe = 0; probe < results.getProbeCount(); ++probe) {
+        out << ',' << results.getProbeName(probe);
+    }
+    out << '\n';
+    for (size_t chunk = 0; chunk < results.getChunkCount(); ++chunk) {
+        SampleSpan times = results.time(chunk);
+        for (size_t row = 0; row < times.size(); ++row) {
+            out << times[row];
+            for (size_t probe = 0; probe < results.getProbeCount(); ++probe) {
+                out << ',' << results.samples(probe, chunk)[row];
+            }
+            out << '\n';
+        }
+    }
+    return static_cast<size_t>(out.tellp());
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t steps = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 200000;
+    size_t stages = (argc > 2) ? std::strtoull(argv[2], nullptr, 10) : 100;
+    std::string path = (std::filesystem::temp_directory_path() / "ic_sim_bench_export.csv").string();
+
+    auto circuit = bench::makeLadder(stages);
+    auto results = std::make_shared<ResultStore>();
+    results->addProbe("v(*)");
+    circuit->setResultStore(results);
+    circuit->simulate(static_cast<double>(steps) * 1e-9, 1e-9);
+    size_t values = results->getSampleCount() * (results->getProbeCount() + 1);
+    std::cout << "CSV export benchmark: " << results->getSampleCount() << " rows, " << results->getProbeCount() + 1
+              << " columns" << std::endl;
+    std::cout << std::fixed << std::setprecision(1);
+
+    auto report = [&](const char* label, size_t bytes, double seconds) {
+        std::cout << "  " << std::left << std::setw(22) << label << std::right << std::setw(8) << seconds * 1e3
+                  << " ms  " << std::setw(7) << bytes / seconds / 1e6 << " MB/s  " << std::setw(6)
+                  << seconds * 1e9 / values << " ns/value" << std::endl;
+    };
+
+    auto start = Clock::now();
+    size_t baseline_bytes = 0;
+    {
+        std::ofstream out(path, std::ios::binary);
+        baseline_bytes = exportWithStream(*results, out);
+    }
+    report("iostream <<", baseline_bytes, secondsSince(start));
+
+    bool ok = true;
+    size_t hardware = ThreadPool::shared().getThreadCount();
+    struct Case {
+        const char* label;
+        int precision;
+        size_t threads;
+    };
+    for (const Case& run : {Case{"to_chars shortest", 0, 1}, Case{"to_chars 6 digits", 6, 1},
+                            Case{"to_chars all threads", 0, hardware}}) {
+        CsvExportOptions options;
+        options.precision = run.precision;
+        options.threads = run.threads;
+        start = Clock::now();
+        CsvExportStats stats;
+        {
+            std::ofstream out(path, std::ios::binary);
+            stats = exportCsv(*results, out, options);
+        }
+        report(run.label, stats.bytes, secondsSince(start));
+        ok = ok && stats.rows == results->getSampleCount() && stats.bytes > 0;
+    }
+    std::filesystem::remove(path);
+    return ok ? 0 : 1;
+}
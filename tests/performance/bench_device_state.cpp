@@ -0,0 +1,95 @@
+#include "core/circuit.h"
+#include "core/device_state.h"
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace ic_sim;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// The circuit provides node handles and the voltage table; the devices are
+// stepped outside it
+struct Ladder {
+    Circuit circuit{"Ladder"};
+    std::vector<std::shared_ptr<Node>> nodes;
+    std::vector<std::shared_ptr<Component>> capacitors;
+
+    explicit Ladder(size_t devices) {
+        circuit.reserve<Node>(devices + 1);
+        circuit.reserve<Capacitor>(devices);
+        for (size_t i = 0; i <= devices; ++i) {
+            nodes.push_back(circuit.createNode("N" + std::to_string(i)));
+        }
+        for (size_t i = 0; i < devices; ++i) {
+            auto capacitor = circuit.createComponent<Capacitor>("C" + std::to_string(i), 1e-12);
+            circuit.connect(capacitor->getHandle(), nodes[i]->getHandle());
+            circuit.connect(capacitor->getHandle(), nodes[i + 1]->getHandle());
+            capacitors.push_back(capacitor);
+        }
+    }
+
+    void drive(size_t step) {
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            nodes[i]->setVoltage(static_cast<double>((i * 7 + step) % 13));
+        }
+    }
+};
+
+// Per-object virtual simulate() calls, state scattered over the heap
+double runObjects(size_t devices, size_t steps) {
+    Ladder ladder(devices);
+    auto start = Clock::now();
+    for (size_t step = 0; step < steps; ++step) {
+        ladder.drive(step);
+        for (auto& capacitor : ladder.capacitors) {
+            capacitor->simulate(1e-9);
+        }
+    }
+    return secondsSince(start);
+}
+
+double runBanks(size_t devices, size_t steps, SimdLevel level) {
+    Ladder ladder(devices);
+    DeviceState state(level);
+    state.bind(ladder.capacitors);
+    auto start = Clock::now();
+    for (size_t step = 0; step < steps; ++step) {
+        ladder.drive(step);
+        state.step(ladder.circuit.getVoltages(), 1e-9);
+    }
+    return secondsSince(start);
+}
+
+void report(const std::string& name, double seconds, double baseline) {
+    std::cout << std::left << std::setw(10) << name << std::right << std::fixed << std::setprecision(3)
+              << std::setw(9) << seconds << " s" << std::setw(8) << std::setprecision(2) << baseline / seconds
+              << "x" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t devices = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    size_t steps = (argc > 2) ? std::strtoull(argv[2], nullptr, 10) : 100;
+
+    std::cout << "Device state benchmark: " << devices << " capacitors, " << steps << " steps" << std::endl;
+    double objects = runObjects(devices, steps);
+    report("objects", objects, objects);
+    for (SimdLevel level : {SimdLevel::Scalar, SimdLevel::AVX2, SimdLevel::AVX512}) {
+        if (level <= detectSimdLevel()) {
+            report(toString(level), runBanks(devices, steps, level), objects);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,87 @@
+#include "core/circuit.h"
+#include "core/topology.h"
+#include "ladder_fixture.h"
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+
+using namespace ic_sim;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// One ECO round: a buffer stage hung off a ladder node, a parallel device, a
+// resized capacitor, then the stage taken out again
+void editRound(Circuit& circuit, size_t round, size_t stages) {
+    std::string tag = std::to_string(round);
+    NodeId tap = static_cast<NodeId>(1 + (round * 7919) % stages);
+    NodeId node = circuit.insertNode("eco" + tag);
+    auto resistor = std::make_shared<Resistor>(1e3);
+    resistor->setId("RECO" + tag);
+    ComponentId r = circuit.insertComponent(resistor, {tap, node});
+    auto capacitor = std::make_shared<Capacitor>(1e-13);
+    capacitor->setId("CECO" + tag);
+    circuit.insertComponent(capacitor, {tap, 0});
+    circuit.setParameter(circuit.findComponent("C" + std::to_string(tap - 1)), 0, 2e-12);
+    circuit.removeComponent(r);
+    circuit.removeNode(node);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t stages = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 200000;
+    size_t rounds = (argc > 2) ? std::strtoull(argv[2], nullptr, 10) : 100;
+    std::cout << "ECO benchmark: " << 2 * stages + 1 << " devices, " << rounds << " edit rounds" << std::endl;
+
+    auto circuit = bench::makeLadder(stages);
+    auto start = Clock::now();
+    circuit->compile();
+    double compile = secondsSince(start);
+    circuit->simulate(1e-9, 1e-9);
+
+    // Incremental: patch the topology and keep the bound state
+    start = Clock::now();
+    for (size_t round = 0; round < rounds; ++round) {
+        editRound(*circuit, round, stages);
+    }
+    double edits = secondsSince(start);
+    start = Clock::now();
+    circuit->simulate(1e-9, 1e-9);
+    double restart = secondsSince(start);
+
+    // The same edits followed by a full recompile
+    auto full = bench::makeLadder(stages);
+    full->compile();
+    full->simulate(1e-9, 1e-9);
+    start = Clock::now();
+    for (size_t round = 0; round < rounds; ++round) {
+        editRound(*full, round, stages);
+        full->compile();
+    }
+    double recompiled = secondsSince(start);
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "  full compile       " << std::setw(8) << compile * 1e3 << " ms" << std::endl;
+    std::cout << "  ECO round          " << std::setw(8) << edits * 1e3 / double(rounds)
+              << " ms (6 edits, topology patched)" << std::endl;
+    std::cout << "  round + recompile  " << std::setw(8) << recompiled * 1e3 / double(rounds) << " ms" << std::endl;
+    std::cout << "  next run start     " << std::setw(8) << restart * 1e3 << " ms (one step, device state kept)"
+              << std::endl;
+
+    const Topology& patched = *circuit->getTopology();
+    const Topology& rebuilt = *full->getTopology();
+    bool ok = patched.getNodeDevices() == rebuilt.getNodeDevices() &&
+              patched.getPatternColumns() == rebuilt.getPatternColumns() &&
+              patched.getIslandCount() == rebuilt.getIslandCount() &&
+              circuit->getComponentCount() == 2 * stages + 1 + rounds;
+    return ok ? 0 : 1;
+}
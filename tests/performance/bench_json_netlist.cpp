@@ -0,0 +1,93 @@
+#include "io/json_netlist.h"
+#include "io/json_reader.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+using namespace ic_sim;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// RC ladder in the rc_filter.json layout: device i joins net i and net i+1
+void writeLadder(const std::string& path, size_t devices) {
+    std::ofstream out(path, std::ios::binary);
+    out << "{\n  \"name\": \"Generated ladder\",\n  \"version\": \"1.0\",\n  \"components\": [\n";
+    for (size_t i = 0; i < devices; ++i) {
+        bool capacitor = (i % 10 == 9);
+        out << "    {\"id\": \"X" << i << "\", \"type\": \"" << (capacitor ? "Capacitor" : "Resistor")
+            << "\", \"parameters\": {\"" << (capacitor ? "capacitance\": 1e-12" : "resistance\": 1000.0")
+            << "}, \"position\": {\"x\": " << i << ", \"y\": 0, \"z\": 0}}" << (i + 1 < devices ? ",\n" : "\n");
+    }
+    out << "  ],\n  \"connections\": [\n";
+    for (size_t i = 0; i + 1 < devices; ++i) {
+        out << "    {\"id\": \"w" << i << "\", \"from\": \"X" << i << "\", \"to\": \"X" << i + 1
+            << "\", \"from_node\": \"output\", \"to_node\": \"input\"}" << (i + 2 < devices ? ",\n" : "\n");
+    }
+    out << "  ],\n  \"simulation\": {\"duration\": 1e-3, \"timestep\": 1e-6, \"type\": \"transient\"}\n}\n";
+}
+
+// Counts events only, to separate tokenizing from circuit construction
+class CountingHandler : public JsonHandler {
+public:
+    size_t events = 0;
+
+    void startObject() override { ++events; }
+    void endObject() override { ++events; }
+    void startArray() override { ++events; }
+    void endArray() override { ++events; }
+    void key(std::string_view) override { ++events; }
+    void string(std::string_view) override { ++events; }
+    void number(double) override { ++events; }
+    void boolean(bool) override { ++events; }
+    void null() override { ++events; }
+};
+
+void report(const std::string& name, size_t bytes, double seconds) {
+    std::cout << std::left << std::setw(10) << name << std::right << std::fixed << std::setprecision(3)
+              << std::setw(9) << seconds << " s" << std::setw(10) << std::setprecision(1)
+              << bytes / seconds / 1e6 << " MB/s" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t devices = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    std::string path = (std::filesystem::temp_directory_path() / "ic_sim_bench_netlist.json").string();
+
+    writeLadder(path, devices);
+    size_t bytes = std::filesystem::file_size(path);
+    std::cout << "JSON netlist benchmark: " << devices << " devices, " << bytes / 1e6 << " MB" << std::endl;
+
+    {
+        std::ifstream in(path, std::ios::binary);
+        CountingHandler handler;
+        auto start = Clock::now();
+        JsonReader reader(in);
+        reader.parse(handler);
+        report("tokenize", bytes, secondsSince(start));
+    }
+    {
+        auto start = Clock::now();
+        JsonNetlist netlist = loadJsonNetlistFile(path);
+        double seconds = secondsSince(start);
+        report("load", bytes, seconds);
+        if (netlist.circuit->getComponentCount() != devices || netlist.circuit->getNodeCount() != devices + 1) {
+            std::cerr << "Unexpected circuit size" << std::endl;
+            std::remove(path.c_str());
+            return 1;
+        }
+    }
+    std::remove(path.c_str());
+    return 0;
+}
@@ -0,0 +1,81 @@
+#include "core/linear_solver.h"
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace ic_sim;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+struct Timing {
+    double factor = 0.0;
+    double solve = 0.0;
+    SolveReport report;
+};
+
+Timing run(SolverPrecision precision, const std::vector<double>& matrix, const std::vector<double>& rhs,
+           size_t n) {
+    SolverOptions options;
+    options.precision = precision;
+    LinearSolver solver(options);
+    Timing timing;
+
+    auto start = Clock::now();
+    solver.factor(matrix, n);
+    timing.factor = secondsSince(start);
+
+    std::vector<double> solution;
+    start = Clock::now();
+    timing.report = solver.solve(rhs, solution);
+    timing.solve = secondsSince(start);
+    return timing;
+}
+
+void report(const char* name, const Timing& timing) {
+    std::cout << std::left << std::setw(8) << name << std::right << std::fixed << std::setprecision(3)
+              << std::setw(9) << timing.factor << " s factor" << std::setw(9) << timing.solve << " s solve"
+              << std::setw(5) << timing.report.refinements << " refinements" << std::scientific
+              << std::setprecision(2) << std::setw(11) << timing.report.backward_error << " backward error"
+              << (timing.report.fell_back ? " (fell back)" : "") << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t n = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 2000;
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> entry(-1.0, 1.0);
+    std::vector<double> matrix(n * n);
+    std::vector<double> rhs(n);
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < n; ++j) {
+            matrix[i * n + j] = entry(rng);
+        }
+        matrix[i * n + i] += static_cast<double>(n);
+        rhs[i] = entry(rng);
+    }
+
+    std::cout << "Mixed-precision solve benchmark: " << n << " x " << n << std::endl;
+    Timing full = run(SolverPrecision::Double, matrix, rhs, n);
+    Timing mixed = run(SolverPrecision::Mixed, matrix, rhs, n);
+    if (mixed.report.fell_back) {
+        std::cerr << "Unexpected fallback: " << mixed.report.fallback_reason << std::endl;
+        return 1;
+    }
+
+    report("double", full);
+    report("mixed", mixed);
+    std::cout << std::fixed << std::setprecision(2) << "Speedup: "
+              << (full.factor + full.solve) / (mixed.factor + mixed.solve) << "x" << std::endl;
+    return 0;
+}
@@ -0,0 +1,117 @@
+#include "core/circuit.h"
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+
+using namespace ic_sim;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+struct Timing {
+    double build = 0.0;
+    double teardown = 0.0;
+    size_t nodes = 0;
+};
+
+// Generated RC ladder: device i sits between node i and node i+1, and every
+// tenth device is a capacitor to keep the pools mixed
+bool isCapacitor(size_t device) {
+    return device % 10 == 9;
+}
+
+// make_shared per element, Component::connect per terminal
+Timing buildShared(size_t devices) {
+    Timing timing;
+    auto start = Clock::now();
+    auto circuit = std::make_unique<Circuit>("shared");
+    auto previous = std::make_shared<Node>("N0");
+    circuit->addNode(previous);
+    for (size_t i = 0; i < devices; ++i) {
+        auto node = std::make_shared<Node>("N" + std::to_string(i + 1));
+        circuit->addNode(node);
+
+        std::shared_ptr<Component> component;
+        if (isCapacitor(i)) {
+            component = std::make_shared<Capacitor>(1e-12);
+        } else {
+            component = std::make_shared<Resistor>(100.0);
+        }
+        component->setId("X" + std::to_string(i));
+        component->connect(previous);
+        component->connect(node);
+        circuit->addComponent(component);
+        previous = node;
+    }
+    previous.reset();
+    timing.build = secondsSince(start);
+    timing.nodes = circuit->getNodeCount();
+
+    start = Clock::now();
+    circuit.reset();
+    timing.teardown = secondsSince(start);
+    return timing;
+}
+
+// Arena pools, circuit-owned elements and handle-based connections
+Timing buildArena(size_t devices) {
+    Timing timing;
+    auto start = Clock::now();
+    auto circuit = std::make_unique<Circuit>("arena");
+    circuit->reserve<Node>(devices + 1);
+    circuit->reserve<Resistor>(devices);
+    circuit->reserve<Capacitor>(devices / 10 + 1);
+
+    NodeId previous = circuit->createNode("N0")->getHandle();
+    for (size_t i = 0; i < devices; ++i) {
+        NodeId node = circuit->createNode("N" + std::to_string(i + 1))->getHandle();
+        std::string id = "X" + std::to_string(i);
+        ComponentId component = isCapacitor(i) ? circuit->createComponent<Capacitor>(id, 1e-12)->getHandle()
+                                               : circuit->createComponent<Resistor>(id, 100.0)->getHandle();
+        circuit->connect(component, previous);
+        circuit->connect(component, node);
+        previous = node;
+    }
+    timing.build = secondsSince(start);
+    timing.nodes = circuit->getNodeCount();
+
+    start = Clock::now();
+    circuit.reset();
+    timing.teardown = secondsSince(start);
+    return timing;
+}
+
+void report(const char* name, const Timing& timing, size_t devices) {
+    std::cout << std::left << std::setw(10) << name << std::right << std::fixed << std::setprecision(3)
+              << std::setw(10) << timing.build << " s build" << std::setw(10) << timing.teardown << " s teardown"
+              << std::setw(10) << std::setprecision(1) << 1e9 * timing.build / static_cast<double>(devices)
+              << " ns/device" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t devices = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+
+    std::cout << "Netlist construction benchmark: " << devices << " devices" << std::endl;
+    Timing shared = buildShared(devices);
+    Timing arena = buildArena(devices);
+    if (shared.nodes != devices + 1 || arena.nodes != devices + 1) {
+        std::cerr << "Unexpected node count" << std::endl;
+        return 1;
+    }
+
+    report("shared", shared, devices);
+    report("arena", arena, devices);
+    std::cout << std::setprecision(2) << "Speedup: " << shared.build / arena.build << "x build, "
+              << shared.teardown / arena.teardown << "x teardown" << std::endl;
+    return 0;
+}
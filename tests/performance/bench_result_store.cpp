@@ -0,0 +1,64 @@
+#include "core/circuit.h"
+#include "core/result_store.h"
+#include "ladder_fixture.h"
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+
+using namespace ic_sim;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+double run(Circuit& circuit, std::shared_ptr<ResultStore> results, size_t steps) {
+    circuit.setResultStore(std::move(results));
+    circuit.reset();
+    auto start = Clock::now();
+    circuit.simulate(static_cast<double>(steps) * 1e-9, 1e-9);
+    return secondsSince(start);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t stages = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 10000;
+    size_t steps = (argc > 2) ? std::strtoull(argv[2], nullptr, 10) : 2000;
+    auto circuit = bench::makeLadder(stages);
+    std::cout << "Result store benchmark: " << 2 * stages + 1 << " devices, " << steps << " steps" << std::endl;
+
+    run(*circuit, nullptr, 10);  // builds the device state
+    double bare = run(*circuit, nullptr, steps);
+
+    auto few = std::make_shared<ResultStore>();
+    few->addProbe("v(n1)");
+    few->addProbe("v(n" + std::to_string(stages) + ")");
+    few->addProbe("i(V1)");
+    double few_seconds = run(*circuit, few, steps);
+
+    auto all = std::make_shared<ResultStore>();
+    all->addProbe("v(*)");
+    double all_seconds = run(*circuit, all, steps);
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "  no probes      " << std::setw(8) << bare << " s" << std::endl;
+    std::cout << "  3 probes       " << std::setw(8) << few_seconds << " s" << std::endl;
+    std::cout << "  v(*) " << std::setw(6) << all->getProbeCount() << " probes" << std::setw(8) << all_seconds << " s"
+              << std::setprecision(1) << std::setw(8) << (all_seconds - bare) * 1e9 / (steps * all->getProbeCount())
+              << " ns/sample, " << all->memoryBytes() / 1e6 << " MB" << std::endl;
+
+    bool ok = few->getSampleCount() == circuit->getLastRunStats().steps + 1 &&
+              all->getSampleCount() == few->getSampleCount() && all->getProbeCount() == stages + 2;
+    if (!ok) {
+        std::cerr << "Unexpected sample counts" << std::endl;
+        return 1;
+    }
+    return 0;
+}
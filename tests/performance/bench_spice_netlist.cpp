@@ -0,0 +1,84 @@
+#include "core/thread_pool.h"
+#include "io/spice_netlist.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+using namespace ic_sim;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// Flat post-layout style deck: RC ladder with parasitic caps to ground and a
+// few parameterized cells
+void writeDeck(const std::string& path, size_t devices) {
+    std::ofstream out(path, std::ios::binary);
+    out << "Generated ladder\n.param rs=12.5 cg=0.8f\n"
+        << ".subckt cell a b params: w=1\nR1 a m {rs*w}\nC1 m 0 {cg*w}\nR2 m b {rs}\n.ends\n";
+    for (size_t i = 0; i < devices; ++i) {
+        if (i % 100 == 99) {
+            out << "Xcell" << i << " n" << i << " n" << i + 1 << " cell w=2\n";
+        } else if (i % 4 == 3) {
+            out << "Cp" << i << " n" << i << " 0 " << (i % 97) + 1 << ".25f\n";
+        } else {
+            out << "Rp" << i << " n" << i << " n" << i + 1 << " " << (i % 89) + 1 << ".5\n";
+        }
+    }
+    out << ".tran 1p 1n\n.end\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t devices = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 2000000;
+    if (argc > 2) {
+        ThreadPoolOptions options;
+        options.threads = std::strtoull(argv[2], nullptr, 10);
+        ThreadPool::configureShared(options);
+    }
+    std::string path = (std::filesystem::temp_directory_path() / "ic_sim_bench_netlist.sp").string();
+
+    writeDeck(path, devices);
+    size_t bytes = std::filesystem::file_size(path);
+    std::cout << "SPICE netlist benchmark: " << devices << " cards, " << bytes / 1e6 << " MB" << std::endl;
+
+    // Thread counts double up to the pool's
+    size_t pool = ThreadPool::shared().getThreadCount();
+    double serial = 0.0;
+    size_t components = 0;
+    for (size_t threads = 1;; threads = std::min(threads * 2, pool)) {
+        SpiceOptions options;
+        options.threads = threads;
+        options.chunk_size = size_t(4) << 20;
+        auto start = Clock::now();
+        SpiceNetlist netlist = loadSpiceNetlist(path, options);
+        double seconds = secondsSince(start);
+        if (threads == 1) {
+            serial = seconds;
+            components = netlist.circuit->getComponentCount();
+        } else if (netlist.circuit->getComponentCount() != components) {
+            std::cerr << "Parallel load built a different circuit" << std::endl;
+            std::remove(path.c_str());
+            return 1;
+        }
+        std::cout << std::setw(3) << threads << " thread(s)" << std::fixed << std::setprecision(3) << std::setw(9)
+                  << seconds << " s" << std::setw(9) << std::setprecision(1) << bytes / seconds / 1e6 << " MB/s"
+                  << std::setw(7) << std::setprecision(2) << serial / seconds << "x" << std::endl;
+        if (threads == pool) {
+            break;
+        }
+    }
+    std::remove(path.c_str());
+    return 0;
+}
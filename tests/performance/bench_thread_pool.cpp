@@ -0,0 +1,103 @@
+#include "core/thread_pool.h"
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <future>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+using namespace ic_sim;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+constexpr size_t kGrain = 4096;
+
+void evaluate(std::vector<double>& values, size_t first, size_t last) {
+    for (size_t i = first; i < last; ++i) {
+        values[i] = std::sqrt(values[i] * 1.0001 + 1.0);
+    }
+}
+
+// Fork-join tree of 2^depth leaf tasks, every level waiting inside a task
+void forkJoin(ThreadPool& pool, int depth, std::atomic<size_t>& leaves) {
+    if (depth == 0) {
+        leaves.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    TaskGroup group(pool);
+    group.run([&pool, depth, &leaves]() { forkJoin(pool, depth - 1, leaves); });
+    forkJoin(pool, depth - 1, leaves);
+    group.wait();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t count = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+    size_t reps = (argc > 2) ? std::strtoull(argv[2], nullptr, 10) : 50;
+    if (argc > 3) {
+        ThreadPoolOptions options;
+        options.threads = std::strtoull(argv[3], nullptr, 10);
+        ThreadPool::configureShared(options);
+    }
+    ThreadPool& pool = ThreadPool::shared();
+    std::cout << "Thread pool benchmark: " << pool.getThreadCount() << " threads, " << count << " values, " << reps
+              << " passes" << std::endl;
+
+    std::vector<double> serial(count, 1.0);
+    auto start = Clock::now();
+    for (size_t rep = 0; rep < reps; ++rep) {
+        evaluate(serial, 0, count);
+    }
+    double one_thread = secondsSince(start);
+
+    // A thread per chunk and pass, the way features spawn their own
+    std::vector<double> spawned(count, 1.0);
+    size_t chunk = (count + pool.getThreadCount() - 1) / pool.getThreadCount();
+    start = Clock::now();
+    for (size_t rep = 0; rep < reps; ++rep) {
+        std::vector<std::future<void>> pending;
+        for (size_t first = 0; first < count; first += chunk) {
+            pending.push_back(std::async(std::launch::async, [&spawned, first, chunk, count]() {
+                evaluate(spawned, first, std::min(count, first + chunk));
+            }));
+        }
+        for (auto& task : pending) {
+            task.get();
+        }
+    }
+    double async = secondsSince(start);
+
+    std::vector<double> pooled(count, 1.0);
+    start = Clock::now();
+    for (size_t rep = 0; rep < reps; ++rep) {
+        parallelFor(0, count, kGrain, [&pooled](size_t first, size_t last) { evaluate(pooled, first, last); });
+    }
+    double parallel = secondsSince(start);
+
+    const int depth = 14;
+    std::atomic<size_t> leaves{0};
+    start = Clock::now();
+    forkJoin(pool, depth, leaves);
+    double tree = secondsSince(start);
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "  serial             " << std::setw(8) << one_thread * 1e3 / double(reps) << " ms per pass"
+              << std::endl;
+    std::cout << "  std::async         " << std::setw(8) << async * 1e3 / double(reps) << " ms per pass" << std::endl;
+    std::cout << "  parallelFor        " << std::setw(8) << parallel * 1e3 / double(reps) << " ms per pass ("
+              << (count + kGrain - 1) / kGrain << " ranges)" << std::endl;
+    std::cout << "  fork-join tasks    " << std::setw(8) << tree * 1e9 / double(leaves.load()) << " ns per task"
+              << std::endl;
+
+    bool ok = pooled == serial && spawned == serial && leaves == (size_t(1) << depth);
+    return ok ? 0 : 1;
+}
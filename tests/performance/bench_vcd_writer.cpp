@@ -0,0 +1,100 @@
+#include "core/result_store.h"
+#include "io/async_writer.h"
+#include "io/vcd_writer.h"
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace ic_sim;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+constexpr size_t kBlockRows = 64;
+
+// One net in a hundred is a clock toggling every 10 steps; the rest hold
+// their level, with a little analog noise on top
+void fillRows(std::vector<double>& rows, size_t first_step, size_t nets) {
+    const size_t width = nets + 1;
+    for (size_t r = 0; r < kBlockRows; ++r) {
+        size_t step = first_step + r;
+        double* row = rows.data() + r * width;
+        row[0] = static_cast<double>(step) * 1e-10;
+        double noise = 0.01 * static_cast<double>(step % 7);
+        for (size_t net = 0; net < nets; ++net) {
+            bool high = (net % 100 == 0) ? (step / 10 + net / 100) % 2 == 1 : net % 3 == 0;
+            row[net + 1] = (high ? 1.0 : 0.0) + noise;
+        }
+    }
+}
+
+// Seconds the caller spent in write() for steps rows
+double run(SampleSink& sink, size_t nets, size_t steps) {
+    std::vector<std::string> columns{"time"};
+    for (size_t net = 0; net < nets; ++net) {
+        columns.push_back("v(X" + std::to_string(net % 16) + ".X" + std::to_string(net % 5) + ".n" +
+                          std::to_string(net) + ")");
+    }
+    std::vector<double> rows(kBlockRows * (nets + 1));
+    sink.begin(columns);
+    double seconds = 0.0;
+    for (size_t step = 0; step < steps; step += kBlockRows) {
+        fillRows(rows, step, nets);
+        auto start = Clock::now();
+        sink.write(rows.data(), kBlockRows, nets + 1);
+        seconds += secondsSince(start);
+    }
+    auto start = Clock::now();
+    sink.finish();
+    return seconds + secondsSince(start);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t nets = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 10000;
+    size_t steps = (argc > 2) ? std::strtoull(argv[2], nullptr, 10) : 100000;
+    steps = (steps + kBlockRows - 1) / kBlockRows * kBlockRows;
+    std::string path = (std::filesystem::temp_directory_path() / "ic_sim_bench.vcd").string();
+    std::cout << "VCD writer benchmark: " << nets << " nets, " << steps << " steps, 1% switching" << std::endl;
+
+    VcdWriterOptions options;
+    options.timescale = 1e-12;
+    auto writer = std::make_shared<VcdWriter>(path, options);
+    double direct = run(*writer, nets, steps);
+    VcdWriterStats stats = writer->getStats();
+
+    AsyncWriterOptions async_options;
+    async_options.block_bytes = kBlockRows * (nets + 1) * sizeof(double);
+    AsyncSampleWriter async(writer, async_options);
+    double queued = run(async, nets, steps);
+
+    double net_steps = static_cast<double>(nets) * static_cast<double>(steps);
+    double raw = net_steps * sizeof(double);
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "  direct             " << std::setw(8) << direct * 1e9 / net_steps << " ns per net-step, "
+              << std::setprecision(1) << direct * 1e9 / double(steps) << " ns per step" << std::endl;
+    std::cout << std::setprecision(2);
+    std::cout << "  async (producer)   " << std::setw(8) << queued * 1e9 / net_steps << " ns per net-step, "
+              << std::setprecision(1) << queued * 1e9 / double(steps) << " ns per step" << std::endl;
+    std::cout << "  file               " << std::setw(8) << stats.bytes / 1e6 << " MB for " << stats.changes
+              << " changes (" << raw / double(stats.bytes) << "x smaller than raw doubles)" << std::endl;
+
+    // Every clock toggles once per 10 steps after the initial dump
+    size_t clocks = (nets + 99) / 100;
+    size_t expected = nets + clocks * ((steps - 1) / 10);
+    bool ok = stats.rows == steps && stats.changes == expected && writer->getStats().changes == expected &&
+              async.getStats().rows_written == steps;
+    std::filesystem::remove(path);
+    return ok ? 0 : 1;
+}
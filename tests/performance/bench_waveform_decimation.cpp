@@ -0,0 +1,87 @@
+#include "io/waveform_decimation.h"
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace ic_sim;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t samples = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+    const size_t pixels = 1000;
+    std::vector<double> times(samples), values(samples);
+    std::mt19937 random(3);
+    std::normal_distribution<double> noise(0.0, 0.01);
+    for (size_t i = 0; i < samples; ++i) {
+        times[i] = double(i) * 1e-9;
+        values[i] = std::sin(double(i) * 1e-5) + noise(random);
+    }
+    std::cout << "Waveform decimation benchmark: " << samples << " samples, " << pixels << " pixels" << std::endl;
+
+    auto start = Clock::now();
+    WaveformPyramid pyramid(times, values);
+    double build = secondsSince(start);
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "  pyramid build      " << std::setw(10) << build * 1e3 << " ms, " << pyramid.getLevelCount()
+              << " levels, " << std::setprecision(1) << pyramid.memoryBytes() / 1e6 << " MB with the raw samples"
+              << std::setprecision(3) << std::endl;
+
+    // Zooming in by 10x per step, centred, pyramid against a full scan
+    bool ok = true;
+    double span = times.back();
+    for (double zoom = 1.0; zoom * 100 <= double(samples); zoom *= 10.0) {
+        double t0 = span / 2 - span / (2 * zoom);
+        double t1 = span / 2 + span / (2 * zoom);
+        const int repeats = 20;
+        std::vector<WaveformBucket> fast, slow;
+        start = Clock::now();
+        for (int r = 0; r < repeats; ++r) {
+            fast = pyramid.envelope(t0, t1, pixels);
+        }
+        double pyramid_seconds = secondsSince(start) / repeats;
+        start = Clock::now();
+        slow = minMaxBuckets(times.data(), values.data(), samples, t0, t1, pixels);
+        double scan_seconds = secondsSince(start);
+
+        double low = INFINITY, high = -INFINITY, expected_low = INFINITY, expected_high = -INFINITY;
+        for (size_t p = 0; p < pixels; ++p) {
+            if (fast[p].count) {
+                low = std::min(low, fast[p].min);
+                high = std::max(high, fast[p].max);
+            }
+            if (slow[p].count) {
+                expected_low = std::min(expected_low, slow[p].min);
+                expected_high = std::max(expected_high, slow[p].max);
+            }
+        }
+        ok = ok && low == expected_low && high == expected_high;
+        std::cout << "  envelope 1/" << std::setw(8) << std::left << static_cast<size_t>(zoom) << std::right
+                  << std::setw(10) << pyramid_seconds * 1e6 << " us  (full scan " << scan_seconds * 1e6 << " us)"
+                  << std::endl;
+    }
+
+    std::vector<double> t, v;
+    start = Clock::now();
+    pyramid.lttb(0.0, span, pixels, t, v);
+    double pyramid_lttb = secondsSince(start);
+    start = Clock::now();
+    std::vector<size_t> direct = lttbIndices(times.data(), values.data(), samples, pixels);
+    double direct_lttb = secondsSince(start);
+    std::cout << "  LTTB whole run     " << std::setw(10) << pyramid_lttb * 1e6 << " us  (over raw samples "
+              << direct_lttb * 1e6 << " us)" << std::endl;
+    ok = ok && !t.empty() && t.size() <= pixels && direct.size() == std::min(pixels, samples);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,107 @@
+#include "core/circuit.h"
+#include "core/result_store.h"
+#include "io/waveform_file.h"
+#include "ladder_fixture.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace ic_sim;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+double run(Circuit& circuit, std::shared_ptr<SampleSink> sink, size_t steps) {
+    ResultStoreOptions options;
+    options.keep_samples = false;
+    auto results = std::make_shared<ResultStore>(options);
+    results->addProbe("v(*)");
+    if (sink) {
+        results->addSink(sink);
+    }
+    circuit.setResultStore(results);
+    circuit.reset();
+    auto start = Clock::now();
+    circuit.simulate(static_cast<double>(steps) * 1e-9, 1e-9);
+    return secondsSince(start);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t stages = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 1000;
+    size_t steps = (argc > 2) ? std::strtoull(argv[2], nullptr, 10) : 20000;
+    std::string path = (std::filesystem::temp_directory_path() / "ic_sim_bench_waveform.icwave").string();
+    auto circuit = bench::makeLadder(stages);
+    std::cout << "Waveform file benchmark: " << stages + 2 << " probes, " << steps << " steps" << std::endl;
+
+    double bare = run(*circuit, nullptr, steps);
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "  no output          " << std::setw(8) << bare << " s" << std::endl;
+
+    bool ok = true;
+    for (int bits : {52, 24}) {
+        WaveformWriterOptions options;
+        options.mantissa_bits = bits;
+        auto writer = std::make_shared<WaveformFileWriter>(path, options);
+        double seconds = run(*circuit, writer, steps);
+        const WaveformWriterStats& stats = writer->getStats();
+
+        WaveformFileReader reader(path);
+        auto start = Clock::now();
+        size_t decoded = 0;
+        for (size_t column = 0; column < reader.getColumns().size(); ++column) {
+            decoded += reader.readColumn(column).size();
+        }
+        double decode = secondsSince(start);
+
+        std::cout << "  " << std::setw(2) << bits << "-bit mantissa    " << std::setw(8) << seconds << " s  "
+                  << std::setprecision(1) << std::setw(7) << stats.raw_bytes / 1e6 << " MB -> " << std::setw(6)
+                  << stats.file_bytes / 1e6 << " MB (" << stats.compressionRatio() << "x), encode "
+                  << (seconds - bare) * 1e9 / (stats.rows * reader.getColumns().size()) << " ns/sample, decode "
+                  << stats.raw_bytes / decode / 1e6 << " MB/s" << std::setprecision(3) << std::endl;
+        ok = ok && stats.rows == circuit->getLastRunStats().steps + 1 && decoded == stats.rows * (stages + 3);
+    }
+
+    // Viewer-style access to the last file: 1% windows of single probes, and
+    // interpolated values on a 2000-point grid
+    WaveformFileReader reader(path);
+    const size_t queries = 200;
+    double span = reader.getEndTime() - reader.getStartTime();
+    std::vector<double> times, values;
+    size_t returned = 0;
+    auto start = Clock::now();
+    for (size_t q = 0; q < queries; ++q) {
+        double t0 = reader.getStartTime() + span * 0.99 * double(q) / queries;
+        reader.readRange(1 + q % (stages + 2), t0, t0 + span * 0.01, times, values);
+        returned += times.size();
+    }
+    double range = secondsSince(start);
+    std::vector<double> grid(2000), sampled(grid.size());
+    for (size_t k = 0; k < grid.size(); ++k) {
+        grid[k] = reader.getStartTime() + span * double(k) / (grid.size() - 1);
+    }
+    start = Clock::now();
+    for (size_t q = 0; q < queries; ++q) {
+        reader.sample(1 + q % (stages + 2), grid.data(), grid.size(), sampled.data());
+    }
+    double sample = secondsSince(start);
+    std::cout << "  1% window query    " << std::setw(8) << range * 1e6 / queries << " us (" << returned / queries
+              << " samples)" << std::endl;
+    std::cout << "  2000-point sample  " << std::setw(8) << sample * 1e6 / queries << " us per probe" << std::endl;
+    ok = ok && returned > 0 && sampled.back() == reader.readColumn(1 + (queries - 1) % (stages + 2)).back();
+
+    std::remove(path.c_str());
+    return ok ? 0 : 1;
+}
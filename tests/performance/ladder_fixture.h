@@ -0,0 +1,52 @@
+#pragma once
+
+#include "core/circuit.h"
+#include "core/sources.h"
+#include <memory>
+#include <string>
+
+namespace ic_sim {
+namespace bench {
+
+enum class LadderKind {
+    // Series R from n(i) to n(i+1), C from n(i+1) to ground
+    RC,
+    // Series C from n(i) to n(i+1) only
+    Capacitive
+};
+
+/**
+ * Sine-driven ladder shared by the benchmarks: smooth analog waveforms on
+ * every node. Node handles are 0 for ground and 1 + i for n(i); V1 drives n0.
+ */
+inline std::unique_ptr<Circuit> makeLadder(size_t stages, LadderKind kind = LadderKind::RC) {
+    auto circuit = std::make_unique<Circuit>("Ladder");
+    circuit->reserve<Node>(stages + 2);
+    NodeId ground = circuit->createNode("0")->getHandle();
+    for (size_t i = 0; i <= stages; ++i) {
+        circuit->createNode("n" + std::to_string(i));
+    }
+    auto source = circuit->createComponent<VoltageSource>("V1", Waveform::sine(0.0, 1.0, 1e6));
+    circuit->connect(source->getHandle(), ground + 1);
+    circuit->connect(source->getHandle(), ground);
+    for (size_t i = 0; i < stages; ++i) {
+        NodeId from = static_cast<NodeId>(ground + 1 + i);
+        NodeId to = static_cast<NodeId>(ground + 2 + i);
+        if (kind == LadderKind::Capacitive) {
+            auto c = circuit->createComponent<Capacitor>("C" + std::to_string(i), 1e-12);
+            circuit->connect(c->getHandle(), from);
+            circuit->connect(c->getHandle(), to);
+            continue;
+        }
+        auto r = circuit->createComponent<Resistor>("R" + std::to_string(i), 100.0);
+        circuit->connect(r->getHandle(), from);
+        circuit->connect(r->getHandle(), to);
+        auto c = circuit->createComponent<Capacitor>("C" + std::to_string(i), 1e-12);
+        circuit->connect(c->getHandle(), to);
+        circuit->connect(c->getHandle(), ground);
+    }
+    return circuit;
+}
+
+} // namespace bench
+} // namespace ic_sim
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "core/circuit.h"
+#include "core/sources.h"
+#include <initializer_list>
+#include <memory>
+#include <string>
+
+namespace ic_sim {
+namespace test {
+
+// Circuit with the given nodes, created in list order so their handles follow it
+inline std::unique_ptr<Circuit> makeCircuit(const std::string& name, std::initializer_list<const char*> nodes) {
+    auto circuit = std::make_unique<Circuit>(name);
+    for (const char* node : nodes) {
+        circuit->createNode(node);
+    }
+    return circuit;
+}
+
+// Connects a two-terminal device from node a to node b, by node id
+inline void wire(Circuit& circuit, const std::shared_ptr<Component>& component, const char* a, const char* b) {
+    circuit.connect(component->getHandle(), circuit.findNode(a));
+    circuit.connect(component->getHandle(), circuit.findNode(b));
+}
+
+// VIN driven by V1, R1 to OUT, C1 to GND, plus a second stage X1.R/X1.C to X1.OUT
+inline std::unique_ptr<Circuit> makeFilter(const std::string& name = "Filter",
+                                           const Waveform& drive = Waveform::pulse(0.0, 1.0, 1e-4, 1e-5, 1e-5,
+                                                                                   2e-4, 0.0),
+                                           double capacitance = 1e-7) {
+    auto circuit = makeCircuit(name, {"VIN", "OUT", "GND", "X1.OUT"});
+    wire(*circuit, circuit->createComponent<VoltageSource>("V1", drive), "VIN", "GND");
+    wire(*circuit, circuit->createComponent<Resistor>("R1", 1e3), "VIN", "OUT");
+    wire(*circuit, circuit->createComponent<Capacitor>("C1", capacitance), "OUT", "GND");
+    wire(*circuit, circuit->createComponent<Resistor>("X1.R", 1e3), "OUT", "X1.OUT");
+    wire(*circuit, circuit->createComponent<Capacitor>("X1.C", capacitance), "X1.OUT", "GND");
+    return circuit;
+}
+
+} // namespace test
+} // namespace ic_sim
@@ -0,0 +1,135 @@
+#include "core/arena.h"
+#include "core/circuit.h"
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <string>
+
+using namespace ic_sim;
+
+namespace {
+
+int live_objects = 0;
+
+struct Counted {
+    explicit Counted(int v) : value(v) { ++live_objects; }
+    ~Counted() { --live_objects; }
+    int value;
+};
+
+} // namespace
+
+void test_typed_pool() {
+    {
+        TypedPool<Counted> pool;
+        Counted* first = pool.create(1);
+        for (int i = 2; i <= 10000; ++i) {
+            pool.create(i);
+        }
+        assert(first->value == 1);
+        assert(pool.size() == 10000);
+        assert(live_objects == 10000);
+
+        // A reserved block is contiguous
+        pool.reserve(100);
+        Counted* a = pool.create(0);
+        Counted* b = pool.create(0);
+        assert(b == a + 1);
+    }
+    assert(live_objects == 0);
+
+    std::cout << "✓ Typed pool test passed" << std::endl;
+}
+
+void test_arena_stats() {
+    CircuitArena arena;
+    arena.reserve<Counted>(16);
+    for (int i = 0; i < 16; ++i) {
+        arena.create<Counted>(i);
+    }
+    arena.create<double>(1.0);
+
+    ArenaStats stats = arena.getStats();
+    assert(stats.pools == 2);
+    assert(stats.objects == 17);
+    assert(stats.bytes_used == 16 * sizeof(Counted) + sizeof(double));
+    assert(stats.bytes_reserved >= stats.bytes_used);
+
+    std::cout << "✓ Arena stats test passed" << std::endl;
+}
+
+void test_arena_built_circuit() {
+    const int count = 10000;
+    {
+        Circuit circuit("Resistor Ladder");
+        circuit.reserve<Node>(count + 1);
+        circuit.reserve<Resistor>(count);
+
+        NodeId previous = circuit.createNode("N0")->getHandle();
+        circuit.getNode(previous)->setVoltage(static_cast<double>(count));
+        for (int i = 1; i <= count; ++i) {
+            auto node = circuit.createNode("N" + std::to_string(i));
+            node->setVoltage(static_cast<double>(count - i));
+
+            auto resistor = circuit.createComponent<Resistor>("R" + std::to_string(i), 100.0);
+            circuit.connect(resistor->getHandle(), previous);
+            circuit.connect(resistor->getHandle(), node->getHandle());
+            previous = node->getHandle();
+        }
+
+        assert(circuit.getNodeCount() == count + 1);
+        assert(circuit.getComponentCount() == count);
+
+        ArenaStats stats = circuit.getArenaStats();
+        assert(stats.pools == 2);
+        assert(stats.objects == 2 * count + 1);
+        assert(stats.bytes_used == (count + 1) * sizeof(Node) + count * sizeof(Resistor));
+
+        // Rejected ids leave nothing behind in the arena
+        for (const std::string& id : {std::string(), std::string("R1")}) {
+            bool threw = false;
+            try {
+                circuit.createComponent<Resistor>(id, 1.0);
+            } catch (const std::invalid_argument&) {
+                threw = true;
+            }
+            assert(threw);
+        }
+        for (const std::string& id : {std::string(), std::string("N1")}) {
+            bool threw = false;
+            try {
+                circuit.createNode(id);
+            } catch (const std::invalid_argument&) {
+                threw = true;
+            }
+            assert(threw);
+        }
+        assert(circuit.getArenaStats().objects == 2 * count + 1);
+
+        circuit.simulate(1e-6, 1e-6);
+        auto resistor = circuit.getComponent("R42");
+        assert(std::abs(resistor->getCurrentValue() - 0.01) < 1e-12);
+    }
+
+    std::cout << "✓ Arena-built circuit test passed" << std::endl;
+}
+
+int main() {
+    std::cout << "Running Arena Tests..." << std::endl;
+
+    try {
+        test_typed_pool();
+        test_arena_stats();
+        test_arena_built_circuit();
+
+        std::cout << "\\n✅ All arena tests passed!" << std::endl;
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "❌ Test failed: " << e.what() << std::endl;
+        return 1;
+    } catch (...) {
+        std::cerr << "❌ Unknown test failure" << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,231 @@
+#include "core/circuit.h"
+#include "core/result_store.h"
+#include "core/sources.h"
+#include "core/spsc_ring.h"
+#include "io/async_writer.h"
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace ic_sim;
+
+namespace {
+
+// Keeps every row it receives, optionally slowly
+class CollectingSink : public SampleSink {
+public:
+    explicit CollectingSink(std::chrono::microseconds delay = std::chrono::microseconds(0)) : delay_(delay) {}
+
+    void begin(const std::vector<std::string>& columns) override {
+        columns_ = columns;
+        rows_.clear();
+        finished_ = false;
+        thread_ = std::this_thread::get_id();
+    }
+    void write(const double* rows, size_t count, size_t width) override {
+        if (delay_.count() > 0) {
+            std::this_thread::sleep_for(delay_);
+        }
+        rows_.insert(rows_.end(), rows, rows + count * width);
+        writer_thread_ = std::this_thread::get_id();
+    }
+    void finish() override { finished_ = true; }
+
+    std::vector<std::string> columns_;
+    std::vector<double> rows_;
+    bool finished_ = false;
+    std::thread::id thread_;
+    std::thread::id writer_thread_;
+
+private:
+    std::chrono::microseconds delay_;
+};
+
+class FailingSink : public SampleSink {
+public:
+    void begin(const std::vector<std::string>&) override {}
+    void write(const double*, size_t, size_t) override { throw std::runtime_error("disk full"); }
+    void finish() override {}
+};
+
+// Writes rows 0..count-1 of one column, one row per call
+void writeSequence(AsyncSampleWriter& writer, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        double value = static_cast<double>(i);
+        writer.write(&value, 1, 1);
+    }
+}
+
+} // namespace
+
+void test_spsc_ring() {
+    SpscRing<size_t> ring(5);
+    assert(ring.capacity() == 8);
+    const size_t count = 200000;
+    std::thread consumer([&] {
+        for (size_t expected = 0; expected < count;) {
+            if (size_t* value = ring.tryFront()) {
+                assert(*value == expected);
+                ring.release();
+                ++expected;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    });
+    for (size_t i = 0; i < count;) {
+        if (size_t* slot = ring.tryAcquire()) {
+            *slot = i++;
+            ring.publish();
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    consumer.join();
+    assert(ring.size() == 0 && ring.tryFront() == nullptr);
+    std::cout << "✓ SPSC ring test passed" << std::endl;
+}
+
+void test_streams_simulation() {
+    Circuit circuit("RC");
+    NodeId in = circuit.createNode("in")->getHandle();
+    NodeId out = circuit.createNode("out")->getHandle();
+    NodeId gnd = circuit.createNode("0")->getHandle();
+    auto source = circuit.createComponent<VoltageSource>("V1", Waveform::sine(0.0, 1.0, 1e3));
+    circuit.connect(source->getHandle(), in);
+    circuit.connect(source->getHandle(), gnd);
+    auto resistor = circuit.createComponent<Resistor>("R1", 1e3);
+    circuit.connect(resistor->getHandle(), in);
+    circuit.connect(resistor->getHandle(), out);
+
+    auto sink = std::make_shared<CollectingSink>();
+    AsyncWriterOptions options;
+    options.block_bytes = 16 * 4 * sizeof(double);  // 16 rows
+    options.ring_blocks = 4;
+    auto writer = std::make_shared<AsyncSampleWriter>(sink, options);
+    auto results = std::make_shared<ResultStore>();
+    results->addProbe("v(*)");
+    results->addSink(writer);
+    circuit.setResultStore(results);
+    circuit.simulate(1e-3, 1e-6);
+
+    // The sink saw every row, bit for bit, on the writer thread
+    assert(sink->finished_);
+    assert(sink->columns_.size() == 4 && sink->columns_[0] == "time" && sink->columns_[2] == "v(out)");
+    assert(sink->writer_thread_ != std::this_thread::get_id());
+    size_t rows = results->getSampleCount();
+    assert(sink->rows_.size() == rows * 4);
+    std::vector<double> time = results->copyTime();
+    std::vector<double> vin = results->copySamples(results->findProbe("v(in)"));
+    for (size_t i = 0; i < rows; ++i) {
+        assert(sink->rows_[i * 4] == time[i] && sink->rows_[i * 4 + 1] == vin[i]);
+    }
+    AsyncWriterStats stats = writer->getStats();
+    assert(stats.rows_written == rows && stats.rows_dropped == 0);
+    assert(stats.blocks_written == (rows + 15) / 16);
+
+    // Streaming only: nothing is kept in memory
+    ResultStoreOptions streaming;
+    streaming.keep_samples = false;
+    auto stream_only = std::make_shared<ResultStore>(streaming);
+    stream_only->addProbe("v(out)");
+    stream_only->addSink(writer);
+    circuit.setResultStore(stream_only);
+    circuit.simulate(1e-3, 1e-6);
+    assert(stream_only->memoryBytes() == 0 && stream_only->getChunkCount() == 0);
+    assert(sink->rows_.size() == stream_only->getSampleCount() * 2);
+    assert(writer->getStats().rows_written == stream_only->getSampleCount());
+    std::cout << "✓ Streaming simulation test passed" << std::endl;
+}
+
+void test_back_pressure() {
+    auto sink = std::make_shared<CollectingSink>(std::chrono::microseconds(200));
+    AsyncWriterOptions options;
+    options.ring_blocks = 2;
+    options.block_bytes = 4 * sizeof(double);
+    AsyncSampleWriter writer(sink, options);
+    writer.begin({"x"});
+    writeSequence(writer, 200);
+    writer.finish();
+
+    AsyncWriterStats stats = writer.getStats();
+    assert(stats.rows_written == 200 && stats.rows_dropped == 0);
+    assert(stats.waits > 0 && stats.wait_seconds > 0.0 && stats.max_queued <= 2);
+    for (size_t i = 0; i < 200; ++i) {
+        assert(sink->rows_[i] == static_cast<double>(i));
+    }
+    std::cout << "✓ Back-pressure test passed" << std::endl;
+}
+
+void test_drop_newest() {
+    auto sink = std::make_shared<CollectingSink>(std::chrono::microseconds(2000));
+    AsyncWriterOptions options;
+    options.ring_blocks = 2;
+    options.block_bytes = 4 * sizeof(double);
+    options.overflow = OverflowPolicy::DropNewest;
+    AsyncSampleWriter writer(sink, options);
+    writer.begin({"x"});
+    writeSequence(writer, 400);
+    writer.finish();
+
+    // Whatever arrives is in order; nothing is lost without being counted
+    AsyncWriterStats stats = writer.getStats();
+    assert(stats.rows_dropped > 0 && stats.wait_seconds == 0.0);
+    assert(stats.rows_written + stats.rows_dropped == 400);
+    assert(sink->rows_.size() == stats.rows_written);
+    for (size_t i = 1; i < sink->rows_.size(); ++i) {
+        assert(sink->rows_[i] > sink->rows_[i - 1]);
+    }
+    std::cout << "✓ Drop policy test passed" << std::endl;
+}
+
+void test_writer_errors() {
+    AsyncSampleWriter writer(std::make_shared<FailingSink>());
+    writer.begin({"x"});
+    bool threw = false;
+    try {
+        writeSequence(writer, 1000);
+        writer.finish();
+    } catch (const std::runtime_error& e) {
+        threw = std::string(e.what()) == "disk full";
+    }
+    assert(threw);
+
+    // Usable again for the next run
+    auto sink = std::make_shared<CollectingSink>();
+    AsyncSampleWriter reused(sink);
+    reused.begin({"x"});
+    writeSequence(reused, 10);
+    reused.finish();
+    reused.begin({"x"});
+    writeSequence(reused, 3);
+    reused.finish();
+    assert(sink->rows_.size() == 3 && reused.getStats().rows_written == 3);
+    std::cout << "✓ Writer error test passed" << std::endl;
+}
+
+int main() {
+    std::cout << "Running Async Writer Tests..." << std::endl;
+
+    try {
+        test_spsc_ring();
+        test_streams_simulation();
+        test_back_pressure();
+        test_drop_newest();
+        test_writer_errors();
+
+        std::cout << "\\n✅ All async writer tests passed!" << std::endl;
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "❌ Test failed: " << e.what() << std::endl;
+        return 1;
+    } catch (...) {
+        std::cerr << "❌ Unknown test failure" << std::endl;
+        return 1;
+    }
+}
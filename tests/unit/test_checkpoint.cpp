@@ -0,0 +1,243 @@
+#include "circuit_fixture.h"
+#include "core/circuit.h"
+#include "core/result_store.h"
+#include "core/sources.h"
+#include "io/checkpoint.h"
+#include <cassert>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace ic_sim;
+
+namespace {
+
+const std::filesystem::path kDir = std::filesystem::temp_directory_path() / "ic_sim_checkpoint_test";
+
+// Pulse and sine sources into two RC stages, so the run has corners to land on
+std::unique_ptr<Circuit> makeCircuit() {
+    auto circuit = test::makeFilter("Checkpointed", Waveform::pulse(0.0, 1.0, 1e-4, 1e-5, 1e-5, 2e-4, 5e-4));
+    circuit->createNode("SIN");
+    test::wire(*circuit, circuit->createComponent<VoltageSource>("V2", Waveform::sine(0.0, 0.5, 3e3)), "SIN", "GND");
+    test::wire(*circuit, circuit->createComponent<Resistor>("R2", 2e3), "SIN", "X1.OUT");
+    return circuit;
+}
+
+std::shared_ptr<ResultStore> record(Circuit& circuit) {
+    auto results = std::make_shared<ResultStore>();
+    results->addProbe("v(*)");
+    results->addProbe("i(*)");
+    circuit.setResultStore(results);
+    return results;
+}
+
+// Counts the runs it was handed
+class CountingSink : public SampleSink {
+public:
+    void begin(const std::vector<std::string>&) override { ++begun; }
+    void write(const double*, size_t, size_t) override {}
+    void finish() override {}
+
+    size_t begun = 0;
+};
+
+// Keeps every checkpoint in memory
+class CheckpointList : public CheckpointSink {
+public:
+    explicit CheckpointList(size_t every) : every_(every) {}
+    bool due(size_t steps) override { return steps % every_ == 0; }
+    void write(std::shared_ptr<const SimulationCheckpoint> checkpoint) override {
+        checkpoints.push_back(std::move(checkpoint));
+    }
+    std::vector<std::shared_ptr<const SimulationCheckpoint>> checkpoints;
+
+private:
+    size_t every_;
+};
+
+bool sameBits(double a, double b) {
+    return std::memcmp(&a, &b, sizeof(double)) == 0;
+}
+
+// The resumed run recorded exactly the reference rows after the checkpoint
+void checkRows(const ResultStore& reference, const ResultStore& resumed, size_t first_row) {
+    assert(resumed.getSampleCount() == reference.getSampleCount() - first_row);
+    std::vector<double> a = reference.copyTime();
+    std::vector<double> b = resumed.copyTime();
+    for (size_t row = 0; row < b.size(); ++row) {
+        assert(sameBits(a[first_row + row], b[row]));
+    }
+    for (size_t probe = 0; probe < reference.getProbeCount(); ++probe) {
+        a = reference.copySamples(probe);
+        b = resumed.copySamples(probe);
+        for (size_t row = 0; row < b.size(); ++row) {
+            assert(sameBits(a[first_row + row], b[row]));
+        }
+    }
+}
+
+void checkFinalState(Circuit& reference, Circuit& resumed) {
+    assert(reference.getLastRunStats().steps == resumed.getLastRunStats().steps);
+    assert(reference.getLastRunStats().breakpoints == resumed.getLastRunStats().breakpoints);
+    assert(sameBits(reference.getLastRunStats().end_time, resumed.getLastRunStats().end_time));
+    for (NodeId id = 0; id < reference.getNodeCount(); ++id) {
+        assert(sameBits(reference.getNode(id)->getVoltage(), resumed.getNode(id)->getVoltage()));
+    }
+    for (ComponentId id = 0; id < reference.getComponentCount(); ++id) {
+        assert(sameBits(reference.getComponent(id)->getCurrentValue(), resumed.getComponent(id)->getCurrentValue()));
+    }
+}
+
+} // namespace
+
+void test_bit_exact_resume() {
+    auto reference = makeCircuit();
+    auto reference_rows = record(*reference);
+    auto list = std::make_shared<CheckpointList>(250);
+    reference->setCheckpointSink(list);
+    reference->simulate(2e-3, 1e-6);
+    assert(list->checkpoints.size() == reference->getLastRunStats().steps / 250);
+
+    // Every checkpoint, including ones with corners pending, resumes into the
+    // same run on a freshly built circuit
+    for (size_t k : {size_t(0), size_t(1), list->checkpoints.size() / 2, list->checkpoints.size() - 1}) {
+        const SimulationCheckpoint& checkpoint = *list->checkpoints[k];
+        assert(checkpoint.steps == (k + 1) * 250 && checkpoint.recorded_rows == checkpoint.steps + 1);
+        auto resumed = makeCircuit();
+        auto resumed_rows = record(*resumed);
+        resumed->resume(checkpoint);
+        checkRows(*reference_rows, *resumed_rows, checkpoint.recorded_rows);
+        checkFinalState(*reference, *resumed);
+    }
+
+    // A resumed run checkpoints on the same steps as the uninterrupted one
+    auto resumed = makeCircuit();
+    record(*resumed);
+    auto again = std::make_shared<CheckpointList>(250);
+    resumed->setCheckpointSink(again);
+    resumed->resume(*list->checkpoints[2]);
+    assert(again->checkpoints.size() == list->checkpoints.size() - 3);
+    assert(sameBits(again->checkpoints.back()->node_voltages[1], list->checkpoints.back()->node_voltages[1]));
+    assert(again->checkpoints.back()->recorded_rows == list->checkpoints.back()->recorded_rows);
+    std::cout << "✓ Bit-exact resume test passed" << std::endl;
+}
+
+void test_checkpoint_file() {
+    std::filesystem::create_directories(kDir);
+    std::string path = (kDir / "run.ickpt").string();
+    auto reference = makeCircuit();
+    auto reference_rows = record(*reference);
+    CheckpointOptions options;
+    options.every_steps = 100;
+    options.every_seconds = 0.0;
+    auto file = std::make_shared<CheckpointFile>(path, options);
+    reference->setCheckpointSink(file);
+    reference->simulate(1.5e-3, 1e-6);
+
+    // finish() waited for the writer: the file holds the last checkpoint
+    CheckpointStats stats = file->getStats();
+    assert(stats.written >= 1 && stats.written + stats.superseded == reference->getLastRunStats().steps / 100);
+    assert(!std::filesystem::exists(path + ".tmp"));
+    std::shared_ptr<SimulationCheckpoint> checkpoint = readCheckpoint(path);
+    assert(checkpoint->steps == reference->getLastRunStats().steps / 100 * 100);
+    assert(stats.bytes == std::filesystem::file_size(path));
+
+    auto resumed = makeCircuit();
+    auto resumed_rows = record(*resumed);
+    resumed->resume(*checkpoint);
+    checkRows(*reference_rows, *resumed_rows, checkpoint->recorded_rows);
+    checkFinalState(*reference, *resumed);
+
+    // Round trip of a checkpoint from the middle of the run
+    auto list = std::make_shared<CheckpointList>(333);
+    auto middle = makeCircuit();
+    record(*middle);
+    middle->setCheckpointSink(list);
+    middle->simulate(1.5e-3, 1e-6);
+    std::string copy = (kDir / "middle.ickpt").string();
+    writeCheckpoint(copy, *list->checkpoints[1]);
+    resumed = makeCircuit();
+    resumed_rows = record(*resumed);
+    resumed->resume(*readCheckpoint(copy));
+    checkRows(*reference_rows, *resumed_rows, list->checkpoints[1]->recorded_rows);
+
+    // A sink would start its output over at the checkpoint, so resume refuses it
+    resumed = makeCircuit();
+    auto sink = std::make_shared<CountingSink>();
+    record(*resumed)->addSink(sink);
+    bool threw = false;
+    try {
+        resumed->resume(*list->checkpoints[1]);
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    assert(threw && sink->begun == 0 && resumed->getLastRunStats().steps == 0);
+    std::cout << "✓ Checkpoint file test passed" << std::endl;
+}
+
+void test_rejected_checkpoints() {
+    std::string path = (kDir / "reject.ickpt").string();
+    auto circuit = makeCircuit();
+    auto list = std::make_shared<CheckpointList>(100);
+    circuit->setCheckpointSink(list);
+    circuit->simulate(5e-4, 1e-6);
+    writeCheckpoint(path, *list->checkpoints.back());
+
+    // A circuit with other devices
+    auto other = makeCircuit();
+    other->createComponent<Resistor>("R3", 1.0);
+    bool threw = false;
+    try {
+        other->resume(*list->checkpoints.back());
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    assert(threw);
+
+    // Damaged and truncated files
+    auto expectError = [](const std::string& file) {
+        try {
+            readCheckpoint(file);
+        } catch (const CheckpointError&) {
+            return true;
+        }
+        return false;
+    };
+    {
+        std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(64);
+        file.put('\x7f');
+    }
+    assert(expectError(path));
+    writeCheckpoint(path, *list->checkpoints.back());
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 8);
+    assert(expectError(path));
+    std::filesystem::resize_file(path, 10);
+    assert(expectError(path));
+    std::filesystem::remove_all(kDir);
+    std::cout << "✓ Rejected checkpoint test passed" << std::endl;
+}
+
+int main() {
+    std::cout << "Running Checkpoint Tests..." << std::endl;
+
+    try {
+        test_bit_exact_resume();
+        test_checkpoint_file();
+        test_rejected_checkpoints();
+
+        std::cout << "\\n✅ All checkpoint tests passed!" << std::endl;
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "❌ Test failed: " << e.what() << std::endl;
+        return 1;
+    } catch (...) {
+        std::cerr << "❌ Unknown test failure" << std::endl;
+        return 1;
+    }
+}
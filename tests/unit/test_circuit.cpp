@@ -1,7 +1,12 @@
 #include "core/circuit.h"
+#include "core/sources.h"
 #include <cassert>
+#include <cmath>
 #include <iostream>
 #include <memory>
+#include <string>
+#include <thread>
+#include <vector>
 
 using namespace ic_sim;
 
@@ -79,6 +84,235 @@ void test_circuit_simulation() {
     std::cout << "✓ Circuit simulation test passed" << std::endl;
 }
 
+void test_symbol_table() {
+    SymbolTable symbols;
+    Symbol a = symbols.intern("VCC");
+    Symbol b = symbols.intern("OUT");
+    assert(a == 0 && b == 1);
+    assert(symbols.intern("VCC") == a);
+    assert(symbols.find("OUT") == b);
+    assert(symbols.find("GND") == kInvalidSymbol);
+    assert(symbols.name(b) == "OUT");
+    
+    // Copies own their characters
+    SymbolTable copy = symbols;
+    symbols.clear();
+    assert(copy.name(a) == "VCC");
+    assert(copy.find("OUT") == b);
+    
+    // Growth and removal keep every other name findable
+    SymbolTable many;
+    for (int i = 0; i < 5000; ++i) {
+        assert(many.intern("n" + std::to_string(i)) == static_cast<Symbol>(i));
+    }
+    for (int i = 0; i < 5000; i += 3) {
+        many.swapRemove(many.find("n" + std::to_string(i)));
+    }
+    assert(many.size() == 5000 - 1667);
+    for (int i = 0; i < 5000; ++i) {
+        Symbol symbol = many.find("n" + std::to_string(i));
+        assert((symbol == kInvalidSymbol) == (i % 3 == 0));
+        assert(symbol == kInvalidSymbol || many.name(symbol) == "n" + std::to_string(i));
+    }
+    
+    std::cout << "✓ Symbol table test passed" << std::endl;
+}
+
+void test_concurrent_symbol_table() {
+    ConcurrentSymbolTable symbols;
+    Symbol vcc = symbols.intern("VCC");
+    
+    // Threads interning overlapping names agree on one dense symbol per name
+    const int kThreads = 4;
+    const int kNames = 20000;
+    std::vector<std::vector<Symbol>> seen(kThreads, std::vector<Symbol>(kNames));
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&, t] {
+            for (int i = 0; i < kNames; ++i) {
+                int name = (i + t * 7919) % kNames;  // same names, different order
+                seen[t][name] = symbols.intern("n" + std::to_string(name));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    assert(symbols.size() == kNames + 1);
+    std::vector<bool> used(kNames + 1, false);
+    for (int i = 0; i < kNames; ++i) {
+        Symbol symbol = seen[0][i];
+        assert(symbol < kNames + 1 && !used[symbol]);
+        used[symbol] = true;
+        for (int t = 1; t < kThreads; ++t) {
+            assert(seen[t][i] == symbol);
+        }
+        assert(symbols.name(symbol) == "n" + std::to_string(i));
+        assert(symbols.find("n" + std::to_string(i)) == symbol);
+    }
+    assert(symbols.intern("VCC") == vcc && symbols.name(vcc) == "VCC");
+    assert(symbols.find("GND") == kInvalidSymbol);
+    
+    std::cout << "✓ Concurrent symbol table test passed" << std::endl;
+}
+
+void test_integer_handles() {
+    Circuit circuit("Handle Circuit");
+    NodeId vcc = circuit.addNode(std::make_shared<Node>("VCC"));
+    NodeId gnd = circuit.addNode(std::make_shared<Node>("GND"));
+    assert(vcc == 0 && gnd == 1);
+    assert(circuit.addNode(std::make_shared<Node>("")) == kInvalidId);
+    
+    auto resistor = std::make_shared<Resistor>(100.0);
+    resistor->setId("R1");
+    ComponentId r1 = circuit.addComponent(resistor);
+    assert(resistor->getHandle() == r1);
+    assert(circuit.getComponent(r1) == resistor);
+    assert(circuit.findComponent("R1") == r1);
+    assert(circuit.findNode("OUT") == kInvalidId);
+    assert(circuit.getNode(gnd)->getId() == "GND");
+    assert(circuit.getNode(gnd)->getHandle() == gnd);
+    
+    // Re-adding an id replaces the element under the same handle
+    auto replacement = std::make_shared<Node>("VCC");
+    assert(circuit.addNode(replacement) == vcc);
+    assert(circuit.getNode("VCC") == replacement);
+    assert(circuit.getNodeCount() == 2);
+    
+    std::cout << "✓ Integer handle test passed" << std::endl;
+}
+
+void test_copy_on_write_clone() {
+    Circuit base("Base");
+    NodeId vin = base.createNode("VIN")->getHandle();
+    NodeId gnd = base.createNode("GND")->getHandle();
+    for (int i = 0; i < 100; ++i) {
+        ComponentId r = base.createComponent<Resistor>("R" + std::to_string(i), 1000.0)->getHandle();
+        base.connect(r, vin);
+        base.connect(r, gnd);
+    }
+    base.getNode(vin)->setVoltage(5.0);
+    base.compile();
+    
+    auto variant = base.clone("Variant");
+    assert(base.isShared() && variant->isShared());
+    assert(variant->getTopology() == base.getTopology());
+    assert(variant->getVoltages() == base.getVoltages());
+    
+    // Editing copies only the edited device
+    ComponentId r7 = variant->findComponent("R7");
+    std::static_pointer_cast<Resistor>(variant->editComponent(r7))->setResistance(500.0);
+    assert(variant->getEditCount() == 1);
+    assert(variant->getComponent(r7) != base.getComponent(r7));
+    assert(std::static_pointer_cast<Resistor>(base.getComponent(r7))->getResistance() == 1000.0);
+    
+    // Runs keep sharing the elements: each circuit steps its own voltages and
+    // device state, and copies nothing it does not write
+    variant->simulate(1e-6, 1e-6);
+    assert(base.isShared() && variant->isShared());
+    assert(variant->getEditCount() == 1);
+    assert(std::abs(variant->getComponent(r7)->getCurrentValue() - 0.01) < 1e-12);
+    assert(std::abs(variant->getComponent(8)->getCurrentValue() - 0.005) < 1e-12);
+    assert(base.getComponent(8)->getCurrentValue() == 0.0);
+    assert(variant->getComponent(8)->getNodes()[0] == variant->getNode(vin).get());
+    base.simulate(1e-6, 1e-6);
+    assert(std::abs(base.getComponent(r7)->getCurrentValue() - 0.005) < 1e-12);
+    assert(std::abs(variant->getComponent(r7)->getCurrentValue() - 0.01) < 1e-12);
+    
+    // Nodes handed out by a shared circuit write to that circuit only
+    assert(variant->getNode(vin) != base.getNode(vin));
+    variant->getNode(vin)->setVoltage(1.0);
+    assert(base.getNode(vin)->getVoltage() == 5.0 && variant->getVoltages()[vin] == 1.0);
+    variant->reset();
+    assert(base.getVoltages()[vin] == 5.0 && variant->getVoltages()[vin] == 0.0);
+    
+    // New names stay private to the circuit that adds them
+    auto other = base.clone("Other");
+    other->createNode("OUT");
+    assert(other->findNode("OUT") == 2);
+    assert(base.findNode("OUT") == kInvalidId);
+    assert(base.getNodeCount() == 2);
+    
+    std::cout << "✓ Copy-on-write clone test passed" << std::endl;
+}
+
+void test_full_state_reset() {
+    Circuit circuit("Sweep");
+    auto in = circuit.createNode("IN");
+    NodeId gnd = circuit.createNode("GND")->getHandle();
+    auto capacitor = circuit.createComponent<Capacitor>("C1", 1e-6);
+    auto resistor = circuit.createComponent<Resistor>("R1", 1e3);
+    for (ComponentId device : {capacitor->getHandle(), resistor->getHandle()}) {
+        circuit.connect(device, in->getHandle());
+        circuit.connect(device, gnd);
+    }
+    
+    // Without initial conditions everything returns to zero
+    in->setVoltage(3.0);
+    circuit.simulate(1e-3, 1e-4);
+    assert(capacitor->getCharge() != 0.0 && resistor->getCurrentValue() != 0.0);
+    circuit.reset();
+    assert(in->getVoltage() == 0.0);
+    assert(capacitor->getCharge() == 0.0 && capacitor->getCurrentValue() == 0.0);
+    assert(resistor->getCurrentValue() == 0.0);
+    assert(circuit.getLastRunStats().steps == 0);
+    
+    // With a snapshot, every run after reset() repeats the first one exactly
+    in->setVoltage(1.5);
+    circuit.saveInitialConditions();
+    assert(circuit.hasInitialConditions());
+    circuit.simulate(1e-3, 1e-4);
+    double charge = capacitor->getCharge();
+    double current = resistor->getCurrentValue();
+    for (int sweep = 0; sweep < 1000; ++sweep) {
+        circuit.reset();
+        assert(in->getVoltage() == 1.5 && capacitor->getCharge() == 0.0);
+    }
+    circuit.simulate(1e-3, 1e-4);
+    assert(capacitor->getCharge() == charge);
+    assert(resistor->getCurrentValue() == current);
+    
+    // Structural edits make the snapshot meaningless
+    circuit.createNode("OUT");
+    assert(!circuit.hasInitialConditions());
+    
+    std::cout << "✓ Full-state reset test passed" << std::endl;
+}
+
+void test_source_state_reset() {
+    Circuit circuit("Stimulus");
+    NodeId in = circuit.createNode("IN")->getHandle();
+    NodeId gnd = circuit.createNode("GND")->getHandle();
+    auto source = circuit.createComponent<VoltageSource>("V1", Waveform::sine(1.0, 0.5, 1e3));
+    auto resistor = circuit.createComponent<Resistor>("R1", 1e3);
+    for (ComponentId device : {source->getHandle(), resistor->getHandle()}) {
+        circuit.connect(device, in);
+        circuit.connect(device, gnd);
+    }
+    
+    // Without initial conditions the source is back at t = 0 and drives its node
+    circuit.simulate(2.5e-4, 1e-5);
+    assert(circuit.getNode(in)->getVoltage() != 1.0);
+    circuit.reset();
+    assert(source->getTime() == 0.0 && source->getCurrentValue() == 1.0);
+    assert(circuit.getNode(in)->getVoltage() == 1.0);
+    
+    // A snapshot taken mid-waveform keeps the source's time and value
+    circuit.simulate(2.5e-4, 1e-5);
+    double time = source->getTime();
+    double value = source->getCurrentValue();
+    double current = resistor->getCurrentValue();
+    circuit.saveInitialConditions();
+    circuit.simulate(3e-4, 1e-5);
+    assert(source->getTime() != time);
+    circuit.reset();
+    assert(source->getTime() == time && source->getCurrentValue() == value);
+    assert(resistor->getCurrentValue() == current);
+    assert(circuit.getNode(in)->getVoltage() == value);
+    
+    std::cout << "✓ Source state reset test passed" << std::endl;
+}
+
 void test_component_connections() {
     auto node1 = std::make_shared<Node>("N1");
     auto node2 = std::make_shared<Node>("N2");
@@ -113,6 +347,12 @@ int main() {
         test_capacitor_component();
         test_circuit_simulation();
         test_component_connections();
+        test_symbol_table();
+        test_concurrent_symbol_table();
+        test_integer_handles();
+        test_copy_on_write_clone();
+        test_full_state_reset();
+        test_source_state_reset();
         
         std::cout << "\\n✅ All circuit tests passed!" << std::endl;
         return 0;
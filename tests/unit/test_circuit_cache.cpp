@@ -0,0 +1,185 @@
+#include "core/circuit.h"
+#include "core/sources.h"
+#include "io/circuit_cache.h"
+#include "plugins/plugin_system.h"
+#include <cassert>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace ic_sim;
+
+namespace {
+
+const std::filesystem::path kDir = std::filesystem::temp_directory_path() / "ic_sim_cache_test";
+
+void writeFile(const std::filesystem::path& path, const std::string& text) {
+    std::filesystem::create_directories(path.parent_path());
+    std::ofstream(path) << text;
+}
+
+std::string writeDeck(const std::string& rload) {
+    writeFile(kDir / "load.inc", "Rload out 0 " + rload + "\n");
+    writeFile(kDir / "top.sp",
+              "Cached deck\n"
+              ".include load.inc\n"
+              ".subckt stage a b\nR1 a m 1k\nC1 m 0 2p\nR2 m b 500\n.ends\n"
+              "V1 in 0 SIN(0 1 1meg 0 0 30)\n"
+              "I1 out 0 PWL(0 0 1n 1m 2n 0)\n"
+              "V2 ref 0 PULSE(0 1 1n 1n 1n 5n 2n)\n"
+              "X1 in mid stage\nX2 mid out stage\nRref ref mid 10k\n"
+              ".tran 1n 50n\n");
+    return (kDir / "top.sp").string();
+}
+
+// Same elements, parameters, wiring and compiled arrays
+void assertSameCircuit(Circuit& a, Circuit& b) {
+    assert(a.getName() == b.getName());
+    assert(a.getNodeCount() == b.getNodeCount() && a.getComponentCount() == b.getComponentCount());
+    for (NodeId id = 0; id < a.getNodeCount(); ++id) {
+        assert(a.getNode(id)->getId() == b.getNode(id)->getId());
+    }
+    for (ComponentId id = 0; id < a.getComponentCount(); ++id) {
+        const auto& x = a.getComponent(id);
+        const auto& y = b.getComponent(id);
+        assert(x->getId() == y->getId() && x->getType() == y->getType());
+        std::vector<double> px;
+        std::vector<double> py;
+        assert(x->getParameters(px) && y->getParameters(py) && px == py);
+        assert(x->getNodes().size() == y->getNodes().size());
+        for (size_t t = 0; t < x->getNodes().size(); ++t) {
+            assert(x->getNodes()[t]->getId() == y->getNodes()[t]->getId());
+        }
+    }
+    auto ta = a.getTopology();
+    auto tb = b.getTopology();
+    assert(ta && tb);
+    assert(ta->getNodeDevices() == tb->getNodeDevices() && ta->getDeviceNodes() == tb->getDeviceNodes());
+    assert(ta->getPatternColumns() == tb->getPatternColumns() && ta->getPatternOffsets() == tb->getPatternOffsets());
+    assert(ta->getIslands() == tb->getIslands() && ta->getOrdering() == tb->getOrdering());
+}
+
+} // namespace
+
+void test_cache_hit() {
+    std::string deck = writeDeck("2k");
+    NetlistCacheOptions options;
+    CachedNetlist parsed = loadNetlistCached(deck, options);
+    assert(!parsed.from_cache);
+    assert(std::filesystem::exists(parsed.cache_path) && parsed.cache_path == deck + ".iccache");
+
+    CachedNetlist cached = loadNetlistCached(deck, options);
+    assert(cached.from_cache);
+    assert(cached.simulation.type == parsed.simulation.type);
+    assert(cached.simulation.duration == parsed.simulation.duration);
+    assert(cached.simulation.timestep == parsed.simulation.timestep);
+    assertSameCircuit(*parsed.circuit, *cached.circuit);
+
+    // Waveforms are restored exactly, so both runs agree to the bit
+    parsed.circuit->simulate(20e-9, 1e-10);
+    cached.circuit->simulate(20e-9, 1e-10);
+    for (NodeId id = 0; id < parsed.circuit->getNodeCount(); ++id) {
+        assert(parsed.circuit->getNode(id)->getVoltage() == cached.circuit->getNode(id)->getVoltage());
+    }
+    std::cout << "✓ Cache hit test passed" << std::endl;
+}
+
+void test_stale_cache() {
+    std::string deck = writeDeck("2k");
+    loadNetlistCached(deck);
+    assert(loadNetlistCached(deck).from_cache);
+
+    // Same size, different contents, in an included file
+    writeDeck("3k");
+    CachedNetlist reparsed = loadNetlistCached(deck);
+    assert(!reparsed.from_cache);
+    auto load = std::static_pointer_cast<Resistor>(reparsed.circuit->getComponent("Rload"));
+    assert(load->getResistance() == 3e3);
+    assert(loadNetlistCached(deck).from_cache);
+
+    // A cache is only used for the netlist it was built from
+    writeFile(kDir / "other.sp", "Other\nR1 a 0 1\n");
+    NetlistCacheOptions shared;
+    shared.cache_path = deck + ".iccache";
+    CachedNetlist other = loadNetlistCached((kDir / "other.sp").string(), shared);
+    assert(!other.from_cache && other.circuit->getComponentCount() == 1);
+    std::cout << "✓ Stale cache test passed" << std::endl;
+}
+
+void test_corrupt_cache() {
+    std::string deck = writeDeck("2k");
+    std::string cache_path = loadNetlistCached(deck).cache_path;
+
+    // Flip one byte in the payload
+    {
+        std::fstream file(cache_path, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(200);
+        file.put('\x5a');
+    }
+    bool threw = false;
+    try {
+        CircuitCache cache(cache_path);
+    } catch (const CircuitCacheError&) {
+        threw = true;
+    }
+    assert(threw);
+    assert(!loadNetlistCached(deck).from_cache);
+    assert(loadNetlistCached(deck).from_cache);
+
+    // Truncated and foreign files
+    std::filesystem::resize_file(cache_path, 30);
+    assert(!loadNetlistCached(deck).from_cache);
+    writeFile(cache_path, "not a cache");
+    assert(!loadNetlistCached(deck).from_cache);
+
+    NetlistCacheOptions read_only;
+    read_only.update = false;
+    writeFile(cache_path, "not a cache");
+    assert(!loadNetlistCached(deck, read_only).from_cache);
+    assert(!loadNetlistCached(deck, read_only).from_cache);
+    std::cout << "✓ Corrupt cache test passed" << std::endl;
+}
+
+void test_plugin_devices() {
+    assert(PluginManager::getInstance().loadPlugin(EXAMPLE_PLUGIN_PATH));
+    writeFile(kDir / "plugins.sp", "Plugins\n.model dfast D(forward_voltage=0.3)\nL1 a b 10u\nD1 b 0 DFAST\nR1 a 0 1\n");
+    std::string deck = (kDir / "plugins.sp").string();
+    CachedNetlist parsed = loadNetlistCached(deck);
+    CachedNetlist cached = loadNetlistCached(deck);
+    assert(cached.from_cache);
+    assertSameCircuit(*parsed.circuit, *cached.circuit);
+
+    // Without the plugin the cache cannot be instantiated and is bypassed
+    PluginManager::getInstance().unloadAllPlugins();
+    bool threw = false;
+    try {
+        CircuitCache(cached.cache_path).instantiate();
+    } catch (const CircuitCacheError&) {
+        threw = true;
+    }
+    assert(threw);
+    std::cout << "✓ Plugin device test passed" << std::endl;
+}
+
+int main() {
+    std::cout << "Running Circuit Cache Tests..." << std::endl;
+
+    try {
+        test_cache_hit();
+        test_stale_cache();
+        test_corrupt_cache();
+        test_plugin_devices();
+
+        std::filesystem::remove_all(kDir);
+        std::cout << "\\n✅ All circuit cache tests passed!" << std::endl;
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "❌ Test failed: " << e.what() << std::endl;
+        return 1;
+    } catch (...) {
+        std::cerr << "❌ Unknown test failure" << std::endl;
+        return 1;
+    }
+}
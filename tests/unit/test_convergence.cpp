@@ -0,0 +1,200 @@
+#include "core/circuit.h"
+#include "core/convergence.h"
+#include "core/sources.h"
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <memory>
+
+using namespace ic_sim;
+
+void test_exponential_settles() {
+    ConvergenceMonitor monitor;
+    double value = 0.0;
+    ProbeTolerance tolerance;
+    tolerance.window = 20;
+    tolerance.abstol = 1e-4;
+    tolerance.reltol = 0.0;
+    monitor.addProbe("x", [&value]() { return value; }, tolerance);
+
+    const double tau = 1e-3;
+    const double dt = 1e-5;
+    double stopped = -1.0;
+    for (int i = 1; i <= 2000; ++i) {
+        double t = i * dt;
+        value = 1.0 - std::exp(-t / tau);
+        if (monitor.sample(t)) {
+            stopped = t;
+            break;
+        }
+    }
+
+    // The window spans 0.2ms, so the band of 1e-4 is met roughly once exp(-t/tau) < 5e-4
+    assert(stopped > 0.0);
+    assert(monitor.getState() == SteadyState::Settled);
+    assert(monitor.getSettleTime() > 5e-3 && monitor.getSettleTime() < 9e-3);
+    assert(monitor.getPeriod() == 0.0);
+
+    std::cout << "✓ Exponential settling test passed" << std::endl;
+}
+
+void test_damped_ringing_is_not_periodic() {
+    ConvergenceMonitor monitor;
+    double value = 0.0;
+    ProbeTolerance tolerance;
+    tolerance.window = 400;
+    tolerance.abstol = 1e-6;
+    monitor.addProbe("ring", [&value]() { return value; }, tolerance);
+
+    // Constant period but a decaying envelope
+    for (int i = 1; i <= 1000; ++i) {
+        double t = i * 1e-5;
+        value = std::exp(-t / 2e-3) * std::sin(2.0 * M_PI * 1000.0 * t);
+        assert(!monitor.sample(t));
+    }
+
+    std::cout << "✓ Damped ringing test passed" << std::endl;
+}
+
+void test_period_longer_than_window() {
+    // 256 samples per period against a 16-sample window: the mid level has to
+    // come from whole cycles, not from the window
+    const double frequency = 1000.0;
+    const double dt = 1.0 / (256.0 * frequency);
+    for (int shape = 0; shape < 2; ++shape) {
+        ConvergenceMonitor monitor;
+        double value = 0.0;
+        ProbeTolerance tolerance;
+        tolerance.window = 16;
+        monitor.addProbe("x", [&value]() { return value; }, tolerance);
+
+        double stopped = -1.0;
+        for (int i = 1; i <= 256 * 20; ++i) {
+            double t = i * dt;
+            double phase = t * frequency - std::floor(t * frequency);
+            // A sine on a decaying offset, or a sawtooth
+            value = (shape == 0) ? 0.5 * std::exp(-t / 1e-3) + std::sin(2.0 * M_PI * phase) : phase;
+            if (monitor.sample(t)) {
+                stopped = t;
+                break;
+            }
+        }
+
+        assert(stopped > 0.0 && stopped < 12e-3);
+        assert(monitor.getState() == SteadyState::Periodic);
+        assert(std::abs(monitor.getPeriod() - 1.0 / frequency) < 1e-3 / frequency);
+    }
+
+    std::cout << "✓ Period longer than window test passed" << std::endl;
+}
+
+void test_sine_source_stops_when_periodic() {
+    Circuit circuit("Sine Circuit");
+    auto out = std::make_shared<Node>("OUT");
+    auto gnd = std::make_shared<Node>("GND");
+    circuit.addNode(out);
+    circuit.addNode(gnd);
+
+    auto source = std::make_shared<VoltageSource>(Waveform::sine(0.5, 1.0, 1000.0));
+    source->setId("V1");
+    source->connect(out);
+    source->connect(gnd);
+    circuit.addComponent(source);
+
+    ProbeTolerance tolerance;
+    tolerance.window = 400;
+    tolerance.reltol = 1e-2;
+    tolerance.periods = 3;
+    auto monitor = std::make_shared<ConvergenceMonitor>();
+    monitor->addNodeProbe(out->getHandle(), tolerance);
+    circuit.setConvergenceMonitor(monitor);
+
+    circuit.simulate(1.0, 1e-5);
+
+    const SimulationStats& stats = circuit.getLastRunStats();
+    assert(stats.steady_state == SteadyState::Periodic);
+    assert(std::abs(stats.period - 1e-3) < 1e-6);
+    assert(stats.end_time < 10e-3);
+    assert(stats.settle_time < stats.end_time);
+    assert(monitor->getProbeName(0) == "V(OUT)");
+
+    // On a clone the probe reads the clone's run, not the shared node
+    auto variant = circuit.clone("Sine Variant");
+    variant->setConvergenceMonitor(monitor);
+    variant->simulate(1.0, 1e-5);
+    assert(variant->isShared());
+    assert(variant->getLastRunStats().steady_state == SteadyState::Periodic);
+    assert(std::abs(variant->getLastRunStats().period - 1e-3) < 1e-6);
+
+    std::cout << "✓ Periodic termination test passed" << std::endl;
+}
+
+void test_dc_circuit_stops_after_window() {
+    Circuit circuit("DC Circuit");
+    auto vcc = std::make_shared<Node>("VCC");
+    auto gnd = std::make_shared<Node>("GND");
+    circuit.addNode(vcc);
+    circuit.addNode(gnd);
+
+    auto source = std::make_shared<VoltageSource>(5.0);
+    source->setId("V1");
+    source->connect(vcc);
+    source->connect(gnd);
+    circuit.addComponent(source);
+
+    auto resistor = std::make_shared<Resistor>(1000.0);
+    resistor->setId("R1");
+    resistor->connect(vcc);
+    resistor->connect(gnd);
+    circuit.addComponent(resistor);
+
+    ProbeTolerance tolerance;
+    tolerance.window = 10;
+    auto monitor = std::make_shared<ConvergenceMonitor>();
+    monitor->addComponentProbe(resistor->getHandle(), tolerance);
+    circuit.setConvergenceMonitor(monitor);
+
+    circuit.simulate(1.0, 1e-3);
+    assert(circuit.getLastRunStats().steady_state == SteadyState::Settled);
+    assert(circuit.getLastRunStats().steps == 10);
+
+    // A second run starts from a clean history
+    circuit.simulate(1.0, 1e-3);
+    assert(circuit.getLastRunStats().steps == 10);
+    assert(monitor->getProbeName(0) == "R1");
+
+    // Handles are checked when the run binds them
+    auto stray = std::make_shared<ConvergenceMonitor>();
+    stray->addNodeProbe(7);
+    circuit.setConvergenceMonitor(stray);
+    bool threw = false;
+    try {
+        circuit.simulate(1.0, 1e-3);
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    assert(threw);
+
+    std::cout << "✓ DC early termination test passed" << std::endl;
+}
+
+int main() {
+    std::cout << "Running Convergence Tests..." << std::endl;
+
+    try {
+        test_exponential_settles();
+        test_damped_ringing_is_not_periodic();
+        test_period_longer_than_window();
+        test_sine_source_stops_when_periodic();
+        test_dc_circuit_stops_after_window();
+
+        std::cout << "\\n✅ All convergence tests passed!" << std::endl;
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "❌ Test failed: " << e.what() << std::endl;
+        return 1;
+    } catch (...) {
+        std::cerr << "❌ Unknown test failure" << std::endl;
+        return 1;
+    }
+}
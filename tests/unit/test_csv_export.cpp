@@ -0,0 +1,242 @@
+#include "circuit_fixture.h"
+#include "core/circuit.h"
+#include "core/result_store.h"
+#include "core/sources.h"
+#include "io/csv_export.h"
+#include "io/waveform_file.h"
+#include <cassert>
+#include <charconv>
+#include <cmath>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace ic_sim;
+
+namespace {
+
+const std::filesystem::path kDir = std::filesystem::temp_directory_path() / "ic_sim_csv_test";
+
+// Every node voltage and i(C1) of test::makeFilter
+std::shared_ptr<ResultStore> recordFilter(size_t chunk_samples) {
+    auto circuit = test::makeFilter();
+
+    ResultStoreOptions options;
+    options.chunk_samples = chunk_samples;
+    auto results = std::make_shared<ResultStore>(options);
+    results->addProbe("v(*)");
+    results->addProbe("i(C1)");
+    circuit->setResultStore(results);
+    circuit->simulate(5e-4, 1e-6);
+    return results;
+}
+
+std::vector<std::string> split(const std::string& line, char delimiter) {
+    std::vector<std::string> fields;
+    size_t start = 0;
+    while (true) {
+        size_t end = line.find(delimiter, start);
+        fields.push_back(line.substr(start, end - start));
+        if (end == std::string::npos) {
+            return fields;
+        }
+        start = end + 1;
+    }
+}
+
+// Header fields, then the rows parsed back to doubles
+struct Table {
+    std::vector<std::string> header;
+    std::vector<std::vector<double>> rows;
+};
+
+Table parse(const std::string& text, char delimiter) {
+    Table table;
+    std::istringstream in(text);
+    std::string line;
+    std::getline(in, line);
+    table.header = split(line, delimiter);
+    while (std::getline(in, line)) {
+        std::vector<double> row;
+        for (const std::string& field : split(line, delimiter)) {
+            double value = 0.0;
+            auto result = std::from_chars(field.data(), field.data() + field.size(), value);
+            assert(result.ec == std::errc() && result.ptr == field.data() + field.size());
+            row.push_back(value);
+        }
+        assert(row.size() == table.header.size());
+        table.rows.push_back(row);
+    }
+    return table;
+}
+
+std::string toCsv(const ResultStore& results, const CsvExportOptions& options, CsvExportStats* stats = nullptr) {
+    std::ostringstream out;
+    CsvExportStats written = exportCsv(results, out, options);
+    if (stats) {
+        *stats = written;
+    }
+    return out.str();
+}
+
+} // namespace
+
+void test_round_trip() {
+    auto results = recordFilter(64);
+    CsvExportStats stats;
+    std::string text = toCsv(*results, {}, &stats);
+    Table table = parse(text, ',');
+
+    assert(table.header.size() == results->getProbeCount() + 1 && table.header[0] == "time");
+    for (size_t probe = 0; probe < results->getProbeCount(); ++probe) {
+        assert(table.header[probe + 1] == results->getProbeName(probe));
+    }
+    assert(stats.rows == results->getSampleCount() && stats.columns == table.header.size());
+    assert(stats.bytes == text.size() && table.rows.size() == stats.rows);
+
+    // Shortest round-trip formatting reads back bit for bit
+    std::vector<double> time = results->copyTime();
+    for (size_t probe = 0; probe < results->getProbeCount(); ++probe) {
+        std::vector<double> samples = results->copySamples(probe);
+        for (size_t row = 0; row < samples.size(); ++row) {
+            assert(table.rows[row][0] == time[row] && table.rows[row][probe + 1] == samples[row]);
+        }
+    }
+
+    // Fixed significant digits
+    CsvExportOptions options;
+    options.precision = 4;
+    Table rounded = parse(toCsv(*results, options), ',');
+    std::vector<double> out = results->copySamples(results->findProbe("v(OUT)"));
+    size_t column = results->findProbe("v(OUT)") + 1;
+    for (size_t row = 0; row < out.size(); ++row) {
+        assert(std::abs(rounded.rows[row][column] - out[row]) <= 5e-4 * std::abs(out[row]) + 1e-300);
+    }
+    std::cout << "✓ Round trip test passed" << std::endl;
+}
+
+void test_columns_and_window() {
+    auto results = recordFilter(64);
+    CsvExportOptions options;
+    options.delimiter = '\t';
+    options.columns = {"v(X1.*)", "i(C1)", "v(OUT)", "v(X1.OUT)"};
+    options.start_time = 1.0005e-4;
+    options.end_time = 3e-4;
+    CsvExportStats stats;
+    Table table = parse(toCsv(*results, options, &stats), '\t');
+    assert((table.header == std::vector<std::string>{"time", "v(X1.OUT)", "i(C1)", "v(OUT)"}));
+    assert(stats.columns == 4 && stats.rows == table.rows.size());
+
+    // Exactly the samples inside the window, in order
+    std::vector<double> time = results->copyTime();
+    std::vector<double> x1 = results->copySamples(results->findProbe("v(X1.OUT)"));
+    size_t expected = 0;
+    for (size_t row = 0; row < time.size(); ++row) {
+        if (time[row] < options.start_time || time[row] > options.end_time) {
+            continue;
+        }
+        assert(table.rows[expected][0] == time[row] && table.rows[expected][1] == x1[row]);
+        ++expected;
+    }
+    assert(expected == stats.rows && expected > 100);
+
+    // A window past the run leaves the header only
+    options.start_time = 1.0;
+    options.end_time = 2.0;
+    assert(toCsv(*results, options) == "time\tv(X1.OUT)\ti(C1)\tv(OUT)\n");
+    options.header = false;
+    assert(toCsv(*results, options).empty());
+
+    // Names without wildcards must exist; patterns may match nothing
+    options.columns = {"v(NOPE)"};
+    bool threw = false;
+    try {
+        toCsv(*results, options);
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    assert(threw);
+    options.columns = {"v(NOPE*)"};
+    toCsv(*results, options);
+    std::cout << "✓ Column and window test passed" << std::endl;
+}
+
+void test_waveform_file_and_threads() {
+    auto results = recordFilter(4096);
+    std::filesystem::create_directories(kDir);
+    std::string path = (kDir / "filter.icwave").string();
+    WaveformWriterOptions writer_options;
+    writer_options.chunk_samples = 50;
+    auto writer = std::make_shared<WaveformFileWriter>(path, writer_options);
+    std::vector<std::string> columns{"time"};
+    for (size_t probe = 0; probe < results->getProbeCount(); ++probe) {
+        columns.push_back(results->getProbeName(probe));
+    }
+    writer->begin(columns);
+    for (size_t chunk = 0; chunk < results->getChunkCount(); ++chunk) {
+        std::vector<double> rows;
+        for (size_t row = 0; row < results->time(chunk).size(); ++row) {
+            rows.push_back(results->time(chunk)[row]);
+            for (size_t probe = 0; probe < results->getProbeCount(); ++probe) {
+                rows.push_back(results->samples(probe, chunk)[row]);
+            }
+        }
+        writer->write(rows.data(), results->time(chunk).size(), columns.size());
+    }
+    writer->finish();
+    WaveformFileReader reader(path);
+
+    // Lossless file, same text as from memory, serial or on several threads
+    CsvExportOptions options;
+    std::string expected = toCsv(*results, options);
+    for (size_t threads : {size_t(1), size_t(3), size_t(0)}) {
+        options.threads = threads;
+        std::ostringstream out;
+        CsvExportStats stats = exportCsv(reader, out, options);
+        assert(out.str() == expected && stats.rows == results->getSampleCount());
+        assert(toCsv(*results, options) == expected);
+    }
+    options.start_time = 2.2e-4;
+    options.end_time = 2.6e-4;
+    options.columns = {"i(*)"};
+    std::ostringstream windowed;
+    exportCsv(reader, windowed, options);
+    assert(windowed.str() == toCsv(*results, options));
+    assert(parse(windowed.str(), ',').rows.size() > 10);
+
+    // Names with delimiters or quotes are quoted
+    std::string odd_path = (kDir / "odd.icwave").string();
+    WaveformFileWriter odd(odd_path);
+    odd.begin({"time", "v(a,b)", "v(\"q\")"});
+    double row[3] = {0.0, 0.5, -1.25};
+    odd.write(row, 1, 3);
+    odd.finish();
+    std::ostringstream quoted;
+    exportCsv(WaveformFileReader(odd_path), quoted);
+    assert(quoted.str() == "time,\"v(a,b)\",\"v(\"\"q\"\")\"\n0,0.5,-1.25\n");
+    std::filesystem::remove_all(kDir);
+    std::cout << "✓ Waveform file and thread test passed" << std::endl;
+}
+
+int main() {
+    std::cout << "Running CSV Export Tests..." << std::endl;
+
+    try {
+        test_round_trip();
+        test_columns_and_window();
+        test_waveform_file_and_threads();
+
+        std::cout << "\\n✅ All CSV export tests passed!" << std::endl;
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "❌ Test failed: " << e.what() << std::endl;
+        return 1;
+    } catch (...) {
+        std::cerr << "❌ Unknown test failure" << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,309 @@
+#include "circuit_fixture.h"
+#include "core/circuit.h"
+#include "core/sources.h"
+#include "core/topology.h"
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace ic_sim;
+
+namespace {
+
+// VIN -R1- N1 -R2- N2, with C1 and C2 from N1/N2 to GND, and a separate
+// R3 between A and B
+std::unique_ptr<Circuit> makeCircuit(const std::string& name = "ECO") {
+    auto circuit = test::makeCircuit(name, {"VIN", "N1", "N2", "GND", "A", "B"});
+    test::wire(*circuit, circuit->createComponent<VoltageSource>("V1", Waveform::sine(0.0, 1.0, 1e3)), "VIN", "GND");
+    test::wire(*circuit, circuit->createComponent<Resistor>("R1", 1e3), "VIN", "N1");
+    test::wire(*circuit, circuit->createComponent<Resistor>("R2", 1e3), "N1", "N2");
+    test::wire(*circuit, circuit->createComponent<Capacitor>("C1", 1e-7), "N1", "GND");
+    test::wire(*circuit, circuit->createComponent<Capacitor>("C2", 1e-7), "N2", "GND");
+    test::wire(*circuit, circuit->createComponent<Resistor>("R3", 1e3), "A", "B");
+    return circuit;
+}
+
+std::vector<uint32_t> toVector(Topology::Range range) {
+    return std::vector<uint32_t>(range.begin(), range.end());
+}
+
+bool sameBits(double a, double b) {
+    return std::memcmp(&a, &b, sizeof(double)) == 0;
+}
+
+// The patched topology describes the same circuit as a fresh compile: equal
+// CSR rows and pattern, the same islands up to their labels, and an ordering
+// that is a permutation keeping every island contiguous
+void checkMatchesBuild(Circuit& circuit) {
+    const Topology& patched = *circuit.getTopology();
+    std::vector<std::shared_ptr<Component>> components;
+    std::vector<std::shared_ptr<Node>> nodes;
+    for (ComponentId id = 0; id < circuit.getComponentCount(); ++id) {
+        components.push_back(circuit.getComponent(id));
+    }
+    for (NodeId id = 0; id < circuit.getNodeCount(); ++id) {
+        nodes.push_back(circuit.getNode(id));
+    }
+    auto built = Topology::build(components, nodes);
+
+    assert(patched.getNodeOffsets() == built->getNodeOffsets());
+    assert(patched.getNodeDevices() == built->getNodeDevices());
+    assert(patched.getDeviceOffsets() == built->getDeviceOffsets());
+    assert(patched.getDeviceNodes() == built->getDeviceNodes());
+    assert(patched.getPatternOffsets() == built->getPatternOffsets());
+    assert(patched.getPatternColumns() == built->getPatternColumns());
+
+    assert(patched.getIslandCount() == built->getIslandCount());
+    std::map<uint32_t, uint32_t> labels;
+    for (NodeId node = 0; node < circuit.getNodeCount(); ++node) {
+        assert(patched.getIslands()[node] < patched.getIslandCount());
+        auto [it, added] = labels.emplace(patched.getIslands()[node], built->getIslands()[node]);
+        assert(it->second == built->getIslands()[node]);
+    }
+    assert(labels.size() == built->getIslandCount());
+
+    std::vector<uint32_t> ordering = patched.getOrdering();
+    std::vector<bool> seen(circuit.getNodeCount(), false);
+    std::vector<bool> finished(patched.getIslandCount(), false);
+    for (size_t i = 0; i < ordering.size(); ++i) {
+        assert(ordering[i] < circuit.getNodeCount() && !seen[ordering[i]]);
+        seen[ordering[i]] = true;
+        uint32_t island = patched.getIslands()[ordering[i]];
+        assert(!finished[island]);
+        if (i + 1 == ordering.size() || patched.getIslands()[ordering[i + 1]] != island) {
+            finished[island] = true;
+        }
+    }
+    assert(ordering.size() == circuit.getNodeCount());
+}
+
+} // namespace
+
+void test_topology_patches() {
+    auto circuit = makeCircuit();
+    circuit->compile();
+    assert(circuit->getTopology()->getIslandCount() == 2);
+
+    // A new node is its own island until a device ties it in
+    NodeId n3 = circuit->insertNode("N3");
+    checkMatchesBuild(*circuit);
+    assert(circuit->getTopology()->getIslandCount() == 3);
+    auto r5 = std::make_shared<Resistor>(1e3);
+    r5->setId("R5");
+    circuit->insertComponent(r5, {n3, circuit->findNode("N2")});
+    checkMatchesBuild(*circuit);
+    assert(circuit->getTopology()->getIslandCount() == 2);
+
+    // Parallel device: the rows grow, the pattern does not
+    auto pattern = circuit->getTopology()->getPatternColumns();
+    auto r4 = std::make_shared<Resistor>(2e3);
+    r4->setId("R4");
+    circuit->insertComponent(r4, {circuit->findNode("N1"), circuit->findNode("N2")});
+    checkMatchesBuild(*circuit);
+    assert(circuit->getTopology()->getPatternColumns() == pattern);
+
+    // Bridging the two islands, then cutting them apart again
+    auto bridge = std::make_shared<Resistor>(1.0);
+    bridge->setId("BRIDGE");
+    ComponentId handle = circuit->insertComponent(bridge, {circuit->findNode("B"), circuit->findNode("GND")});
+    checkMatchesBuild(*circuit);
+    assert(circuit->getTopology()->getIslandCount() == 1);
+    circuit->removeComponent(handle);
+    checkMatchesBuild(*circuit);
+    assert(circuit->getTopology()->getIslandCount() == 2);
+
+    // Removing a device from the middle renumbers the last one
+    circuit->removeComponent(circuit->findComponent("R2"));
+    checkMatchesBuild(*circuit);
+    circuit->removeComponent(circuit->findComponent("R3"));
+    checkMatchesBuild(*circuit);
+    assert(circuit->getTopology()->getIslandCount() == 3);
+    circuit->removeNode(circuit->findNode("A"));
+    checkMatchesBuild(*circuit);
+    circuit->removeNode(circuit->findNode("B"));
+    checkMatchesBuild(*circuit);
+    assert(circuit->getTopology()->getIslandCount() == 1);
+    std::cout << "✓ Topology patch test passed" << std::endl;
+}
+
+void test_handles_after_removal() {
+    auto circuit = makeCircuit();
+    circuit->compile();
+    ComponentId r1 = circuit->findComponent("R1");
+    ComponentId last = static_cast<ComponentId>(circuit->getComponentCount() - 1);
+    std::string moved = circuit->getComponent(last)->getId();
+
+    circuit->removeComponent(r1);
+    assert(circuit->findComponent("R1") == kInvalidId);
+    assert(circuit->findComponent(moved) == r1);
+    assert(circuit->getComponent(r1)->getHandle() == r1 && circuit->getComponent(r1)->getId() == moved);
+    assert(circuit->getComponentCount() == last);
+
+    // Nodes with terminals stay; bare ones go, and the last node takes the handle
+    bool threw = false;
+    try {
+        circuit->removeNode(circuit->findNode("N1"));
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    assert(threw);
+    NodeId vin = circuit->findNode("VIN");
+    circuit->removeComponent(circuit->findComponent("V1"));
+    circuit->removeNode(vin);
+    assert(circuit->findNode("VIN") == kInvalidId);
+    assert(circuit->getNode(vin)->getId() == "B" && circuit->findNode("B") == vin);
+    checkMatchesBuild(*circuit);
+
+    // Taken ids and foreign nodes are refused
+    threw = false;
+    try {
+        circuit->insertNode("N1");
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    assert(threw);
+    threw = false;
+    try {
+        auto resistor = std::make_shared<Resistor>(1.0);
+        resistor->setId("R9");
+        circuit->insertComponent(resistor, {0, 99});
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    assert(threw);
+    assert(circuit->findComponent("R9") == kInvalidId);
+    std::cout << "✓ Handles after removal test passed" << std::endl;
+}
+
+void test_state_kept() {
+    // Inserting through the ECO path and through addComponent/connect gives
+    // the same run; only the former keeps the device state object
+    auto eco = makeCircuit();
+    auto rebuilt = makeCircuit();
+    eco->simulate(1e-4, 1e-6);
+    rebuilt->simulate(1e-4, 1e-6);
+    const DeviceState* state = eco->getDeviceState();
+    assert(state->getBoundCount() == 5);
+
+    auto c3 = std::make_shared<Capacitor>(2e-7);
+    c3->setId("C3");
+    eco->insertComponent(c3, {eco->findNode("N2"), eco->findNode("GND")});
+    assert(eco->getDeviceState() == state && state->getBoundCount() == 6);
+    auto copy = rebuilt->createComponent<Capacitor>("C3", 2e-7);
+    rebuilt->connect(copy->getHandle(), rebuilt->findNode("N2"));
+    rebuilt->connect(copy->getHandle(), rebuilt->findNode("GND"));
+    assert(rebuilt->getDeviceState() == nullptr);
+
+    eco->simulate(1e-4, 1e-6);
+    rebuilt->simulate(1e-4, 1e-6);
+    assert(eco->getDeviceState() == state);
+    for (NodeId id = 0; id < eco->getNodeCount(); ++id) {
+        assert(sameBits(eco->getNode(id)->getVoltage(), rebuilt->getNode(id)->getVoltage()));
+    }
+    assert(sameBits(std::static_pointer_cast<Capacitor>(eco->getComponent(eco->findComponent("C1")))->getCharge(),
+                    std::static_pointer_cast<Capacitor>(rebuilt->getComponent(rebuilt->findComponent("C1")))->getCharge()));
+
+    // Removal frees one slot; the last capacitor moves into it, state and all
+    auto c2 = std::static_pointer_cast<Capacitor>(eco->getComponent(eco->findComponent("C2")));
+    double c2_charge = c2->getCharge();
+    double c3_charge = c3->getCharge();
+    eco->removeComponent(eco->findComponent("C2"));
+    assert(eco->getDeviceState() == state && state->getBoundCount() == 5);
+    assert(state->capacitors().size() == 2);
+    assert(sameBits(c2->getCharge(), c2_charge) && sameBits(c3->getCharge(), c3_charge));
+    rebuilt->removeComponent(rebuilt->findComponent("C2"));
+    eco->simulate(1e-5, 1e-6);
+    rebuilt->simulate(1e-5, 1e-6);
+    assert(eco->getDeviceState() == state);
+    assert(sameBits(c3->getCharge(), copy->getCharge()));
+    std::cout << "✓ Device state kept test passed" << std::endl;
+}
+
+void test_set_parameter() {
+    auto circuit = makeCircuit();
+    circuit->compile();
+    circuit->simulate(1e-5, 1e-6);
+    const DeviceState* state = circuit->getDeviceState();
+    auto topology = circuit->getTopology();
+
+    ComponentId c1 = circuit->findComponent("C1");
+    circuit->setParameter(c1, 0, 4.7e-7);
+    circuit->setParameter(circuit->findComponent("R1"), 0, 220.0);
+    circuit->setParameter(circuit->findComponent("V1"), 3, 5e3);
+    assert(circuit->getDeviceState() == state && circuit->getTopology() == topology);
+    auto capacitor = std::static_pointer_cast<Capacitor>(circuit->getComponent(c1));
+    assert(capacitor->getCapacitance() == 4.7e-7);
+    bool found = false;
+    for (double capacitance : state->capacitors().capacitance) {
+        found = found || capacitance == 4.7e-7;
+    }
+    assert(found);
+    auto source = std::static_pointer_cast<Source>(circuit->getComponent(circuit->findComponent("V1")));
+    assert(source->getWaveform().getParameters()[2] == 5e3);
+
+    // No such slot; waveform type is fixed
+    for (auto [id, index] : {std::pair<ComponentId, size_t>{c1, 1}, {circuit->findComponent("V1"), 0}}) {
+        bool threw = false;
+        try {
+            circuit->setParameter(id, index, 1.0);
+        } catch (const std::invalid_argument&) {
+            threw = true;
+        }
+        assert(threw);
+    }
+
+    // On a clone only the clone's copy changes
+    auto variant = circuit->clone("Variant");
+    variant->setParameter(c1, 0, 1e-9);
+    assert(capacitor->getCapacitance() == 4.7e-7);
+    assert(std::static_pointer_cast<Capacitor>(variant->getComponent(c1))->getCapacitance() == 1e-9);
+    std::cout << "✓ Set parameter test passed" << std::endl;
+}
+
+void test_shared_topology() {
+    // Clones share the compiled topology; an edit patches a private copy
+    auto circuit = makeCircuit();
+    circuit->compile();
+    auto variant = circuit->clone("Variant");
+    auto before = circuit->getTopology();
+    variant->insertNode("N3");
+    assert(circuit->getTopology() == before && before->getNodeCount() == 6);
+    assert(variant->getTopology() != before && variant->getTopology()->getNodeCount() == 7);
+    assert(circuit->findNode("N3") == kInvalidId && variant->getNodeCount() == 7);
+    checkMatchesBuild(*variant);
+    checkMatchesBuild(*circuit);
+
+    // Without a compiled topology nothing is patched
+    auto plain = makeCircuit();
+    plain->insertNode("N3");
+    assert(plain->getTopology() == nullptr);
+    assert((toVector(plain->compile().nodeDevices(plain->findNode("N3"))).empty()));
+    std::cout << "✓ Shared topology test passed" << std::endl;
+}
+
+int main() {
+    std::cout << "Running ECO Tests..." << std::endl;
+
+    try {
+        test_topology_patches();
+        test_handles_after_removal();
+        test_state_kept();
+        test_set_parameter();
+        test_shared_topology();
+
+        std::cout << "\\n✅ All ECO tests passed!" << std::endl;
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "❌ Test failed: " << e.what() << std::endl;
+        return 1;
+    } catch (...) {
+        std::cerr << "❌ Unknown test failure" << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,203 @@
+#include "core/circuit.h"
+#include "core/sources.h"
+#include "io/json_netlist.h"
+#include "io/json_reader.h"
+#include <cassert>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace ic_sim;
+
+namespace {
+
+// Flattens the event stream into one line per event
+class Recorder : public JsonHandler {
+public:
+    std::vector<std::string> events;
+
+    void startObject() override { events.push_back("{"); }
+    void endObject() override { events.push_back("}"); }
+    void startArray() override { events.push_back("["); }
+    void endArray() override { events.push_back("]"); }
+    void key(std::string_view name) override { events.push_back("key " + std::string(name)); }
+    void string(std::string_view value) override { events.push_back("str " + std::string(value)); }
+    void number(double value) override {
+        std::ostringstream out;
+        out << value;
+        events.push_back("num " + out.str());
+    }
+    void boolean(bool value) override { events.push_back(value ? "true" : "false"); }
+    void null() override { events.push_back("null"); }
+};
+
+std::vector<std::string> events(const std::string& json, size_t buffer_size) {
+    std::istringstream in(json);
+    JsonReader reader(in, buffer_size);
+    Recorder recorder;
+    reader.parse(recorder);
+    assert(reader.getBytesRead() == json.size());
+    return recorder.events;
+}
+
+template <typename Error>
+bool fails(const std::string& json) {
+    std::istringstream in(json);
+    try {
+        loadJsonNetlist(in);
+    } catch (const Error&) {
+        return true;
+    }
+    return false;
+}
+
+const char* kForwardNetlist = R"({
+  "connections": [
+    {"id": "w1", "from": "V\u00b5", "to": "R1", "from_node": "positive", "to_node": "input"},
+    {"id": "w2", "from": "R1", "to": "R2", "from_node": "output", "to_node": "input"},
+    {"id": "w3", "from": "R2", "to": "V\u00b5", "from_node": "output", "to_node": "negative"}
+  ],
+  "extra": [1, {"nested": [true, null]}, "ignored"],
+  "components": [
+    {"id": "R1", "type": "Resistor", "parameters": {"resistance": 2e3}, "position": {"x": 1}},
+    {"id": "R2", "type": "Resistor", "parameters": {}},
+    {"type": "VoltageSource", "id": "V\u00b5", "parameters": {"voltage": 3.0}}
+  ],
+  "name": "Divider \"forward\""
+})";
+
+} // namespace
+
+void test_reader_events() {
+    std::string json = R"( {"a": [1, -2.5e-3, true, false, null], "s": "q\"\\\/\n\u00e9\ud83d\ude00", "e": {}} )";
+    std::vector<std::string> expected = {
+        "{", "key a", "[", "num 1", "num -0.0025", "true", "false", "null", "]",
+        "key s", "str q\"\\/\n\xc3\xa9\xf0\x9f\x98\x80", "key e", "{", "}", "}"};
+    // Every buffer size splits tokens at different places
+    for (size_t buffer_size : {size_t(1), size_t(2), size_t(3), size_t(7), size_t(1) << 20}) {
+        assert(events(json, buffer_size) == expected);
+    }
+    std::cout << "✓ Reader events test passed" << std::endl;
+}
+
+void test_reader_errors() {
+    for (const char* json : {"{\"a\" 1}", "[1, 2", "{\"a\": tru}", "\"open", "[1,]x", "{} {}",
+                             "[01.2.3]", "\"\\x\"", "\"\\ud800x\""}) {
+        bool threw = false;
+        try {
+            events(json, 4);
+        } catch (const JsonError& e) {
+            threw = true;
+            assert(std::string(e.what()).find("JSON error at byte") == 0);
+        }
+        assert(threw);
+    }
+
+    // Oversized tokens are rejected instead of growing without bound
+    std::string big = "\"" + std::string(100, 'x') + "\"";
+    std::istringstream in(big);
+    JsonReader reader(in, 16, 64);
+    Recorder recorder;
+    bool threw = false;
+    try {
+        reader.parse(recorder);
+    } catch (const JsonError&) {
+        threw = true;
+    }
+    assert(threw);
+    std::cout << "✓ Reader error test passed" << std::endl;
+}
+
+void test_rc_filter_example() {
+    JsonNetlist netlist = loadJsonNetlistFile(RC_FILTER_JSON);
+    Circuit& circuit = *netlist.circuit;
+    assert(circuit.getName() == "RC Low-pass Filter");
+    assert(netlist.version == "1.0");
+    assert(netlist.connections == 3);
+    assert(netlist.simulation.duration == 0.01);
+    assert(netlist.simulation.timestep == 1e-6);
+    assert(netlist.simulation.type == "transient");
+
+    assert(circuit.getComponentCount() == 3);
+    assert(circuit.getNodeCount() == 3);
+    assert(circuit.getComponent("R1")->getType() == "Resistor");
+    auto source = std::static_pointer_cast<VoltageSource>(circuit.getComponent("V1"));
+    assert(source->getWaveform().getType() == WaveformType::Sine);
+
+    // V1+ -- R1 -- C1 -- V1-
+    NodeId input = circuit.findNode("R1.input");
+    NodeId output = circuit.findNode("R1.output");
+    NodeId ground = circuit.findNode("C1.output");
+    assert(input != kInvalidId && output != kInvalidId && ground != kInvalidId);
+    const auto& v1 = source->getNodes();
+    assert(v1[0] == circuit.getNode(input).get() && v1[1] == circuit.getNode(ground).get());
+    const auto& c1 = circuit.getComponent("C1")->getNodes();
+    assert(c1[0] == circuit.getNode(output).get() && c1[1] == circuit.getNode(ground).get());
+
+    const Topology& topology = circuit.compile();
+    assert(topology.getNodeCount() == 3);
+    circuit.simulate(1e-4, netlist.simulation.timestep);
+    std::cout << "✓ RC filter example test passed" << std::endl;
+}
+
+void test_forward_references() {
+    std::istringstream in(kForwardNetlist);
+    JsonNetlist netlist = loadJsonNetlist(in);
+    Circuit& circuit = *netlist.circuit;
+    assert(circuit.getName() == "Divider \"forward\"");
+    assert(circuit.getComponentCount() == 3 && circuit.getNodeCount() == 3);
+    assert(netlist.bytes_read == std::string(kForwardNetlist).size());
+
+    // Defaults come from the schema; escaped ids are decoded
+    auto r2 = std::static_pointer_cast<Resistor>(circuit.getComponent("R2"));
+    assert(r2->getResistance() == 1e3);
+    assert(std::static_pointer_cast<Resistor>(circuit.getComponent("R1"))->getResistance() == 2e3);
+    assert(circuit.findComponent("V\xc2\xb5") != kInvalidId);
+    assert(circuit.findNode("V\xc2\xb5.positive") != kInvalidId);
+
+    // Chunk boundaries must not change the result
+    std::istringstream again(kForwardNetlist);
+    JsonNetlistOptions options;
+    options.buffer_size = 5;
+    JsonNetlist chunked = loadJsonNetlist(again, options);
+    for (NodeId node = 0; node < circuit.getNodeCount(); ++node) {
+        assert(chunked.circuit->getNode(node)->getId() == circuit.getNode(node)->getId());
+    }
+    std::cout << "✓ Forward reference test passed" << std::endl;
+}
+
+void test_netlist_errors() {
+    assert(fails<JsonError>("{\"components\": [}"));
+    assert(fails<std::runtime_error>("[]"));
+    assert(fails<std::runtime_error>(R"({"components": [{"id": "X1", "type": "Memristor"}]})"));
+    assert(fails<std::runtime_error>(R"({"components": [{"type": "Resistor"}]})"));
+    assert(fails<std::runtime_error>(
+        R"({"components": [{"id": "R1", "type": "Resistor"}, {"id": "R1", "type": "Resistor"}]})"));
+    assert(fails<std::runtime_error>(R"({"components": [{"id": "R1", "type": "Resistor"}],
+        "connections": [{"from": "R1", "to": "R9", "from_node": "input", "to_node": "input"}]})"));
+    assert(fails<std::runtime_error>(R"({"components": [{"id": "R1", "type": "Resistor"}],
+        "connections": [{"from": "R1", "to": "R1", "from_node": "input", "to_node": "gate"}]})"));
+    std::cout << "✓ Netlist error test passed" << std::endl;
+}
+
+int main() {
+    std::cout << "Running JSON Netlist Tests..." << std::endl;
+
+    try {
+        test_reader_events();
+        test_reader_errors();
+        test_rc_filter_example();
+        test_forward_references();
+        test_netlist_errors();
+
+        std::cout << "\\n✅ All JSON netlist tests passed!" << std::endl;
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "❌ Test failed: " << e.what() << std::endl;
+        return 1;
+    } catch (...) {
+        std::cerr << "❌ Unknown test failure" << std::endl;
+        return 1;
+    }
+}
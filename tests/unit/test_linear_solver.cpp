@@ -0,0 +1,195 @@
+#include "core/linear_solver.h"
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+using namespace ic_sim;
+
+namespace {
+
+// Diagonally dominant random matrix: well conditioned, so float factors refine quickly
+std::vector<double> makeDominant(size_t n, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> entry(-1.0, 1.0);
+    std::vector<double> matrix(n * n);
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < n; ++j) {
+            matrix[i * n + j] = entry(rng);
+        }
+        matrix[i * n + i] += static_cast<double>(n);
+    }
+    return matrix;
+}
+
+// Hilbert matrix: condition number far beyond what float factors can refine
+std::vector<double> makeHilbert(size_t n) {
+    std::vector<double> matrix(n * n);
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < n; ++j) {
+            matrix[i * n + j] = 1.0 / static_cast<double>(i + j + 1);
+        }
+    }
+    return matrix;
+}
+
+std::vector<double> multiply(const std::vector<double>& matrix, const std::vector<double>& x) {
+    size_t n = x.size();
+    std::vector<double> result(n, 0.0);
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < n; ++j) {
+            result[i] += matrix[i * n + j] * x[j];
+        }
+    }
+    return result;
+}
+
+} // namespace
+
+void test_double_solve() {
+    LinearSolver solver;
+    // Needs a row swap: the leading entry is zero
+    solver.factor({{0.0, 2.0, 1.0}, {1.0, 1.0, 0.0}, {2.0, 0.0, 3.0}});
+    std::vector<double> solution;
+    SolveReport report = solver.solve({7.0, 3.0, 11.0}, solution);
+
+    assert(report.precision == SolverPrecision::Double);
+    assert(!report.fell_back);
+    assert(std::abs(solution[0] - 1.0) < 1e-12);
+    assert(std::abs(solution[1] - 2.0) < 1e-12);
+    assert(std::abs(solution[2] - 3.0) < 1e-12);
+
+    std::cout << "✓ Double solve test passed" << std::endl;
+}
+
+void test_mixed_refinement() {
+    const size_t n = 200;
+    std::vector<double> matrix = makeDominant(n, 7);
+    std::vector<double> expected(n);
+    for (size_t i = 0; i < n; ++i) {
+        expected[i] = std::sin(static_cast<double>(i));
+    }
+    std::vector<double> rhs = multiply(matrix, expected);
+
+    SolverOptions options;
+    options.precision = SolverPrecision::Mixed;
+    LinearSolver solver(options);
+    solver.factor(matrix, n);
+
+    std::vector<double> solution;
+    SolveReport report = solver.solve(rhs, solution);
+    assert(report.precision == SolverPrecision::Mixed);
+    assert(!report.fell_back);
+    assert(report.refinements >= 1);
+    assert(report.backward_error <= std::sqrt(static_cast<double>(n)) * 2.3e-16);
+    for (size_t i = 0; i < n; ++i) {
+        assert(std::abs(solution[i] - expected[i]) < 1e-12);
+    }
+    assert(solver.getFallbackCount() == 0);
+
+    std::cout << "✓ Mixed-precision refinement test passed" << std::endl;
+}
+
+void test_fallback_reported() {
+    const size_t n = 12;
+    std::vector<double> matrix = makeHilbert(n);
+    std::vector<double> rhs = multiply(matrix, std::vector<double>(n, 1.0));
+
+    SolverOptions options;
+    options.precision = SolverPrecision::Mixed;
+    LinearSolver solver(options);
+    size_t reported = 0;
+    solver.setFallbackHandler([&](const SolveReport& report) {
+        assert(report.fell_back && !report.fallback_reason.empty());
+        ++reported;
+    });
+    solver.factor(matrix, n);
+
+    std::vector<double> solution;
+    SolveReport report = solver.solve(rhs, solution);
+    assert(report.fell_back);
+    assert(report.precision == SolverPrecision::Double);
+    assert(report.backward_error < 1e-14);
+    assert(reported == 1 && solver.getFallbackCount() == 1);
+
+    // The double factors are kept for later solves against the same matrix
+    report = solver.solve(rhs, solution);
+    assert(!report.fell_back && report.precision == SolverPrecision::Double);
+    assert(reported == 1);
+
+    // Entries beyond float range go straight to double
+    std::vector<double> wide = {1e40, 1.0, 1.0, 1.0};
+    solver.factor(wide, 2);
+    report = solver.solve({1e40 + 1.0, 2.0}, solution);
+    assert(report.fell_back);
+    assert(report.fallback_reason == "matrix entries overflow single precision");
+    assert(std::abs(solution[0] - 1.0) < 1e-12 && std::abs(solution[1] - 1.0) < 1e-12);
+
+    std::cout << "✓ Fallback report test passed" << std::endl;
+}
+
+void test_singular_matrix() {
+    const std::vector<double> singular = {1.0, 2.0, 2.0, 4.0};
+    std::vector<double> solution;
+
+    // Double mode: factor() finds it, and solve() refuses the failed factors
+    SolverOptions options;
+    options.precision = SolverPrecision::Double;
+    LinearSolver exact(options);
+    bool threw = false;
+    try {
+        exact.factor(singular, 2);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+    threw = false;
+    try {
+        exact.solve({1.0, 2.0}, solution);
+    } catch (const std::logic_error&) {
+        threw = true;
+    }
+    assert(threw);
+    exact.factor({2.0, 0.0, 0.0, 4.0}, 2);
+    exact.solve({1.0, 2.0}, solution);
+    assert(solution[0] == 0.5 && solution[1] == 0.5);
+
+    // Mixed mode: the float factors hit a zero pivot and the double fallback in
+    // solve() finds the matrix singular, on every solve
+    options.precision = SolverPrecision::Mixed;
+    LinearSolver mixed(options);
+    mixed.factor(singular, 2);
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        threw = false;
+        try {
+            mixed.solve({1.0, 2.0}, solution);
+        } catch (const std::runtime_error&) {
+            threw = true;
+        }
+        assert(threw);
+    }
+
+    std::cout << "✓ Singular matrix test passed" << std::endl;
+}
+
+int main() {
+    std::cout << "Running Linear Solver Tests..." << std::endl;
+
+    try {
+        test_double_solve();
+        test_mixed_refinement();
+        test_fallback_reported();
+        test_singular_matrix();
+
+        std::cout << "\\n✅ All linear solver tests passed!" << std::endl;
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "❌ Test failed: " << e.what() << std::endl;
+        return 1;
+    } catch (...) {
+        std::cerr << "❌ Unknown test failure" << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,215 @@
+#include "core/linear_solver.h"
+#include "core/memory_policy.h"
+#include "core/thread_pool.h"
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+using namespace ic_sim;
+
+namespace {
+
+size_t nodeTotal(const PlacementReport& report) {
+    return std::accumulate(report.node_pages.begin(), report.node_pages.end(), size_t(0));
+}
+
+// CPUs this process may run on
+std::vector<unsigned> allowedCpus() {
+    std::vector<unsigned> cpus;
+#ifdef __linux__
+    cpu_set_t set;
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (unsigned cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &set)) {
+                cpus.push_back(cpu);
+            }
+        }
+    }
+#endif
+    return cpus;
+}
+
+// NUMA node of a CPU from sysfs, 0 where the system has no node entries
+size_t cpuNode(unsigned cpu) {
+    std::error_code error;
+    std::filesystem::directory_iterator entries("/sys/devices/system/cpu/cpu" + std::to_string(cpu), error);
+    for (; !error && entries != std::filesystem::directory_iterator(); entries.increment(error)) {
+        std::string name = entries->path().filename().string();
+        if (name.size() > 4 && name.compare(0, 4, "node") == 0 &&
+            name.find_first_not_of("0123456789", 4) == std::string::npos) {
+            return std::stoul(name.substr(4));
+        }
+    }
+    return 0;
+}
+
+} // namespace
+
+void test_first_write_places_pages() {
+    const size_t count = 1 << 18;  // 2 MB of doubles
+    PagedBuffer<double> buffer(count, MemoryPolicy());
+    assert(buffer.size() == count);
+    assert(buffer.getPagePolicy() == PagePolicy::Default);
+
+    PlacementReport untouched = buffer.placement();
+    assert(untouched.bytes == count * sizeof(double));
+    assert(untouched.pages > 0);
+#ifdef __linux__
+    assert(untouched.resident_pages == 0);
+#endif
+
+    for (size_t i = 0; i < count; ++i) {
+        assert(buffer[i] == 0.0);
+        buffer[i] = static_cast<double>(i);
+    }
+    PlacementReport written = buffer.placement();
+#ifdef __linux__
+    assert(written.resident_pages == written.pages);
+#endif
+    if (!written.node_pages.empty()) {
+        assert(nodeTotal(written) == written.resident_pages);
+    }
+
+    std::cout << "✓ First-write placement test passed" << std::endl;
+}
+
+void test_first_touch_follows_affinity() {
+    // Shared pool with one worker pinned to each allowed CPU, at most four
+    std::vector<unsigned> cpus = allowedCpus();
+    if (cpus.empty()) {
+        cpus.push_back(0);
+    }
+    cpus.resize(std::min<size_t>(cpus.size(), 4));
+    ThreadPoolOptions options;
+    options.threads = cpus.size() + 1;
+    options.cpus = cpus;
+    ThreadPool::configureShared(options);
+    ThreadPool& pool = ThreadPool::shared();
+    const size_t workers = pool.getWorkerCount();
+
+    MemoryPolicy policy;
+    policy.first_touch = firstTouchOn();
+    PagedBuffer<float> buffer(1 << 20, policy);
+
+    PlacementReport report = buffer.placement();
+#ifdef __linux__
+    assert(report.resident_pages == report.pages);
+#endif
+    assert(buffer[0] == 0.0f && buffer[buffer.size() - 1] == 0.0f);
+
+    // A consumer splitting the elements the same way finds its slice on the
+    // node of the CPU its worker is pinned to; the page it shares with the
+    // next slice may have gone to the neighbour
+    std::atomic<size_t> misplaced{0};
+    parallelForStatic(0, buffer.size(), [&](size_t first, size_t last) {
+        PlacementReport slice = queryPlacement(&buffer[first], (last - first) * sizeof(float));
+        if (slice.node_pages.empty() || pool.getPinnedCount() != workers) {
+            return;
+        }
+#ifdef __linux__
+        size_t node = cpuNode(static_cast<unsigned>(sched_getcpu()));
+        if (node >= slice.node_pages.size() || slice.node_pages[node] + 2 < slice.pages) {
+            ++misplaced;
+        }
+#endif
+    });
+    assert(misplaced == 0);
+
+    // Ownership moves with the buffer
+    PagedBuffer<float> moved = std::move(buffer);
+    assert(buffer.empty() && buffer.data() == nullptr);
+    assert(moved.size() == (1u << 20));
+
+    // A toucher that runs past the end is an error, not a silent overrun
+    policy.first_touch = [](size_t pages, const PageTouch& touch) { touch(0, pages + 1); };
+    bool threw = false;
+    try {
+        PagedBuffer<float> overrun(1024, policy);
+    } catch (const std::out_of_range&) {
+        threw = true;
+    }
+    assert(threw);
+
+    std::cout << "✓ First touch affinity test passed" << std::endl;
+}
+
+void test_huge_page_policies() {
+    MemoryPolicy policy;
+    policy.pages = PagePolicy::Transparent;
+    PagedBuffer<double> transparent(1 << 20, policy);
+#ifdef __linux__
+    assert(transparent.getPagePolicy() == PagePolicy::Transparent);
+    assert(reinterpret_cast<uintptr_t>(transparent.data()) % (2u << 20) == 0);
+#endif
+    transparent[0] = 1.0;
+    assert(transparent.placement().huge_page_bytes <= (8u << 20));
+
+    // Without a reserved hugetlb pool this falls back to transparent pages
+    policy.pages = PagePolicy::Explicit;
+    PagedBuffer<double> explicit_pages(1 << 20, policy);
+#ifdef __linux__
+    assert(explicit_pages.getPagePolicy() != PagePolicy::Default);
+#endif
+    explicit_pages[explicit_pages.size() - 1] = 2.0;
+    assert(explicit_pages[explicit_pages.size() - 1] == 2.0);
+
+    std::cout << "✓ Huge page policy test passed" << std::endl;
+}
+
+void test_solver_placement() {
+    SolverOptions options;
+    options.precision = SolverPrecision::Mixed;
+    options.memory.first_touch = firstTouchOn();
+    LinearSolver solver(options);
+
+    const size_t n = 64;
+    std::vector<double> matrix(n * n, 0.0);
+    for (size_t i = 0; i < n; ++i) {
+        matrix[i * n + i] = 2.0;
+    }
+    solver.factor(matrix, n);
+
+    // Original matrix in double plus float factors
+    PlacementReport report = solver.getPlacement();
+    assert(report.bytes == n * n * (sizeof(double) + sizeof(float)));
+#ifdef __linux__
+    assert(report.resident_pages == report.pages);
+#endif
+
+    std::vector<double> solution;
+    solver.solve(std::vector<double>(n, 1.0), solution);
+    assert(solution[n - 1] == 0.5);
+
+    std::cout << "✓ Solver placement test passed" << std::endl;
+}
+
+int main() {
+    std::cout << "Running Memory Policy Tests..." << std::endl;
+
+    try {
+        test_first_write_places_pages();
+        test_first_touch_follows_affinity();
+        test_huge_page_policies();
+        test_solver_placement();
+
+        std::cout << "\\n✅ All memory policy tests passed!" << std::endl;
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "❌ Test failed: " << e.what() << std::endl;
+        return 1;
+    } catch (...) {
+        std::cerr << "❌ Unknown test failure" << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,149 @@
+#include "circuit_fixture.h"
+#include "core/circuit.h"
+#include "core/result_store.h"
+#include "core/sources.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace ic_sim;
+
+namespace {
+
+bool threwInvalidArgument(const std::function<void()>& action) {
+    try {
+        action();
+    } catch (const std::invalid_argument&) {
+        return true;
+    }
+    return false;
+}
+
+} // namespace
+
+void test_wildcards() {
+    assert(matchWildcard("X1.*", "X1.OUT"));
+    assert(matchWildcard("*", ""));
+    assert(matchWildcard("R?", "R1") && !matchWildcard("R?", "R12"));
+    assert(matchWildcard("*.C*", "X1.C") && !matchWildcard("*.C*", "C1"));
+    assert(matchWildcard("a*b*c", "aXXbYbZc") && !matchWildcard("a*b*c", "aXXbYbZ"));
+    assert(!matchWildcard("OUT", "X1.OUT"));
+    std::cout << "✓ Wildcard test passed" << std::endl;
+}
+
+void test_recording_during_simulation() {
+    auto circuit = test::makeFilter();
+    ResultStoreOptions options;
+    options.chunk_samples = 64;  // several chunks per run
+    auto results = std::make_shared<ResultStore>(options);
+    results->addProbe("v(VIN)");
+    results->addProbe("v(OUT)");
+    results->addProbe("i(C1)");
+    circuit->setResultStore(results);
+
+    circuit->simulate(5e-4, 1e-6);
+    const SimulationStats& stats = circuit->getLastRunStats();
+    assert(results->getProbeCount() == 3);
+    assert(results->getSampleCount() == stats.steps + 1);
+    assert(results->getChunkCount() == (stats.steps + 1 + 63) / 64);
+
+    // Spans are contiguous, chunk by chunk, and agree with the flat copies
+    std::vector<double> time = results->copyTime();
+    std::vector<double> vin = results->copySamples(results->findProbe("v(VIN)"));
+    assert(time.size() == results->getSampleCount() && time.front() == 0.0);
+    size_t row = 0;
+    for (size_t chunk = 0; chunk < results->getChunkCount(); ++chunk) {
+        SampleSpan t = results->time(chunk);
+        SampleSpan v = results->samples(0, chunk);
+        assert(t.size() == v.size() && t.size() <= 64);
+        for (size_t i = 0; i < t.size(); ++i, ++row) {
+            assert(t[i] == time[row] && v[i] == vin[row]);
+        }
+    }
+    assert(row == time.size());
+
+    // Rows are taken after each step, so the input follows the waveform and the
+    // pulse corners are sampled exactly
+    auto source = std::static_pointer_cast<VoltageSource>(circuit->getComponent("V1"));
+    for (size_t i = 1; i < time.size(); ++i) {
+        assert(time[i] > time[i - 1]);
+        assert(vin[i] == source->getWaveform().valueAt(time[i]));
+    }
+    assert(std::find(time.begin(), time.end(), 1e-4) != time.end());
+    assert(time.back() == stats.end_time);
+
+    std::vector<double> out = results->copySamples(results->findProbe("v(OUT)"));
+    assert(out.back() == circuit->getNode("OUT")->getVoltage());
+    assert(results->findProbe("v(GND)") == ResultStore::kNoProbe);
+
+    // A second run overwrites the first and reuses its chunks
+    size_t bytes = results->memoryBytes();
+    circuit->simulate(5e-4, 1e-6);
+    assert(results->getSampleCount() == stats.steps + 1 && results->memoryBytes() == bytes);
+    std::cout << "✓ Recording test passed" << std::endl;
+}
+
+void test_wildcard_probes() {
+    auto circuit = test::makeFilter();
+    auto results = std::make_shared<ResultStore>();
+    results->addProbe("v(X1.*)");
+    results->addProbe("v(*OUT)");  // X1.OUT again, once
+    results->addProbe("i(X1.?)");
+    results->addProbe("i(R*)");
+    circuit->setResultStore(results);
+    circuit->simulate(1e-5, 1e-6);
+
+    assert(results->getProbeCount() == 5);
+    assert(results->getProbeName(0) == "v(X1.OUT)");
+    assert(results->getProbeName(1) == "v(OUT)");
+    assert(results->getProbeName(2) == "i(X1.R)" && results->getProbeName(3) == "i(X1.C)");
+    assert(results->getProbeName(4) == "i(R1)");
+    assert(results->getProbeKind(4) == ProbeKind::Current);
+    assert(results->getSampleCount() == circuit->getLastRunStats().steps + 1);
+    std::cout << "✓ Wildcard probe test passed" << std::endl;
+}
+
+void test_probe_errors() {
+    ResultStore results;
+    assert(threwInvalidArgument([&] { results.addProbe("OUT"); }));
+    assert(threwInvalidArgument([&] { results.addProbe("x(OUT)"); }));
+    assert(threwInvalidArgument([&] { results.addProbe("v()"); }));
+    assert(threwInvalidArgument([] { ResultStoreOptions options; options.chunk_samples = 0; ResultStore r(options); }));
+
+    // Exact names must exist; wildcards may match nothing
+    auto circuit = test::makeFilter();
+    auto store = std::make_shared<ResultStore>();
+    store->addProbe("v(NOPE*)");
+    circuit->setResultStore(store);
+    circuit->simulate(1e-6, 1e-6);
+    assert(store->getProbeCount() == 0 && store->getSampleCount() == 2);
+    store->addProbe("i(R9)");
+    assert(threwInvalidArgument([&] { circuit->simulate(1e-6, 1e-6); }));
+    std::cout << "✓ Probe error test passed" << std::endl;
+}
+
+int main() {
+    std::cout << "Running Result Store Tests..." << std::endl;
+
+    try {
+        test_wildcards();
+        test_recording_during_simulation();
+        test_wildcard_probes();
+        test_probe_errors();
+
+        std::cout << "\\n✅ All result store tests passed!" << std::endl;
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "❌ Test failed: " << e.what() << std::endl;
+        return 1;
+    } catch (...) {
+        std::cerr << "❌ Unknown test failure" << std::endl;
+        return 1;
+    }
+}
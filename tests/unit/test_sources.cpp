@@ -0,0 +1,150 @@
+#include "core/circuit.h"
+#include "core/sources.h"
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+using namespace ic_sim;
+
+namespace {
+
+bool near(double a, double b, double tolerance = 1e-9) {
+    return std::abs(a - b) < tolerance;
+}
+
+// Records the times at which the circuit advanced the source
+class RecordingSource : public VoltageSource {
+public:
+    explicit RecordingSource(Waveform waveform) : VoltageSource(std::move(waveform)) {}
+    std::vector<double> times;
+
+protected:
+    void apply() override {
+        times.push_back(time_);
+        VoltageSource::apply();
+    }
+};
+
+} // namespace
+
+void test_pulse_waveform() {
+    // 0V -> 5V, 1us delay, 0.2us edges, 1us width, 3us period
+    auto pulse = Waveform::pulse(0.0, 5.0, 1e-6, 0.2e-6, 0.2e-6, 1e-6, 3e-6);
+    assert(near(pulse.valueAt(0.0), 0.0));
+    assert(near(pulse.valueAt(1.1e-6), 2.5));
+    assert(near(pulse.valueAt(1.5e-6), 5.0));
+    assert(near(pulse.valueAt(2.3e-6), 2.5));
+    assert(near(pulse.valueAt(3.0e-6), 0.0));
+    assert(near(pulse.valueAt(4.5e-6), 5.0)); // second period
+
+    assert(near(pulse.nextBreakpoint(0.0), 1e-6, 1e-15));
+    assert(near(pulse.nextBreakpoint(1e-6), 1.2e-6, 1e-15));
+    assert(near(pulse.nextBreakpoint(2.3e-6), 2.4e-6, 1e-15));
+    assert(near(pulse.nextBreakpoint(2.4e-6), 4e-6, 1e-15));
+
+    std::cout << "✓ Pulse waveform test passed" << std::endl;
+}
+
+void test_sine_waveform() {
+    auto sine = Waveform::sine(1.0, 2.0, 1000.0, 1e-3);
+    assert(near(sine.valueAt(0.5e-3), 1.0));
+    assert(near(sine.valueAt(1.25e-3), 3.0));
+    assert(near(sine.nextBreakpoint(0.0), 1e-3));
+    assert(std::isinf(sine.nextBreakpoint(2e-3)));
+
+    std::cout << "✓ Sine waveform test passed" << std::endl;
+}
+
+void test_pwl_cursor() {
+    auto pwl = Waveform::pwl({{0.0, 0.0}, {1.0, 10.0}, {2.0, 10.0}, {3.0, 0.0}});
+    assert(near(pwl.valueAt(0.5), 5.0));
+    assert(near(pwl.valueAt(1.5), 10.0));
+    assert(near(pwl.valueAt(2.5), 5.0));
+    assert(near(pwl.valueAt(4.0), 0.0));
+
+    // Going backwards rewinds the cursor instead of returning stale segments
+    assert(near(pwl.valueAt(0.25), 2.5));
+    assert(near(pwl.nextBreakpoint(1.0), 2.0));
+    assert(std::isinf(pwl.nextBreakpoint(3.0)));
+
+    std::cout << "✓ PWL cursor test passed" << std::endl;
+}
+
+void test_stepper_lands_on_breakpoints() {
+    Circuit circuit("Pulse Circuit");
+    auto in = std::make_shared<Node>("IN");
+    auto gnd = std::make_shared<Node>("GND");
+    circuit.addNode(in);
+    circuit.addNode(gnd);
+
+    // Corners at 0.35us, 0.4us, 1.1us, 1.15us: none is a multiple of the 0.1us step
+    auto source = std::make_shared<RecordingSource>(
+        Waveform::pulse(0.0, 1.0, 0.35e-6, 0.05e-6, 0.05e-6, 0.7e-6, 0.0));
+    source->setId("V1");
+    source->connect(in);
+    source->connect(gnd);
+    circuit.addComponent(source);
+
+    circuit.simulate(2e-6, 0.1e-6);
+
+    const SimulationStats& stats = circuit.getLastRunStats();
+    assert(stats.breakpoints == 4);
+    assert(near(stats.end_time, 2e-6, 1e-18));
+
+    // Every corner must have been an exact step boundary
+    const Waveform& waveform = source->getWaveform();
+    for (double corner = waveform.nextBreakpoint(0.0); !std::isinf(corner);
+         corner = waveform.nextBreakpoint(corner)) {
+        bool landed = false;
+        for (double t : source->times) {
+            landed = landed || t == corner;
+        }
+        assert(landed);
+    }
+    assert(near(in->getVoltage(), 0.0));
+
+    std::cout << "✓ Stepper breakpoint test passed" << std::endl;
+}
+
+void test_voltage_source_drives_node() {
+    auto vin = std::make_shared<Node>("VIN");
+    auto gnd = std::make_shared<Node>("GND");
+    gnd->setVoltage(1.0);
+
+    auto source = std::make_shared<VoltageSource>(5.0);
+    source->connect(vin);
+    source->connect(gnd);
+    source->setTime(0.0);
+
+    assert(source->getType() == "VoltageSource");
+    assert(near(vin->getVoltage(), 6.0));
+
+    auto current = std::make_shared<CurrentSource>(Waveform::pwl({{0.0, 0.0}, {1.0, 2.0}}));
+    current->setTime(0.5);
+    assert(near(current->getCurrentValue(), 1.0));
+
+    std::cout << "✓ Voltage source test passed" << std::endl;
+}
+
+int main() {
+    std::cout << "Running Source Tests..." << std::endl;
+
+    try {
+        test_pulse_waveform();
+        test_sine_waveform();
+        test_pwl_cursor();
+        test_stepper_lands_on_breakpoints();
+        test_voltage_source_drives_node();
+
+        std::cout << "\\n✅ All source tests passed!" << std::endl;
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "❌ Test failed: " << e.what() << std::endl;
+        return 1;
+    } catch (...) {
+        std::cerr << "❌ Unknown test failure" << std::endl;
+        return 1;
+    }
+}
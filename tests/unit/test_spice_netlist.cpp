@@ -0,0 +1,247 @@
+#include "core/circuit.h"
+#include "core/sources.h"
+#include "io/spice_netlist.h"
+#include "plugins/plugin_system.h"
+#include <cassert>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+using namespace ic_sim;
+
+namespace {
+
+bool near(double a, double b) {
+    return std::abs(a - b) <= 1e-12 * std::abs(b);
+}
+
+double resistance(Circuit& circuit, const std::string& id) {
+    return std::static_pointer_cast<Resistor>(circuit.getComponent(id))->getResistance();
+}
+
+// Line of the SpiceError thrown for the deck, 0 if it loads
+size_t errorLine(const std::string& deck) {
+    try {
+        parseSpiceNetlist(deck);
+    } catch (const SpiceError& e) {
+        return e.getLine();
+    }
+    return 0;
+}
+
+void writeFile(const std::filesystem::path& path, const std::string& text) {
+    std::filesystem::create_directories(path.parent_path());
+    std::ofstream(path) << text;
+}
+
+} // namespace
+
+void test_numbers() {
+    double value = 0.0;
+    assert(parseSpiceNumber("4.7k", value) && near(value, 4.7e3));
+    assert(parseSpiceNumber("10uF", value) && near(value, 10e-6));
+    assert(parseSpiceNumber("1MEG", value) && near(value, 1e6));
+    assert(parseSpiceNumber("1m", value) && near(value, 1e-3));
+    assert(parseSpiceNumber("2mil", value) && near(value, 50.8e-6));
+    assert(parseSpiceNumber("-3.3v", value) && value == -3.3);
+    assert(parseSpiceNumber("1e-9", value) && value == 1e-9);
+    assert(parseSpiceNumber("+.5p", value) && near(value, 0.5e-12));
+    assert(!parseSpiceNumber("nand", value));
+    assert(!parseSpiceNumber("2*w", value));
+    std::cout << "✓ Number test passed" << std::endl;
+}
+
+void test_rc_filter_example() {
+    SpiceNetlist netlist = loadSpiceNetlist(RC_FILTER_SP);
+    Circuit& circuit = *netlist.circuit;
+    assert(netlist.title == "RC Low-pass Filter");
+    assert(circuit.getName() == netlist.title);
+    assert(netlist.simulation.type == "transient");
+    assert(near(netlist.simulation.timestep, 1e-6) && near(netlist.simulation.duration, 10e-3));
+
+    assert(circuit.getComponentCount() == 3 && circuit.getNodeCount() == 3);
+    assert(resistance(circuit, "R1") == 1e3);
+    auto source = std::static_pointer_cast<VoltageSource>(circuit.getComponent("V1"));
+    assert(source->getWaveform().getType() == WaveformType::Sine);
+    assert(source->getNodes()[1] == circuit.getNode("0").get());
+    assert(circuit.getComponent("C1")->getNodes()[0] == circuit.getNode("out").get());
+
+    circuit.simulate(1e-4, netlist.simulation.timestep);
+    std::cout << "✓ RC filter example test passed" << std::endl;
+}
+
+void test_numeric_node_names() {
+    // Node names that read as numbers keep their spelling; only 0 is ground
+    SpiceNetlist netlist = parseSpiceNetlist("Supplies\n"
+                                             "V1 5V 0 5\n"
+                                             "R1 5V 3V3 1k\n"
+                                             "R2 3V3 1e3 2k\n"
+                                             "C1 1e3 00 1n\n");
+    Circuit& circuit = *netlist.circuit;
+    assert(circuit.getNodeCount() == 5);
+    assert(circuit.getComponent("V1")->getNodes()[0] == circuit.getNode("5V").get());
+    const auto& r1 = circuit.getComponent("R1")->getNodes();
+    assert(r1[0] == circuit.getNode("5V").get() && r1[1] == circuit.getNode("3V3").get());
+    assert(resistance(circuit, "R1") == 1e3);
+    assert(circuit.getComponent("R2")->getNodes()[1] == circuit.getNode("1e3").get());
+    assert(circuit.getComponent("C1")->getNodes()[1] == circuit.getNode("00").get());
+    std::cout << "✓ Numeric node name test passed" << std::endl;
+}
+
+void test_subcircuits_and_includes() {
+    auto dir = std::filesystem::temp_directory_path() / "ic_sim_spice_test";
+    writeFile(dir / "lib" / "cells.inc",
+              "* divider cells\n"
+              ".subckt half in out gnd params: r=1k\n"
+              "R1 in mid {r}\n"
+              "R2 mid out {2*r}\n"
+              "C1 out GND 1p ; GND is ground, not the pin\n"
+              ".ends\n"
+              ".SUBCKT pair a b\n"
+              "Xleft a m 0 HALF r=500\n"
+              "Xright m b 0 half\n"
+              ".ends pair\n");
+    writeFile(dir / "top.sp",
+              "Hierarchy test\n"
+              ".include 'lib/cells.inc'\n"
+              ".PARAM scale=2 rbase={scale*1k}\n"
+              "X1 vin vout 0 half R={rbase}\n"
+              "X2 vout\n"
+              "+ vend pair\n"
+              "V1 vin 0 DC 1.2 AC 1\n"
+              "I1 vend 0 PULSE(0 1m 1n 1n 1n 5n 20n)\n"
+              ".end\n"
+              "R99 never parsed 1\n");
+
+    SpiceNetlist netlist = loadSpiceNetlist((dir / "top.sp").string());
+    Circuit& circuit = *netlist.circuit;
+    assert(netlist.subcircuit_instances == 4);
+    assert(circuit.findComponent("R99") == kInvalidId);
+
+    // Instance values override defaults and are evaluated in the caller's scope
+    assert(resistance(circuit, "X1.R1") == 2e3);
+    assert(resistance(circuit, "X1.R2") == 4e3);
+    assert(resistance(circuit, "X2.Xleft.R1") == 500.0);
+    assert(resistance(circuit, "X2.Xright.R2") == 2e3);
+
+    // Pins map to the caller's nodes, internal nodes are prefixed, ground is shared
+    const auto& r1 = circuit.getComponent("X1.R1")->getNodes();
+    assert(r1[0] == circuit.getNode("vin").get() && r1[1] == circuit.getNode("X1.mid").get());
+    assert(circuit.getComponent("X2.Xleft.R2")->getNodes()[1] == circuit.getNode("X2.m").get());
+    assert(circuit.getComponent("X2.Xright.C1")->getNodes()[1] == circuit.getNode("0").get());
+    assert(circuit.getComponent("X2.Xright.R2")->getNodes()[1] == circuit.getNode("vend").get());
+
+    auto v1 = std::static_pointer_cast<VoltageSource>(circuit.getComponent("V1"));
+    assert(v1->getWaveform().getType() == WaveformType::DC && v1->getWaveform().valueAt(0.0) == 1.2);
+    auto i1 = std::static_pointer_cast<CurrentSource>(circuit.getComponent("I1"));
+    assert(i1->getWaveform().getType() == WaveformType::Pulse);
+    assert(near(i1->getWaveform().valueAt(4e-9), 1e-3));
+
+    std::filesystem::remove_all(dir);
+    std::cout << "✓ Subcircuit and include test passed" << std::endl;
+}
+
+void test_parallel_matches_serial() {
+    std::ostringstream deck;
+    deck << "Generated ladder\n.param unit=10\n";
+    for (int i = 0; i < 3000; ++i) {
+        if (i % 7 == 0) {
+            deck << "* comment " << i << "\n";
+        }
+        if (i % 5 == 0) {
+            deck << "R" << i << " n" << i << "\n+ n" << i + 1 << "\n* between\n+ {unit*" << i + 1 << "}\n";
+        } else if (i % 5 == 1) {
+            deck << "C" << i << " n" << i << " n" << i + 1 << " " << i + 1 << "f\n";
+        } else {
+            deck << "R" << i << " n" << i << " n" << i + 1 << " " << i + 1 << "k $ trailing\n";
+        }
+    }
+    std::string text = deck.str();
+
+    SpiceOptions serial;
+    serial.threads = 1;
+    SpiceNetlist expected = parseSpiceNetlist(text, serial);
+
+    SpiceOptions parallel;
+    parallel.threads = 4;
+    parallel.chunk_size = 97;  // many chunks, boundaries inside continuation runs
+    SpiceNetlist actual = parseSpiceNetlist(text, parallel);
+
+    Circuit& a = *expected.circuit;
+    Circuit& b = *actual.circuit;
+    assert(a.getComponentCount() == 3000 && b.getComponentCount() == 3000);
+    assert(a.getNodeCount() == b.getNodeCount() && expected.cards == actual.cards);
+    for (ComponentId id = 0; id < a.getComponentCount(); ++id) {
+        assert(a.getComponent(id)->getId() == b.getComponent(id)->getId());
+        assert(a.getComponent(id)->getNodes()[1]->getId() == b.getComponent(id)->getNodes()[1]->getId());
+    }
+    for (NodeId id = 0; id < a.getNodeCount(); ++id) {
+        assert(a.getNode(id)->getId() == b.getNode(id)->getId());
+    }
+    assert(resistance(b, "R10") == 110.0);
+    assert(resistance(b, "R12") == 13e3);
+    std::cout << "✓ Parallel parsing test passed" << std::endl;
+}
+
+void test_plugin_elements() {
+    assert(errorLine("t\nL1 a b 1u\n") == 2);  // no plugin loaded yet
+    assert(PluginManager::getInstance().loadPlugin(EXAMPLE_PLUGIN_PATH));
+
+    SpiceNetlist netlist = parseSpiceNetlist("Plugins\n"
+                                             ".model dfast D(forward_voltage=0.3)\n"
+                                             "L1 a b 10u\n"
+                                             "D1 b 0 DFAST\n");
+    Circuit& circuit = *netlist.circuit;
+    assert(circuit.getComponent("L1")->getType() == "Inductor");
+    assert(circuit.getComponent("D1")->getType() == "Diode");
+    assert(circuit.getComponent("D1")->getNodes()[0] == circuit.getNode("b").get());
+
+    PluginManager::getInstance().unloadAllPlugins();
+    std::cout << "✓ Plugin element test passed" << std::endl;
+}
+
+void test_errors() {
+    assert(errorLine("t\nR1 a b 1k\nX1 a b missing\n") == 3);
+    assert(errorLine("t\nR1 a b {undefined*2}\n") == 2);
+    assert(errorLine("t\n* comment\nM1 d g s b nmos\n") == 3);
+    assert(errorLine("t\n.subckt open a b\nR1 a b 1\n") == 2);
+    assert(errorLine("t\n.subckt s a b\n.ends\nX1 a s\n") == 4);
+    assert(errorLine("t\nV1 a 0 SIN(0 1)\n") == 2);
+    assert(errorLine("t\nR1 a b 1k\nC1 a 0 1n\nR1 b 0 2k\n") == 4);
+    assert(errorLine("t\nR1 a b 1k\n.control\nrun\nplot v(a)\n.endc\n") == 0);
+
+    bool threw = false;
+    try {
+        loadSpiceNetlist("/nonexistent/deck.sp");
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+    std::cout << "✓ Error reporting test passed" << std::endl;
+}
+
+int main() {
+    std::cout << "Running SPICE Netlist Tests..." << std::endl;
+
+    try {
+        test_numbers();
+        test_rc_filter_example();
+        test_numeric_node_names();
+        test_subcircuits_and_includes();
+        test_parallel_matches_serial();
+        test_plugin_elements();
+        test_errors();
+
+        std::cout << "\\n✅ All SPICE netlist tests passed!" << std::endl;
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "❌ Test failed: " << e.what() << std::endl;
+        return 1;
+    } catch (...) {
+        std::cerr << "❌ Unknown test failure" << std::endl;
+        return 1;
+    }
+}
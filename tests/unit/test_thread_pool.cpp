@@ -0,0 +1,308 @@
+#include "core/thread_pool.h"
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+using namespace ic_sim;
+
+namespace {
+
+ThreadPoolOptions threads(size_t count) {
+    ThreadPoolOptions options;
+    options.threads = count;
+    return options;
+}
+
+// Spins until count reaches target; false after a generous timeout
+bool waitFor(const std::atomic<size_t>& count, size_t target) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (count.load() < target) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::yield();
+    }
+    return true;
+}
+
+} // namespace
+
+void test_parallel_for() {
+    for (size_t count : {1, 2, 4}) {
+        ThreadPool pool(threads(count));
+        assert(pool.getThreadCount() == count && pool.getWorkerCount() == count - 1);
+        for (size_t grain : {1, 7, 1000, 5000}) {
+            std::vector<std::atomic<int>> hits(3001);
+            std::atomic<size_t> calls{0};
+            parallelFor(1, 3001, grain,
+                        [&](size_t first, size_t last) {
+                            assert(first < last && last - first <= grain);
+                            for (size_t i = first; i < last; ++i) {
+                                hits[i].fetch_add(1);
+                            }
+                            calls.fetch_add(1);
+                        },
+                        pool);
+            assert(hits[0] == 0);
+            for (size_t i = 1; i < hits.size(); ++i) {
+                assert(hits[i] == 1);
+            }
+            assert(calls >= (3000 + grain - 1) / grain);
+        }
+        parallelFor(5, 5, 1, [](size_t, size_t) { assert(false); }, pool);
+    }
+    std::cout << "✓ Parallel for test passed" << std::endl;
+}
+
+void test_parallel_for_static() {
+    ThreadPool pool(threads(4));
+    const size_t workers = pool.getWorkerCount();
+
+    // Same slices on the same workers every time, never on the caller
+    std::vector<std::thread::id> owner(workers);
+    for (int round = 0; round < 3; ++round) {
+        std::mutex mutex;
+        std::vector<std::pair<size_t, size_t>> slices;
+        std::vector<std::thread::id> ran;
+        parallelForStatic(10, 1010,
+                          [&](size_t first, size_t last) {
+                              std::lock_guard<std::mutex> lock(mutex);
+                              slices.emplace_back(first, last);
+                              ran.push_back(std::this_thread::get_id());
+                          },
+                          pool);
+        assert(slices.size() == workers);
+        for (size_t k = 0; k < workers; ++k) {
+            size_t i = 0;
+            while (i < workers && slices[k].first != 10 + 1000 * i / workers) {
+                ++i;
+            }
+            assert(i < workers);
+            assert(slices[k].first == 10 + 1000 * i / workers && slices[k].second == 10 + 1000 * (i + 1) / workers);
+            assert(ran[k] != std::this_thread::get_id());
+            if (round == 0) {
+                owner[i] = ran[k];
+            }
+            assert(owner[i] == ran[k]);
+        }
+    }
+
+    // Called from inside tasks, including by the workers the slices go to
+    std::atomic<size_t> covered{0};
+    parallelFor(0, 8, 1,
+                [&](size_t, size_t) {
+                    parallelForStatic(0, 100, [&](size_t first, size_t last) { covered.fetch_add(last - first); },
+                                      pool);
+                },
+                pool);
+    assert(covered == 800);
+
+    bool threw = false;
+    try {
+        parallelForStatic(0, 3,
+                          [](size_t first, size_t) {
+                              if (first == 0) {
+                                  throw std::runtime_error("slice");
+                              }
+                          },
+                          pool);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+
+    // Without workers the caller takes the whole range at once
+    ThreadPool single(threads(1));
+    size_t calls = 0;
+    parallelForStatic(0, 50, [&](size_t first, size_t last) { calls += (first == 0 && last == 50); }, single);
+    assert(calls == 1);
+    std::cout << "✓ Static parallel for test passed" << std::endl;
+}
+
+void test_nested_groups() {
+    // Every level waits for the next from inside a task; with no workers the
+    // calling thread runs all of it
+    for (size_t count : {1, 3}) {
+        ThreadPool pool(threads(count));
+        std::atomic<size_t> leaves{0};
+        parallelFor(0, 8, 1,
+                    [&](size_t, size_t) {
+                        TaskGroup group(pool);
+                        for (int task = 0; task < 4; ++task) {
+                            group.run([&]() {
+                                parallelFor(0, 100, 10, [&](size_t first, size_t last) { leaves += last - first; },
+                                            pool);
+                            });
+                        }
+                        group.wait();
+                    },
+                    pool);
+        assert(leaves == 8 * 4 * 100);
+    }
+    std::cout << "✓ Nested groups test passed" << std::endl;
+}
+
+void test_concurrency_and_stealing() {
+    ThreadPool pool(threads(4));
+
+    // Four tasks that only finish once all four run at the same time: three
+    // workers plus the waiting caller
+    std::atomic<size_t> running{0};
+    std::atomic<bool> all_met{true};
+    TaskGroup group(pool);
+    for (int task = 0; task < 4; ++task) {
+        group.run([&]() {
+            running.fetch_add(1);
+            if (!waitFor(running, 4)) {
+                all_met = false;
+            }
+        });
+    }
+    group.wait();
+    assert(all_met);
+
+    // Tasks spawned on one worker land in its deque; while it sleeps the
+    // other workers steal them
+    std::mutex mutex;
+    std::set<std::thread::id> runners;
+    TaskGroup outer(pool);
+    outer.run([&]() {
+        TaskGroup inner(pool);
+        for (int task = 0; task < 64; ++task) {
+            inner.run([&]() {
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+                std::lock_guard<std::mutex> lock(mutex);
+                runners.insert(std::this_thread::get_id());
+            });
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        inner.wait();
+    });
+    outer.wait();
+    assert(runners.size() >= 2);
+    std::cout << "✓ Concurrency and stealing test passed" << std::endl;
+}
+
+void test_exceptions() {
+    ThreadPool pool(threads(3));
+    TaskGroup group(pool);
+    std::atomic<int> finished{0};
+    for (int task = 0; task < 10; ++task) {
+        group.run([&, task]() {
+            if (task == 3) {
+                throw std::runtime_error("task failed");
+            }
+            ++finished;
+        });
+    }
+    bool threw = false;
+    try {
+        group.wait();
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw && finished == 9);
+    // The error is reported once; the group can be reused
+    group.run([&]() { ++finished; });
+    group.wait();
+    assert(finished == 10);
+
+    threw = false;
+    try {
+        parallelFor(0, 100, 1,
+                    [](size_t first, size_t) {
+                        if (first == 77) {
+                            throw std::out_of_range("77");
+                        }
+                    },
+                    pool);
+    } catch (const std::out_of_range&) {
+        threw = true;
+    }
+    assert(threw);
+    std::cout << "✓ Exceptions test passed" << std::endl;
+}
+
+void test_configuration() {
+    bool threw = false;
+    ThreadPoolOptions options;
+    options.threads = 2;
+    options.cpus = {1u << 30};
+    try {
+        ThreadPool pool(options);
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+#ifdef __linux__
+    assert(threw);
+
+    // Pin both workers to the CPU this thread is on, which is allowed
+    int cpu = sched_getcpu();
+    assert(cpu >= 0);
+    options.threads = 3;
+    options.cpus = {static_cast<unsigned>(cpu)};
+    ThreadPool pinned(options);
+    assert(pinned.getPinnedCount() == 2);
+    std::atomic<size_t> started{0};
+    std::atomic<bool> placed{true};
+    TaskGroup group(pinned);
+    for (int task = 0; task < 3; ++task) {
+        group.run([&]() {
+            ++started;
+            // Two tasks sit on the workers until all three have started
+            waitFor(started, 3);
+            cpu_set_t set;
+            if (sched_getaffinity(0, sizeof(set), &set) == 0 && CPU_COUNT(&set) == 1 && !CPU_ISSET(cpu, &set)) {
+                placed = false;
+            }
+        });
+    }
+    group.wait();
+    assert(placed);
+#endif
+
+    // The shared pool takes its options before first use only
+    ThreadPool::configureShared(threads(2));
+    assert(ThreadPool::shared().getThreadCount() == 2);
+    threw = false;
+    try {
+        ThreadPool::configureShared(threads(4));
+    } catch (const std::logic_error&) {
+        threw = true;
+    }
+    assert(threw && &ThreadPool::shared() == &ThreadPool::shared());
+    std::cout << "✓ Configuration test passed" << std::endl;
+}
+
+int main() {
+    std::cout << "Running Thread Pool Tests..." << std::endl;
+
+    try {
+        test_parallel_for();
+        test_parallel_for_static();
+        test_nested_groups();
+        test_concurrency_and_stealing();
+        test_exceptions();
+        test_configuration();
+
+        std::cout << "\\n✅ All thread pool tests passed!" << std::endl;
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "❌ Test failed: " << e.what() << std::endl;
+        return 1;
+    } catch (...) {
+        std::cerr << "❌ Unknown test failure" << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,206 @@
+#include "circuit_fixture.h"
+#include "core/circuit.h"
+#include "core/topology.h"
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace ic_sim;
+
+namespace {
+
+// VIN -R1- N1 -R2- N2, with C1 and C2 from N1/N2 to GND, plus an unconnected node
+std::unique_ptr<Circuit> makeLadder() {
+    auto circuit = test::makeCircuit("Ladder", {"VIN", "N1", "N2", "GND", "ISOLATED"});
+    test::wire(*circuit, circuit->createComponent<Resistor>("R1", 1000.0), "VIN", "N1");
+    test::wire(*circuit, circuit->createComponent<Resistor>("R2", 1000.0), "N1", "N2");
+    test::wire(*circuit, circuit->createComponent<Capacitor>("C1", 1e-6), "N1", "GND");
+    test::wire(*circuit, circuit->createComponent<Capacitor>("C2", 1e-6), "N2", "GND");
+    return circuit;
+}
+
+std::vector<uint32_t> toVector(Topology::Range range) {
+    return std::vector<uint32_t>(range.begin(), range.end());
+}
+
+} // namespace
+
+void test_csr_adjacency() {
+    auto circuit = makeLadder();
+    const Topology& topology = circuit->compile();
+
+    assert(topology.getNodeCount() == 5);
+    assert(topology.getDeviceCount() == 4);
+    assert(topology.getTerminalCount() == 8);
+
+    NodeId n1 = circuit->findNode("N1");
+    ComponentId r2 = circuit->findComponent("R2");
+    assert((toVector(topology.nodeDevices(n1)) ==
+            std::vector<uint32_t>{circuit->findComponent("R1"), r2, circuit->findComponent("C1")}));
+    assert((toVector(topology.deviceNodes(r2)) == std::vector<uint32_t>{n1, circuit->findNode("N2")}));
+    assert(topology.nodeDevices(circuit->findNode("ISOLATED")).size() == 0);
+
+    std::cout << "✓ CSR adjacency test passed" << std::endl;
+}
+
+void test_matrix_pattern() {
+    auto circuit = makeLadder();
+    const Topology& topology = circuit->compile();
+
+    // N1 couples to itself, VIN, N2 and GND
+    std::vector<uint32_t> row = toVector(topology.patternRow(circuit->findNode("N1")));
+    assert((row == std::vector<uint32_t>{0, 1, 2, 3}));
+    // Diagonal-only row for the isolated node
+    assert((toVector(topology.patternRow(4)) == std::vector<uint32_t>{4}));
+    assert(topology.getPatternNonZeros() == 2 + 4 + 3 + 3 + 1);
+
+    std::cout << "✓ Matrix pattern test passed" << std::endl;
+}
+
+void test_connectivity_checks() {
+    auto circuit = makeLadder();
+    const Topology& topology = circuit->compile();
+
+    assert(topology.getIslandCount() == 2);
+    const auto& islands = topology.getIslands();
+    assert(islands[circuit->findNode("VIN")] == islands[circuit->findNode("GND")]);
+    assert(islands[circuit->findNode("ISOLATED")] != islands[circuit->findNode("GND")]);
+
+    // VIN only touches R1
+    assert((topology.getDanglingNodes() == std::vector<uint32_t>{circuit->findNode("VIN"), 4}));
+
+    std::vector<uint32_t> parts = topology.partition(2);
+    size_t first = 0;
+    for (uint32_t part : parts) {
+        assert(part < 2);
+        first += (part == 0);
+    }
+    assert(first == 2 || first == 3);
+
+    std::cout << "✓ Connectivity checks test passed" << std::endl;
+}
+
+void test_foreign_node_rejected() {
+    Circuit circuit("Foreign");
+    circuit.addNode(std::make_shared<Node>("A"));
+    auto outside = std::make_shared<Node>("B");
+
+    auto resistor = std::make_shared<Resistor>(10.0);
+    resistor->setId("R1");
+    resistor->connect(circuit.getNode("A"));
+    resistor->connect(outside);
+    circuit.addComponent(resistor);
+
+    bool threw = false;
+    try {
+        circuit.compile();
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+    assert(circuit.getTopology() == nullptr);
+
+    std::cout << "✓ Foreign node test passed" << std::endl;
+}
+
+void test_fill_reducing_ordering() {
+    // A chain whose nodes were created in scrambled order: the natural order has
+    // a wide profile, the computed ordering should recover the chain
+    Circuit circuit("Chain");
+    const uint32_t count = 50;
+    for (uint32_t i = 0; i < count; ++i) {
+        circuit.createNode("n" + std::to_string(i));
+    }
+    for (uint32_t i = 0; i + 1 < count; ++i) {
+        auto resistor = circuit.createComponent<Resistor>("R" + std::to_string(i), 1.0);
+        circuit.connect(resistor->getHandle(), (i * 7) % count);
+        circuit.connect(resistor->getHandle(), ((i + 1) * 7) % count);
+    }
+    circuit.createNode("floating");
+    const Topology& topology = circuit.compile();
+
+    const auto& ordering = topology.getOrdering();
+    assert(ordering.size() == count + 1);
+    std::vector<uint32_t> position(ordering.size(), count + 1);
+    for (uint32_t i = 0; i < ordering.size(); ++i) {
+        assert(position[ordering[i]] == count + 1);  // a permutation
+        position[ordering[i]] = i;
+    }
+    size_t natural = 0;
+    size_t ordered = 0;
+    for (uint32_t node = 0; node < topology.getNodeCount(); ++node) {
+        for (uint32_t column : topology.patternRow(node)) {
+            natural = std::max<size_t>(natural, node > column ? node - column : column - node);
+            ordered = std::max<size_t>(ordered, position[node] > position[column] ? position[node] - position[column]
+                                                                                  : position[column] - position[node]);
+        }
+    }
+    assert(natural > 20 && ordered == 1);
+    std::cout << "✓ Fill-reducing ordering test passed" << std::endl;
+}
+
+void test_from_arrays() {
+    auto circuit = makeLadder();
+    const Topology& built = circuit->compile();
+
+    Topology::Arrays arrays;
+    arrays.node_offsets = built.getNodeOffsets();
+    arrays.node_devices = built.getNodeDevices();
+    arrays.device_offsets = built.getDeviceOffsets();
+    arrays.device_nodes = built.getDeviceNodes();
+    arrays.pattern_offsets = built.getPatternOffsets();
+    arrays.pattern_columns = built.getPatternColumns();
+    arrays.islands = built.getIslands();
+    arrays.ordering = built.getOrdering();
+    arrays.island_count = built.getIslandCount();
+
+    auto restored = Topology::fromArrays(arrays);
+    assert(toVector(restored->patternRow(1)) == toVector(built.patternRow(1)));
+    assert(restored->getOrdering() == built.getOrdering());
+    circuit->setTopology(restored);
+    assert(circuit->getTopology() == restored);
+
+    // Arrays of a different circuit are rejected
+    bool threw = false;
+    try {
+        makeLadder()->setTopology(nullptr);
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    assert(threw);
+    arrays.device_nodes[0] = 99;
+    threw = false;
+    try {
+        Topology::fromArrays(arrays);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+    std::cout << "✓ Topology from arrays test passed" << std::endl;
+}
+
+int main() {
+    std::cout << "Running Topology Tests..." << std::endl;
+
+    try {
+        test_csr_adjacency();
+        test_matrix_pattern();
+        test_connectivity_checks();
+        test_foreign_node_rejected();
+        test_fill_reducing_ordering();
+        test_from_arrays();
+
+        std::cout << "\\n✅ All topology tests passed!" << std::endl;
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "❌ Test failed: " << e.what() << std::endl;
+        return 1;
+    } catch (...) {
+        std::cerr << "❌ Unknown test failure" << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,246 @@
+#include "circuit_fixture.h"
+#include "core/circuit.h"
+#include "core/result_store.h"
+#include "core/sources.h"
+#include "io/async_writer.h"
+#include "io/vcd_writer.h"
+#include <algorithm>
+#include <cassert>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace ic_sim;
+
+namespace {
+
+const std::filesystem::path kDir = std::filesystem::temp_directory_path() / "ic_sim_vcd_test";
+
+std::vector<std::string> readLines(const std::string& path) {
+    std::ifstream in(path);
+    std::vector<std::string> lines;
+    std::string line;
+    while (std::getline(in, line)) {
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+// Lines after $enddefinitions
+std::vector<std::string> body(const std::vector<std::string>& lines) {
+    auto end = std::find(lines.begin(), lines.end(), "$enddefinitions $end");
+    assert(end != lines.end());
+    return std::vector<std::string>(end + 1, lines.end());
+}
+
+// Hierarchical reference ("top.X1.q") of every identifier code in the header
+std::map<std::string, std::string> declarations(const std::vector<std::string>& lines) {
+    std::map<std::string, std::string> codes;
+    std::vector<std::string> scopes;
+    for (const std::string& line : lines) {
+        std::istringstream in(line);
+        std::string keyword, kind, size, code, reference;
+        in >> keyword;
+        if (keyword == "$scope") {
+            in >> kind >> reference;
+            scopes.push_back(reference);
+        } else if (keyword == "$upscope") {
+            scopes.pop_back();
+        } else if (keyword == "$var") {
+            in >> kind >> size >> code >> reference;
+            std::string path;
+            for (const std::string& scope : scopes) {
+                path += scope + ".";
+            }
+            codes[code] = kind + " " + path + reference;
+        }
+    }
+    assert(scopes.empty());
+    return codes;
+}
+
+} // namespace
+
+void test_change_only_output() {
+    std::filesystem::create_directories(kDir);
+    std::string path = (kDir / "changes.vcd").string();
+    VcdWriterOptions options;
+    options.top_scope = "Chip";
+    options.timescale = 1e-9;
+    options.analog = {"i(*)"};
+    VcdWriter writer(path, options);
+    writer.begin({"time", "v(clk)", "v(X1.q)", "v(X1.X2.n)", "i(X1.R1)", "v(idle)"});
+
+    // clk toggles every row, X1.q once, X1.X2.n never, the current twice
+    std::vector<double> rows;
+    for (int step = 0; step < 6; ++step) {
+        rows.insert(rows.end(), {step * 1e-9, double(step % 2), step >= 3 ? 1.0 : 0.0, 1.0,
+                                 step < 4 ? 0.25 : 0.5, 0.0});
+    }
+    writer.write(rows.data(), 4, 6);
+    writer.write(rows.data() + 24, 2, 6);
+    writer.finish();
+
+    std::vector<std::string> lines = readLines(path);
+    assert(lines[1] == "$timescale 1 ns $end");
+    std::map<std::string, std::string> codes = declarations(lines);
+    assert(codes.size() == 5);
+    std::map<std::string, std::string> names;
+    for (const auto& [code, name] : codes) {
+        names[name] = code;
+    }
+    assert(names.count("wire Chip.clk") && names.count("wire Chip.X1.q") && names.count("wire Chip.X1.X2.n"));
+    assert(names.count("real Chip.X1.i(R1)") && names.count("wire Chip.idle"));
+
+    // Initial dump of everything, then one line per change only
+    std::vector<std::string> changes = body(lines);
+    std::vector<std::string> expected = {"#0", "$dumpvars"};
+    expected.insert(expected.end(), {"0" + names["wire Chip.clk"], "0" + names["wire Chip.X1.q"],
+                                     "1" + names["wire Chip.X1.X2.n"], "0" + names["wire Chip.idle"],
+                                     "r0.25 " + names["real Chip.X1.i(R1)"], "$end"});
+    expected.insert(expected.end(), {"#1", "1" + names["wire Chip.clk"], "#2", "0" + names["wire Chip.clk"]});
+    expected.insert(expected.end(), {"#3", "1" + names["wire Chip.clk"], "1" + names["wire Chip.X1.q"]});
+    expected.insert(expected.end(), {"#4", "0" + names["wire Chip.clk"], "r0.5 " + names["real Chip.X1.i(R1)"]});
+    expected.insert(expected.end(), {"#5", "1" + names["wire Chip.clk"]});
+    assert(changes == expected);
+    assert(writer.getStats().rows == 6 && writer.getStats().variables == 5);
+    assert(writer.getStats().changes == 5 + 7);
+    assert(writer.getStats().bytes == std::filesystem::file_size(path));
+    std::cout << "✓ Change-only output test passed" << std::endl;
+}
+
+void test_thresholds() {
+    std::string path = (kDir / "thresholds.vcd").string();
+    VcdWriterOptions options;
+    options.threshold = 0.5;
+    options.hysteresis = 0.2;
+    options.timescale = 1e-6;
+    VcdWriter writer(path, options);
+    writer.begin({"time", "v(a)"});
+    // Starts inside the band (x), then noise around the threshold only
+    // switches once the band is crossed
+    std::vector<double> values = {0.5, 0.45, 0.3, 0.55, 0.59, 0.61, 0.45, 0.41, 0.39};
+    for (size_t step = 0; step < values.size(); ++step) {
+        double row[2] = {step * 1e-6, values[step]};
+        writer.write(row, 1, 2);
+    }
+    // Rows that round to the same tick share one timestamp, and the last
+    // row's time closes the file
+    double late[4] = {9.0e-6, 0.9, 9.2e-6, 0.1};
+    writer.write(late, 2, 2);
+    double end[2] = {12e-6, 0.1};
+    writer.write(end, 1, 2);
+    writer.finish();
+
+    std::vector<std::string> expected = {"#0", "$dumpvars", "x!", "$end", "#2", "0!", "#5", "1!",
+                                         "#8", "0!",        "#9", "1!",   "0!", "#12"};
+    assert(body(readLines(path)) == expected);
+    std::cout << "✓ Threshold test passed" << std::endl;
+}
+
+void test_async_simulation() {
+    std::string path = (kDir / "run.vcd").string();
+    auto circuit = test::makeFilter("Pulse Train", Waveform::pulse(0.0, 1.0, 1e-4, 1e-6, 1e-6, 1e-4, 2e-4), 1e-9);
+
+    ResultStoreOptions store;
+    store.keep_samples = false;
+    auto results = std::make_shared<ResultStore>(store);
+    results->addProbe("v(*)");
+    VcdWriterOptions options;
+    options.top_scope = circuit->getName();
+    options.timescale = 1e-9;
+    auto vcd = std::make_shared<VcdWriter>(path, options);
+    AsyncWriterOptions async;
+    async.ring_blocks = 4;
+    async.block_bytes = 4096;
+    auto writer = std::make_shared<AsyncSampleWriter>(vcd, async);
+    results->addSink(writer);
+    circuit->setResultStore(results);
+    circuit->simulate(1e-3, 1e-6);
+
+    std::vector<std::string> lines = readLines(path);
+    std::map<std::string, std::string> codes = declarations(lines);
+    assert(codes.size() == 4);
+    std::string vin;
+    for (const auto& [code, name] : codes) {
+        assert(name.rfind("wire Pulse_Train.", 0) == 0);
+        if (name == "wire Pulse_Train.VIN") {
+            vin = code;
+        }
+    }
+    assert(!vin.empty());
+    assert(std::find_if(codes.begin(), codes.end(),
+                        [](const auto& entry) { return entry.second == "wire Pulse_Train.X1.OUT"; }) != codes.end());
+
+    // Five pulses, the last still high at the end: the initial 0 and four falls
+    size_t rises = 0;
+    size_t falls = 0;
+    for (const std::string& line : body(lines)) {
+        rises += (line == "1" + vin);
+        falls += (line == "0" + vin);
+    }
+    assert(rises == 5 && falls == 5);
+    assert(vcd->getStats().rows == writer->getStats().rows_written);
+    assert(vcd->getStats().changes < vcd->getStats().rows);
+    std::cout << "✓ Async simulation test passed" << std::endl;
+}
+
+void test_rejected_options() {
+    bool threw = false;
+    VcdWriterOptions options;
+    options.timescale = 3e-9;
+    try {
+        VcdWriter writer((kDir / "bad.vcd").string(), options);
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    assert(threw);
+
+    threw = false;
+    options = VcdWriterOptions();
+    options.digital = {"v(missing)"};
+    VcdWriter writer((kDir / "bad.vcd").string(), options);
+    try {
+        writer.begin({"time", "v(a)"});
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    assert(threw);
+
+    threw = false;
+    VcdWriter unwritable((kDir / "no_such_dir" / "x.vcd").string());
+    try {
+        unwritable.begin({"time", "v(a)"});
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+    std::filesystem::remove_all(kDir);
+    std::cout << "✓ Rejected options test passed" << std::endl;
+}
+
+int main() {
+    std::cout << "Running VCD Writer Tests..." << std::endl;
+
+    try {
+        test_change_only_output();
+        test_thresholds();
+        test_async_simulation();
+        test_rejected_options();
+
+        std::cout << "\\n✅ All VCD writer tests passed!" << std::endl;
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "❌ Test failed: " << e.what() << std::endl;
+        return 1;
+    } catch (...) {
+        std::cerr << "❌ Unknown test failure" << std::endl;
+        return 1;
+    }
+}
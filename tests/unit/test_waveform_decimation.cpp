@@ -0,0 +1,200 @@
+#include "io/waveform_decimation.h"
+#include "io/waveform_file.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace ic_sim;
+
+namespace {
+
+const std::filesystem::path kDir = std::filesystem::temp_directory_path() / "ic_sim_decimation_test";
+
+// A sine with noise and a few narrow spikes, sampled every 1 us
+void makeWaveform(size_t count, std::vector<double>& times, std::vector<double>& values) {
+    std::mt19937 random(11);
+    std::normal_distribution<double> noise(0.0, 0.05);
+    times.resize(count);
+    values.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        times[i] = double(i) * 1e-6;
+        values[i] = std::sin(double(i) * 1e-3) + noise(random);
+        if (i % 9973 == 5000) {
+            values[i] += 3.0;
+        }
+    }
+}
+
+// Reference min/max per column by brute force
+struct Extremes {
+    double min = INFINITY;
+    double max = -INFINITY;
+    uint64_t count = 0;
+};
+
+std::vector<Extremes> bruteForce(const std::vector<double>& times, const std::vector<double>& values, double t0,
+                                 double t1, size_t pixels) {
+    std::vector<Extremes> columns(pixels);
+    for (size_t i = 0; i < times.size(); ++i) {
+        if (times[i] < t0 || times[i] > t1) {
+            continue;
+        }
+        size_t p = std::min(static_cast<size_t>((times[i] - t0) * (double(pixels) / (t1 - t0))), pixels - 1);
+        columns[p].min = std::min(columns[p].min, values[i]);
+        columns[p].max = std::max(columns[p].max, values[i]);
+        ++columns[p].count;
+    }
+    return columns;
+}
+
+// Pyramid envelopes report real samples inside each column, the exact
+// window extremes and the exact sample count
+void checkEnvelope(const WaveformPyramid& pyramid, const std::vector<double>& times,
+                   const std::vector<double>& values, double t0, double t1, size_t pixels) {
+    std::vector<WaveformBucket> envelope = pyramid.envelope(t0, t1, pixels);
+    std::vector<Extremes> expected = bruteForce(times, values, t0, t1, pixels);
+    assert(envelope.size() == pixels);
+    uint64_t total = 0, expected_total = 0;
+    double lowest = INFINITY, highest = -INFINITY, expected_lowest = INFINITY, expected_highest = -INFINITY;
+    double width = (t1 - t0) / double(pixels);
+    for (size_t p = 0; p < pixels; ++p) {
+        const WaveformBucket& b = envelope[p];
+        total += b.count;
+        expected_total += expected[p].count;
+        expected_lowest = std::min(expected_lowest, expected[p].min);
+        expected_highest = std::max(expected_highest, expected[p].max);
+        if (b.count == 0) {
+            continue;
+        }
+        lowest = std::min(lowest, b.min);
+        highest = std::max(highest, b.max);
+        assert(b.min >= expected[p].min && b.max <= expected[p].max);
+        assert(b.first_time >= t0 + p * width - 1e-12 && b.last_time <= t0 + (p + 1) * width + 1e-12);
+    }
+    assert(total == expected_total);
+    assert(lowest == expected_lowest && highest == expected_highest);
+}
+
+} // namespace
+
+void test_min_max_buckets() {
+    std::vector<double> times, values;
+    makeWaveform(10000, times, values);
+    std::vector<WaveformBucket> buckets = minMaxBuckets(times.data(), values.data(), times.size(), 1e-3, 5e-3, 40);
+    std::vector<Extremes> expected = bruteForce(times, values, 1e-3, 5e-3, 40);
+    assert(buckets.size() == 40);
+    for (size_t p = 0; p < buckets.size(); ++p) {
+        assert(buckets[p].min == expected[p].min && buckets[p].max == expected[p].max);
+        assert(buckets[p].count == expected[p].count);
+        assert(values[static_cast<size_t>(std::lround(buckets[p].min_time * 1e6))] == buckets[p].min);
+    }
+    assert(buckets.front().first_time == times[1000] && buckets.front().first == values[1000]);
+
+    // Columns with no samples stay empty
+    std::vector<WaveformBucket> sparse = minMaxBuckets(times.data(), values.data(), times.size(), 0.0, 4e-6, 8);
+    assert(sparse[0].count == 1 && sparse[1].count == 0 && sparse[2].count == 1 && sparse[7].count == 1);
+    std::cout << "✓ Min/max bucket test passed" << std::endl;
+}
+
+void test_lttb() {
+    std::vector<double> times, values;
+    makeWaveform(20000, times, values);
+    std::vector<size_t> selected = lttbIndices(times.data(), values.data(), times.size(), 500);
+    assert(selected.size() == 500 && selected.front() == 0 && selected.back() == times.size() - 1);
+    assert(std::is_sorted(selected.begin(), selected.end()));
+    // The spikes are the largest triangles in their buckets
+    for (size_t spike = 5000; spike < times.size(); spike += 9973) {
+        assert(std::find(selected.begin(), selected.end(), spike) != selected.end());
+    }
+    assert(lttbIndices(times.data(), values.data(), 10, 50).size() == 10);
+    assert(lttbIndices(times.data(), values.data(), 10, 2) == std::vector<size_t>({0, 9}));
+    std::cout << "✓ LTTB test passed" << std::endl;
+}
+
+void test_pyramid_queries() {
+    std::vector<double> times, values;
+    makeWaveform(200000, times, values);
+    WaveformPyramid pyramid(times, values);
+    assert(pyramid.getSampleCount() == times.size());
+    assert(pyramid.getLevel(0).size() == times.size() / 16);
+    assert(pyramid.getLevel(pyramid.getLevelCount() - 1).size() == 1);
+    const WaveformBucket& top = pyramid.getLevel(pyramid.getLevelCount() - 1)[0];
+    assert(top.count == times.size() && top.max == *std::max_element(values.begin(), values.end()));
+    assert(pyramid.memoryBytes() < 2 * times.size() * sizeof(double) * 3 / 2);
+
+    // Whole run, zoomed in, narrower than a leaf bucket, and across level edges
+    checkEnvelope(pyramid, times, values, 0.0, times.back(), 800);
+    checkEnvelope(pyramid, times, values, 0.0123, 0.0456, 1000);
+    checkEnvelope(pyramid, times, values, 0.1, 0.1 + 40e-6, 100);
+    checkEnvelope(pyramid, times, values, 0.05000037, 0.15000011, 333);
+    assert(pyramid.envelope(1.0, 2.0, 10)[3].count == 0);
+
+    // LTTB from the pyramid keeps the spikes inside the window
+    std::vector<double> t, v;
+    pyramid.lttb(0.0, times.back(), 1000, t, v);
+    assert(t.size() <= 1000 && t.size() >= 900);
+    assert(std::is_sorted(t.begin(), t.end()));
+    for (size_t spike = 5000; spike < times.size(); spike += 9973) {
+        assert(std::find(t.begin(), t.end(), times[spike]) != t.end());
+    }
+    pyramid.lttb(times[100000], times[100040], 1000, t, v);
+    assert(t.size() == 41 && t.front() == times[100000]);
+    std::cout << "✓ Pyramid query test passed" << std::endl;
+}
+
+void test_file_backed_pyramid() {
+    std::vector<double> times, values;
+    makeWaveform(50000, times, values);
+    std::filesystem::create_directories(kDir);
+    std::string path = (kDir / "decimation.icwave").string();
+    WaveformWriterOptions options;
+    options.chunk_samples = 1000;
+    WaveformFileWriter writer(path, options);
+    writer.begin({"time", "v(x)"});
+    for (size_t i = 0; i < times.size(); ++i) {
+        double row[2] = {times[i], values[i]};
+        writer.write(row, 1, 2);
+    }
+    writer.finish();
+
+    auto reader = std::make_shared<const WaveformFileReader>(path);
+    WaveformPyramid from_file(reader, 1);
+    WaveformPyramid from_arrays(times, values);
+    assert(from_file.getLevelCount() == from_arrays.getLevelCount());
+    for (auto window : {std::make_pair(0.0, 0.05), std::make_pair(0.0101, 0.0102), std::make_pair(0.02, 0.0200051)}) {
+        std::vector<WaveformBucket> a = from_file.envelope(window.first, window.second, 200);
+        std::vector<WaveformBucket> b = from_arrays.envelope(window.first, window.second, 200);
+        for (size_t p = 0; p < a.size(); ++p) {
+            assert(a[p].count == b[p].count && a[p].min == b[p].min && a[p].max == b[p].max);
+        }
+    }
+    checkEnvelope(from_file, times, values, 0.0101, 0.0102, 37);
+    std::filesystem::remove_all(kDir);
+    std::cout << "✓ File-backed pyramid test passed" << std::endl;
+}
+
+int main() {
+    std::cout << "Running Waveform Decimation Tests..." << std::endl;
+
+    try {
+        test_min_max_buckets();
+        test_lttb();
+        test_pyramid_queries();
+        test_file_backed_pyramid();
+
+        std::cout << "\\n✅ All waveform decimation tests passed!" << std::endl;
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "❌ Test failed: " << e.what() << std::endl;
+        return 1;
+    } catch (...) {
+        std::cerr << "❌ Unknown test failure" << std::endl;
+        return 1;
+    }
+}
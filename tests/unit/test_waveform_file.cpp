@@ -0,0 +1,350 @@
+#include "circuit_fixture.h"
+#include "core/circuit.h"
+#include "core/result_store.h"
+#include "core/sources.h"
+#include "io/async_writer.h"
+#include "io/waveform_file.h"
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace ic_sim;
+
+namespace {
+
+const std::filesystem::path kDir = std::filesystem::temp_directory_path() / "ic_sim_waveform_test";
+
+std::string tempFile(const std::string& name) {
+    std::filesystem::create_directories(kDir);
+    return (kDir / name).string();
+}
+
+bool sameBits(double a, double b) {
+    return std::memcmp(&a, &b, sizeof(a)) == 0;
+}
+
+std::vector<double> roundTrip(const std::vector<double>& values, WaveformCodec* codec = nullptr) {
+    std::vector<uint64_t> words;
+    WaveformCodec used = encodeWaveform(values.data(), values.size(), words);
+    if (codec) {
+        *codec = used;
+    }
+    WaveformDecoder decoder(words.data(), words.size(), values.size(), used);
+    std::vector<double> decoded;
+    double value;
+    while (decoder.next(value)) {
+        decoded.push_back(value);
+    }
+    return decoded;
+}
+
+bool threwWaveformError(const std::function<void()>& action) {
+    try {
+        action();
+    } catch (const WaveformFileError&) {
+        return true;
+    }
+    return false;
+}
+
+} // namespace
+
+void test_codecs_are_lossless() {
+    const double inf = std::numeric_limits<double>::infinity();
+    std::vector<std::vector<double>> cases = {
+        {1.0},
+        {0.0, -0.0, 0.0, 5e-324, -5e-324, inf, -inf, 1e308, -1e308},
+        {std::numeric_limits<double>::quiet_NaN(), 1.0, std::numeric_limits<double>::quiet_NaN()},
+    };
+    std::vector<double> time, smooth, noise;
+    std::mt19937_64 random(7);
+    for (int i = 0; i < 5000; ++i) {
+        time.push_back(i * 1e-9);
+        smooth.push_back(std::sin(i * 1e-3) * 1.8);
+        double r;
+        uint64_t bits = random();
+        std::memcpy(&r, &bits, sizeof(r));
+        noise.push_back(r);
+    }
+    cases.push_back(time);
+    cases.push_back(smooth);
+    cases.push_back(noise);
+
+    for (const std::vector<double>& values : cases) {
+        std::vector<double> decoded = roundTrip(values);
+        assert(decoded.size() == values.size());
+        for (size_t i = 0; i < values.size(); ++i) {
+            assert(sameBits(decoded[i], values[i]));
+        }
+    }
+
+    // Sampled time goes to delta-of-delta and shrinks to about a bit a sample;
+    // a constant is one bit a sample either way
+    WaveformCodec codec;
+    roundTrip(time, &codec);
+    assert(codec == WaveformCodec::DeltaOfDelta);
+    std::vector<uint64_t> words;
+    encodeWaveform(time.data(), time.size(), words);
+    assert(words.size() * 64 < time.size() * 4);
+    words.clear();
+    std::vector<double> constant(4096, 3.3);
+    encodeWaveform(constant.data(), constant.size(), words);
+    assert(words.size() <= 65);
+    std::cout << "✓ Codec round-trip test passed" << std::endl;
+}
+
+void test_mantissa_rounding() {
+    std::vector<double> values;
+    for (int i = 0; i < 4096; ++i) {
+        values.push_back(std::exp(-i * 1e-3) * std::cos(i * 2e-2));
+    }
+    std::vector<uint64_t> lossless, lossy;
+    encodeWaveform(values.data(), values.size(), lossless);
+    WaveformCodec codec = encodeWaveform(values.data(), values.size(), lossy, 20);
+    assert(lossy.size() * 2 < lossless.size());
+
+    WaveformDecoder decoder(lossy.data(), lossy.size(), values.size(), codec);
+    std::vector<double> decoded(values.size());
+    decoder.decode(decoded.data());
+    for (size_t i = 0; i < values.size(); ++i) {
+        assert(std::abs(decoded[i] - values[i]) <= std::abs(values[i]) * std::ldexp(1.0, -21));
+    }
+    std::cout << "✓ Mantissa rounding test passed" << std::endl;
+}
+
+void test_file_round_trip_and_index() {
+    std::string path = tempFile("round_trip.icwave");
+    WaveformWriterOptions options;
+    options.chunk_samples = 100;
+    WaveformFileWriter writer(path, options);
+    writer.begin({"time", "v(a)", "v(b)"});
+    std::vector<double> rows;
+    for (int i = 0; i < 1050; ++i) {
+        double row[3] = {i * 1e-6, std::sin(i * 0.01), i % 7 == 0 ? 1.0 : 0.0};
+        rows.insert(rows.end(), row, row + 3);
+        if (i % 13 == 12) {  // uneven writes straddle the chunks
+            writer.write(rows.data(), rows.size() / 3, 3);
+            rows.clear();
+        }
+    }
+    writer.write(rows.data(), rows.size() / 3, 3);
+    writer.finish();
+    const WaveformWriterStats& stats = writer.getStats();
+    assert(stats.rows == 1050 && stats.chunks == 11);
+    assert(stats.file_bytes == std::filesystem::file_size(path));
+    assert(stats.compressionRatio() > 1.0);
+
+    WaveformFileReader reader(path);
+    assert(reader.isComplete());
+    assert(reader.getColumns() == std::vector<std::string>({"time", "v(a)", "v(b)"}));
+    assert(reader.getSampleCount() == 1050 && reader.getChunkCount() == 11);
+    assert(reader.findColumn("v(b)") == 2 && reader.findColumn("v(c)") == WaveformFileReader::kNoColumn);
+    const WaveformChunk& last = reader.getChunk(10);
+    assert(last.first_row == 1000 && last.rows == 50);
+    assert(last.first_time == 1000 * 1e-6 && last.last_time == 1049 * 1e-6);
+
+    // Random access to one block, and whole columns
+    std::vector<double> values;
+    reader.readChunk(4, 1, values);
+    assert(values.size() == 100 && values[0] == std::sin(400 * 0.01));
+    std::vector<double> b = reader.readColumn(2);
+    for (int i = 0; i < 1050; ++i) {
+        assert(b[i] == (i % 7 == 0 ? 1.0 : 0.0));
+    }
+
+    // Streaming decoder
+    WaveformStream stream(reader, 1);
+    double t, v;
+    size_t n = 0;
+    while (stream.next(t, v)) {
+        assert(t == n * 1e-6 && v == std::sin(n * 0.01));
+        ++n;
+    }
+    assert(n == 1050);
+    std::cout << "✓ File round-trip test passed" << std::endl;
+}
+
+void test_time_queries() {
+    std::string path = tempFile("queries.icwave");
+    WaveformWriterOptions options;
+    options.chunk_samples = 100;
+    WaveformFileWriter writer(path, options);
+    writer.begin({"time", "ramp", "sine"});
+    for (int i = 0; i < 1050; ++i) {
+        double t = i * 1e-6;
+        double row[3] = {t, 2.0 * i, std::sin(i * 0.01)};
+        writer.write(row, 1, 3);
+    }
+    writer.finish();
+    const WaveformFileReader reader(path);
+    assert(reader.getStartTime() == 0.0 && reader.getEndTime() == 1049 * 1e-6);
+
+    // Chunk lookup by time
+    assert(reader.findChunk(-1.0) == 0 && reader.findChunk(99 * 1e-6) == 0);
+    assert(reader.findChunk(99.5e-6) == 1 && reader.findChunk(250e-6) == 2);
+    assert(reader.findChunk(1.0) == reader.getChunkCount());
+
+    // Range queries include both ends and cross chunk boundaries
+    std::vector<double> times, values;
+    reader.readRange(2, 123 * 1e-6, 456 * 1e-6, times, values);
+    assert(times.size() == 334 && values.size() == 334);
+    for (size_t k = 0; k < times.size(); ++k) {
+        assert(times[k] == (123 + k) * 1e-6 && values[k] == std::sin((123 + k) * 0.01));
+    }
+    reader.readRange(1, 2e-3, 3e-3, times, values);
+    assert(times.empty() && values.empty());
+    reader.readRange(1, 5e-6, 4e-6, times, values);
+    assert(times.empty());
+
+    // Interpolation: exact at samples, linear between them and across the gap
+    // between two chunks, clamped outside the run
+    assert(reader.valueAt(2, 500 * 1e-6) == std::sin(500 * 0.01));
+    assert(std::abs(reader.valueAt(1, 10.5e-6) - 21.0) < 1e-9);
+    assert(std::abs(reader.valueAt(1, 99.25e-6) - 198.5) < 1e-9);
+    assert(reader.valueAt(1, -1.0) == 0.0 && reader.valueAt(1, 1.0) == 2098.0);
+    std::vector<double> grid, sampled(2000);
+    for (int k = 0; k < 2000; ++k) {
+        grid.push_back(-1e-5 + k * 0.53e-6);
+    }
+    reader.sample(1, grid.data(), grid.size(), sampled.data());
+    for (size_t k = 0; k < grid.size(); ++k) {
+        double expected = std::min(std::max(grid[k], 0.0), 1049e-6) * 2e6;
+        assert(std::abs(sampled[k] - expected) < 1e-6 && sampled[k] == reader.valueAt(1, grid[k]));
+    }
+    double backwards[2] = {2e-6, 1e-6};
+    bool threw = false;
+    try {
+        reader.sample(1, backwards, 2, sampled.data());
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    assert(threw);
+
+    // Readers share the mapping and may be used from several threads
+    std::vector<std::thread> threads;
+    std::vector<size_t> counts(4);
+    for (size_t k = 0; k < counts.size(); ++k) {
+        threads.emplace_back([&reader, &counts, k] {
+            std::vector<double> t, v;
+            for (int repeat = 0; repeat < 50; ++repeat) {
+                reader.readRange(2, (100 * k + 0.5) * 1e-6, (100 * k + 250.5) * 1e-6, t, v);
+            }
+            counts[k] = t.size();
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    assert(counts == std::vector<size_t>(4, 250));
+
+    // Only the chunks a query overlaps are decoded: a damaged last chunk
+    // does not affect earlier windows
+    {
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        uint32_t huge = 0xffffffffu;
+        file.seekp(static_cast<std::streamoff>(reader.getChunk(10).offset + 40 + 4));  // time block size
+        file.write(reinterpret_cast<const char*>(&huge), sizeof(huge));
+    }
+    const WaveformFileReader damaged(path);
+    damaged.readRange(1, 0.0, 500 * 1e-6, times, values);
+    assert(times.size() == 501);
+    assert(threwWaveformError([&] { damaged.readColumn(1); }));
+    std::cout << "✓ Time query test passed" << std::endl;
+}
+
+void test_simulation_through_async_writer() {
+    auto circuit = test::makeCircuit("RC", {"IN", "OUT", "GND"});
+    test::wire(*circuit, circuit->createComponent<VoltageSource>("V1", Waveform::sine(0.0, 1.0, 1e3)), "IN", "GND");
+    test::wire(*circuit, circuit->createComponent<Resistor>("R1", 1e3), "IN", "OUT");
+    test::wire(*circuit, circuit->createComponent<Capacitor>("C1", 1e-7), "OUT", "GND");
+
+    std::string path = tempFile("simulation.icwave");
+    auto file = std::make_shared<WaveformFileWriter>(path);
+    auto results = std::make_shared<ResultStore>();
+    results->addProbe("v(*)");
+    results->addSink(std::make_shared<AsyncSampleWriter>(file));
+    circuit->setResultStore(results);
+    circuit->simulate(2e-3, 1e-7);
+
+    WaveformFileReader reader(path);
+    assert(reader.getSampleCount() == results->getSampleCount());
+    assert(reader.getColumns().size() == 1 + results->getProbeCount());
+    assert(reader.readColumn(0) == results->copyTime());
+    size_t out = reader.findColumn("v(OUT)");
+    assert(reader.readColumn(out) == results->copySamples(results->findProbe("v(OUT)")));
+    std::cout << "  " << reader.getSampleCount() << " samples, " << file->getStats().compressionRatio()
+              << "x smaller" << std::endl;
+    std::cout << "✓ Simulation output test passed" << std::endl;
+}
+
+void test_truncated_and_corrupt_files() {
+    std::string path = tempFile("truncated.icwave");
+    WaveformWriterOptions options;
+    options.chunk_samples = 64;
+    WaveformFileWriter writer(path, options);
+    writer.begin({"time", "x"});
+    for (int i = 0; i < 300; ++i) {
+        double row[2] = {double(i), double(i * i)};
+        writer.write(row, 1, 2);
+    }
+    writer.finish();
+
+    // Losing the trailer, the index (240 bytes) and part of the last chunk
+    // keeps the whole chunks
+    auto size = std::filesystem::file_size(path);
+    std::filesystem::resize_file(path, size - 250);
+    WaveformFileReader recovered(path);
+    assert(!recovered.isComplete());
+    assert(recovered.getChunkCount() == 4 && recovered.getSampleCount() == 256);
+    std::vector<double> x = recovered.readColumn(1);
+    assert(x[255] == 255.0 * 255.0);
+
+    std::filesystem::resize_file(path, 10);
+    assert(threwWaveformError([&] { WaveformFileReader reader(path); }));
+
+    // A truncated block is reported, not read past
+    std::vector<double> values(100, 0.0);
+    for (size_t i = 0; i < values.size(); ++i) {
+        values[i] = std::sqrt(double(i));
+    }
+    std::vector<uint64_t> words;
+    WaveformCodec codec = encodeWaveform(values.data(), values.size(), words);
+    WaveformDecoder decoder(words.data(), words.size() / 2, values.size(), codec);
+    std::vector<double> decoded(values.size());
+    assert(threwWaveformError([&] { decoder.decode(decoded.data()); }));
+    std::cout << "✓ Truncated file test passed" << std::endl;
+}
+
+int main() {
+    std::cout << "Running Waveform File Tests..." << std::endl;
+
+    try {
+        test_codecs_are_lossless();
+        test_mantissa_rounding();
+        test_file_round_trip_and_index();
+        test_time_queries();
+        test_simulation_through_async_writer();
+        test_truncated_and_corrupt_files();
+        std::filesystem::remove_all(kDir);
+
+        std::cout << "\\n✅ All waveform file tests passed!" << std::endl;
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "❌ Test failed: " << e.what() << std::endl;
+        return 1;
+    } catch (...) {
+        std::cerr << "❌ Unknown test failure" << std::endl;
+        return 1;
+    }
+}